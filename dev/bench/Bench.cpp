@@ -0,0 +1,313 @@
+#include "Bench.hpp"
+#include "Xi/Math.hpp"
+#include "Xi/Perf.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+#ifndef XI_BENCH_BUILD_TYPE
+#define XI_BENCH_BUILD_TYPE ""
+#endif
+
+namespace XiBench {
+
+i64 nanos() {
+#if defined(__unix__) || defined(__APPLE__)
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (i64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+  return micros() * 1000;
+#endif
+}
+
+// --- Registry ---
+
+const int MaxGroups = 64, MaxResults = 512, MaxReps = 1000;
+
+Group groups[MaxGroups];
+int groupCount = 0;
+
+Register::Register(Group fn) {
+  if (groupCount < MaxGroups)
+    groups[groupCount++] = fn;
+}
+
+// --- Results ---
+
+struct Result {
+  char name[64];
+  usz iters, bytes;
+  int reps;
+  f64 ns[MaxReps];
+  f64 min, median, p90, p99, mean;
+  PerfCounters::Sample counts; ///< Summed over all reps
+};
+
+Result *results = nullptr;
+int resultCount = 0;
+
+PerfCounters *counters = nullptr; ///< Open only with --counters
+PerfCounters::Sample countStart;
+
+bool State::wants(const char *name) {
+  bool match = config.filterCount == 0;
+  for (int i = 0; i < config.filterCount && !match; ++i)
+    match = strstr(name, config.filters[i]) != nullptr;
+  if (match && config.list)
+    printf("%s\n", name);
+  return match && !config.list && resultCount < MaxResults;
+}
+
+f64 *State::begin(const char *name, usz iters, usz bytes) {
+  Result &r = results[resultCount];
+  snprintf(r.name, sizeof r.name, "%s", name);
+  r.iters = iters;
+  r.bytes = bytes;
+  r.reps = config.reps;
+  r.counts = PerfCounters::Sample();
+  return r.ns;
+}
+
+void State::count(bool start) {
+  if (!counters)
+    return;
+  if (start) {
+    countStart = counters->read();
+    return;
+  }
+  Result &r = results[resultCount];
+  PerfCounters::Sample d = counters->read() - countStart;
+  if (r.counts.valid == 0)
+    r.counts = d;
+  else
+    r.counts += d;
+}
+
+// One indented line of counts divided by `per` (ops or calls).
+static void printCounts(const PerfCounters::Sample &c, f64 per,
+                        const char *unit) {
+  if (!c.valid)
+    return;
+  printf("  ");
+  if (c.ipc() > 0)
+    printf(" ipc %.2f", c.ipc());
+  for (int e = 0; e < PerfCounters::EventCount; ++e)
+    if (c.has((PerfCounters::Event)e))
+      printf(" %s/%s %.4g", PerfCounters::name((PerfCounters::Event)e), unit,
+             c.value[e] / per);
+  printf("\n");
+}
+
+// Nearest-rank percentile over sorted samples.
+static f64 rank(const f64 *sorted, int n, f64 p) {
+  int i = (int)(p * n + 0.999999) - 1;
+  return sorted[i < 0 ? 0 : (i >= n ? n - 1 : i)];
+}
+
+void State::end() {
+  Result &r = results[resultCount++];
+  f64 s[MaxReps];
+  f64 sum = 0;
+  for (int i = 0; i < r.reps; ++i) {
+    f64 v = r.ns[i];
+    int j = i;
+    for (; j > 0 && s[j - 1] > v; --j)
+      s[j] = s[j - 1];
+    s[j] = v;
+    sum += v;
+  }
+  r.min = s[0];
+  r.median = rank(s, r.reps, 0.5);
+  r.p90 = rank(s, r.reps, 0.9);
+  r.p99 = rank(s, r.reps, 0.99);
+  r.mean = sum / r.reps;
+
+  printf("%-40s %12.1f %12.1f %12.1f %+7.1f%%", r.name, r.median, r.min,
+         r.p90, (r.p90 - r.median) / r.median * 100);
+  if (r.bytes)
+    printf(" %10.1f", r.bytes / r.median * 1e3);
+  printf("\n");
+  printCounts(r.counts, (f64)r.iters * r.reps, "op");
+  fflush(stdout);
+}
+
+// --- Output ---
+
+static void jsonCounts(FILE *f, const PerfCounters::Sample &c, f64 per) {
+  fprintf(f, "{");
+  bool first = true;
+  if (c.ipc() > 0) {
+    fprintf(f, "\"ipc\": %.4f", c.ipc());
+    first = false;
+  }
+  for (int e = 0; e < PerfCounters::EventCount; ++e)
+    if (c.has((PerfCounters::Event)e)) {
+      fprintf(f, "%s\"%s\": %.4f", first ? "" : ", ",
+              PerfCounters::name((PerfCounters::Event)e),
+              c.value[e] / per);
+      first = false;
+    }
+  fprintf(f, "}");
+}
+
+// Totals of the XI_PERF_REGION markers hit during the run (library built
+// with XI_PERF_REGIONS), per call.
+static usz regionStats(PerfRegionStats *out, usz max) {
+  usz n = PerfRegion::collect(out, max);
+  return n < max ? n : max;
+}
+
+static void printRegions() {
+  PerfRegionStats regions[64];
+  usz n = regionStats(regions, 64);
+  if (!n)
+    return;
+  printf("\n%-40s %12s %12s\n", "region", "calls", "ns/call");
+  for (usz i = 0; i < n; ++i) {
+    const PerfRegionStats &g = regions[i];
+    f64 calls = g.calls ? (f64)g.calls : 1;
+    printf("%-40s %12llu %12.1f\n", g.name, (unsigned long long)g.calls,
+           g.ns / calls);
+    printCounts(g.counts, calls, "call");
+  }
+}
+
+static void writeJson(const char *path, const Config &c) {
+  FILE *f = fopen(path, "w");
+  if (!f) {
+    fprintf(stderr, "xi_bench: cannot write %s\n", path);
+    return;
+  }
+  fprintf(f, "{\n  \"meta\": {\n");
+  fprintf(f, "    \"time\": %lld,\n", (long long)::time(nullptr));
+  fprintf(f, "    \"isa\": \"%s\",\n", Math::Simd::isa());
+#if defined(__VERSION__)
+  fprintf(f, "    \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+  fprintf(f, "    \"build\": \"%s\",\n", XI_BENCH_BUILD_TYPE);
+  fprintf(f, "    \"threads\": %u,\n", std::thread::hardware_concurrency());
+  fprintf(f, "    \"counters\": [");
+  for (int e = 0, n = 0; counters && e < PerfCounters::EventCount; ++e)
+    if (counters->available((PerfCounters::Event)e))
+      fprintf(f, "%s\"%s\"", n++ ? ", " : "",
+              PerfCounters::name((PerfCounters::Event)e));
+  fprintf(f, "],\n");
+  fprintf(f, "    \"reps\": %d,\n    \"sample_ns\": %lld\n  },\n", c.reps,
+          (long long)c.sampleNs);
+  fprintf(f, "  \"results\": [\n");
+  for (int i = 0; i < resultCount; ++i) {
+    const Result &r = results[i];
+    fprintf(f,
+            "    {\"name\": \"%s\", \"iters\": %llu, \"bytes\": %llu, "
+            "\"min\": %.3f, \"median\": %.3f, \"p90\": %.3f, \"p99\": %.3f, "
+            "\"mean\": %.3f, \"samples\": [",
+            r.name, (unsigned long long)r.iters, (unsigned long long)r.bytes,
+            r.min, r.median, r.p90, r.p99, r.mean);
+    for (int k = 0; k < r.reps; ++k)
+      fprintf(f, "%s%.3f", k ? ", " : "", r.ns[k]);
+    fprintf(f, "]");
+    if (r.counts.valid) {
+      fprintf(f, ", \"counters\": ");
+      jsonCounts(f, r.counts, (f64)r.iters * r.reps);
+    }
+    fprintf(f, "}%s\n", i + 1 < resultCount ? "," : "");
+  }
+  fprintf(f, "  ]");
+  PerfRegionStats regions[64];
+  usz n = regionStats(regions, 64);
+  if (n) {
+    fprintf(f, ",\n  \"regions\": [\n");
+    for (usz i = 0; i < n; ++i) {
+      const PerfRegionStats &g = regions[i];
+      f64 calls = g.calls ? (f64)g.calls : 1;
+      fprintf(f, "    {\"name\": \"%s\", \"calls\": %llu, "
+                 "\"ns\": %.3f, \"counters\": ",
+              g.name, (unsigned long long)g.calls, g.ns / calls);
+      jsonCounts(f, g.counts, calls);
+      fprintf(f, "}%s\n", i + 1 < n ? "," : "");
+    }
+    fprintf(f, "  ]");
+  }
+  fprintf(f, "\n}\n");
+  fclose(f);
+}
+
+static bool flag(const char *arg, const char *name, const char **value) {
+  usz n = strlen(name);
+  if (strncmp(arg, name, n) != 0)
+    return false;
+  *value = arg[n] == '=' ? arg + n + 1 : arg + n;
+  return arg[n] == '=' || arg[n] == 0;
+}
+
+} // namespace XiBench
+
+using namespace XiBench;
+
+int main(int argc, char **argv) {
+  Config c;
+  const char *json = nullptr;
+  const char **filters = new const char *[argc];
+  for (int i = 1; i < argc; ++i) {
+    const char *v;
+    if (flag(argv[i], "--json", &v))
+      json = v;
+    else if (flag(argv[i], "--reps", &v))
+      c.reps = atoi(v);
+    else if (flag(argv[i], "--sample-ms", &v))
+      c.sampleNs = (i64)(atof(v) * 1e6);
+    else if (flag(argv[i], "--warmup-ms", &v))
+      c.warmupNs = (i64)(atof(v) * 1e6);
+    else if (flag(argv[i], "--list", &v))
+      c.list = true;
+    else if (flag(argv[i], "--counters", &v))
+      c.counters = true;
+    else if (argv[i][0] == '-') {
+      printf("usage: xi_bench [filter...] [--json=out.json] [--reps=15]\n"
+             "                [--sample-ms=20] [--warmup-ms=50] [--list]\n"
+             "                [--counters]\n"
+             "Times every result whose name contains one of the filters\n"
+             "(all without filters); ns/op median, min, p90 and spread.\n"
+             "--counters adds perf_event_open counts per op (Linux).\n");
+      return argv[i][1] == 'h' || !strcmp(argv[i], "--help") ? 0 : 2;
+    } else
+      filters[c.filterCount++] = argv[i];
+  }
+  c.filters = filters;
+  c.reps = c.reps < 1 ? 1 : (c.reps > MaxReps ? MaxReps : c.reps);
+
+  results = new Result[MaxResults];
+  if (c.counters && !c.list) {
+    counters = new PerfCounters();
+    if (!counters->open()) {
+      printf("counters: perf_event_open unavailable (no PMU, "
+             "perf_event_paranoid or a container seccomp policy)\n");
+      delete counters;
+      counters = nullptr;
+    } else if (!counters->available(PerfCounters::Instructions)) {
+      printf("counters: no hardware events, software events only\n");
+    }
+  }
+  if (!c.list)
+    printf("isa %s, %d reps of %.0f ms\n\n%-40s %12s %12s %12s %8s %10s\n",
+           Math::Simd::isa(), c.reps, c.sampleNs / 1e6, "ns/op", "median",
+           "min", "p90", "spread", "MB/s");
+  State s(c);
+  for (int g = 0; g < groupCount; ++g)
+    groups[g](s);
+  if (!c.list)
+    printRegions();
+  if (json)
+    writeJson(json, c);
+  delete counters;
+  delete[] results;
+  delete[] filters;
+  return 0;
+}
@@ -0,0 +1,106 @@
+#ifndef XI_BENCH_HPP
+#define XI_BENCH_HPP
+
+#include "Xi/Primitives.hpp"
+
+// -------------------------------------------------------------------------
+// xi_bench harness
+//
+// Each XI_BENCH group registers itself at static-init time and reports one
+// or more results through State::run(). A run calibrates the iteration
+// count to the sample length, warms up, then times `reps` samples and keeps
+// ns/op for each; Bench.cpp turns those into min / median / p90 / p99 and
+// writes the table and the JSON that dev/bench/compare.py diffs. With
+// --counters each sample is also bracketed by Xi::PerfCounters reads.
+// -------------------------------------------------------------------------
+
+namespace XiBench {
+
+using namespace Xi;
+
+/// Keeps a value alive so the optimizer cannot drop the work behind it.
+template <typename T> inline void keep(const T &v) {
+#if defined(__GNUC__)
+  asm volatile("" : : "g"(&v) : "memory");
+#else
+  volatile const void *p = &v;
+  (void)p;
+#endif
+}
+
+i64 nanos();
+
+struct Config {
+  const char *const *filters = nullptr; ///< substrings; a result must match one
+  int filterCount = 0;
+  int reps = 15;
+  i64 sampleNs = 20000000; ///< target length of one sample
+  i64 warmupNs = 50000000;
+  bool list = false;
+  bool counters = false; ///< perf_event_open counts per result (Linux)
+};
+
+class State {
+public:
+  explicit State(const Config &c) : config(c) {}
+
+  /// Whether `name` passes the command-line filters (and --list is off).
+  bool wants(const char *name);
+
+  /// Times op() as one operation named `name`. `bytes` per operation, if
+  /// set, adds a MB/s column.
+  template <typename Op> void run(const char *name, Op op, usz bytes = 0) {
+    if (!wants(name))
+      return;
+    usz iters = 1;
+    for (;;) {
+      i64 t = batch(op, iters);
+      if (t >= config.sampleNs / 8 || iters >= ((usz)1 << 40)) {
+        f64 scale = t > 0 ? (f64)config.sampleNs / (f64)t : 8;
+        iters = (usz)(iters * (scale > 8 ? 8 : scale));
+        iters = iters ? iters : 1;
+        break;
+      }
+      iters *= 8;
+    }
+    for (i64 end = nanos() + config.warmupNs; nanos() < end;)
+      batch(op, iters);
+    f64 *ns = begin(name, iters, bytes);
+    for (int r = 0; r < config.reps; ++r) {
+      count(true);
+      ns[r] = (f64)batch(op, iters) / (f64)iters;
+      count(false);
+    }
+    end();
+  }
+
+private:
+  const Config &config;
+
+  template <typename Op> static i64 batch(Op &op, usz iters) {
+    i64 t0 = nanos();
+    for (usz i = 0; i < iters; ++i)
+      op();
+    return nanos() - t0;
+  }
+
+  f64 *begin(const char *name, usz iters, usz bytes);
+  void count(bool start); ///< no-op unless config.counters
+  void end();
+};
+
+typedef void (*Group)(State &);
+
+struct Register {
+  explicit Register(Group fn);
+};
+
+} // namespace XiBench
+
+/// Declares a group of results: XI_BENCH(strings) { s.run("...", op); }
+#define XI_BENCH(fn)                                                           \
+  static void fn(XiBench::State &s);                                           \
+  static XiBench::Register fn##Registration(fn);                               \
+  static void fn(XiBench::State &s)
+
+#endif
@@ -0,0 +1,210 @@
+// Containers, strings, varints, serialization and Regex.
+
+#include "Bench.hpp"
+#include "Xi/Array.hpp"
+#include "Xi/Map.hpp"
+#include "Xi/Regex.hpp"
+#include "Xi/String.hpp"
+
+using namespace XiBench;
+
+XI_BENCH(inlineArray) {
+  s.run("inlinearray/push/1k", [] {
+    InlineArray<u64> a;
+    for (u64 i = 0; i < 1024; ++i)
+      a.push(i);
+    keep(a);
+  });
+
+  u64 src[1024];
+  for (u64 i = 0; i < 1024; ++i)
+    src[i] = i * 7;
+  s.run("inlinearray/pushEach/1k", [&] {
+    InlineArray<u64> a;
+    a.pushEach(src, 1024);
+    keep(a);
+  }, sizeof src);
+
+  InlineArray<u64> shared;
+  shared.pushEach(src, 1024);
+  s.run("inlinearray/copy+detach/1k", [&] {
+    InlineArray<u64> b = shared; // shares the block
+    b.push(1);                   // detaches it
+    keep(b);
+  }, sizeof src);
+}
+
+XI_BENCH(array) {
+  s.run("array/push/1k", [] {
+    Array<u64> a;
+    for (u64 i = 0; i < 1024; ++i)
+      a.push(i);
+    keep(a);
+  });
+
+  Array<u64> a;
+  for (u64 i = 0; i < 4096; ++i)
+    a.push(i);
+  s.run("array/index/4k", [&] {
+    u64 sum = 0;
+    for (usz i = 0; i < 4096; ++i)
+      sum += a[i];
+    keep(sum);
+  });
+}
+
+XI_BENCH(strings) {
+  u8 raw[1024];
+  for (int i = 0; i < 1024; ++i)
+    raw[i] = (u8)('a' + i % 26);
+
+  s.run("string/construct/64", [&] {
+    String x(raw, 64);
+    keep(x);
+  }, 64);
+  s.run("string/construct/1k", [&] {
+    String x(raw, 1024);
+    keep(x);
+  }, 1024);
+
+  String part(raw, 16);
+  s.run("string/concat/16x64", [&] {
+    String x;
+    for (int i = 0; i < 64; ++i)
+      x += part;
+    keep(x);
+  }, 16 * 64);
+
+  String text(raw, 1024);
+  text += "needle";
+  s.run("string/indexOf/1k", [&] {
+    long long at = text.indexOf("needle");
+    keep(at);
+  }, text.size());
+  s.run("string/substring", [&] {
+    String x = text.substring(100, 900);
+    keep(x);
+  });
+  s.run("string/split/1k", [&] {
+    Array<String> parts = text.split("q");
+    keep(parts);
+  }, text.size());
+}
+
+XI_BENCH(maps) {
+  s.run("map/u64/insert/1k", [] {
+    Map<u64, u64> m;
+    for (u64 i = 0; i < 1024; ++i)
+      m.put(i * 2654435761u, i);
+    keep(m);
+  });
+
+  Map<u64, u64> m;
+  for (u64 i = 0; i < 1024; ++i)
+    m.put(i * 2654435761u, i);
+  s.run("map/u64/lookup/1k", [&] {
+    u64 sum = 0;
+    for (u64 i = 0; i < 1024; ++i)
+      sum += *m.get(i * 2654435761u);
+    keep(sum);
+  });
+
+  String keys[256];
+  for (int i = 0; i < 256; ++i)
+    keys[i] = String("key-") + String(i);
+  s.run("map/string/insert/256", [&] {
+    Map<String, u64> ms;
+    for (int i = 0; i < 256; ++i)
+      ms.put(keys[i], (u64)i);
+    keep(ms);
+  });
+
+  Map<String, u64> ms;
+  for (int i = 0; i < 256; ++i)
+    ms.put(keys[i], (u64)i);
+  s.run("map/string/lookup/256", [&] {
+    u64 sum = 0;
+    for (int i = 0; i < 256; ++i)
+      sum += *ms.get(keys[i]);
+    keep(sum);
+  });
+}
+
+XI_BENCH(varint) {
+  long long values[256];
+  for (int i = 0; i < 256; ++i)
+    values[i] = (long long)1 << (i % 56);
+  s.run("varint/push/256", [&] {
+    String x;
+    for (int i = 0; i < 256; ++i)
+      x.pushVarLong(values[i]);
+    keep(x);
+  });
+
+  String packed;
+  for (int i = 0; i < 256; ++i)
+    packed.pushVarLong(values[i]);
+  s.run("varint/peek/256", [&] {
+    usz at = 0;
+    long long sum = 0;
+    while (at < packed.size()) {
+      auto r = packed.peekVarLong(at);
+      sum += r.value;
+      at += r.bytes;
+    }
+    keep(sum);
+  }, packed.size());
+}
+
+XI_BENCH(serialize) {
+  Array<u64> nums;
+  for (u64 i = 0; i < 1024; ++i)
+    nums.push(i * i);
+  s.run("serialize/array<u64>/1k", [&] {
+    String x = nums.serialize();
+    keep(x);
+  });
+  String numsBlob = nums.serialize();
+  s.run("deserialize/array<u64>/1k", [&] {
+    Array<u64> x = Array<u64>::deserialize(numsBlob);
+    keep(x);
+  }, numsBlob.size());
+
+  Map<u64, String> meta;
+  for (u64 i = 0; i < 64; ++i)
+    meta.put(i, String("value-") + String(i));
+  s.run("serialize/map<u64,string>/64", [&] {
+    String x = meta.serialize();
+    keep(x);
+  });
+  String metaBlob = meta.serialize();
+  s.run("deserialize/map<u64,string>/64", [&] {
+    Map<u64, String> x = Map<u64, String>::deserialize(metaBlob);
+    keep(x);
+  }, metaBlob.size());
+}
+
+XI_BENCH(regex) {
+  String log;
+  const char *line = "GET /api/v1/items?id=42 HTTP/1.1 200 1532 user=alice\n";
+  while (log.size() < 64 * 1024)
+    log += line;
+
+  Regex literal("HTTP/1.1 404");
+  s.run("regex/literal-miss/64k", [&] {
+    Array<RegexMatch> m = literal.matchAll(log);
+    keep(m);
+  }, log.size());
+
+  Regex user("user=[a-z]+");
+  s.run("regex/class-matches/64k", [&] {
+    Array<RegexMatch> m = user.matchAll(log);
+    keep(m);
+  }, log.size());
+
+  Regex groups("id=(\\d+) HTTP/(\\d)\\.(\\d) (\\d+)");
+  s.run("regex/groups/64k", [&] {
+    Array<RegexMatch> m = groups.matchAll(log);
+    keep(m);
+  }, log.size());
+}
@@ -0,0 +1,70 @@
+// AEAD, BLAKE2b and X25519 through the Xi::String wrappers Rho uses.
+
+#include "Bench.hpp"
+#include "Xi/Crypto.hpp"
+
+using namespace XiBench;
+
+XI_BENCH(aead) {
+  String key = hash(String("xi_bench key"), 32);
+  const usz sizes[3] = {64, 1400, 64 * 1024};
+  const char *seal[3] = {"aead/seal/64", "aead/seal/1400", "aead/seal/64k"};
+  const char *open[3] = {"aead/open/64", "aead/open/1400", "aead/open/64k"};
+  for (int i = 0; i < 3; ++i) {
+    String text;
+    for (usz k = 0; k < sizes[i]; ++k)
+      text.push((u8)k);
+    u64 nonce = 0;
+    s.run(seal[i], [&] {
+      AEADOptions o;
+      o.text = text;
+      o.tagLength = 8;
+      aeadSeal(key, ++nonce, o);
+      keep(o);
+    }, sizes[i]);
+
+    AEADOptions sealed;
+    sealed.text = text;
+    sealed.tagLength = 8;
+    aeadSeal(key, 1, sealed);
+    s.run(open[i], [&] {
+      AEADOptions o;
+      o.text = sealed.text;
+      o.tag = sealed.tag;
+      o.tagLength = 8;
+      bool ok = aeadOpen(key, 1, o);
+      keep(ok);
+    }, sizes[i]);
+  }
+}
+
+XI_BENCH(blake2b) {
+  String small("xi_bench"), big;
+  for (usz k = 0; k < 64 * 1024; ++k)
+    big.push((u8)(k * 31));
+  s.run("hash/blake2b-32/8", [&] {
+    String h = hash(small, 32);
+    keep(h);
+  }, small.size());
+  s.run("hash/blake2b-64/64k", [&] {
+    String h = hash(big, 64);
+    keep(h);
+  }, big.size());
+  String salt("salt");
+  s.run("hash/kdf-32", [&] {
+    String k = kdf(small, salt, String("info"), 32);
+    keep(k);
+  });
+}
+
+XI_BENCH(x25519) {
+  KeyPair a = generateKeyPair(), b = generateKeyPair();
+  s.run("x25519/publicKey", [&] {
+    String p = publicKey(a.secretKey);
+    keep(p);
+  });
+  s.run("x25519/sharedKey", [&] {
+    String k = sharedKey(a.secretKey, b.publicKey);
+    keep(k);
+  });
+}
@@ -0,0 +1,67 @@
+// Vector transcendentals, GEMM and batched 4x4 transforms.
+
+#include "Bench.hpp"
+#include "Xi/Math.hpp"
+
+using namespace XiBench;
+
+XI_BENCH(simd) {
+  const usz N = 4096;
+  static f32 x[N], y[N];
+  for (usz i = 0; i < N; ++i)
+    x[i] = (f32)i / N * 8 - 4;
+  s.run("math/exp/4k", [&] {
+    Math::Simd::exp(x, y, N);
+    keep(y);
+  }, N * 4);
+  s.run("math/sin/4k", [&] {
+    Math::Simd::sin(x, y, N);
+    keep(y);
+  }, N * 4);
+  s.run("math/sigmoid/4k", [&] {
+    Math::Simd::sigmoid(x, y, N);
+    keep(y);
+  }, N * 4);
+}
+
+XI_BENCH(gemm) {
+  const usz sizes[3] = {16, 64, 256};
+  const char *names[3] = {"math/gemm/16", "math/gemm/64", "math/gemm/256"};
+  for (int i = 0; i < 3; ++i) {
+    usz n = sizes[i];
+    f32 *a = new f32[n * n], *b = new f32[n * n], *c = new f32[n * n];
+    for (usz k = 0; k < n * n; ++k)
+      a[k] = (f32)(k % 7) - 3, b[k] = (f32)(k % 5) - 2, c[k] = 0;
+    s.run(names[i], [&] {
+      Math::gemm(n, n, n, 1, a, n, b, n, 0, c, n);
+      keep(c[0]);
+    });
+    delete[] a;
+    delete[] b;
+    delete[] c;
+  }
+}
+
+XI_BENCH(matrix) {
+  Matrix4 m = Math::compose({1, 2, 3}, {0.1f, 0.2f, 0.3f}, {1, 1, 1});
+  const usz N = 4096;
+  static f32 in[N * 3], out[N * 3];
+  for (usz i = 0; i < N * 3; ++i)
+    in[i] = (f32)i;
+  s.run("math/transformPoints/4k", [&] {
+    Math::transformPoints(m, in, out, N);
+    keep(out);
+  }, N * 12);
+
+  static f32 ma[256 * 16], mb[256 * 16], mc[256 * 16];
+  for (usz i = 0; i < 256 * 16; ++i)
+    ma[i] = (f32)(i % 9), mb[i] = (f32)(i % 11);
+  s.run("math/multiply4x4/256", [&] {
+    Math::multiply(ma, mb, mc, 256);
+    keep(mc);
+  });
+  s.run("math/inverse4x4", [&] {
+    Matrix4 r = Math::inverse(m);
+    keep(r);
+  });
+}
@@ -0,0 +1,121 @@
+// Tunnel build/flush/parse round trips and Railway push/pushRaw.
+
+#include "Bench.hpp"
+#include "Rho/Railway.hpp"
+#include "Rho/Tunnel.hpp"
+
+using namespace XiBench;
+
+// Nothing acknowledges bundles in these loops, so windowed tunnels would
+// keep every one for resending; drop them as if they were acked.
+static void ackAll(Tunnel &t) {
+  if (t.inflightBundles.size() > 64) {
+    t.inflightBundles.clear();
+    t.resendPosition = 0;
+  }
+}
+
+static void tunnelPair(const char *name, bool secure, usz size,
+                       usz perBundle, State &s) {
+  Tunnel a, b;
+  a.setAliveTimeout(0);
+  b.setAliveTimeout(0);
+  if (secure) {
+    String key = hash(String("xi_bench tunnel"), 32);
+    a.enableWindowing();
+    b.enableWindowing();
+    a.enableSecurity(key);
+    b.enableSecurity(key);
+  }
+  usz received = 0;
+  b.onPacket([&](Packet p) { received += p.payload.size(); });
+  String payload;
+  for (usz k = 0; k < size; ++k)
+    payload.push((u8)k);
+
+  s.run(name, [&] {
+    for (usz i = 0; i < perBundle; ++i)
+      a.push(payload, 3);
+    String bundle = a.flush();
+    b.parse(bundle);
+    ackAll(a);
+    keep(received);
+  }, size * perBundle);
+}
+
+XI_BENCH(tunnel) {
+  tunnelPair("tunnel/roundtrip/plain/64", false, 64, 1, s);
+  tunnelPair("tunnel/roundtrip/plain/1200", false, 1200, 1, s);
+  tunnelPair("tunnel/roundtrip/secure/64", true, 64, 1, s);
+  tunnelPair("tunnel/roundtrip/secure/1200", true, 1200, 1, s);
+  tunnelPair("tunnel/roundtrip/secure/16x64", true, 64, 16, s);
+
+  // flush() alone: build and seal without the receiving side.
+  Tunnel a;
+  a.setAliveTimeout(0);
+  a.enableWindowing();
+  a.enableSecurity(hash(String("xi_bench tunnel"), 32));
+  String payload;
+  for (usz k = 0; k < 256; ++k)
+    payload.push((u8)k);
+  s.run("tunnel/push+flush/secure/256", [&] {
+    a.push(payload, 3);
+    String bundle = a.flush();
+    ackAll(a);
+    keep(bundle);
+  }, 256);
+}
+
+XI_BENCH(railway) {
+  const bool modes[2] = {false, true};
+  const char *names[2] = {"railway/push/plain/256", "railway/push/secure/256"};
+  for (int m = 0; m < 2; ++m) {
+    RailwayStation a, b;
+    if (modes[m]) {
+      String key = hash(String("xi_bench railway"), 32);
+      a.isSecure = b.isSecure = true;
+      a.key = b.key = key;
+    }
+    usz delivered = 0;
+    b.onCart([&](String data, u64, RailwayStation *) {
+      delivered += data.size();
+    });
+    a.onOutboxRawCartListener([&](u8 h, u64 n, String mac, String ct,
+                                  RailwayStation *origin) {
+      b.pushRaw(h, n, mac, ct, origin);
+    });
+    String data;
+    for (usz k = 0; k < 256; ++k)
+      data.push((u8)k);
+    s.run(names[m], [&] {
+      a.push(data);
+      keep(delivered);
+    }, 256);
+  }
+
+  // pushRaw() alone on a prebuilt plain cart.
+  RailwayStation a, b;
+  u8 header = 0;
+  u64 nonce = 0;
+  String mac, cipher;
+  a.onOutboxRawCartListener([&](u8 h, u64 n, String m, String c,
+                                RailwayStation *) {
+    header = h, nonce = n, mac = m, cipher = c;
+  });
+  String data;
+  for (usz k = 0; k < 256; ++k)
+    data.push((u8)k);
+  a.push(data);
+  usz delivered = 0;
+  b.onCart([&](String d, u64, RailwayStation *) { delivered += d.size(); });
+  s.run("railway/pushRaw/plain/256", [&] {
+    b.pushRaw(header, nonce, mac, cipher, &a);
+    keep(delivered);
+  }, 256);
+
+  s.run("railway/serializeCart/256", [&] {
+    String raw = RailwayStation::serializeCart(header, nonce, mac, cipher);
+    RawCart rc = RailwayStation::deserializeCart(raw);
+    keep(rc);
+  }, 256);
+}
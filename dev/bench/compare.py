@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Diff two xi_bench --json runs.
+
+    dev/bench/compare.py base.json new.json [--threshold=5] [filter...]
+
+Prints the median ns/op of every result present in both runs and the
+change in percent. A change counts only when it exceeds the threshold and
+the [min, p90] ranges of the two runs do not overlap; anything else is
+shown as noise. Exits with 1 when some result got slower, so the script
+can gate a CI step.
+
+When both runs were made with --counters and counted instructions, the
+change in instructions/op is shown as well; unlike time it hardly moves
+between runs, so it tells a code change from a noisy machine.
+"""
+
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        run = json.load(f)
+    return run.get('meta', {}), {r['name']: r for r in run['results']}
+
+
+def main(argv):
+    threshold = 5.0
+    paths, filters = [], []
+    for arg in argv:
+        if arg.startswith('--threshold='):
+            threshold = float(arg.split('=', 1)[1])
+        elif arg.startswith('-'):
+            print(__doc__.strip())
+            return 0 if arg in ('-h', '--help') else 2
+        elif len(paths) < 2:
+            paths.append(arg)
+        else:
+            filters.append(arg)
+    if len(paths) != 2:
+        print(__doc__.strip())
+        return 2
+
+    (meta_a, a), (meta_b, b) = load(paths[0]), load(paths[1])
+    for key in ('isa', 'build', 'compiler'):
+        if meta_a.get(key) != meta_b.get(key):
+            print('note: %s differs: %s -> %s'
+                  % (key, meta_a.get(key), meta_b.get(key)))
+
+    print('%-40s %12s %12s %9s' % ('ns/op', 'base', 'new', 'change'))
+    slower = faster = 0
+    for name, old in a.items():
+        new = b.get(name)
+        if new is None or (filters and not any(f in name for f in filters)):
+            continue
+        change = (new['median'] - old['median']) / old['median'] * 100
+        overlap = new['min'] <= old['p90'] and old['min'] <= new['p90']
+        if abs(change) < threshold or overlap:
+            verdict = ''
+        elif change > 0:
+            verdict, slower = '  slower', slower + 1
+        else:
+            verdict, faster = '  faster', faster + 1
+        instr = ''
+        ia = old.get('counters', {}).get('instructions')
+        ib = new.get('counters', {}).get('instructions')
+        if ia and ib:
+            instr = '  instr %+.1f%%' % ((ib - ia) / ia * 100)
+        print('%-40s %12.1f %12.1f %+8.1f%%%s%s'
+              % (name, old['median'], new['median'], change, verdict, instr))
+
+    missing = len(set(a) ^ set(b))
+    if missing:
+        print('\n%d results appear in only one run' % missing)
+    print('\n%d slower, %d faster (threshold %g%%)'
+          % (slower, faster, threshold))
+    return 1 if slower else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,90 @@
+// Array expression fusion: sigmoid(a * 2 + b) evaluated eagerly (one
+// temporary and one pass per operator) vs. fused into one pass.
+// g++ -O3 -march=native -std=c++17 -Iinclude dev/bench_array_expr.cpp
+//     -L_gate_build -lXi
+
+#include "Xi/Array.hpp"
+#include "Xi/Math.hpp"
+#include "Xi/Time.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+using namespace Xi;
+
+static usz allocations = 0;
+
+void *operator new(size_t n) {
+  allocations++;
+  if (void *p = malloc(n ? n : 1))
+    return p;
+  __builtin_abort();
+}
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+template <typename F> static i64 best(int reps, F f) {
+  i64 b = -1;
+  for (int r = 0; r < reps; ++r) {
+    i64 t0 = micros();
+    f();
+    i64 dt = micros() - t0;
+    if (b < 0 || dt < b)
+      b = dt;
+  }
+  return b;
+}
+
+int main() {
+  const usz sizes[] = {(usz)1 << 20, (usz)10 << 20, (usz)100 << 20};
+  printf("%10s %22s %22s %22s\n", "elements", "eager", "fused",
+         "fused into dst");
+  for (usz n : sizes) {
+    Array<f32> a, b, out;
+    a.allocate(n);
+    b.allocate(n);
+    f32 *pa = a.data(), *pb = b.data();
+    for (usz i = 0; i < n; ++i) {
+      pa[i] = (f32)(i % 1000) * 0.001f;
+      pb[i] = 0.5f;
+    }
+    int reps = n > ((usz)10 << 20) ? 2 : 5;
+
+    usz allocEager = 0, allocFused = 0, allocInto = 0;
+    i64 eager = best(reps, [&]() {
+      usz before = allocations;
+      Array<f32> t1 = a * 2.0f;
+      Array<f32> t2 = t1 + b;
+      Array<f32> r = Math::sigmoid(t2);
+      allocEager = allocations - before;
+    });
+    i64 fused = best(reps, [&]() {
+      usz before = allocations;
+      Array<f32> r = Math::sigmoid(a * 2.0f + b);
+      allocFused = allocations - before;
+    });
+    out.allocate(n);
+    i64 into = best(reps, [&]() {
+      usz before = allocations;
+      evalInto(out, Math::sigmoid(a * 2.0f + b));
+      allocInto = allocations - before;
+    });
+
+    // Bytes the result fundamentally needs: read a and b, write r.
+    f64 bytes = 3.0 * (f64)n * sizeof(f32);
+    printf("%10zu %9.2f GB/s %2zu allocs %9.2f GB/s %2zu allocs %9.2f GB/s %2zu "
+           "allocs\n",
+           (size_t)n, bytes / (f64)eager / 1e3, (size_t)allocEager,
+           bytes / (f64)fused / 1e3, (size_t)allocFused,
+           bytes / (f64)into / 1e3, (size_t)allocInto);
+
+    // Fused and eager agree.
+    Array<f32> t1 = a * 2.0f;
+    Array<f32> t2 = t1 + b;
+    Array<f32> e = Math::sigmoid(t2);
+    f32 diff = Math::sum(Math::abs(e - out));
+    if (diff != 0.0f)
+      printf("  MISMATCH: |eager - fused| = %g\n", diff);
+  }
+  return 0;
+}
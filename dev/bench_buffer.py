@@ -0,0 +1,82 @@
+# MB/s across the Python/C++ boundary for String and Array<float>: the
+# copying paths the package used before (ctypes staging buffer into
+# String, ctypes.string_at out of it, per-element reads of an Array)
+# against the zero-copy ones (bytes-like constructor, xi.view() and
+# xi.numpy() over the InlineArray block). Best of N runs per size.
+# python3 dev/bench_buffer.py [N]
+
+import ctypes
+import sys
+import time
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parent.parent / "src"))
+import xi  # noqa: E402
+
+Xi = xi.Xi
+SIZES = [64, 4096, 1 << 20, 16 << 20]
+
+
+def best(fn, nbytes, runs):
+    reps = max(1, (64 << 20) // nbytes)
+    t = 1e30
+    for _ in range(runs):
+        t0 = time.perf_counter()
+        for _ in range(reps):
+            fn()
+        t = min(t, (time.perf_counter() - t0) / reps)
+    return nbytes / t / 1e6
+
+
+def legacy_string(data):
+    s = xi.String()
+    c_buf = (ctypes.c_ubyte * len(data)).from_buffer_copy(data)
+    s.pushEach(xi.cppyy.ll.cast['uint8_t*'](ctypes.addressof(c_buf)),
+               len(data))
+    return s
+
+
+def main():
+    runs = int(sys.argv[1]) if len(sys.argv) > 1 else 5
+    try:
+        import numpy as np
+    except ImportError:
+        np = None
+
+    rows = []
+    for n in SIZES:
+        data = bytes(range(256)) * (n // 256) if n >= 256 else bytes(n)
+        buf = bytearray(data)
+        s = xi.String(data)
+        rows.append((n, "String(bytes) in", [
+            best(lambda: legacy_string(data), n, runs),
+            best(lambda: xi.String(data), n, runs)]))
+        rows.append((n, "String(bytearray) in", [
+            best(lambda: legacy_string(buf), n, runs),
+            best(lambda: xi.String(buf), n, runs)]))
+        rows.append((n, "String out", [
+            best(lambda: bytes(s), n, runs),
+            best(lambda: s.view(), n, runs)]))
+
+        count = n // 4
+        arr = Xi.Array["float"]()
+        arr.reserve(count)
+        for i in range(min(count, 1 << 16)):
+            arr.push(float(i))
+        got = arr.length()
+        if got:
+            per = [best(lambda: [arr[i] for i in range(got)], got * 4, 1),
+                   best(lambda: xi.view(arr), got * 4, runs)]
+            if np is not None:
+                per.append(best(lambda: xi.numpy(arr).sum(), got * 4, runs))
+            rows.append((got * 4, "Array<float> out", per))
+
+    head = ["before", "zero-copy"] + (["numpy sum"] if np else [])
+    print("%10s %-22s" % ("bytes", "MB/s, best of %d" % runs) +
+          "".join("%14s" % h for h in head))
+    for n, name, vals in rows:
+        print("%10d %-22s" % (n, name) + "".join("%14.0f" % v for v in vals))
+
+
+if __name__ == "__main__":
+    main()
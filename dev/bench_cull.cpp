@@ -0,0 +1,135 @@
+// Frustum culling a 100k-object scene: drawing everything (what Camera3
+// did), a brute-force SIMD test over all boxes, and the CullBVH, with the
+// draw count each leaves. Objects hang off a TransformHierarchy; 1% move
+// per frame and the BVH refits.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_cull.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/Culling.hpp"
+#include "Xi/Hierarchy.hpp"
+#include <cstdio>
+
+using namespace Xi;
+
+template <typename F> static i64 best(int reps, F f) {
+  i64 b = -1;
+  for (int r = 0; r < reps; ++r) {
+    i64 t0 = micros();
+    f();
+    i64 dt = micros() - t0;
+    if (b < 0 || dt < b)
+      b = dt;
+  }
+  return b > 0 ? b : 1;
+}
+
+static u32 seed = 12345;
+static u32 rnd(u32 n) {
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % n;
+}
+static f32 rndf() { return (f32)rnd(1000) * 0.001f - 0.5f; }
+
+int main() {
+  const usz n = 100000;
+  const f32 world = 1000.0f;
+
+  // Flat scene of unit cubes spread over a 1 km square, 0-20 m up, as
+  // children of 100 group nodes.
+  TransformHierarchy h;
+  CullBVH bvh;
+  Bounds cube;
+  cube.min = {-0.5f, -0.5f, -0.5f};
+  cube.max = {0.5f, 0.5f, 0.5f};
+  u32 groups[100];
+  for (usz g = 0; g < 100; ++g)
+    groups[g] = h.add(TransformHierarchy::None);
+  u32 *nodes = new u32[n];
+  for (usz i = 0; i < n; ++i) {
+    nodes[i] = h.add(groups[rnd(100)],
+                     {rndf() * world, rndf() * 20.0f, rndf() * world},
+                     {rndf(), rndf(), rndf()}, {1, 1, 1});
+    bvh.insert(cube, nodes[i]);
+  }
+  h.update();
+  bvh.refit(h);
+
+  // Camera at the center looking down +z with a 60 degree lens, far 300 m.
+  Matrix4 view = Math::translate(0, -5, 0);
+  Matrix4 proj = Math::perspective(60.0f * 3.14159f / 180.0f, 16.0f / 9.0f,
+                                   0.1f, 300.0f);
+  Frustum f = Frustum::fromMatrix(Math::multiply(view, proj));
+
+  InlineArray<u32> visible;
+  i64 tBuild = best(3, [&]() { bvh.build(); });
+
+  // Reference: Frustum::intersects on every world box.
+  usz ref = 0;
+  for (usz i = 0; i < n; ++i)
+    ref += f.intersects(bvh.worldBounds((u32)i));
+
+  // Brute force: SoA boxes through Frustum::test.
+  InlineArray<f32> boxes;
+  InlineArray<u8> flags;
+  boxes.allocate(6 * n);
+  flags.allocate(n);
+  for (usz i = 0; i < n; ++i) {
+    const Bounds &b = bvh.worldBounds((u32)i);
+    f32 *p = boxes.data();
+    p[i] = b.min.x, p[n + i] = b.min.y, p[2 * n + i] = b.min.z;
+    p[3 * n + i] = b.max.x, p[4 * n + i] = b.max.y, p[5 * n + i] = b.max.z;
+  }
+  usz brute = 0;
+  i64 tBrute = best(20, [&]() { brute = f.test(boxes.data(), n, flags.data()); });
+  usz bruteRef = ref;
+
+  usz culled = 0;
+  i64 tCull = best(20, [&]() {
+    visible.allocate(0);
+    culled = bvh.cull(f, visible);
+  });
+
+  // Frame: 1% of objects move, hierarchy update, refit, cull.
+  auto move = [&]() {
+    for (usz k = 0; k < n / 100; ++k) {
+      u32 i = nodes[rnd((u32)n)];
+      Vector3 p = h.position(i);
+      p.x += 0.5f;
+      h.setPosition(i, p);
+    }
+  };
+  usz refitted = 0;
+  i64 tMove = best(10, [&]() {
+    move();
+    h.update();
+  });
+  i64 tFrame = best(10, [&]() {
+    move();
+    h.update();
+    refitted = bvh.refit(h);
+    visible.allocate(0);
+    culled = bvh.cull(f, visible);
+  });
+
+  // After refits the BVH must still agree with the reference test.
+  ref = 0;
+  for (usz i = 0; i < n; ++i)
+    ref += f.intersects(bvh.worldBounds((u32)i));
+  visible.allocate(0);
+  culled = bvh.cull(f, visible);
+
+  printf("objects %zu, visible %zu (%.1f%%), brute %zu, bvh %zu %s\n",
+         (size_t)n, (size_t)ref, 100.0 * ref / n, (size_t)brute,
+         (size_t)culled, culled == ref && brute == bruteRef ? "ok" : "FAILED");
+  printf("\n%-40s %9s %9s\n", "", "us", "draws");
+  printf("%-40s %9s %9zu\n", "no culling", "-", (size_t)n);
+  printf("%-40s %9lld %9zu\n", "brute force SIMD test", (long long)tBrute,
+         (size_t)brute);
+  printf("%-40s %9lld %9zu\n", "BVH cull", (long long)tCull, (size_t)culled);
+  printf("%-40s %9lld\n", "BVH build", (long long)tBuild);
+  printf("%-40s %9lld %9zu   (%zu refitted)\n", "refit + cull, 1% moved",
+         (long long)(tFrame - tMove > 0 ? tFrame - tMove : 0), (size_t)culled,
+         (size_t)refitted);
+  delete[] nodes;
+  return 0;
+}
@@ -0,0 +1,206 @@
+// Dense products: blocked GEMM/GEMV (f32 and int8) vs. a naive triple loop,
+// per kernel set, plus a correctness sweep over ragged shapes.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_gemm.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/Array.hpp"
+#include "Xi/Math.hpp"
+#include "Xi/Worker.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace Xi;
+
+static void naive(usz m, usz n, usz k, const f32 *a, const f32 *b, f32 *c) {
+  for (usz i = 0; i < m; ++i)
+    for (usz j = 0; j < n; ++j) {
+      f32 s = 0;
+      for (usz p = 0; p < k; ++p)
+        s += a[i * k + p] * b[p * n + j];
+      c[i * n + j] = s;
+    }
+}
+
+template <typename F> static i64 best(int reps, F f) {
+  i64 b = -1;
+  for (int r = 0; r < reps; ++r) {
+    i64 t0 = micros();
+    f();
+    i64 dt = micros() - t0;
+    if (b < 0 || dt < b)
+      b = dt;
+  }
+  return b > 0 ? b : 1;
+}
+
+static u32 seed = 12345;
+static f32 rnd() {
+  seed = seed * 1664525u + 1013904223u;
+  return (f32)(seed >> 8) / 16777216.0f - 0.5f;
+}
+
+// Ragged shapes through every path (direct, gemv, blocked) and both types.
+static bool check() {
+  const usz shapes[][3] = {{1, 1, 1},   {3, 5, 7},    {17, 33, 9},
+                           {1, 300, 70}, {70, 1, 300}, {61, 67, 129},
+                           {100, 37, 513}, {130, 300, 257}};
+  bool ok = true;
+  for (auto &s : shapes) {
+    usz m = s[0], n = s[1], k = s[2];
+    f32 *a = new f32[m * k], *b = new f32[k * n], *c = new f32[m * n],
+        *r = new f32[m * n];
+    i8 *ai = new i8[m * k], *bi = new i8[k * n];
+    i32 *ci = new i32[m * n];
+    for (usz i = 0; i < m * k; ++i) {
+      a[i] = rnd();
+      ai[i] = (i8)(rnd() * 255.0f);
+    }
+    for (usz i = 0; i < k * n; ++i) {
+      b[i] = rnd();
+      bi[i] = (i8)(rnd() * 255.0f);
+    }
+    for (usz i = 0; i < m * n; ++i)
+      c[i] = 1.0f;
+    naive(m, n, k, a, b, r);
+    // C = 2AB + 0.5C exercises alpha and beta.
+    Math::gemm(m, n, k, 2.0f, a, k, b, n, 0.5f, c, n);
+    f32 err = 0;
+    for (usz i = 0; i < m * n; ++i) {
+      f32 e = std::fabs(c[i] - (2.0f * r[i] + 0.5f));
+      if (e > err)
+        err = e;
+    }
+    Math::gemm(m, n, k, ai, k, bi, n, ci, n);
+    usz wrong = 0;
+    for (usz i = 0; i < m; ++i)
+      for (usz j = 0; j < n; ++j) {
+        i32 want = 0;
+        for (usz p = 0; p < k; ++p)
+          want += (i32)ai[i * k + p] * (i32)bi[p * n + j];
+        wrong += ci[i * n + j] != want;
+      }
+    if (err > 1e-3f * (f32)k || wrong) {
+      printf("  %zux%zux%zu: f32 err %g, i8 wrong %zu\n", (size_t)m, (size_t)n,
+             (size_t)k, err, (size_t)wrong);
+      ok = false;
+    }
+    delete[] a;
+    delete[] b;
+    delete[] c;
+    delete[] r;
+    delete[] ai;
+    delete[] bi;
+    delete[] ci;
+  }
+
+  // Shaped Arrays: matmul, matvec, transpose, axis reductions.
+  Array<f32> x, y;
+  x.allocate(6);
+  y.allocate(6);
+  for (usz i = 0; i < 6; ++i) {
+    x[i] = (f32)i;
+    y[i] = (f32)(i + 1);
+  }
+  usz d23[2] = {2, 3}, d32[2] = {3, 2};
+  x.shape(2, d23);
+  y.shape(2, d32);
+  Array<f32> z = Math::matmul(x, y); // [[0 1 2][3 4 5]] x [[1 2][3 4][5 6]]
+  Array<f32> t = Math::transpose(x);
+  Array<f32> s0 = Math::sum(x, 0), s1 = Math::max(x, 1);
+  ok = ok && z.rank() == 2 && z.dim(0) == 2 && z.dim(1) == 2 && z[0] == 13 &&
+       z[1] == 16 && z[2] == 40 && z[3] == 52 && t.dim(0) == 3 && t[1] == 3 &&
+       s0.size() == 3 && s0[2] == 7 && s1.size() == 2 && s1[1] == 5 &&
+       Math::matmul(x, x).size() == 0;
+  return ok;
+}
+
+int main() {
+  const char *isas[] = {"avx512", "avx2", "sse2", "neon", "generic", "scalar"};
+  for (const char *isa : isas) {
+    if (!Math::Simd::use(isa))
+      continue;
+    printf("correctness %-8s %s\n", isa, check() ? "ok" : "FAILED");
+  }
+  Math::Simd::use(nullptr);
+  printf("\nkernels: %s\n", Math::Simd::isa());
+
+  printf("\n%6s %12s %12s %12s %12s\n", "n", "naive", "gemm f32", "gemm i8",
+         "speedup");
+  const usz sizes[] = {64, 128, 256, 512, 1024};
+  for (usz n : sizes) {
+    f32 *a = new f32[n * n], *b = new f32[n * n], *c = new f32[n * n];
+    i8 *ai = new i8[n * n], *bi = new i8[n * n];
+    i32 *ci = new i32[n * n];
+    for (usz i = 0; i < n * n; ++i) {
+      a[i] = rnd();
+      b[i] = rnd();
+      ai[i] = (i8)(rnd() * 255.0f);
+      bi[i] = (i8)(rnd() * 255.0f);
+    }
+    f64 flops = 2.0 * (f64)n * (f64)n * (f64)n;
+    int reps = n >= 512 ? 2 : 10;
+    i64 tn = best(n >= 1024 ? 1 : reps, [&]() { naive(n, n, n, a, b, c); });
+    i64 tg = best(reps, [&]() {
+      Math::gemm(n, n, n, 1.0f, a, n, b, n, 0.0f, c, n);
+    });
+    i64 ti = best(reps, [&]() { Math::gemm(n, n, n, ai, n, bi, n, ci, n); });
+    printf("%6zu %7.2f GF/s %7.2f GF/s %7.2f GOP/s %9.1fx\n", (size_t)n,
+           flops / (f64)tn / 1e3, flops / (f64)tg / 1e3, flops / (f64)ti / 1e3,
+           (f64)tn / (f64)tg);
+    delete[] a;
+    delete[] b;
+    delete[] c;
+    delete[] ai;
+    delete[] bi;
+    delete[] ci;
+  }
+
+  // GEMV is bandwidth bound: report GB/s of A streamed.
+  {
+    const usz m = 4096, k = 4096;
+    f32 *a = new f32[m * k], *x = new f32[k], *y = new f32[m];
+    for (usz i = 0; i < m * k; ++i)
+      a[i] = rnd();
+    for (usz i = 0; i < k; ++i)
+      x[i] = rnd();
+    i64 tv = best(5, [&]() {
+      Math::gemv(m, k, 1.0f, a, k, x, 0.0f, y);
+    });
+    i64 tn = best(5, [&]() { naive(m, 1, k, a, x, y); });
+    printf("\ngemv 4096x4096: naive %.2f GB/s, gemv %.2f GB/s\n",
+           (f64)(m * k * 4) / (f64)tn / 1e3, (f64)(m * k * 4) / (f64)tv / 1e3);
+    delete[] a;
+    delete[] x;
+    delete[] y;
+  }
+
+  // Threads: only meaningful with more than one core.
+  {
+    const usz n = 1024;
+    f32 *a = new f32[n * n], *b = new f32[n * n], *c = new f32[n * n],
+        *c1 = new f32[n * n];
+    for (usz i = 0; i < n * n; ++i) {
+      a[i] = rnd();
+      b[i] = rnd();
+    }
+    f64 flops = 2.0 * (f64)n * (f64)n * (f64)n;
+    WorkerPool pool(3);
+    i64 t1 = best(2, [&]() {
+      Math::gemm(n, n, n, 1.0f, a, n, b, n, 0.0f, c1, n);
+    });
+    i64 tp = best(2, [&]() {
+      Math::gemm(n, n, n, 1.0f, a, n, b, n, 0.0f, c, n, &pool);
+    });
+    bool same = true;
+    for (usz i = 0; i < n * n; ++i)
+      same = same && c[i] == c1[i];
+    printf("gemm 1024 f32: 1 thread %.2f GF/s, %zu threads %.2f GF/s %s\n",
+           flops / (f64)t1 / 1e3, (size_t)pool.size() + 1,
+           flops / (f64)tp / 1e3, same ? "ok" : "MISMATCH");
+    delete[] c1;
+    delete[] a;
+    delete[] b;
+    delete[] c;
+  }
+  return 0;
+}
@@ -0,0 +1,232 @@
+// GeodeticSphere and GeoIndex on 10M points (or argv[1]): half uniform
+// over the globe, half in 50 city-sized Gaussian clusters, altitudes from
+// -400 m to 40 000 km. Reports conversions/sec for the scalar and batch
+// ECEF <-> geodetic and ENU paths with round-trip error, then GeoIndex
+// build time and radius / k-nearest query latency, each query set checked
+// against a brute-force scan.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_geo.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/GeoIndex.hpp"
+#include "Xi/Math.hpp"
+#include "Xi/Time.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace Xi;
+
+static u64 seed = 0x9e3779b97f4a7c15ULL;
+static f64 uniform() {
+  seed ^= seed << 13, seed ^= seed >> 7, seed ^= seed << 17;
+  return (seed >> 11) * (1.0 / 9007199254740992.0);
+}
+static f64 gauss() {
+  f64 u = uniform() + 1e-300, v = uniform();
+  return std::sqrt(-2 * std::log(u)) * std::cos(6.283185307179586 * v);
+}
+
+struct Arrays {
+  InlineArray<f64> a, b, c;
+  explicit Arrays(usz n) { a.allocate(n), b.allocate(n), c.allocate(n); }
+};
+
+static f64 seconds(i64 t0) { return (micros() - t0) * 1e-6; }
+
+// Error in metres between two geodetic positions (small differences).
+static f64 geoError(f64 la, f64 lo, f64 al, f64 lb, f64 ob, f64 ab) {
+  f64 dlo = std::fabs(lo - ob);
+  dlo = dlo > 180 ? 360 - dlo : dlo;
+  f64 m = 6378137 * 3.141592653589793 / 180;
+  f64 e = std::fabs(la - lb) * m + std::fabs(al - ab);
+  if (std::fabs(la) < 89.999) // longitude is ill-defined at the poles
+    e += dlo * m * std::cos(la * 3.141592653589793 / 180);
+  return e;
+}
+
+int main(int argc, char **argv) {
+  usz n = argc > 1 ? (usz)atoll(argv[1]) : 10000000;
+  printf("%zu points, isa %s\n\n", (size_t)n, Math::Simd::isa());
+
+  Arrays geo(n), ecef(n), back(n);
+  f64 cityLat[50], cityLng[50];
+  for (int k = 0; k < 50; ++k)
+    cityLat[k] = std::asin(2 * uniform() - 1) * 57.29577951308232,
+    cityLng[k] = uniform() * 360 - 180;
+  for (usz i = 0; i < n; ++i) {
+    f64 lat, lng;
+    if (i & 1) {
+      lat = std::asin(2 * uniform() - 1) * 57.29577951308232;
+      lng = uniform() * 360 - 180;
+    } else {
+      int k = (int)(uniform() * 50);
+      lat = cityLat[k] + gauss() * 0.2;
+      lat = lat > 90 ? 180 - lat : lat < -90 ? -180 - lat : lat;
+      lng = cityLng[k] + gauss() * 0.2;
+      lng = lng > 180 ? lng - 360 : lng < -180 ? lng + 360 : lng;
+    }
+    geo.a[i] = lat, geo.b[i] = lng;
+    geo.c[i] = i % 10 ? uniform() * 9000 - 400 : uniform() * 4e7;
+  }
+
+  // --- Conversions ---
+  GeodeticSphere wgs84;
+  printf("%-22s %14s %14s %9s\n", "conversion", "scalar conv/s",
+         "batch conv/s", "speedup");
+  f64 ts = 1e30, tb = 1e30;
+  for (int rep = 0; rep < 3; ++rep) {
+    i64 t0 = micros();
+    for (usz i = 0; i < n; ++i) {
+      Ecef p = wgs84.toEcef(GeoPos{geo.a[i], geo.b[i], geo.c[i]});
+      back.a[i] = p.x, back.b[i] = p.y, back.c[i] = p.z;
+    }
+    ts = std::fmin(ts, seconds(t0));
+    t0 = micros();
+    wgs84.toEcef(geo.a.data(), geo.b.data(), geo.c.data(), ecef.a.data(),
+                 ecef.b.data(), ecef.c.data(), n);
+    tb = std::fmin(tb, seconds(t0));
+  }
+  f64 ecefDiff = 0;
+  for (usz i = 0; i < n; ++i)
+    ecefDiff = std::fmax(ecefDiff, std::fabs(back.a[i] - ecef.a[i]) +
+                                       std::fabs(back.b[i] - ecef.b[i]) +
+                                       std::fabs(back.c[i] - ecef.c[i]));
+  printf("%-22s %14.0f %14.0f %8.1fx\n", "geodetic -> ECEF", n / ts, n / tb,
+         ts / tb);
+
+  ts = tb = 1e30;
+  f64 geoDiff = 0;
+  for (int rep = 0; rep < 3; ++rep) {
+    i64 t0 = micros();
+    for (usz i = 0; i < n; ++i) {
+      GeoPos g = wgs84.toGeo(Ecef{ecef.a[i], ecef.b[i], ecef.c[i]});
+      back.a[i] = g.lat, back.b[i] = g.lng, back.c[i] = g.alt;
+    }
+    ts = std::fmin(ts, seconds(t0));
+    if (rep == 0) { // keep the scalar results to compare with the batch
+      Arrays batch(n);
+      wgs84.toGeo(ecef.a.data(), ecef.b.data(), ecef.c.data(),
+                  batch.a.data(), batch.b.data(), batch.c.data(), n);
+      for (usz i = 0; i < n; ++i)
+        geoDiff = std::fmax(geoDiff, geoError(back.a[i], back.b[i],
+                                              back.c[i], batch.a[i],
+                                              batch.b[i], batch.c[i]));
+    }
+    t0 = micros();
+    wgs84.toGeo(ecef.a.data(), ecef.b.data(), ecef.c.data(), back.a.data(),
+                back.b.data(), back.c.data(), n);
+    tb = std::fmin(tb, seconds(t0));
+  }
+  printf("%-22s %14.0f %14.0f %8.1fx\n", "ECEF -> geodetic", n / ts, n / tb,
+         ts / tb);
+  f64 roundTrip = 0;
+  for (usz i = 0; i < n; ++i)
+    roundTrip = std::fmax(roundTrip, geoError(geo.a[i], geo.b[i], geo.c[i],
+                                              back.a[i], back.b[i],
+                                              back.c[i]));
+
+  GeoPos origin = {47.3769, 8.5417, 408};
+  Arrays enu(n);
+  ts = tb = 1e30;
+  for (int rep = 0; rep < 3; ++rep) {
+    i64 t0 = micros();
+    for (usz i = 0; i < n; ++i) {
+      Enu e = wgs84.toEnu(origin, Ecef{ecef.a[i], ecef.b[i], ecef.c[i]});
+      enu.a[i] = e.e, enu.b[i] = e.n, enu.c[i] = e.u;
+    }
+    ts = std::fmin(ts, seconds(t0));
+    t0 = micros();
+    wgs84.toEnu(origin, ecef.a.data(), ecef.b.data(), ecef.c.data(),
+                enu.a.data(), enu.b.data(), enu.c.data(), n);
+    tb = std::fmin(tb, seconds(t0));
+  }
+  printf("%-22s %14.0f %14.0f %8.1fx\n", "ECEF -> ENU", n / ts, n / tb,
+         ts / tb);
+  wgs84.fromEnu(origin, enu.a.data(), enu.b.data(), enu.c.data(),
+                back.a.data(), back.b.data(), back.c.data(), n);
+  f64 enuTrip = 0;
+  for (usz i = 0; i < n; ++i)
+    enuTrip = std::fmax(enuTrip, std::fabs(back.a[i] - ecef.a[i]) +
+                                     std::fabs(back.b[i] - ecef.b[i]) +
+                                     std::fabs(back.c[i] - ecef.c[i]));
+  printf("\nmax round-trip error: geodetic -> ECEF -> geodetic %.3g nm, "
+         "ECEF -> ENU -> ECEF %.3g nm\n",
+         roundTrip * 1e9, enuTrip * 1e9);
+  printf("max batch vs scalar: ECEF %.3g nm, geodetic %.3g nm\n",
+         ecefDiff * 1e9, geoDiff * 1e9);
+  ecef = Arrays(0), back = Arrays(0), enu = Arrays(0);
+
+  // --- Index ---
+  GeoIndex index;
+  i64 t0 = micros();
+  index.build(geo.a.data(), geo.b.data(), n);
+  printf("\nGeoIndex build: %.2f s (%.1f M points/s)\n", seconds(t0),
+         n / seconds(t0) / 1e6);
+
+  // Query centres on the data, so clusters get their share.
+  const int Queries = 2000, Checked = 10;
+  GeoPos centers[Queries];
+  for (int q = 0; q < Queries; ++q) {
+    usz i = (usz)(uniform() * n);
+    centers[q] = {geo.a[i] + gauss() * 0.01, geo.b[i] + gauss() * 0.01, 0};
+  }
+  auto brute = [&](const GeoPos &c, f64 meters) {
+    usz hits = 0;
+    for (usz i = 0; i < n; ++i)
+      hits += GeoIndex::distance(c, GeoPos{geo.a[i], geo.b[i], 0}) <=
+              meters + 1e-6; // unit vectors vs haversine: ~1 nm apart
+    return hits;
+  };
+
+  printf("\n%-14s %12s %12s %12s %8s\n", "query", "us/query", "queries/s",
+         "mean hits", "checked");
+  InlineArray<u32> hits;
+  InlineArray<f64> dist;
+  const f64 radii[4] = {100, 1000, 10000, 100000};
+  for (f64 r : radii) {
+    u64 total = 0;
+    t0 = micros();
+    for (int q = 0; q < Queries; ++q) {
+      index.within(centers[q], r, hits);
+      total += hits.size();
+    }
+    f64 t = seconds(t0);
+    int ok = 0;
+    for (int q = 0; q < Checked; ++q) {
+      index.within(centers[q], r, hits);
+      bool inside = true;
+      for (usz i = 0; i < hits.size(); ++i)
+        inside &= GeoIndex::distance(centers[q],
+                                     GeoPos{geo.a[hits[i]], geo.b[hits[i]],
+                                            0}) <= r + 1e-6;
+      ok += inside && hits.size() == brute(centers[q], r);
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "within %g km", r / 1000);
+    printf("%-14s %12.2f %12.0f %12.1f %5d/%d\n", name, t * 1e6 / Queries,
+           Queries / t, (f64)total / Queries, ok, Checked);
+  }
+
+  const usz ks[3] = {1, 10, 100};
+  for (usz k : ks) {
+    t0 = micros();
+    for (int q = 0; q < Queries; ++q)
+      index.nearest(centers[q], k, hits, &dist);
+    f64 t = seconds(t0);
+    int ok = 0;
+    for (int q = 0; q < Checked; ++q) {
+      index.nearest(centers[q], k, hits, &dist);
+      // Exactly k points lie within the k-th distance (ties aside).
+      f64 far = dist[dist.size() - 1];
+      bool sorted = true;
+      for (usz i = 1; i < dist.size(); ++i)
+        sorted &= dist[i - 1] <= dist[i];
+      ok += sorted && hits.size() == k && brute(centers[q], far) == k;
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "nearest %zu", (size_t)k);
+    printf("%-14s %12.2f %12.0f %12zu %5d/%d\n", name, t * 1e6 / Queries,
+           Queries / t, (size_t)k, ok, Checked);
+  }
+  return 0;
+}
@@ -0,0 +1,276 @@
+// GPSParser on a 10 Hz multi-constellation receiver log: GN GGA/RMC/VTG,
+// three GSA, nine GSV and a UBX NAV-PVT per epoch, 1% of sentences
+// corrupted. The log is written to a file and read back (or pass a real
+// log as argv[1]), then fed in random 1..64 byte chunks as a UART
+// delivers it. Reports sentences/sec, MB/s and decoded position error,
+// next to the old line-buffered GGA-only parser (which also loses the GGA
+// that follows each binary UBX frame, having no newline before it).
+// g++ -O2 -std=c++17 -Iinclude dev/bench_gps.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Hardware/GPSParser.hpp"
+#include "Xi/File.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace Xi;
+
+static u32 seed = 12345;
+static u32 rnd(u32 n) {
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % n;
+}
+
+static usz corrupted = 0;
+
+static void sentence(String &out, const char *body) {
+  u8 sum = 0;
+  for (const char *p = body; *p; ++p)
+    sum ^= (u8)*p;
+  char line[160];
+  snprintf(line, sizeof(line), "$%s*%02X\r\n", body, sum);
+  if (rnd(100) == 0) { // flip a character in the body
+    line[1 + rnd((u32)strlen(body))] ^= 0x04;
+    corrupted++;
+  }
+  out += line;
+}
+
+static void coord(char *buf, usz size, i32 v, int degDigits) {
+  i32 a = v < 0 ? -v : v;
+  i32 deg = a / 10000000;
+  i64 min5 = ((i64)(a - deg * 10000000) * 60 + 50) / 100; // 1e-5 minutes
+  snprintf(buf, size, "%0*d%02d.%05d", degDigits, deg, (int)(min5 / 100000),
+           (int)(min5 % 100000));
+}
+
+static void put32(u8 *p, i32 v) {
+  for (int i = 0; i < 4; ++i)
+    p[i] = (u8)((u32)v >> (8 * i));
+}
+
+struct Truth {
+  i32 lat, lng;
+};
+
+// `talker` prefixes GGA/RMC/VTG/GSA: "GN" as multi-GNSS receivers send,
+// "GP" for the only form the old parser understood.
+static void makeLog(usz epochs, const char *talker, String &log,
+                    InlineArray<Truth> &truth) {
+  for (usz e = 0; e < epochs; ++e) {
+    f64 t = e * 0.1;
+    Truth tr = {(i32)(473769000 + 20000 * std::sin(t * 0.05)),
+                (i32)(85417000 + 30000 * std::cos(t * 0.05))};
+    truth.push(tr);
+    u32 ms = (u32)(e * 100) % 86400000, s = ms / 1000;
+    char tm[16], lat[20], lng[20], body[140];
+    snprintf(tm, sizeof(tm), "%02u%02u%02u.%02u", s / 3600, s / 60 % 60,
+             s % 60, ms % 1000 / 10);
+    coord(lat, sizeof(lat), tr.lat, 2);
+    coord(lng, sizeof(lng), tr.lng, 3);
+
+    snprintf(body, sizeof(body),
+             "%sGGA,%s,%s,N,%s,E,1,24,0.62,408.512,M,47.3,M,,", talker, tm,
+             lat, lng);
+    sentence(log, body);
+    snprintf(body, sizeof(body),
+             "%sRMC,%s,A,%s,N,%s,E,0.412,231.85,181026,,,A,V", talker, tm,
+             lat, lng);
+    sentence(log, body);
+    const char *fixed[4] = {
+        "VTG,231.85,T,,M,0.412,N,0.763,K,A",
+        "GSA,A,3,05,07,13,14,15,17,19,24,30,,,,1.12,0.62,0.93,1",
+        "GSA,A,3,65,66,75,76,81,82,,,,,,,1.12,0.62,0.93,2",
+        "GSA,A,3,02,04,11,19,25,,,,,,,,1.12,0.62,0.93,3"};
+    for (const char *f : fixed) {
+      snprintf(body, sizeof(body), "%s%s", talker, f);
+      sentence(log, body);
+    }
+    const char *talkers[4] = {"GP", "GL", "GA", "GB"};
+    for (int k = 0; k < 4; ++k)
+      for (int m = 1; m <= (k ? 2 : 3); ++m) {
+        snprintf(body, sizeof(body),
+                 "%sGSV,%d,%d,%d,%02d,62,070,47,%02d,41,190,44,%02d,12,310,"
+                 "38,%02d,33,122,41,1",
+                 talkers[k], k ? 2 : 3, m, k ? 7 : 11, m * 4, m * 4 + 1,
+                 m * 4 + 2, m * 4 + 3);
+        sentence(log, body);
+      }
+
+    u8 f[100] = {0xB5, 0x62, 0x01, 0x07, 92, 0};
+    u8 *p = f + 6;
+    p[4] = 2026 & 0xff, p[5] = 2026 >> 8, p[6] = 10, p[7] = 18;
+    p[8] = (u8)(s / 3600), p[9] = (u8)(s / 60 % 60), p[10] = (u8)(s % 60);
+    p[11] = 3;
+    put32(p + 16, (i32)(ms % 1000) * 1000000);
+    p[20] = 3, p[21] = 1, p[23] = 24;
+    put32(p + 24, tr.lng);
+    put32(p + 28, tr.lat);
+    put32(p + 36, 408512);
+    u8 a = 0, b = 0;
+    for (int i = 2; i < 6 + 92; ++i)
+      a += f[i], b += a;
+    f[98] = a, f[99] = b;
+    for (u8 c : f)
+      log += (char)c;
+  }
+}
+
+// The parser this replaced: a line buffer, strncat per character, atof,
+// and only "$GP...GGA".
+struct LegacyParser {
+  char buf[90] = {};
+  int idx = 0;
+  usz fixes = 0;
+  f32 lat = 0, lng = 0, alt = 0;
+
+  void parse(const char *buf) {
+    if (strncmp(buf, "$GP", 3) == 0 && strstr(buf, "GGA")) {
+      char lt[15] = {}, lg[15] = {}, al[10] = {};
+      char ns = 'N', ew = 'E';
+      int cm = 0;
+      for (const char *p = buf; *p; p++) {
+        if (*p == ',') {
+          cm++;
+          continue;
+        }
+        if (cm == 2) strncat(lt, p, 1);
+        if (cm == 3) ns = *p;
+        if (cm == 4) strncat(lg, p, 1);
+        if (cm == 5) ew = *p;
+        if (cm == 9) strncat(al, p, 1);
+        if (cm > 9) break;
+      }
+      if (lt[0] && lg[0]) {
+        f32 t = atof(lt), g = atof(lg);
+        lat = (int)(t / 100) + (t - ((int)(t / 100) * 100)) / 60.0f;
+        lng = (int)(g / 100) + (g - ((int)(g / 100) * 100)) / 60.0f;
+        if (ns == 'S') lat = -lat;
+        if (ew == 'W') lng = -lng;
+        alt = atof(al);
+        fixes++;
+      }
+    }
+  }
+  void feed(const u8 *d, usz n) {
+    for (usz i = 0; i < n; ++i) {
+      char c = (char)d[i];
+      if (c == '\n') {
+        buf[idx] = 0;
+        parse(buf);
+        idx = 0;
+      } else if (idx < 88) {
+        buf[idx++] = c;
+      }
+    }
+  }
+};
+
+struct Result {
+  GPSParser parser;
+  f64 secs = 1e30, legacySecs = 1e30;
+  usz legacyFixes = 0;
+  i64 maxErr = 0;
+};
+
+// Feeds the log in the same random chunks to both parsers, best of five.
+static Result measure(const String &log, const InlineArray<Truth> &truth) {
+  const u8 *bytes = log.data();
+  usz size = log.size();
+  InlineArray<u32> chunks;
+  for (usz at = 0; at < size;) {
+    u32 c = 1 + rnd(64);
+    chunks.push(c);
+    at += c;
+  }
+
+  Result r;
+  for (int rep = 0; rep < 5; ++rep) {
+    GPSParser p;
+    u32 seen = 0;
+    usz at = 0, k = 0;
+    i64 t0 = micros();
+    while (at < size) {
+      usz n = chunks[k] < size - at ? chunks[k] : size - at;
+      p.feed(bytes + at, n);
+      at += n, k++;
+      if (rep == 0 && p.positions != seen && truth.size()) {
+        seen = p.positions;
+        usz e = p.fix.timeMs / 100;
+        if (e < truth.size()) {
+          i64 d = std::abs((i64)p.fix.lat - truth[e].lat) +
+                  std::abs((i64)p.fix.lng - truth[e].lng);
+          r.maxErr = d > r.maxErr ? d : r.maxErr;
+        }
+      }
+    }
+    f64 secs = (micros() - t0) * 1e-6;
+    if (secs < r.secs)
+      r.secs = secs, r.parser = p;
+  }
+  for (int rep = 0; rep < 5; ++rep) {
+    LegacyParser l;
+    usz at = 0, k = 0;
+    i64 t0 = micros();
+    while (at < size) {
+      usz n = chunks[k] < size - at ? chunks[k] : size - at;
+      l.feed(bytes + at, n);
+      at += n, k++;
+    }
+    f64 secs = (micros() - t0) * 1e-6;
+    if (secs < r.legacySecs)
+      r.legacySecs = secs, r.legacyFixes = l.fixes;
+  }
+  return r;
+}
+
+static void report(const char *name, const String &log, const Result &r) {
+  const GPSParser &p = r.parser;
+  u64 messages = p.stats.nmea + p.stats.ubx + p.stats.bad;
+  printf("%-16s %-10s %12.0f %10.1f %10u %10.2f\n", name, "GPSParser",
+         messages / r.secs, log.size() / r.secs / 1e6, p.positions,
+         r.secs * 1e9 / log.size());
+  printf("%-16s %-10s %12.0f %10.1f %10zu %10.2f\n", "", "legacy",
+         messages / r.legacySecs, log.size() / r.legacySecs / 1e6,
+         (size_t)r.legacyFixes, r.legacySecs * 1e9 / log.size());
+}
+
+int main(int argc, char **argv) {
+  FilesystemDevice *fs = requestFS();
+  const usz epochs = 6000; // ten minutes at 10 Hz
+  InlineArray<Truth> truth, truthGP;
+  String log, logGP;
+  const char *path = argc > 1 ? argv[1] : "/tmp/xi_gps.log";
+  usz bad = 0;
+  if (argc <= 1) {
+    makeLog(epochs, "GN", log, truth);
+    bad = corrupted;
+    fs->write(path, log);
+    makeLog(epochs, "GP", logGP, truthGP);
+  }
+  log = fs->read(path);
+  delete fs;
+
+  Result r = measure(log, truth);
+  printf("log: %.2f MB, %zu epochs, %zu sentences corrupted\n",
+         log.size() / 1e6, (size_t)truth.size(), (size_t)bad);
+  printf("\n%-16s %-10s %12s %10s %10s %10s\n", "log", "parser", "msgs/s",
+         "MB/s", "positions", "ns/byte");
+  report(argc > 1 ? argv[1] : "GN talkers", log, r);
+  if (logGP.size())
+    report("GP talkers", logGP, measure(logGP, truthGP));
+
+  const GPSParser &p = r.parser;
+  printf("\nvalid: %llu NMEA, %llu UBX; rejected: %llu bad checksum, "
+         "%llu overflow; %llu not decoded\n",
+         (unsigned long long)p.stats.nmea, (unsigned long long)p.stats.ubx,
+         (unsigned long long)p.stats.bad, (unsigned long long)p.stats.overflow,
+         (unsigned long long)p.stats.ignored);
+  printf("max position error: %lld x 1e-7 deg; satellites in view %u, "
+         "hdop %.2f, utc %llu\n",
+         (long long)r.maxErr, p.fix.inView, p.fix.hdop / 100.0,
+         (unsigned long long)p.fix.utcNS());
+  return 0;
+}
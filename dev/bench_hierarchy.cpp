@@ -0,0 +1,151 @@
+// World-matrix update for a 100k-node scene: recursive traversal (what
+// Camera3 rendering does) vs. TransformHierarchy with 100% and 1% dirty.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_hierarchy.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/Hierarchy.hpp"
+#include "Xi/Tree.hpp"
+#include "Xi/Worker.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace Xi;
+
+template <typename F> static i64 best(int reps, F f) {
+  i64 b = -1;
+  for (int r = 0; r < reps; ++r) {
+    i64 t0 = micros();
+    f();
+    i64 dt = micros() - t0;
+    if (b < 0 || dt < b)
+      b = dt;
+  }
+  return b > 0 ? b : 1;
+}
+
+static u32 seed = 12345;
+static u32 rnd(u32 n) {
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % n;
+}
+static f32 rndf() { return (f32)rnd(1000) * 0.001f - 0.5f; }
+
+struct Node : public TreeItem, public Transform {
+  Matrix4 world;
+};
+
+// Camera3::_renderRec without the drawing.
+static void recurse(TreeItem *n, const Matrix4 &p) {
+  Matrix4 world = p;
+  if (Node *r = dynamic_cast<Node *>(n)) {
+    world = Math::multiply(r->getMatrix(), p);
+    r->world = world;
+  }
+  for (usz i = 0; i < n->children.length(); ++i)
+    recurse(n->children[i], world);
+}
+
+// Largest difference between the hierarchy and the recursion's results.
+// Hierarchy indices are depth-first, so nodes are matched via source().
+static f32 maxDiff(const TransformHierarchy &h) {
+  f32 e = 0;
+  for (u32 i = 0; i < h.size(); ++i) {
+    const Matrix4 &a = h.world(i),
+                  &b = static_cast<const Node *>(h.source(i))->world;
+    for (int r = 0; r < 4; ++r)
+      for (int c = 0; c < 4; ++c)
+        e = std::fmax(e, std::fabs(a.m[r][c] - b.m[r][c]));
+  }
+  return e;
+}
+
+int main() {
+  const usz n = 100000;
+  // Random recursive tree: each node hangs off any earlier node (or, 1% of
+  // the time, the scene root), so depth grows like ln(n) as in typical
+  // scenes.
+  TreeItem root;
+  Node **nodes = new Node *[n];
+  for (usz i = 0; i < n; ++i) {
+    nodes[i] = new Node();
+    nodes[i]->name = "n";
+    nodes[i]->setPosition({rndf(), rndf(), rndf()});
+    nodes[i]->setRotation({rndf() * 0.1f, rndf() * 0.1f, rndf() * 0.1f});
+    TreeItem *parent =
+        i == 0 || rnd(100) == 0 ? (TreeItem *)&root
+                                : nodes[rnd((u32)i)];
+    parent->add(nodes[i]);
+  }
+
+  TransformHierarchy h;
+  usz added = h.addTree(&root);
+  usz first = h.update();
+  Matrix4 id = Math::identity();
+  recurse(&root, id);
+  f32 err = maxDiff(h);
+  printf("nodes %zu, first update wrote %zu, max diff vs recursion %g %s\n",
+         (size_t)added, (size_t)first, err, err < 1e-3f ? "ok" : "FAILED");
+
+  // 1% of nodes change; recursion recomputes everything regardless.
+  const usz dirty = n / 100;
+  auto move = [&]() {
+    for (usz k = 0; k < dirty; ++k) {
+      Node *m = nodes[rnd((u32)n)];
+      Vector3 p = m->getPosition();
+      p.x += 0.01f;
+      m->setPosition(p);
+    }
+  };
+
+  i64 tRec = best(5, [&]() {
+    move();
+    recurse(&root, id);
+  });
+  i64 tAll = best(5, [&]() {
+    for (usz i = 0; i < n; ++i)
+      h.touch((u32)i);
+    h.update();
+  });
+  usz written = 0, synced = 0;
+  i64 tSync = best(5, [&]() {
+    move();
+    synced = h.sync();
+  });
+  h.update();
+  i64 tOne = best(5, [&]() {
+    move();
+    h.sync();
+    written = h.update();
+  });
+  i64 tMove = best(5, move);
+
+  h.sync();
+  h.update();
+  recurse(&root, id);
+  err = maxDiff(h);
+
+  printf("\n%-40s %9s\n", "", "us");
+  printf("%-40s %9lld\n", "recursive traversal (all nodes)",
+         (long long)(tRec - tMove));
+  printf("%-40s %9lld\n", "hierarchy update, 100% dirty", (long long)tAll);
+  printf("%-40s %9lld   (%zu marked)\n", "hierarchy sync, 1% moved",
+         (long long)(tSync - tMove > 0 ? tSync - tMove : 0), (size_t)synced);
+  printf("%-40s %9lld   (%zu worlds written)\n",
+         "hierarchy sync + update, 1% moved",
+         (long long)(tOne - tMove > 0 ? tOne - tMove : 0), (size_t)written);
+  printf("max diff vs recursion after updates %g %s\n", err,
+         err < 1e-3f ? "ok" : "FAILED");
+
+  // Only useful with more than one core.
+  WorkerPool pool(3);
+  i64 tPar = best(5, [&]() {
+    move();
+    h.sync();
+    h.update(&pool);
+  });
+  printf("%-40s %9lld   (%zu threads)\n", "same, on a pool",
+         (long long)(tPar - tMove > 0 ? tPar - tMove : 0),
+         (size_t)pool.size() + 1);
+  delete[] nodes;
+  return 0;
+}
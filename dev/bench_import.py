@@ -0,0 +1,73 @@
+# Cold `import xi` time and first-call latency, with the precompiled
+# dictionary (build it with cmake -DXI_BUILD_PYTHON_DICT=ON) and with the
+# runtime header parse it replaces (XI_JIT=1). Every sample is a fresh
+# interpreter; the table shows the median of N runs.
+# python3 dev/bench_import.py [N]
+
+import json
+import os
+import statistics
+import subprocess
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+
+PROBE = r"""
+import json, time
+t0 = time.perf_counter()
+import xi
+t = {"import": time.perf_counter() - t0}
+
+def first(name, fn):
+    t0 = time.perf_counter()
+    fn()
+    t[name] = time.perf_counter() - t0
+
+Xi = xi.Xi
+first("String(bytes)", lambda: bytes(xi.String(b"hello")))
+first("Map<u64,String>", lambda: Xi.Map["unsigned long long", Xi.String]().put(7, xi.String(b"v")))
+first("Array<String>", lambda: Xi.Array[Xi.String]().push(xi.String(b"x")))
+first("Packet", lambda: xi.Packet(xi.String(b"p"), 3).channel)
+first("hash()", lambda: bytes(xi.hash(xi.String(b"abc"), 32)))
+first("Tunnel()", lambda: xi.Tunnel())
+print(json.dumps(t))
+"""
+
+
+def sample(jit):
+    env = dict(os.environ, PYTHONPATH=str(ROOT / "src"))
+    env.pop("XI_JIT", None)
+    if jit:
+        env["XI_JIT"] = "1"
+    out = subprocess.run([sys.executable, "-c", PROBE], env=env, check=True,
+                         capture_output=True, text=True).stdout
+    return json.loads(out.strip().splitlines()[-1])
+
+
+def main():
+    runs = int(sys.argv[1]) if len(sys.argv) > 1 else 5
+    have_dict = any((ROOT / "src/xi").glob("libXiPy.*"))
+    modes = [("header JIT", True)]
+    if have_dict:
+        modes.append(("dictionary", False))
+    else:
+        print("no src/xi/libXiPy.*: configure with -DXI_BUILD_PYTHON_DICT=ON"
+              " to compare\n")
+
+    results = {}
+    for name, jit in modes:
+        samples = [sample(jit) for _ in range(runs)]
+        results[name] = {k: statistics.median(s[k] for s in samples)
+                         for k in samples[0]}
+
+    keys = list(next(iter(results.values())))
+    head = "ms, median of %d" % runs
+    print("%-18s" % head + "".join("%14s" % m for m in results))
+    for k in keys:
+        print("%-18s" % k +
+              "".join("%14.1f" % (results[m][k] * 1e3) for m in results))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,370 @@
+// Matrix4 kernels (multiply/inverse/transpose) against the scalar code they
+// replaced, and SoA batch transforms against per-item loops.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_matrix.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/Math.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace Xi;
+
+template <typename F> static i64 best(int reps, F f) {
+  i64 b = -1;
+  for (int r = 0; r < reps; ++r) {
+    i64 t0 = micros();
+    f();
+    i64 dt = micros() - t0;
+    if (b < 0 || dt < b)
+      b = dt;
+  }
+  return b > 0 ? b : 1;
+}
+
+static u32 seed = 12345;
+static f32 rnd() {
+  seed = seed * 1664525u + 1013904223u;
+  return (f32)(seed >> 8) / 16777216.0f - 0.5f;
+}
+
+static Matrix4 randomMatrix() {
+  Matrix4 m;
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      m.m[i][j] = rnd() + (i == j ? 2.0f : 0.0f);
+  return m;
+}
+
+// --- The previous scalar implementations, for reference ---
+
+static __attribute__((noinline)) Matrix4 refMultiply(const Matrix4 &a,
+                                                     const Matrix4 &b) {
+  Matrix4 r = {{{0}}};
+  for (int i = 0; i < 4; ++i)
+    for (int k = 0; k < 4; ++k)
+      for (int j = 0; j < 4; ++j)
+        r.m[i][j] += a.m[i][k] * b.m[k][j];
+  return r;
+}
+
+static f32 refDet(const Matrix4 &m) {
+  f32 a = m.m[0][0], b = m.m[0][1], c = m.m[0][2], d = m.m[0][3];
+  f32 e = m.m[1][0], f = m.m[1][1], g = m.m[1][2], h = m.m[1][3];
+  f32 i = m.m[2][0], j = m.m[2][1], k = m.m[2][2], l = m.m[2][3];
+  f32 n = m.m[3][0], o = m.m[3][1], p = m.m[3][2], q = m.m[3][3];
+  return a * (f * (k * q - l * p) - g * (j * q - l * o) + h * (j * p - k * o)) -
+         b * (e * (k * q - l * p) - g * (i * q - l * n) + h * (i * p - k * n)) +
+         c * (e * (j * q - l * o) - f * (i * q - l * n) + h * (i * o - j * n)) -
+         d * (e * (j * p - k * o) - f * (i * p - k * n) + g * (i * o - j * n));
+}
+
+static __attribute__((noinline)) Matrix4 oldInverse(const Matrix4 &m) {
+  f32 d = refDet(m);
+  if (std::fabs(d) < 1e-8f)
+    return Math::identity();
+  f32 invDet = 1.0f / d;
+
+  f32 a = m.m[0][0], b = m.m[0][1], c = m.m[0][2], d_ = m.m[0][3];
+  f32 e = m.m[1][0], f = m.m[1][1], g = m.m[1][2], h = m.m[1][3];
+  f32 i = m.m[2][0], j = m.m[2][1], k = m.m[2][2], l = m.m[2][3];
+  f32 n = m.m[3][0], o = m.m[3][1], p = m.m[3][2], q = m.m[3][3];
+
+  Matrix4 res;
+  res.m[0][0] = invDet * (f * (k * q - l * p) - g * (j * q - l * o) +
+                          h * (j * p - k * o));
+  res.m[1][0] = -invDet * (e * (k * q - l * p) - g * (i * q - l * n) +
+                           h * (i * p - k * n));
+  res.m[2][0] = invDet * (e * (j * q - l * o) - f * (i * q - l * n) +
+                          h * (i * o - j * n));
+  res.m[3][0] = -invDet * (e * (j * p - k * o) - f * (i * p - k * n) +
+                           g * (i * o - j * n));
+
+  res.m[0][1] = -invDet * (b * (k * q - l * p) - c * (j * q - l * o) +
+                           d_ * (j * p - k * o));
+  res.m[1][1] = invDet * (a * (k * q - l * p) - c * (i * q - l * n) +
+                          d_ * (i * p - k * n));
+  res.m[2][1] = -invDet * (a * (j * q - l * o) - b * (i * q - l * n) +
+                           d_ * (i * o - j * n));
+  res.m[3][1] = invDet * (a * (j * p - k * o) - b * (i * p - k * n) +
+                          c * (i * o - j * n));
+
+  res.m[0][2] = invDet * (b * (g * q - h * p) - c * (f * q - h * o) +
+                          d_ * (f * p - g * o));
+  res.m[1][2] = -invDet * (a * (g * q - h * p) - c * (e * q - h * n) +
+                           d_ * (e * p - g * n));
+  res.m[2][2] = invDet * (a * (f * q - h * o) - b * (e * q - h * n) +
+                          d_ * (e * o - f * n));
+  res.m[3][2] = -invDet * (a * (f * p - g * o) - b * (e * p - g * n) +
+                           c * (e * o - f * n));
+
+  res.m[0][3] = -invDet * (b * (g * l - h * k) - c * (f * l - h * j) +
+                           d_ * (f * k - g * j));
+  res.m[1][3] = invDet * (a * (g * l - h * k) - c * (e * l - h * i) +
+                          d_ * (e * k - g * i));
+  res.m[2][3] = -invDet * (a * (f * l - h * j) - b * (e * l - h * i) +
+                           d_ * (e * j - f * i));
+  res.m[3][3] = invDet * (a * (f * k - g * j) - b * (e * k - g * i) +
+                          c * (e * j - f * i));
+
+  return res;
+}
+
+// Gauss-Jordan with partial pivoting in f64, as an accuracy reference.
+static Matrix4 refInverse(const Matrix4 &m) {
+  f64 a[4][8];
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 8; ++j)
+      a[i][j] = j < 4 ? m.m[i][j] : (j - 4 == i);
+  for (int c = 0; c < 4; ++c) {
+    int p = c;
+    for (int r = c + 1; r < 4; ++r)
+      if (std::fabs(a[r][c]) > std::fabs(a[p][c]))
+        p = r;
+    for (int j = 0; j < 8; ++j) {
+      f64 t = a[c][j];
+      a[c][j] = a[p][j];
+      a[p][j] = t;
+    }
+    f64 inv = 1.0 / a[c][c];
+    for (int j = 0; j < 8; ++j)
+      a[c][j] *= inv;
+    for (int r = 0; r < 4; ++r)
+      if (r != c) {
+        f64 f = a[r][c];
+        for (int j = 0; j < 8; ++j)
+          a[r][j] -= f * a[c][j];
+      }
+  }
+  Matrix4 r;
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      r.m[i][j] = (f32)a[i][j + 4];
+  return r;
+}
+
+static f32 maxDiff(const Matrix4 &a, const Matrix4 &b) {
+  f32 e = 0;
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      e = std::fmax(e, std::fabs(a.m[i][j] - b.m[i][j]));
+  return e;
+}
+
+static bool check() {
+  bool ok = true;
+  for (int t = 0; t < 1000; ++t) {
+    Matrix4 a = randomMatrix(), b = randomMatrix();
+    ok = ok && maxDiff(Math::multiply(a, b), refMultiply(a, b)) < 1e-5f;
+    ok = ok && std::fabs(Math::det(a) - refDet(a)) <
+                   1e-4f * std::fmax(1.0f, std::fabs(refDet(a)));
+    ok = ok && maxDiff(Math::inverse(a), refInverse(a)) < 1e-4f;
+    Matrix4 t1 = Math::transpose(a);
+    for (int i = 0; i < 4; ++i)
+      for (int j = 0; j < 4; ++j)
+        ok = ok && t1.m[i][j] == a.m[j][i];
+  }
+  Matrix4 singular = {{{1, 2, 3, 4}, {2, 4, 6, 8}, {0, 1, 0, 1}, {1, 0, 1, 0}}};
+  ok = ok && maxDiff(Math::inverse(singular), Math::identity()) == 0;
+
+  // compose() is S Rx Ry Rz T.
+  Vector3 p = {1, -2, 3}, r = {0.3f, -1.1f, 2.0f}, s = {2, 0.5f, 3};
+  Matrix4 sm = Math::identity();
+  sm.m[0][0] = s.x;
+  sm.m[1][1] = s.y;
+  sm.m[2][2] = s.z;
+  Matrix4 want = sm * Math::rotateX(r.x) * Math::rotateY(r.y) *
+                 Math::rotateZ(r.z) * Math::translate(p.x, p.y, p.z);
+  ok = ok && maxDiff(Math::compose(p, r, s), want) < 1e-5f;
+
+  // Batches agree with the single-item functions, including ragged tails.
+  const usz n = 1037;
+  Matrix4 *ma = new Matrix4[n], *mb = new Matrix4[n], *mc = new Matrix4[n];
+  Array<f32> pos, rot, scl, pts;
+  pos.allocate(3 * n);
+  rot.allocate(3 * n);
+  scl.allocate(3 * n);
+  pts.allocate(3 * n);
+  for (usz i = 0; i < n; ++i) {
+    ma[i] = randomMatrix();
+    mb[i] = randomMatrix();
+  }
+  for (usz i = 0; i < 3 * n; ++i) {
+    pos[i] = rnd() * 10;
+    rot[i] = rnd() * 6;
+    scl[i] = rnd() + 1;
+    pts[i] = rnd() * 10;
+  }
+  usz d3[2] = {3, n};
+  pos.shape(2, d3);
+  rot.shape(2, d3);
+  scl.shape(2, d3);
+  pts.shape(2, d3);
+
+  ok = ok && Math::fromPlanes(Math::multiply(Math::toPlanes(ma, n),
+                                             Math::toPlanes(mb, n)),
+                              mc);
+  for (usz i = 0; i < n; ++i)
+    ok = ok && maxDiff(mc[i], ma[i] * mb[i]) < 1e-5f;
+
+  ok = ok && Math::fromPlanes(Math::compose(pos, rot, scl), mc);
+  for (usz i = 0; i < n; ++i) {
+    Matrix4 one = Math::compose({pos[i], pos[n + i], pos[2 * n + i]},
+                                {rot[i], rot[n + i], rot[2 * n + i]},
+                                {scl[i], scl[n + i], scl[2 * n + i]});
+    ok = ok && maxDiff(mc[i], one) < 1e-5f;
+  }
+
+  Array<f32> tp = Math::transformPoints(ma[0], pts),
+             tv = Math::transformVectors(ma[0], pts);
+  for (usz i = 0; i < n; ++i) {
+    Vector3 v = {pts[i], pts[n + i], pts[2 * n + i]};
+    Vector3 a = Math::transformPoint(ma[0], v), b = Math::transformVector(ma[0], v);
+    ok = ok && std::fabs(tp[i] - a.x) < 1e-4f &&
+         std::fabs(tp[n + i] - a.y) < 1e-4f &&
+         std::fabs(tp[2 * n + i] - a.z) < 1e-4f &&
+         std::fabs(tv[2 * n + i] - b.z) < 1e-4f;
+  }
+  ok = ok && Math::multiply(pts, pts).size() == 0 &&
+       Math::compose(pos, rot, Array<f32>()).size() == 0;
+
+  delete[] ma;
+  delete[] mb;
+  delete[] mc;
+  return ok;
+}
+
+int main() {
+  const char *isas[] = {"avx512", "avx2", "sse2", "neon", "generic", "scalar"};
+  for (const char *isa : isas) {
+    if (!Math::Simd::use(isa))
+      continue;
+    printf("correctness %-8s %s\n", isa, check() ? "ok" : "FAILED");
+  }
+  Math::Simd::use(nullptr);
+  printf("\nbatch kernels: %s\n\n", Math::Simd::isa());
+
+  const usz n = 1 << 16;
+  Matrix4 *ma = new Matrix4[n], *mb = new Matrix4[n], *mc = new Matrix4[n];
+  for (usz i = 0; i < n; ++i) {
+    ma[i] = randomMatrix();
+    mb[i] = randomMatrix();
+  }
+  f32 sink = 0;
+  auto rate = [](i64 us, usz items) { return (f64)items / (f64)us; };
+
+  printf("%-30s %14s %14s\n", "", "scalar", "simd");
+  {
+    i64 ts = best(5, [&]() {
+      for (usz i = 0; i < n; ++i)
+        mc[i] = refMultiply(ma[i], mb[i]);
+    });
+    i64 tv = best(5, [&]() {
+      for (usz i = 0; i < n; ++i)
+        mc[i] = Math::multiply(ma[i], mb[i]);
+    });
+    printf("%-30s %9.1f M/s %9.1f M/s\n", "multiply (matrices)",
+           rate(ts, n), rate(tv, n));
+  }
+  {
+    i64 ts = best(5, [&]() {
+      for (usz i = 0; i < n; ++i)
+        mc[i] = oldInverse(ma[i]);
+    });
+    i64 tv = best(5, [&]() {
+      for (usz i = 0; i < n; ++i)
+        mc[i] = Math::inverse(ma[i]);
+    });
+    printf("%-30s %9.1f M/s %9.1f M/s\n", "inverse (matrices)", rate(ts, n), rate(tv, n));
+    ts = best(5, [&]() {
+      for (usz i = 0; i < n; ++i)
+        sink += refDet(ma[i]);
+    });
+    tv = best(5, [&]() {
+      for (usz i = 0; i < n; ++i)
+        sink += Math::det(ma[i]);
+    });
+    printf("%-30s %9.1f M/s %9.1f M/s\n", "det (matrices)", rate(ts, n),
+           rate(tv, n));
+  }
+
+  // Batches sized to stay in L2 and repeated, so the numbers are compute,
+  // not DRAM or timer resolution. (Plane strides of a large power of two
+  // alias in L1 and cost about a third of the batch multiply rate.)
+  printf("\n%-30s %14s %14s\n", "", "per item", "batch SoA");
+  const usz nb = 4000, rounds = 100;
+  auto repeat = [&](auto f) {
+    return best(5, [&]() {
+      for (usz k = 0; k < rounds; ++k)
+        f();
+    });
+  };
+  {
+    Array<f32> a = Math::toPlanes(ma, nb), b = Math::toPlanes(mb, nb),
+               c = Math::toPlanes(mc, nb);
+    i64 ts = repeat([&]() {
+      for (usz i = 0; i < nb; ++i)
+        mc[i] = ma[i] * mb[i];
+    });
+    i64 tv =
+        repeat([&]() { Math::multiply(a.data(), b.data(), c.data(), nb); });
+    printf("%-30s %9.1f M/s %9.1f M/s\n", "multiply pairwise (matrices)",
+           rate(ts, nb * rounds), rate(tv, nb * rounds));
+  }
+  {
+    const usz np = 4 * nb;
+    Array<f32> pts, out;
+    pts.allocate(3 * np);
+    out.allocate(3 * np);
+    for (usz i = 0; i < 3 * np; ++i)
+      pts[i] = rnd();
+    Vector3 *aos = new Vector3[np], *aosOut = new Vector3[np];
+    for (usz i = 0; i < np; ++i)
+      aos[i] = {pts[i], pts[np + i], pts[2 * np + i]};
+    const Matrix4 m = ma[1];
+    i64 ts = repeat([&]() {
+      for (usz i = 0; i < np; ++i)
+        aosOut[i] = Math::transformPoint(m, aos[i]);
+    });
+    const f32 *p = pts.data();
+    f32 *o = out.data();
+    i64 tv = repeat([&]() { Math::transformPoints(m, p, o, np); });
+    printf("%-30s %9.1f M/s %9.1f M/s\n", "transform points",
+           rate(ts, np * rounds), rate(tv, np * rounds));
+    delete[] aos;
+    delete[] aosOut;
+  }
+  {
+    Array<f32> pos, rot, scl, out;
+    out.allocate(16 * nb);
+    pos.allocate(3 * nb);
+    rot.allocate(3 * nb);
+    scl.allocate(3 * nb);
+    for (usz i = 0; i < 3 * nb; ++i) {
+      pos[i] = rnd();
+      rot[i] = rnd() * 6;
+      scl[i] = rnd() + 1;
+    }
+    const f32 *pp = pos.data(), *pr = rot.data(), *ps = scl.data();
+    i64 tr = repeat([&]() {
+      for (usz i = 0; i < nb; ++i)
+        mc[i] = Math::rotateX(pr[i]) * Math::rotateY(pr[nb + i]) *
+                Math::translate(pp[i], pp[nb + i], pp[2 * nb + i]);
+    });
+    i64 ts = repeat([&]() {
+      for (usz i = 0; i < nb; ++i)
+        mc[i] = Math::compose({pp[i], pp[nb + i], pp[2 * nb + i]},
+                              {pr[i], pr[nb + i], pr[2 * nb + i]},
+                              {ps[i], ps[nb + i], ps[2 * nb + i]});
+    });
+    i64 tv = repeat([&]() { Math::compose(pp, pr, ps, out.data(), nb); });
+    printf("%-30s %9.1f M/s %9.1f M/s  (old getMatrix path %.1f M/s)\n",
+           "compose TRS (matrices)", rate(ts, nb * rounds),
+           rate(tv, nb * rounds), rate(tr, nb * rounds));
+  }
+  printf("(%g)\n", (f64)sink + mc[7].m[1][1]);
+
+  delete[] ma;
+  delete[] mb;
+  delete[] mc;
+  return 0;
+}
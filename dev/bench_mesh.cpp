@@ -0,0 +1,191 @@
+// MeshOpt on a triangle soup of 27 overlapping spheres (120k triangles,
+// shuffled): welding, vertex cache and overdraw reordering, and the
+// compact vertex layouts. Reports bytes per vertex, post-transform cache
+// ACMR / ATVR (FIFO 16 and 32), overdraw measured with the software
+// rasterizer from six directions, quantization error and pass times.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_mesh.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/MeshOptimize.hpp"
+#include "Xi/Raster.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace Xi;
+
+static u32 seed = 12345;
+static u32 rnd(u32 n) {
+  seed = seed * 1664525u + 1013904223u;
+  return (seed >> 8) % n;
+}
+
+static void sphere(f32 cx, f32 cy, f32 cz, u32 rings, u32 segments,
+                   InlineArray<Vertex> &v, InlineArray<u32> &idx) {
+  u32 base = (u32)v.size();
+  for (u32 r = 0; r <= rings; ++r)
+    for (u32 s = 0; s <= segments; ++s) {
+      f32 th = 3.14159265f * r / rings, ph = 2 * 3.14159265f * s / segments;
+      Vertex p = {};
+      p.nx = std::sin(th) * std::cos(ph);
+      p.ny = std::cos(th);
+      p.nz = std::sin(th) * std::sin(ph);
+      p.x = cx + p.nx, p.y = cy + p.ny, p.z = cz + p.nz;
+      p.u = (f32)s / segments, p.v = (f32)r / rings;
+      p.j[0] = s % 4, p.w[0] = 1;
+      v.push(p);
+    }
+  for (u32 r = 0; r < rings; ++r)
+    for (u32 s = 0; s < segments; ++s) {
+      u32 a = base + r * (segments + 1) + s, b = a + segments + 1;
+      u32 q[6] = {a, a + 1, b, a + 1, b + 1, b}; // clockwise from outside
+      for (u32 k : q)
+        idx.push(k);
+    }
+}
+
+// Fragments that passed the depth test per covered pixel, averaged over
+// six axis views. Triangles are drawn in index order, so this is the
+// overdraw the order produces.
+static f64 overdraw(SoftwareRenderingDevice &sw, void *target,
+                    const InlineArray<Vertex> &v, const InlineArray<u32> &idx) {
+  const i32 W = 512, H = 512;
+  Vector3 dirs[6] = {{0, 0, 0}, {0, 3.14159f, 0}, {0, 1.5708f, 0},
+                     {0, -1.5708f, 0}, {1.5708f, 0, 0}, {-1.5708f, 0, 0}};
+  Matrix4 proj = Math::ortho(-4, 4, -4, 4, 0.1f, 20.0f);
+  f64 sum = 0;
+  for (const Vector3 &r : dirs) {
+    Matrix4 world = Math::multiply(Math::compose({0, 0, 0}, r, {1, 1, 1}),
+                                   Math::translate(0, 0, 10));
+    sw.begin(target);
+    sw.draw(v.data(), v.size(), idx.data(), idx.size(),
+            Math::multiply(world, proj), world);
+    usz frags = sw.flush();
+    const u32 *px = (const u32 *)sw.map(target);
+    usz covered = 0;
+    for (usz i = 0; i < (usz)W * H; ++i)
+      covered += px[i] != sw.clearColor;
+    sum += covered ? (f64)frags / covered : 0;
+  }
+  return sum / 6;
+}
+
+static void report(const char *name, const InlineArray<u32> &idx, usz verts,
+                   f64 od) {
+  MeshOpt::CacheStats a = MeshOpt::analyzeVertexCache(idx.data(), idx.size(),
+                                                      verts, 16);
+  MeshOpt::CacheStats b = MeshOpt::analyzeVertexCache(idx.data(), idx.size(),
+                                                      verts, 32);
+  printf("%-22s %8.3f %8.3f %8.3f %8.3f %9.3f\n", name, a.acmr, a.atvr,
+         b.acmr, b.atvr, od);
+}
+
+int main() {
+  InlineArray<Vertex> mesh;
+  InlineArray<u32> meshIdx;
+  for (int i = 0; i < 27; ++i)
+    sphere((i % 3 - 1) * 1.2f, (i / 3 % 3 - 1) * 1.2f, (i / 9 - 1) * 1.2f, 40,
+           56, mesh, meshIdx);
+
+  // Triangle soup in random order, as from a naive exporter.
+  usz tris = meshIdx.size() / 3;
+  InlineArray<u32> order;
+  order.allocate(tris);
+  for (usz t = 0; t < tris; ++t)
+    order[t] = (u32)t;
+  for (usz t = tris - 1; t > 0; --t) {
+    usz k = rnd((u32)t + 1);
+    u32 tmp = order[t];
+    order[t] = order[k];
+    order[k] = tmp;
+  }
+  InlineArray<Vertex> soup;
+  for (usz t = 0; t < tris; ++t)
+    for (int c = 0; c < 3; ++c)
+      soup.push(mesh[meshIdx[order[t] * 3 + c]]);
+
+  SoftwareRenderingDevice sw;
+  sw.cullBack = true; // overdraw ordering assumes back faces are culled
+  void *target = sw.allocSurface(512, 512);
+
+  InlineArray<Vertex> v;
+  InlineArray<u32> idx;
+  i64 t0 = micros();
+  MeshOpt::weld(soup.data(), soup.size(), nullptr, 0, v, idx);
+  i64 tWeld = micros() - t0;
+  printf("%zu triangles, %zu soup vertices -> %zu welded\n\n", (size_t)tris,
+         (size_t)soup.size(), (size_t)v.size());
+
+  printf("%-22s %8s %8s %8s %8s %9s\n", "order", "acmr16", "atvr16", "acmr32",
+         "atvr32", "overdraw");
+  report("welded, shuffled", idx, v.size(), overdraw(sw, target, v, idx));
+
+  t0 = micros();
+  MeshOpt::optimizeVertexCache(idx.data(), idx.size(), v.size());
+  i64 tCache = micros() - t0;
+  report("vertex cache", idx, v.size(), overdraw(sw, target, v, idx));
+
+  t0 = micros();
+  MeshOpt::optimizeOverdraw(idx.data(), idx.size(), v.data(), v.size());
+  i64 tOver = micros() - t0;
+  report("+ overdraw", idx, v.size(), overdraw(sw, target, v, idx));
+
+  t0 = micros();
+  MeshOpt::optimizeVertexFetch(v, idx.data(), idx.size());
+  i64 tFetch = micros() - t0;
+
+  printf("\n%-30s %9s\n", "pass", "ms");
+  printf("%-30s %9.2f\n", "weld", tWeld / 1000.0);
+  printf("%-30s %9.2f\n", "optimizeVertexCache", tCache / 1000.0);
+  printf("%-30s %9.2f\n", "optimizeOverdraw", tOver / 1000.0);
+  printf("%-30s %9.2f\n", "optimizeVertexFetch", tFetch / 1000.0);
+
+  // Sizes and quantization error.
+  Bounds box = Bounds::of(&v.data()->x, v.size(), sizeof(Vertex) / 4);
+  InlineArray<u16> idx16;
+  bool narrowed = MeshOpt::narrow(idx.data(), idx.size(), idx16);
+  printf("\n%-16s %8s %12s %12s\n", "format", "bytes/v", "vertex KB",
+         "total KB");
+  VertexFormat formats[3] = {VertexFormat::Full, VertexFormat::Compact,
+                             VertexFormat::CompactSkinned};
+  const char *names[3] = {"Full", "Compact", "CompactSkinned"};
+  usz ib32 = idx.size() * 4, ib16 = narrowed ? idx.size() * 2 : ib32;
+  printf("soup (u32, none) %8zu %12.1f %12.1f\n", sizeof(Vertex),
+         soup.size() * sizeof(Vertex) / 1024.0,
+         soup.size() * sizeof(Vertex) / 1024.0);
+  f64 posErr = 0, nrmErr = 0, uvErr = 0;
+  for (int f = 0; f < 3; ++f) {
+    InlineArray<u8> packed;
+    MeshOpt::pack(v.data(), v.size(), formats[f], box, packed);
+    usz ib = f == 0 ? ib32 : ib16;
+    printf("%-16s %8zu %12.1f %12.1f\n", names[f],
+           (size_t)vertexStride(formats[f]), packed.size() / 1024.0,
+           (packed.size() + ib) / 1024.0);
+    if (formats[f] != VertexFormat::Compact)
+      continue;
+    Matrix4 d = MeshOpt::decodeMatrix(box, formats[f]);
+    for (usz i = 0; i < v.size(); ++i) {
+      CompactVertex c;
+      __builtin_memcpy(&c, packed.data() + i * sizeof(c), sizeof(c));
+      f32 p[3];
+      for (int k = 0; k < 3; ++k)
+        p[k] = c.p[0] / 32767.0f * d.m[0][k] + c.p[1] / 32767.0f * d.m[1][k] +
+               c.p[2] / 32767.0f * d.m[2][k] + d.m[3][k];
+      f64 e = std::fabs(p[0] - v[i].x) + std::fabs(p[1] - v[i].y) +
+              std::fabs(p[2] - v[i].z);
+      posErr = e > posErr ? e : posErr;
+      f32 n[3];
+      MeshOpt::octDecode(c.n, n);
+      f64 dot = n[0] * v[i].nx + n[1] * v[i].ny + n[2] * v[i].nz;
+      f64 ang = std::acos(dot > 1 ? 1 : dot) * 180 / 3.14159265;
+      nrmErr = ang > nrmErr ? ang : nrmErr;
+      f64 ue = std::fabs(MeshOpt::fromHalf(c.uv[0]) - v[i].u);
+      uvErr = ue > uvErr ? ue : uvErr;
+    }
+  }
+  printf("\nindices %s u16; compact max error: position %.2e (box %.1f), "
+         "normal %.4f deg, uv %.2e\n",
+         narrowed ? "fit" : "do not fit", posErr, box.max.x - box.min.x,
+         nrmErr, uvErr);
+  sw.free(target);
+  return 0;
+}
@@ -0,0 +1,151 @@
+// Per-thread RandomStream / SecureRandom against the shared global pool
+// they replace: ns per random() call and GB/s for bulk randomFill and
+// secureRandomFill, with 1, 2, 4 and 8 threads each working on their own
+// buffers. Rates are aggregate (wall time over the work of all threads),
+// so they scale with cores and stay flat when threads share one. The old generators are only timed on one thread; they share
+// unsynchronized state and lose or repeat values under contention.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_random.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/Crypto.hpp"
+#include "Xi/Math.hpp"
+#include "Xi/Random.hpp"
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+using namespace Xi;
+
+// The previous implementation: xorshift128 in a global pool, ChaCha20 over
+// a memset buffer keyed from the same pool.
+namespace legacy {
+u32 pool[20] = {123456789, 362436069, 521288629, 88675123};
+u32 counter = 0;
+
+u32 next() {
+  u32 t = pool[3], s = pool[0];
+  pool[3] = pool[2], pool[2] = pool[1], pool[1] = s;
+  t ^= t << 11;
+  t ^= t >> 8;
+  return pool[0] = t ^ s ^ (s >> 19);
+}
+void fill(u8 *buffer, usz size) {
+  usz i = 0;
+  for (; i + 4 <= size; i += 4) {
+    u32 r = next();
+    memcpy(buffer + i, &r, 4);
+  }
+}
+void secureFill(u8 *buffer, usz size) {
+  memset(buffer, 0, size);
+  crypto_chacha20_ietf(buffer, buffer, size, (const u8 *)&pool[4],
+                       (const u8 *)&pool[12], counter);
+  counter += (u32)((size + 63) / 64);
+}
+} // namespace legacy
+
+struct Result {
+  f64 callNs = 0, fillGBs = 0, secureGBs = 0, smallNs = 0;
+};
+
+const usz Calls = 20000000, Bulk = 1 << 20, BulkReps = 128, Small = 32;
+
+// Best of three; each thread runs the same work on its own buffer.
+template <typename Call, typename Fill, typename Secure>
+static Result run(int threads, Call call, Fill fill, Secure secure) {
+  Result best = {1e30, 0, 0, 1e30};
+  for (int rep = 0; rep < 3; ++rep) {
+    Result r;
+    u32 sink = 0;
+    auto phase = [&](auto work) {
+      std::thread pool[8];
+      i64 t0 = micros();
+      for (int t = 0; t < threads; ++t)
+        pool[t] = std::thread(work);
+      for (int t = 0; t < threads; ++t)
+        pool[t].join();
+      return (micros() - t0) * 1e-6;
+    };
+    f64 s = phase([&] {
+      u32 x = 0;
+      for (usz i = 0; i < Calls; ++i)
+        x += call();
+      __atomic_fetch_add(&sink, x, __ATOMIC_RELAXED);
+    });
+    r.callNs = s * 1e9 / (Calls * threads); // wall time over all calls
+    s = phase([&] {
+      u8 *b = new u8[Bulk];
+      for (usz i = 0; i < BulkReps; ++i)
+        fill(b, Bulk);
+      __atomic_fetch_add(&sink, b[Bulk / 2], __ATOMIC_RELAXED);
+      delete[] b;
+    });
+    r.fillGBs = (f64)threads * Bulk * BulkReps / s / 1e9;
+    s = phase([&] {
+      u8 *b = new u8[Bulk];
+      for (usz i = 0; i < BulkReps / 4; ++i)
+        secure(b, Bulk);
+      __atomic_fetch_add(&sink, b[Bulk / 2], __ATOMIC_RELAXED);
+      delete[] b;
+    });
+    r.secureGBs = (f64)threads * Bulk * (BulkReps / 4) / s / 1e9;
+    s = phase([&] {
+      u8 b[Small];
+      for (usz i = 0; i < Calls / 20; ++i)
+        secure(b, Small);
+      __atomic_fetch_add(&sink, b[0], __ATOMIC_RELAXED);
+    });
+    r.smallNs = s * 1e9 / (Calls / 20 * threads);
+    if (sink == 0x12345678)
+      printf(" ");
+    best.callNs = r.callNs < best.callNs ? r.callNs : best.callNs;
+    best.fillGBs = r.fillGBs > best.fillGBs ? r.fillGBs : best.fillGBs;
+    best.secureGBs = r.secureGBs > best.secureGBs ? r.secureGBs
+                                                  : best.secureGBs;
+    best.smallNs = r.smallNs < best.smallNs ? r.smallNs : best.smallNs;
+  }
+  return best;
+}
+
+static void row(const char *name, int threads, const Result &r) {
+  printf("%-10s %7d %12.2f %12.2f %12.2f %14.1f\n", name, threads, r.callNs,
+         r.fillGBs, r.secureGBs, r.smallNs);
+}
+
+int main() {
+  printf("isa %s, %u hardware threads\n\n", Math::Simd::isa(),
+         std::thread::hardware_concurrency());
+  printf("%-10s %7s %12s %12s %12s %14s\n", "generator", "threads",
+         "ns/random()", "fill GB/s", "secure GB/s", "ns/32B secure");
+
+  row("legacy", 1,
+      run(1, [] { return legacy::next(); }, legacy::fill,
+          legacy::secureFill));
+  const int counts[4] = {1, 2, 4, 8};
+  for (int t : counts)
+    row("per-thread", t,
+        run(
+            t, [] { return randomNext(); },
+            [](u8 *b, usz n) { randomFill(b, n); },
+            [](u8 *b, usz n) { secureRandomFill(b, n); }));
+
+  // Streams split by jump() must not meet: compare the heads of 64
+  // thread streams against each other.
+  const int Threads = 64, Draws = 64;
+  static u64 heads[Threads][Draws];
+  std::thread pool[Threads];
+  for (int t = 0; t < Threads; ++t)
+    pool[t] = std::thread([t] {
+      for (int i = 0; i < Draws; ++i)
+        heads[t][i] = threadRandom().next64();
+    });
+  for (std::thread &th : pool)
+    th.join();
+  int repeats = 0;
+  for (int a = 0; a < Threads * Draws; ++a)
+    for (int b = a + 1; b < Threads * Draws; ++b)
+      repeats += heads[a / Draws][a % Draws] == heads[b / Draws][b % Draws];
+  printf("\n%d threads x %d draws: %d repeated values\n", Threads, Draws,
+         repeats);
+  return 0;
+}
@@ -0,0 +1,125 @@
+// SoftwareRenderingDevice throughput: a grid of spheres (about 1M
+// triangles) at 1280x720, untextured and textured, with 0-7 worker threads.
+// Pass a file name to also write the textured frame as a PPM.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_raster.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/Raster.hpp"
+#include "Xi/Worker.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace Xi;
+
+template <typename F> static i64 best(int reps, F f) {
+  i64 b = -1;
+  for (int r = 0; r < reps; ++r) {
+    i64 t0 = micros();
+    f();
+    i64 dt = micros() - t0;
+    if (b < 0 || dt < b)
+      b = dt;
+  }
+  return b > 0 ? b : 1;
+}
+
+// Unit sphere, `rings` x `segments` quads.
+static void sphere(u32 rings, u32 segments, InlineArray<Vertex> &v,
+                   InlineArray<u32> &idx) {
+  for (u32 r = 0; r <= rings; ++r)
+    for (u32 s = 0; s <= segments; ++s) {
+      f32 th = 3.14159265f * r / rings, ph = 2 * 3.14159265f * s / segments;
+      Vertex p = {};
+      p.nx = std::sin(th) * std::cos(ph);
+      p.ny = std::cos(th);
+      p.nz = std::sin(th) * std::sin(ph);
+      p.x = p.nx, p.y = p.ny, p.z = p.nz;
+      p.u = (f32)s / segments * 4;
+      p.v = (f32)r / rings * 2;
+      v.push(p);
+    }
+  for (u32 r = 0; r < rings; ++r)
+    for (u32 s = 0; s < segments; ++s) {
+      u32 a = r * (segments + 1) + s, b = a + segments + 1;
+      u32 q[6] = {a, b, a + 1, a + 1, b, b + 1};
+      for (u32 k : q)
+        idx.push(k);
+    }
+}
+
+int main(int argc, char **argv) {
+  const i32 W = 1280, H = 720;
+  InlineArray<Vertex> verts;
+  InlineArray<u32> idx;
+  sphere(64, 128, verts, idx); // 16k triangles
+  const usz tris = idx.size() / 3;
+
+  InlineArray<u8> checker;
+  checker.allocate(256 * 256 * 4);
+  for (usz y = 0; y < 256; ++y)
+    for (usz x = 0; x < 256; ++x) {
+      u8 *p = checker.data() + (y * 256 + x) * 4;
+      bool on = ((x / 32) ^ (y / 32)) & 1;
+      p[0] = on ? 230 : 40, p[1] = on ? 180 : 90, p[2] = on ? 60 : 200;
+      p[3] = 255;
+    }
+  RasterTexture tex;
+  tex.rgba = checker.data();
+  tex.width = tex.height = 256;
+
+  // 8 x 8 spheres, camera 12 units back.
+  Matrix4 view = Math::translate(0, 0, 12);
+  Matrix4 proj = Math::perspective(60.0f * 3.14159f / 180.0f, (f32)W / H,
+                                   0.1f, 100.0f);
+  Matrix4 vp = Math::multiply(view, proj);
+  Matrix4 worlds[64];
+  for (int i = 0; i < 64; ++i) {
+    worlds[i] = Math::compose(
+        {(i % 8 - 3.5f) * 2.2f, (i / 8 - 3.5f) * 1.3f, (f32)(i % 3)},
+        {0.3f, 0.2f * i, 0}, {0.9f, 0.9f, 0.9f});
+  }
+
+  SoftwareRenderingDevice sw;
+  void *target = sw.allocSurface(W, H);
+  auto frame = [&](bool textured) {
+    sw.begin(target);
+    for (int i = 0; i < 64; ++i)
+      sw.draw(verts.data(), verts.size(), idx.data(), idx.size(),
+              Math::multiply(worlds[i], vp), worlds[i],
+              textured ? tex : RasterTexture());
+    sw.flush();
+  };
+
+  printf("%zu triangles per frame at %dx%d, isa %s\n", (size_t)tris * 64, W,
+         H, Math::Simd::isa());
+  printf("\n%-10s %-10s %9s %12s %12s\n", "threads", "texture", "ms",
+         "Mtri/s", "Mfrag/s");
+  usz counts[] = {0, 1, 3, 7};
+  for (usz c : counts) {
+    WorkerPool *pool = c ? new WorkerPool(c) : nullptr;
+    sw.pool = pool;
+    for (int textured = 0; textured < 2; ++textured) {
+      i64 t = best(3, [&]() { frame(textured != 0); });
+      printf("%-10zu %-10s %9.2f %12.1f %12.1f\n", (size_t)c + 1,
+             textured ? "bilinear" : "none", t / 1000.0,
+             (f64)sw.stats.triangles / t, (f64)sw.stats.fragments / t);
+    }
+    sw.pool = nullptr;
+    delete pool;
+  }
+  printf("\nrejected %zu, tile bins %zu, fragments %zu\n",
+         (size_t)sw.stats.rejected, (size_t)sw.stats.binned,
+         (size_t)sw.stats.fragments);
+
+  if (argc > 1) {
+    if (FILE *f = fopen(argv[1], "wb")) {
+      fprintf(f, "P6\n%d %d\n255\n", W, H);
+      const u8 *p = (const u8 *)sw.map(target);
+      for (usz i = 0; i < (usz)W * H; ++i)
+        fwrite(p + i * 4, 1, 3, f);
+      fclose(f);
+    }
+  }
+  sw.free(target);
+  return 0;
+}
@@ -0,0 +1,109 @@
+// DeviceScheduler benchmark: loop time and jitter with mixed fast/slow devices.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_scheduler.cpp -L_gate_build -lXi -pthread
+
+#include "Xi/Scheduler.hpp"
+#include "Xi/Time.hpp"
+#include <cstdio>
+
+using namespace Xi;
+
+// Busy for `spinMicros`, or blocked for `sleepMicros` (a sensor read, a poll).
+class SimDevice : public Device {
+public:
+  i64 spinMicros = 0;
+  i64 sleepMicros = 0;
+  u64 updates = 0;
+
+  void update() override {
+    if (sleepMicros)
+      Time::sleep((f64)sleepMicros / 1e6);
+    i64 until = micros() + spinMicros;
+    while (micros() < until) {
+    }
+    updates++;
+  }
+};
+
+struct Jitter {
+  i64 min = 0x7fffffffffffffffLL, max = 0, sum = 0, sumSq = 0;
+  u64 n = 0;
+  void add(i64 v) {
+    if (v < min)
+      min = v;
+    if (v > max)
+      max = v;
+    sum += v;
+    sumSq += v * v;
+    n++;
+  }
+  void print(const char *label) const {
+    f64 mean = (f64)sum / (f64)n;
+    f64 var = (f64)sumSq / (f64)n - mean * mean;
+    f64 sd = 1.0;
+    // Newton's method; keeps the bench free of <cmath>.
+    for (int i = 0; i < 32 && var > 0; ++i)
+      sd = 0.5 * (sd + var / sd);
+    printf("%-10s mean %8.1f us  min %6lld  max %6lld  stddev %7.1f\n", label,
+           mean, (long long)min, (long long)max, var > 0 ? sd : 0.0);
+  }
+};
+
+int main() {
+  const usz fast = 8, slow = 2;
+  const u64 frames = 300;
+  SimDevice devs[fast + slow];
+  for (usz i = 0; i < fast; ++i)
+    devs[i].spinMicros = 50;
+  for (usz i = fast; i < fast + slow; ++i)
+    devs[i].sleepMicros = 2000;
+
+  // Serial: what the application loop does today.
+  {
+    Jitter j;
+    for (u64 f = 0; f < frames; ++f) {
+      i64 t0 = micros();
+      for (usz i = 0; i < fast + slow; ++i)
+        devs[i].update();
+      j.add(micros() - t0);
+    }
+    j.print("serial");
+  }
+
+  // Scheduled: same devices in parallel, one fusion node after the fast ones.
+  {
+    WorkerPool pool(4);
+    DeviceScheduler sched(pool);
+    u64 fused = 0;
+    usz fuse = sched.add([&fused]() { fused++; });
+    for (usz i = 0; i < fast + slow; ++i) {
+      usz id = sched.add(&devs[i]);
+      if (i < fast)
+        sched.dependsOn(fuse, id);
+    }
+    Jitter j;
+    for (u64 f = 0; f < frames; ++f) {
+      sched.tick();
+      j.add(sched.lastTickMicros);
+    }
+    j.print("scheduled");
+
+    // Rate-limit the slow devices to 50 Hz; the tick then mostly waits on
+    // the fast ones.
+    for (usz i = fast; i < fast + slow; ++i)
+      sched.setRate(sched.find(&devs[i]), 50.0);
+    sched.resetStats();
+    Jitter r;
+    for (u64 f = 0; f < frames; ++f) {
+      sched.tick();
+      r.add(sched.lastTickMicros);
+    }
+    r.print("50Hz slow");
+    const DeviceScheduler::Stats *s = sched.stats(sched.find(&devs[fast]));
+    printf("slow dev:  %llu runs, %llu skipped, avg %.1f us, max %lld us; "
+           "fused %llu\n",
+           (unsigned long long)s->runs, (unsigned long long)s->skipped,
+           s->averageMicros(), (long long)s->maxMicros,
+           (unsigned long long)fused);
+  }
+  return 0;
+}
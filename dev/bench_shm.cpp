@@ -0,0 +1,113 @@
+// SharedMemoryDevice benchmark: payload hand-off to a child process through
+// the shared handle ring vs. copying through a Unix socket.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_shm.cpp -L_gate_build -lXi -pthread
+
+#include "Xi/SharedMemory.hpp"
+#include "Xi/String.hpp"
+#include <cstdio>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace Xi;
+
+static const usz Payload = 64 * 1024;
+static const u64 Count = 20000;
+
+// Both sides touch every byte, as a real producer/consumer would.
+static u64 checksum(const u8 *p, usz n) {
+  const u64 *w = (const u64 *)p;
+  u64 s = 0;
+  for (usz i = 0; i < n / 8; ++i)
+    s += w[i];
+  return s;
+}
+
+static void fill(u8 *p, usz n, u64 seed) {
+  u64 *w = (u64 *)p;
+  for (usz i = 0; i < n / 8; ++i)
+    w[i] = seed + i;
+}
+
+static void benchSocket() {
+  int sv[2];
+  socketpair(AF_UNIX, SOCK_STREAM, 0, sv);
+  i64 t0 = micros();
+  if (fork() == 0) {
+    close(sv[0]);
+    u8 *buf = new u8[Payload];
+    u64 sum = 0;
+    for (u64 k = 0; k < Count; ++k) {
+      usz got = 0;
+      while (got < Payload) {
+        ssize_t r = read(sv[1], buf + got, Payload - got);
+        if (r <= 0)
+          _exit(1);
+        got += (usz)r;
+      }
+      sum += checksum(buf, Payload);
+    }
+    _exit(sum ? 0 : 1);
+  }
+  close(sv[1]);
+  String s;
+  s.allocate(Payload);
+  for (u64 k = 0; k < Count; ++k) {
+    fill(s.data(), Payload, k);
+    usz sent = 0;
+    while (sent < Payload) {
+      ssize_t w = write(sv[0], s.data() + sent, Payload - sent);
+      if (w <= 0)
+        break;
+      sent += (usz)w;
+    }
+  }
+  close(sv[0]);
+  wait(nullptr);
+  i64 dt = micros() - t0;
+  printf("socket: %8.2f MB/s\n", (f64)Payload * Count / (f64)dt);
+}
+
+static void benchShared() {
+  SharedMemoryDevice shm;
+  if (!shm.create((usz)256 << 20)) {
+    printf("shm:    unavailable\n");
+    return;
+  }
+  i64 t0 = micros();
+  if (fork() == 0) {
+    // The child inherits the mapping; a separate process would attach(fd).
+    u64 sum = 0;
+    for (u64 k = 0; k < Count;) {
+      String s = shm.receive<u8>();
+      if (s.size() == 0) {
+        sched_yield(); // ring empty
+        continue;
+      }
+      sum += checksum(s.data(), s.size());
+      k++;
+    }
+    _exit(sum ? 0 : 1);
+  }
+  for (u64 k = 0; k < Count; ++k) {
+    String s;
+    while (!s.allocateOn(&shm, Payload))
+      sched_yield(); // slab exhausted until the child frees blocks
+    fill(s.data(), Payload, k);
+    while (!shm.send(s.getDeviceHandle()))
+      sched_yield(); // ring full
+  }
+  int status = 0;
+  wait(&status);
+  i64 dt = micros() - t0;
+  printf("shm:    %8.2f MB/s (child %s, %zu KiB of slab used)\n",
+         (f64)Payload * Count / (f64)dt, status == 0 ? "ok" : "failed",
+         shm.usedBytes() / 1024);
+}
+
+int main() {
+  benchSocket();
+  benchShared();
+  return 0;
+}
@@ -0,0 +1,169 @@
+// Vectorized transcendental kernels: accuracy (max ulp vs. the correctly
+// rounded double result, sampled across the f32 range) and throughput per
+// instruction set vs. scalar libm.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_simd_math.cpp -L_gate_build -lXi
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/Array.hpp"
+#include "Xi/Math.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+using namespace Xi;
+
+typedef void (*Kernel)(const f32 *, f32 *, usz);
+
+struct Fn {
+  const char *name;
+  Kernel kernel;
+  double (*ref)(double);
+  bool (*domain)(f32);
+  bool relative; // approximate kernels: report relative error
+};
+
+static double sigmoidRef(double x) { return 1.0 / (1.0 + std::exp(-x)); }
+static bool all(f32 x) { return x == x; }
+static bool positive(f32 x) { return x > 0; }
+static bool expRange(f32 x) { return x > -104.0f && x < 88.7f; }
+static bool trigRange(f32 x) { return x >= -8192.0f && x <= 8192.0f; }
+static bool approxRange(f32 x) { return x > -87.0f && x < 88.0f; }
+static bool sigmoidApproxRange(f32 x) { return x > -88.0f && x < 87.0f; }
+
+static const Fn fns[] = {
+    {"exp", Math::Simd::exp, std::exp, expRange, false},
+    {"log", Math::Simd::log, std::log, positive, false},
+    {"sin", Math::Simd::sin, std::sin, trigRange, false},
+    {"cos", Math::Simd::cos, std::cos, trigRange, false},
+    {"tanh", Math::Simd::tanh, std::tanh, all, false},
+    {"sigmoid", Math::Simd::sigmoid, sigmoidRef, all, false},
+    {"expApprox", Math::Simd::expApprox, std::exp, approxRange, true},
+    {"sigmoidApprox", Math::Simd::sigmoidApprox, sigmoidRef,
+     sigmoidApproxRange, true},
+};
+static const int FnCount = sizeof(fns) / sizeof(fns[0]);
+
+static i64 ordered(f32 f) {
+  i32 i;
+  memcpy(&i, &f, 4);
+  return i < 0 ? (i64)(i32)0x80000000 - i : i;
+}
+
+static f64 ulps(f32 got, double want) {
+  f32 w = (f32)want;
+  if (got != got || w != w)
+    return (got != got && w != w) ? 0 : 1e9;
+  if (got == w)
+    return 0;
+  i64 d = ordered(got) - ordered(w);
+  return (f64)(d < 0 ? -d : d);
+}
+
+int main() {
+  const char *isas[] = {"avx512", "avx2", "sse2", "neon", "generic", "scalar"};
+  const char *avail[6];
+  int na = 0;
+  for (const char *i : isas)
+    if (Math::Simd::use(i))
+      avail[na++] = i;
+  Math::Simd::use(nullptr);
+  printf("default kernels: %s\n\n", Math::Simd::isa());
+
+  // --- Accuracy ---
+  const usz Batch = 4096;
+  static f32 in[Batch], out[Batch];
+  static double ref[Batch];
+  f64 worst[FnCount][6] = {};
+  for (int f = 0; f < FnCount; ++f) {
+    usz n = 0;
+    auto flush = [&]() {
+      for (usz k = 0; k < n; ++k)
+        ref[k] = fns[f].ref((double)in[k]);
+      for (int a = 0; a < na; ++a) {
+        Math::Simd::use(avail[a]);
+        fns[f].kernel(in, out, n);
+        for (usz k = 0; k < n; ++k) {
+          f64 e = fns[f].relative
+                      ? std::fabs(out[k] - ref[k]) / std::fabs(ref[k])
+                      : ulps(out[k], ref[k]);
+          if (e > worst[f][a])
+            worst[f][a] = e;
+        }
+      }
+      n = 0;
+    };
+    for (u64 b = 0; b < ((u64)1 << 32); b += 97) {
+      u32 bitsv = (u32)b;
+      f32 x;
+      memcpy(&x, &bitsv, 4);
+      if (!fns[f].domain(x))
+        continue;
+      in[n++] = x;
+      if (n == Batch)
+        flush();
+    }
+    if (n)
+      flush();
+  }
+  Math::Simd::use(nullptr);
+
+  printf("%-14s", "max error");
+  for (int a = 0; a < na; ++a)
+    printf("%12s", avail[a]);
+  printf("\n");
+  for (int f = 0; f < FnCount; ++f) {
+    printf("%-14s", fns[f].name);
+    for (int a = 0; a < na; ++a)
+      if (fns[f].relative)
+        printf("%10.1e  ", worst[f][a]);
+      else
+        printf("%8.0f ulp", worst[f][a]);
+    printf("\n");
+  }
+
+  // --- Throughput ---
+  const usz N = (usz)1 << 16; // stays in L2: measures compute, not DRAM
+  static f32 x[N], y[N];
+  for (usz i = 0; i < N; ++i)
+    x[i] = ((f32)i / N - 0.5f) * 20.0f + 0.001f;
+  printf("\n%-14s", "Melem/s");
+  for (int a = 0; a < na; ++a)
+    printf("%12s", avail[a]);
+  printf("\n");
+  for (int f = 0; f < FnCount; ++f) {
+    printf("%-14s", fns[f].name);
+    for (int a = 0; a < na; ++a) {
+      Math::Simd::use(avail[a]);
+      i64 bestDt = -1;
+      for (int r = 0; r < 20; ++r) {
+        i64 t0 = micros();
+        fns[f].kernel(x, y, N);
+        i64 dt = micros() - t0;
+        if (bestDt < 0 || dt < bestDt)
+          bestDt = dt;
+      }
+      printf("%12.0f", (f64)N / (f64)(bestDt > 0 ? bestDt : 1));
+    }
+    printf("\n");
+  }
+  Math::Simd::use(nullptr);
+
+  // --- Through the Array expression layer ---
+  Array<f32> a, r;
+  a.allocate((usz)1 << 22);
+  f32 *pa = a.data();
+  for (usz i = 0; i < a.size(); ++i)
+    pa[i] = ((f32)i / (f32)a.size() - 0.5f) * 8.0f;
+  r.allocate(a.size());
+  for (int pass = 0; pass < 2; ++pass) {
+    Math::Simd::use(pass == 0 ? "scalar" : nullptr);
+    i64 t0 = micros();
+    evalInto(r, Math::sigmoid(a * 2.0f + 1.0f));
+    i64 dt = micros() - t0;
+    printf("\nsigmoid(a * 2 + 1), 4M elements, %-7s %8.1f Melem/s",
+           Math::Simd::isa(), (f64)a.size() / (f64)dt);
+  }
+  printf("\n");
+  Math::Simd::use(nullptr);
+  return 0;
+}
@@ -0,0 +1,111 @@
+// Coroutine layer benchmark: awaits/sec and memory per suspended task.
+// g++ -O2 -std=c++20 -Iinclude dev/bench_task.cpp -L_gate_build -lXi
+// Needs optimization: section 2 relies on symmetric transfer being a tail call.
+
+#include "Rho/Async.hpp"
+#include "Xi/File.hpp"
+#include "Xi/Task.hpp"
+#include <cstdio>
+
+using namespace Xi;
+
+static Task<u64> spinner(EventLoop &loop, u64 rounds) {
+  u64 n = 0;
+  for (u64 i = 0; i < rounds; ++i) {
+    co_await loop.yield();
+    n++;
+  }
+  co_return n;
+}
+
+static Task<u64> leaf(u64 v) { co_return v + 1; }
+
+static Task<u64> chain(u64 depth) {
+  u64 acc = 0;
+  for (u64 i = 0; i < depth; ++i)
+    acc += co_await leaf(i);
+  co_return acc;
+}
+
+static Task<> parked(EventLoop &loop) { co_await loop.sleep(60000); }
+
+static Task<> consumer(AsyncTunnel &t, u64 count, u64 &bytes) {
+  for (u64 i = 0; i < count; ++i) {
+    Packet p = co_await t.nextPacket(5);
+    bytes += p.payload.size();
+  }
+}
+
+int main() {
+  EventLoop loop;
+
+  // 1. Scheduler round trips (yield -> resume).
+  {
+    const u64 tasks = 1000, rounds = 1000;
+    Task<u64> *ts = new Task<u64>[tasks];
+    for (u64 i = 0; i < tasks; ++i) {
+      ts[i] = spinner(loop, rounds);
+      ts[i].start();
+    }
+    i64 t0 = micros();
+    loop.run();
+    i64 dt = micros() - t0;
+    f64 awaits = (f64)(tasks * rounds);
+    printf("yield:        %.2f M awaits/s (%lld us)\n",
+           awaits / (f64)dt, (long long)dt);
+    delete[] ts;
+  }
+
+  // 2. Task-to-task awaits (symmetric transfer, pooled frames).
+  {
+    FramePool &pool = FramePool::local();
+    usz before = pool.heapAllocs;
+    const u64 depth = 1000000;
+    i64 t0 = micros();
+    Task<u64> t = chain(depth);
+    t.start();
+    i64 dt = micros() - t0;
+    printf("task await:   %.2f M awaits/s, heap allocs %zu for %llu frames\n",
+           (f64)depth / (f64)dt, (size_t)(pool.heapAllocs - before),
+           (unsigned long long)depth + 1);
+  }
+
+  // 3. Memory per suspended task. The parked timers get their own loop:
+  // destroying a suspended Task does not unlink it from the loop that holds it.
+  {
+    EventLoop parkLoop;
+    FramePool &pool = FramePool::local();
+    const usz n = 100000;
+    usz bytes0 = pool.liveBytes, live0 = pool.live;
+    Task<> *ts = new Task<>[n];
+    for (usz i = 0; i < n; ++i) {
+      ts[i] = parked(parkLoop);
+      ts[i].start();
+    }
+    usz frames = pool.live - live0;
+    printf("suspended:    %zu tasks, %.1f bytes/task\n", (size_t)frames,
+           (f64)(pool.liveBytes - bytes0) / (f64)frames);
+    delete[] ts; // destroys the suspended frames
+  }
+
+  // 4. Tunnel packets delivered to a waiting coroutine.
+  {
+    Tunnel tx, rx;
+    AsyncTunnel arx(rx, loop);
+    const u64 count = 100000;
+    u64 bytes = 0;
+    Task<> c = consumer(arx, count, bytes);
+    c.start();
+    String payload = "0123456789abcdef0123456789abcdef";
+    i64 t0 = micros();
+    for (u64 i = 0; i < count; ++i) {
+      tx.push(payload, 5);
+      rx.parse(tx.flush());
+      loop.runOnce();
+    }
+    i64 dt = micros() - t0;
+    printf("tunnel:       %.2f k packets/s (%llu bytes)\n",
+           (f64)count * 1000.0 / (f64)dt, (unsigned long long)bytes);
+  }
+  return 0;
+}
@@ -0,0 +1,127 @@
+// TransferQueue benchmark on the CPU-emulated device: per-array uploads vs.
+// one coalesced batch, full vs. dirty-range re-upload, and overlap with work.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_transfer.cpp -L_gate_build -lXi -pthread
+
+#include "Xi/Transfer.hpp"
+#include <cstdio>
+
+using namespace Xi;
+
+static bool same(EmulatedMemoryDevice &dev, const InlineArray<f32> &gpu,
+                 const InlineArray<f32> &cpu) {
+  const f32 *d = (const f32 *)dev.contents(gpu.getDeviceHandle());
+  for (usz i = 0; i < cpu.size(); ++i)
+    if (d[i] != cpu[i])
+      return false;
+  return true;
+}
+
+int main() {
+  EmulatedMemoryDevice dev;
+
+  // 1. Many small arrays: one call each vs. one batch.
+  {
+    const usz arrays = 2000, n = 256;
+    InlineArray<f32> *cpu = new InlineArray<f32>[arrays];
+    InlineArray<f32> *gpu = new InlineArray<f32>[arrays];
+    for (usz a = 0; a < arrays; ++a) {
+      cpu[a].allocate(n);
+      for (usz i = 0; i < n; ++i)
+        cpu[a][i] = (f32)(a * n + i);
+      gpu[a].allocateOn(&dev, n);
+    }
+
+    dev.calls = 0;
+    i64 t0 = micros();
+    for (usz a = 0; a < arrays; ++a)
+      dev.upload(gpu[a].getDeviceHandle(), cpu[a].data(), n * sizeof(f32));
+    i64 single = micros() - t0;
+    u64 singleCalls = dev.calls;
+
+    for (usz a = 0; a < arrays; ++a)
+      cpu[a][0] += 1.0f;
+    dev.calls = 0;
+    TransferQueue q(dev);
+    t0 = micros();
+    for (usz a = 0; a < arrays; ++a)
+      q.upload(gpu[a], cpu[a].data(), n);
+    q.flush();
+    i64 batched = micros() - t0;
+
+    bool ok = true;
+    for (usz a = 0; a < arrays && ok; ++a)
+      ok = same(dev, gpu[a], cpu[a]);
+    printf("small arrays: per-array %lld us (%llu calls), batched %lld us "
+           "(%llu call) %s\n",
+           (long long)single, (unsigned long long)singleCalls,
+           (long long)batched, (unsigned long long)dev.calls,
+           ok ? "ok" : "MISMATCH");
+    delete[] cpu;
+    delete[] gpu;
+  }
+
+  // 2. Large array with scattered edits: full vs. dirty ranges.
+  {
+    const usz n = (usz)4 << 20;
+    InlineArray<f32> cpu, gpu;
+    cpu.allocate(n);
+    gpu.allocateOn(&dev, n);
+    TransferQueue q(dev);
+    q.upload(gpu, cpu.data(), n);
+    q.flush();
+
+    DirtyRanges dirty;
+    dirty.mergeGap = 64;
+    for (usz k = 0; k < 200; ++k) {
+      usz at = (k * 2654435761u) % (n - 32);
+      for (usz i = 0; i < 32; ++i)
+        cpu[at + i] = (f32)k;
+      dirty.mark(at, at + 32);
+    }
+    usz dirtyElems = dirty.total();
+
+    i64 t0 = micros();
+    dev.upload(gpu.getDeviceHandle(), cpu.data(), n * sizeof(f32));
+    i64 full = micros() - t0;
+
+    t0 = micros();
+    q.upload(gpu, cpu, dirty);
+    q.flush();
+    i64 partial = micros() - t0;
+    printf("dirty ranges: full %lld us, %zu ranges / %zu elems %lld us %s\n",
+           (long long)full, (size_t)q.submittedOps - 1, (size_t)dirtyElems,
+           (long long)partial, same(dev, gpu, cpu) ? "ok" : "MISMATCH");
+  }
+
+  // 3. Overlap: copies on a worker while the caller computes.
+  {
+    const usz n = (usz)8 << 20;
+    InlineArray<f32> cpu, gpu;
+    cpu.allocate(n);
+    gpu.allocateOn(&dev, n);
+    auto work = []() {
+      volatile f64 acc = 0;
+      for (int i = 0; i < 3000000; ++i)
+        acc = acc + i * 0.5;
+    };
+
+    TransferQueue sync(dev);
+    i64 t0 = micros();
+    sync.upload(gpu, cpu.data(), n);
+    sync.flush();
+    work();
+    i64 serial = micros() - t0;
+
+    WorkerPool pool(1);
+    TransferQueue async(dev, &pool);
+    t0 = micros();
+    async.upload(gpu, cpu.data(), n);
+    u64 fence = async.submit();
+    work();
+    async.wait(fence);
+    i64 overlapped = micros() - t0;
+    printf("overlap:      serial %lld us, async %lld us\n", (long long)serial,
+           (long long)overlapped);
+  }
+  return 0;
+}
@@ -0,0 +1,95 @@
+// Packets/s of a JS-driven Tunnel loop under Node: JS pushes a payload into
+// tunnel A, hands the flushed bundle to tunnel B and reads the payload back
+// out, plain and with security (windowed ChaCha20-Poly1305). "copy" moves
+// every payload and bundle as a fresh String and copies results back into
+// JS arrays, like passing Strings by value; "zero-copy" reuses XiBytes
+// handles and reads results through views over WASM memory
+// (src/wasm/bridge.js). Build first with `node src/build.js wasm`.
+// node dev/bench_tunnel.mjs [--variant=simd] [size=256]
+
+import path from "path";
+import { pathToFileURL } from "url";
+
+const args = process.argv.slice(2);
+const variantArg = args.find((a) => a.startsWith("--variant="));
+const sizeArg = args.find((a) => /^\d+$/.test(a));
+const Size = sizeArg ? Number(sizeArg) : 256;
+const Packets = 20000;
+
+const loader = pathToFileURL(path.resolve("dist/js/xi.js")).href;
+const { default: createXi } = await import(loader);
+const Xi = await createXi(
+  variantArg ? { variant: variantArg.slice("--variant=".length) } : {},
+);
+const { XiBytes, XiTunnel } = Xi;
+
+function pair(secure) {
+  const a = new XiTunnel(), b = new XiTunnel();
+  for (const t of [a, b]) {
+    t.setAliveTimeout(0);
+    if (secure) {
+      t.enableWindowing();
+      t.secure(new Uint8Array(32).fill(7));
+    }
+  }
+  return [a, b];
+}
+
+function copyLoop(a, b, payload) {
+  let bytes = 0;
+  for (let i = 0; i < Packets; ++i) {
+    payload[0] = i;
+    a.push(payload); // a fresh String per packet
+    const bundle = a.flush().slice();
+    const inbound = XiBytes.from(bundle);
+    b.parse(inbound);
+    inbound.free();
+    const got = XiBytes.alloc();
+    while (b.receive(got) >= 0) bytes += got.view().slice().length;
+    got.free();
+  }
+  return bytes;
+}
+
+function zeroCopyLoop(a, b, payload) {
+  const msg = XiBytes.alloc(payload.length), got = XiBytes.alloc();
+  let bytes = 0;
+  for (let i = 0; i < Packets; ++i) {
+    payload[0] = i;
+    msg.write(payload);
+    a.push(msg);
+    const bundle = a.flush();
+    b.inbound.prepare(bundle.length).set(bundle); // the socket read
+    b.parse();
+    while (b.receive(got) >= 0) bytes += got.view().length;
+  }
+  msg.free();
+  got.free();
+  return bytes;
+}
+
+function measure(loop, secure) {
+  let best = 0;
+  for (let rep = 0; rep < 3; ++rep) {
+    const [a, b] = pair(secure); // fresh pair: windowed A keeps unacked bundles
+    const payload = new Uint8Array(Size).fill(1);
+    const t0 = process.hrtime.bigint();
+    const bytes = loop(a, b, payload);
+    const s = Number(process.hrtime.bigint() - t0) / 1e9;
+    if (bytes !== Packets * Size) throw new Error(`lost packets: ${bytes}`);
+    best = Math.max(best, Packets / s);
+    a.free();
+    b.free();
+  }
+  return best;
+}
+
+console.log(`variant ${Xi.variant}, ${Size}-byte payloads, ${Packets} packets`);
+console.log("mode".padEnd(12) + ["copy", "zero-copy", "speedup"].map((h) =>
+  h.padStart(14)).join(""));
+for (const secure of [false, true]) {
+  const c = measure(copyLoop, secure), z = measure(zeroCopyLoop, secure);
+  console.log((secure ? "secure" : "plain").padEnd(12) +
+    [c.toFixed(0), z.toFixed(0), (z / c).toFixed(2) + "x"]
+      .map((v) => v.padStart(14)).join("") + "  packets/s");
+}
@@ -0,0 +1,199 @@
+// Strided views: cost of creating views, and kernels reading strided data
+// in place vs. copying it into a dense Array first.
+// g++ -O2 -std=c++17 -Iinclude dev/bench_view.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/ArrayView.hpp"
+#include "Xi/Math.hpp"
+#include <cmath>
+#include <cstdio>
+
+using namespace Xi;
+
+template <typename F> static i64 best(int reps, F f) {
+  i64 b = -1;
+  for (int r = 0; r < reps; ++r) {
+    i64 t0 = micros();
+    f();
+    i64 dt = micros() - t0;
+    if (b < 0 || dt < b)
+      b = dt;
+  }
+  return b > 0 ? b : 1;
+}
+
+static Array<f32> matrix(usz m, usz n) {
+  Array<f32> a;
+  a.allocate(m * n);
+  f32 *p = a.data();
+  for (usz i = 0; i < m * n; ++i)
+    p[i] = (f32)((i * 7919) % 1000) * 0.001f;
+  usz d[2] = {m, n};
+  a.shape(2, d);
+  return a;
+}
+
+static bool check() {
+  Array<f32> a = matrix(5, 7);
+  ArrayView<f32> v(a);
+  bool ok = v.isContiguous() && v.size() == 35;
+
+  ArrayView<f32> col = v.select(1, 3);
+  ok = ok && col.rank() == 1 && col.size() == 5 && !col.isContiguous();
+  for (usz i = 0; i < 5; ++i)
+    ok = ok && col(i) == a[i * 7 + 3];
+
+  ArrayView<f32> t = v.transpose();
+  Array<f32> tc = t.copy(), tm = Math::transpose(a);
+  ok = ok && tc.dim(0) == 7 && tc.dim(1) == 5;
+  for (usz i = 0; i < 35; ++i)
+    ok = ok && tc[i] == tm[i];
+
+  // Every other row, columns 1..5 reversed by permute of a 3-d reshape.
+  ArrayView<f32> s = v.slice(0, 0, 5, 2).slice(1, 1, 6);
+  ok = ok && s.dim(0) == 3 && s.dim(1) == 5 && s(2, 4) == a[4 * 7 + 5];
+  usz d3[3] = {5, 7, 1};
+  ArrayView<f32> r3 = v.reshape(3, d3);
+  u8 order[3] = {2, 0, 1};
+  ok = ok && r3.rank() == 3 && r3.permute(3, order).dim(0) == 1 &&
+       s.reshape(3, d3).rank() == 0; // not contiguous
+
+  // Row vector broadcast over the matrix, written into a transposed view.
+  Array<f32> row = matrix(1, 7);
+  usz d2[2] = {5, 7};
+  ArrayView<f32> rb = ArrayView<f32>(row).select(0, 0).broadcast(2, d2);
+  Array<f32> sum = v + rb;
+  Array<f32> out = matrix(7, 5);
+  evalInto(ArrayView<f32>(out).transpose(), v + rb);
+  for (usz i = 0; i < 5; ++i)
+    for (usz j = 0; j < 7; ++j) {
+      f32 want = a[i * 7 + j] + row[j];
+      ok = ok && sum[i * 7 + j] == want && out[j * 5 + i] == want;
+    }
+
+  // Axis reductions agree with the Array versions, including on a transpose.
+  Array<f32> s0 = Math::sum(v, 0), s1 = Math::max(t, 0);
+  Array<f32> r0 = Math::sum(a, 0), r1 = Math::max(a, 1);
+  for (usz j = 0; j < 7; ++j)
+    ok = ok && std::fabs(s0[j] - r0[j]) < 1e-5f;
+  for (usz i = 0; i < 5; ++i)
+    ok = ok && s1[i] == r1[i];
+  ok = ok && std::fabs(Math::sum(col) - (a[3] + a[10] + a[17] + a[24] + a[31])) <
+                 1e-5f;
+
+  // Products on transposed / sliced operands match dense copies.
+  Array<f32> b = matrix(40, 30);
+  ArrayView<f32> bt = ArrayView<f32>(b).transpose(); // [30, 40]
+  Array<f32> ab = Math::matmul(bt, ArrayView<f32>(b)),
+             ref = Math::matmul(bt.copy(), b);
+  ok = ok && ab.size() == 900;
+  for (usz i = 0; i < 900; ++i)
+    ok = ok && std::fabs(ab[i] - ref[i]) < 1e-3f;
+  Array<f32> x = matrix(1, 40);
+  Array<f32> y = Math::matvec(bt, ArrayView<f32>(x).select(0, 0)),
+             yr = Math::matvec(bt.copy(), x);
+  ok = ok && y.size() == 30;
+  for (usz i = 0; i < 30; ++i)
+    ok = ok && std::fabs(y[i] - yr[i]) < 1e-3f;
+
+  // Views keep their block alive.
+  ArrayView<f32> kept;
+  {
+    Array<f32> tmp = matrix(3, 3);
+    kept = ArrayView<f32>(tmp).slice(0, 1, 3);
+  }
+  ok = ok && kept.size() == 6 && kept(0, 0) == matrix(3, 3)[3];
+  return ok;
+}
+
+int main() {
+  printf("correctness %s\n\n", check() ? "ok" : "FAILED");
+
+  const usz n = 2048;
+  Array<f32> a = matrix(n, n), b = matrix(n, n);
+  ArrayView<f32> v(a);
+
+  // --- View creation ---
+  {
+    const usz reps = 1000000;
+    usz acc = 0;
+    i64 t0 = micros();
+    for (usz i = 0; i < reps; ++i)
+      acc += (usz)v.slice(0, i & 1023, 2048, 2).transpose().data();
+    i64 dt = micros() - t0;
+    usz d2[2] = {n, n};
+    ArrayView<f32> row = v.select(0, 7);
+    i64 t1 = micros();
+    for (usz i = 0; i < reps; ++i)
+      acc += (usz)row.broadcast(2, d2).select(1, i & 1023).data();
+    i64 dt1 = micros() - t1;
+    printf("view creation: slice+transpose %.1f ns, broadcast+select %.1f ns "
+           "(%zu)\n\n",
+           (f64)dt * 1e3 / reps, (f64)dt1 * 1e3 / reps, (size_t)(acc & 1));
+  }
+
+  printf("%-34s %12s %12s\n", "", "copy first", "in place");
+
+  // Column sum.
+  {
+    ArrayView<f32> col = v.select(1, 5);
+    f32 s1 = 0, s2 = 0;
+    i64 tc = best(20, [&]() { s1 = Math::sum(col.copy()); });
+    i64 tv = best(20, [&]() { s2 = Math::sum(col); });
+    // Summation order differs, so compare relative to the sum.
+    bool same = std::fabs(s1 - s2) <= 1e-4f * std::fabs(s1);
+    printf("%-34s %9lld us %9lld us %s\n", "sum of one column (2048)",
+           (long long)tc, (long long)tv, same ? "" : "MISMATCH");
+  }
+
+  // Element-wise over a transpose.
+  {
+    ArrayView<f32> t = v.transpose();
+    Array<f32> r1, r2;
+    i64 tc = best(3, [&]() { r1 = Math::exp(Math::transpose(a) * 0.5f); });
+    i64 tv = best(3, [&]() { r2 = Math::exp(t * 0.5f); });
+    printf("%-34s %9lld us %9lld us %s\n", "exp(transpose(a) * 0.5), 2048^2",
+           (long long)tc, (long long)tv,
+           Math::sum(r1 - r2) == 0 ? "" : "MISMATCH");
+  }
+
+  // Broadcast add of a row.
+  {
+    usz d2[2] = {n, n};
+    ArrayView<f32> rb = v.select(0, 3).broadcast(2, d2);
+    Array<f32> r1, r2;
+    i64 tc = best(3, [&]() { r1 = a + rb.copy(); });
+    i64 tv = best(3, [&]() { r2 = a + rb; });
+    printf("%-34s %9lld us %9lld us %s\n", "a + broadcast(row), 2048^2",
+           (long long)tc, (long long)tv,
+           Math::sum(r1 - r2) == 0 ? "" : "MISMATCH");
+  }
+
+  // Reduction along the strided axis.
+  {
+    ArrayView<f32> t = v.transpose();
+    Array<f32> r1, r2;
+    i64 tc = best(3, [&]() { r1 = Math::sum(t.copy(), 1); });
+    i64 tv = best(3, [&]() { r2 = Math::sum(t, 1); });
+    // Summation order differs, so compare relative to the row sums.
+    bool same = r1.size() == r2.size();
+    for (usz i = 0; same && i < r1.size(); ++i)
+      same = std::fabs(r1[i] - r2[i]) <= 1e-4f * std::fabs(r1[i]);
+    printf("%-34s %9lld us %9lld us %s\n", "sum(transpose(a), axis 1), 2048^2",
+           (long long)tc, (long long)tv, same ? "" : "MISMATCH");
+  }
+
+  // Product with a transposed operand.
+  {
+    const usz m = 1024;
+    Array<f32> p = matrix(m, m), q = matrix(m, m);
+    ArrayView<f32> qt = ArrayView<f32>(q).transpose();
+    Array<f32> r1, r2;
+    i64 tc = best(2, [&]() { r1 = Math::matmul(p, Math::transpose(q)); });
+    i64 tv = best(2, [&]() { r2 = Math::matmul(ArrayView<f32>(p), qt); });
+    f32 diff = Math::sum(Math::abs(r1 - r2));
+    printf("%-34s %9lld us %9lld us %s\n", "matmul(p, transpose(q)), 1024^2",
+           (long long)tc, (long long)tv, diff < 1.0f ? "" : "MISMATCH");
+  }
+  return 0;
+}
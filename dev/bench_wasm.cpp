@@ -0,0 +1,82 @@
+// Driver for dev/bench_wasm.mjs, linked once per WebAssembly variant:
+// Tunnel-style AEAD sealing, BLAKE2b hashing, Regex scanning, the f32
+// transcendentals and a WorkerPool fan-out of them. Prints one
+// "name value unit" line per measurement for the Node script to tabulate.
+// Also builds natively for a reference row:
+// g++ -O2 -std=c++17 -Iinclude dev/bench_wasm.cpp -L_gate_build -lXi -pthread
+// (configure the library with -DCMAKE_BUILD_TYPE=Release for real numbers)
+
+#include "Xi/Crypto.hpp"
+#include "Xi/Math.hpp"
+#include "Xi/Regex.hpp"
+#include "Xi/Worker.hpp"
+#include <cstdio>
+
+using namespace Xi;
+
+// Best of five; run() does `bytes` of work per call.
+template <typename Run> static f64 rate(usz bytes, Run run) {
+  f64 best = 0;
+  for (int rep = 0; rep < 5; ++rep) {
+    int calls = 0;
+    i64 t0 = micros(), t = t0;
+    while (t - t0 < 200000) {
+      run();
+      ++calls;
+      t = micros();
+    }
+    f64 r = (f64)bytes * calls / ((t - t0) * 1e-6);
+    best = r > best ? r : best;
+  }
+  return best;
+}
+
+int main() {
+  printf("isa %s\n", Math::Simd::isa());
+  printf("threads %u\n", (unsigned)WorkerPool::shared().size() + 1);
+
+  const usz Packet = 64 * 1024;
+  String key(zeros(32)), text;
+  for (usz i = 0; i < Packet; ++i)
+    text.push((u8)(i * 131));
+
+  u64 nonce = 0;
+  printf("aead %.1f MB/s\n", rate(Packet, [&] {
+           AEADOptions o;
+           o.text = text;
+           aeadSeal(key, ++nonce, o);
+         }) / 1e6);
+  printf("blake2b %.1f MB/s\n",
+         rate(Packet, [&] { hash(text, 32); }) / 1e6);
+
+  String log;
+  const char *line = "GET /api/v1/items?id=42 HTTP/1.1 200 1532 user=alice\n";
+  while (log.size() < 256 * 1024)
+    log += line;
+  Regex re("user=[a-z]+");
+  printf("regex %.1f MB/s\n",
+         rate(log.size(), [&] { re.matchAll(log); }) / 1e6);
+
+  const usz N = 1 << 16;
+  static f32 x[N], y[N];
+  for (usz i = 0; i < N; ++i)
+    x[i] = (f32)i / N * 8 - 4;
+  printf("exp %.1f Melem/s\n",
+         rate(N, [&] { Math::Simd::exp(x, y, N); }) / 1e6);
+
+  // The same exp work split over the shared pool; one thread without it.
+  const usz Big = 1 << 20;
+  static f32 bx[Big], by[Big];
+  for (usz i = 0; i < Big; ++i)
+    bx[i] = (f32)(i % 1000) / 125 - 4;
+  printf("exp-parallel %.1f Melem/s\n", rate(Big, [&] {
+           WorkerPool::shared().parallelFor(
+               Big / 4096,
+               [&](usz b, usz e) {
+                 Math::Simd::exp(bx + b * 4096, by + b * 4096,
+                                 (e - b) * 4096);
+               },
+               4);
+         }) / 1e6);
+  return 0;
+}
@@ -0,0 +1,81 @@
+// Compares the WebAssembly builds from `node src/build.js wasm` under Node:
+// links dev/bench_wasm.cpp against each variant's libXi.a with that
+// variant's flags, runs it and tabulates the rates side by side, next to
+// the variant the dist/js/xi.js loader would pick on this host.
+// node dev/bench_wasm.mjs [--variant=simd,base] [--profile=speed]
+
+import { execSync } from "child_process";
+import fs from "fs";
+import os from "os";
+import path from "path";
+import { pathToFileURL } from "url";
+import { wasmProfiles, wasmVariants } from "../src/build.js";
+
+const args = process.argv.slice(2);
+const option = (name) => {
+  const arg = args.find((a) => a.startsWith(`--${name}=`));
+  return arg ? arg.slice(name.length + 3).split(",") : null;
+};
+
+const outDir = path.join(os.tmpdir(), "xi-bench-wasm");
+fs.mkdirSync(outDir, { recursive: true });
+
+async function runVariant(variant, profile) {
+  const tag = `${variant.name}${profile.suffix}`;
+  const lib = path.join("dist/bin/wasm", tag, "libXi.a");
+  if (!fs.existsSync(lib)) return null;
+  const out = path.join(outDir, `${tag}.mjs`);
+  execSync(
+    `emcc ${profile.opt} ${variant.cflags} -std=c++17 -Iinclude -Ipackages/monocypher ` +
+      `dev/bench_wasm.cpp ${lib} ${variant.ldflags} ` +
+      `-sMODULARIZE -sEXPORT_ES6 -sALLOW_MEMORY_GROWTH -sEXIT_RUNTIME -o ${out}`,
+    { stdio: "inherit" },
+  );
+  const lines = [];
+  const { default: factory } = await import(pathToFileURL(out).href);
+  await factory({ print: (l) => lines.push(l), printErr: () => {} });
+  const row = {};
+  for (const l of lines) {
+    const [name, value] = l.split(" ");
+    row[name] = value;
+  }
+  const wasm = out.replace(/\.mjs$/, ".wasm");
+  row.size = `${(fs.statSync(wasm).size / 1024).toFixed(0)}K`;
+  return row;
+}
+
+async function main() {
+  const onlyVariants = option("variant");
+  const onlyProfiles = option("profile");
+  const rows = [];
+  for (const profile of wasmProfiles) {
+    if (onlyProfiles && !onlyProfiles.includes(profile.name)) continue;
+    for (const variant of wasmVariants) {
+      if (onlyVariants && !onlyVariants.includes(variant.name)) continue;
+      const row = await runVariant(variant, profile);
+      if (row) rows.push([`${variant.name}${profile.suffix}`, row]);
+    }
+  }
+  if (!rows.length) {
+    console.log("no dist/bin/wasm/*/libXi.a: run `node src/build.js wasm` first");
+    return;
+  }
+
+  const cols = ["isa", "threads", "aead", "blake2b", "regex", "exp",
+    "exp-parallel", "size"];
+  const units = ["", "", "MB/s", "MB/s", "MB/s", "Melem/s", "Melem/s", "wasm"];
+  const pad = (s, n) => String(s ?? "-").padStart(n);
+  console.log("variant".padEnd(14) + cols.map((c) => pad(c, 13)).join(""));
+  console.log("".padEnd(14) + units.map((u) => pad(u, 13)).join(""));
+  for (const [tag, row] of rows)
+    console.log(tag.padEnd(14) + cols.map((c) => pad(row[c], 13)).join(""));
+
+  const loader = path.resolve("dist/js/xi.js");
+  if (fs.existsSync(loader)) {
+    const { features, pick } = await import(pathToFileURL(loader).href);
+    console.log(`\nhost features ${JSON.stringify(features)}, ` +
+      `dist/js/xi.js loads ${pick()?.file ?? "nothing"}`);
+  }
+}
+
+main();
@@ -0,0 +1,104 @@
+#ifndef XI_HARDWARE_FUSION_HPP
+#define XI_HARDWARE_FUSION_HPP
+
+#include "../Xi/InlineArray.hpp"
+#include "../Xi/Math.hpp"
+#include "GPS.hpp"
+#include "MPU.hpp"
+
+namespace Xi {
+
+enum class FusionPath : u8 {
+    Scalar, ///< One filter after another, f32
+    Vector, ///< All sensors in lockstep, one SIMD lane each, f32
+    Fixed   ///< Q30 integer filter, for cores without an FPU
+};
+
+// -------------------------------------------------------------------------
+// SensorFusion — Mahony filter bank over timestamped sample batches
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Runs one Mahony attitude filter per IMU over every sample in a
+ * batch (integrating with the sample timestamps, not the call rate) and
+ * fuses the healthy filters into one orientation.
+ *
+ * A sample is rejected when its readings are out of range, non-finite or
+ * repeat the previous sample exactly (a stuck bus). A sensor is left out
+ * of the fused result while its newest accepted sample is older than
+ * staleNS, and, with three or more sensors, while its orientation
+ * disagrees with the others by more than maxDisagree. A sensor that comes
+ * back restarts from the fused orientation.
+ *
+ * @code
+ *   const ImuSample *batches[2] = {a.data(), b.data()};
+ *   usz counts[2] = {a.size(), b.size()};
+ *   fusion.process(batches, counts, 2);
+ *   Vector3 rpy = fusion.euler();
+ * @endcode
+ */
+class SensorFusion {
+public:
+    static constexpr usz MaxSensors = 8; ///< Sensors past this are ignored
+
+    FusionPath path = FusionPath::Vector;
+    f32 kp = 2.0f, ki = 0.005f;
+    f32 maxAccel = 16.0f;   ///< g; larger readings are rejected
+    f32 maxGyro = 2000.0f;  ///< deg/s
+    f32 maxDisagree = 0.2f; ///< rad
+    u64 staleNS = 100000000ULL;
+
+    // Fused state, valid after process()
+    f32 q[4] = {1, 0, 0, 0}; ///< Body to earth (w, x, y, z)
+    u64 time = 0;            ///< Newest sample timestamp
+    ImuSample latest;        ///< Newest accepted sample of a healthy sensor
+    u64 processed = 0, rejected = 0;
+
+    // Newest GPS fix, and the receiver's UTC minus the local clock
+    GpsSample fix;
+    bool hasFix = false;
+    i64 clockOffsetNS = 0;
+    bool hasClockOffset = false;
+
+    SensorFusion() { reset(); }
+    void reset();
+
+    /// Feeds one batch per sensor, each in time order. Sensor i keeps its
+    /// filter across calls, so pass the sensors in the same order.
+    void process(const ImuSample *const *batches, const usz *counts,
+                 usz sensors);
+    void processGps(const GpsSample *samples, usz count);
+
+    bool healthy(usz sensor) const;
+    /// One sensor's own orientation (w, x, y, z).
+    const f32 *sensorQuaternion(usz sensor, f32 out[4]) const;
+
+    Vector3 euler() const; ///< Roll, pitch, yaw in radians
+    Vector3 down() const;  ///< Gravity direction in the body frame
+
+private:
+    // Filter state, one lane per sensor
+    f32 _q[4][MaxSensors];
+    f32 _e[3][MaxSensors];
+    u64 _last[MaxSensors];      // timestamp of the last integrated sample
+    u64 _lastValid[MaxSensors];
+    u32 _repeats[MaxSensors];
+    bool _init[MaxSensors];
+    ImuSample _prev[MaxSensors];
+    InlineArray<u8> _ok[MaxSensors]; // per sample of the current batch
+    u32 _outliers = 0;
+    usz _sensors = 0;
+    bool _fused = false;
+
+    usz _screen(usz lane, const ImuSample *s, usz n);
+    void _scalar(usz lane, const ImuSample *s, usz n);
+    void _fixed(usz lane, const ImuSample *s, usz n);
+    void _vector(const ImuSample *const *batches, const usz *counts,
+                 usz lanes);
+    bool _usable(usz lane) const;
+    void _consensus();
+};
+
+} // namespace Xi
+
+#endif
@@ -2,7 +2,10 @@
 #define XI_HARDWARE_GPS_HPP
 
 #include "../Xi/Device.hpp"
+#include "../Xi/Func.hpp"
+#include "../Xi/InlineArray.hpp"
 #include "../Xi/Spatial.hpp"
+#include "GPSParser.hpp"
 
 #if defined(ARDUINO)
 #include <Arduino.h>
@@ -10,25 +13,54 @@
 
 namespace Xi {
 
+struct GpsSample {
+    u64 t = 0;   // nanoseconds, HardwareSpatial clock
+    u64 utc = 0; // nanoseconds since epoch from the receiver, 0 if unknown
+    GeoPos pos = {0, 0, 0};
+    bool fix = false;
+};
+
 class GPSDevice : public Device, public GeodeticSphere {
 public:
     GeoPos pos = {0, 0, 0};
     u64 lastTimeSync = 0; // Nanoseconds epoch
     bool hasFix = false;
 
+    /// Fixes not yet fused, oldest first (see MPUDevice::samples).
+    InlineArray<GpsSample> samples;
+
 #if defined(ARDUINO)
     Stream *port = nullptr;
 #endif
 
+    /// NMEA and UBX decoder; `parser.fix` keeps the full-precision state.
+    GPSParser parser;
+
+    /// Nanosecond clock GpsSample::t is read from; micros() when unset.
+    /// HardwareSpatial hands its own `clock` to devices without one, so
+    /// fusion compares fix and IMU times on the same base.
+    Func<u64()> sampleClock;
+
+    GPSDevice();
+    GPSDevice(const GPSDevice &) = delete;
+    GPSDevice &operator=(const GPSDevice &) = delete;
+
     void update() override;
     void onPPS();
 
+    /// Feeds raw receiver bytes, in chunks of any size. update() does this
+    /// from `port`; elsewhere (e.g. a recorded log on Linux) call it
+    /// directly. Every position epoch in the chunk is queued in `samples`,
+    /// stamped `t` (default: sampleClock now).
+    void feed(const u8 *data, usz n);
+    void feed(const u8 *data, usz n, u64 t);
+
 private:
-    char gpsBuf[90] = {};
-    int gpsIdx = 0;
     u64 lastPPS = 0;
+    u64 feedTime = 0; // stamp for the epochs of the chunk being fed
 
-    void parseNMEA(const char *buf);
+    u64 now() const;
+    void queue(const GPSFix &f);
 };
 
 } // namespace Xi
@@ -0,0 +1,112 @@
+#ifndef XI_HARDWARE_GPS_PARSER_HPP
+#define XI_HARDWARE_GPS_PARSER_HPP
+
+#include "../Xi/Func.hpp"
+#include "../Xi/Primitives.hpp"
+
+namespace Xi {
+
+struct GeoPos;
+
+/// Receiver state in integer fixed point, as UBX reports it.
+struct GPSFix {
+    i32 lat = 0, lng = 0; ///< 1e-7 degrees
+    i32 alt = 0;          ///< mm above mean sea level
+    i32 speed = 0;        ///< mm/s over ground
+    i32 course = 0;       ///< 1e-5 degrees
+    u32 timeMs = 0;       ///< UTC time of day
+    u32 date = 0;         ///< UTC days since 1970-01-01, 0 if unknown
+    u16 hdop = 0;         ///< x100
+    u8 quality = 0;       ///< GGA: 0 none, 1 GNSS, 2 DGNSS, 4/5 RTK, 6 DR
+    u8 mode = 0;          ///< 1 no fix, 2 2D, 3 3D
+    u8 satellites = 0;    ///< Used in the solution
+    u8 inView = 0;        ///< Tracked, summed over constellations (GSV)
+    bool valid = false;
+
+    u64 utcNS() const; ///< 0 until a date has been seen
+    GeoPos pos() const;
+};
+
+// -------------------------------------------------------------------------
+// GPSParser — Incremental NMEA 0183 / UBX parser
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Parses a receiver byte stream in chunks of any size, one byte at
+ * a time, without buffering NMEA sentences: each field is accumulated
+ * into an integer as it arrives and stored once the field ends.
+ *
+ * NMEA: GGA, RMC, GLL, VTG, GSA and GSV from any talker (GP, GL, GA, GB,
+ * GN, ...). Sentences without a valid checksum change nothing. UBX:
+ * NAV-PVT and NAV-POSLLH, Fletcher checksum checked; other messages are
+ * counted and skipped. Both protocols can be interleaved.
+ *
+ * @code
+ *   GPSParser p;
+ *   p.onPosition = [](const GPSFix &f) { use(f); };
+ *   p.feed(bytes, n);
+ * @endcode
+ *
+ * A chunk can hold several epochs; `positions` only tells that some
+ * arrived, onPosition sees each of them.
+ */
+class GPSParser {
+public:
+    struct Stats {
+        u64 nmea = 0;     ///< Sentences with a valid checksum
+        u64 ubx = 0;      ///< UBX messages with a valid checksum
+        u64 bad = 0;      ///< Checksum mismatches and malformed frames
+        u64 overflow = 0; ///< Sentences longer than NMEA allows
+        u64 ignored = 0;  ///< Valid but not decoded (proprietary etc.)
+    };
+
+    GPSFix fix;
+    Stats stats;
+    u32 positions = 0; ///< Bumped once per new position epoch
+    /// Called with `fix` once per new position epoch, from inside feed().
+    Func<void(const GPSFix &)> onPosition;
+
+    void reset();
+    /// Returns the number of messages that passed their checksum.
+    usz feed(const u8 *data, usz n);
+
+private:
+    enum State : u8 {
+        Idle, Nmea, NmeaCk1, NmeaCk2,
+        UbxSync, UbxClass, UbxId, UbxLen1, UbxLen2, UbxPayload, UbxCkA,
+        UbxCkB
+    };
+
+    // Current NMEA field
+    struct Field {
+        i64 mant = 0;
+        i8 frac = -1;     // digits after the '.', -1 before it
+        bool digits = false, neg = false;
+        char ch = 0;      // first non-numeric character
+    };
+
+    State _state = Idle;
+    u8 _sum = 0, _ck = 0;  // running XOR, received checksum
+    u16 _length = 0;
+    u8 _field = 0;
+    u16 _talker = 0;      // address, packed: "GP" + "GGA"
+    u32 _type = 0;
+    Field _f;
+    GPSFix _p;            // fix as this sentence would leave it
+    u32 _lastEpoch = ~0u;
+    u8 _view[8] = {};     // GSV satellites in view per talker
+
+    u8 _cls = 0, _id = 0, _ckA = 0, _ckB = 0;
+    u16 _ubxLen = 0, _ubxAt = 0;
+    u8 _payload[100];
+
+    bool _byte(u8 c);
+    void _endField();
+    void _commitNmea();
+    void _commitUbx();
+    void _position(u32 epoch);
+};
+
+} // namespace Xi
+
+#endif
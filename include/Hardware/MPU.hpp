@@ -2,10 +2,19 @@
 #define XI_HARDWARE_MPU_HPP
 
 #include "../Xi/Device.hpp"
+#include "../Xi/InlineArray.hpp"
 #include "../Xi/Math.hpp"
 
 namespace Xi {
 
+/// One timestamped reading, in the MPUDevice units (g, deg/s, uT).
+struct ImuSample {
+    u64 t = 0; // nanoseconds, HardwareSpatial clock
+    Vector3 accel = {0, 0, 0};
+    Vector3 gyro = {0, 0, 0};
+    Vector3 mag = {0, 0, 0};
+};
+
 class MPUDevice : public Device {
 public:
     Vector3 accel;
@@ -13,6 +22,12 @@ public:
     Vector3 mag;
     f32 temp;
 
+    /// Readings not yet fused, oldest first. Drivers that drain a FIFO
+    /// push every sample here; HardwareSpatial clears it after fusing.
+    /// When it is empty, the fields above are fused as one sample if they
+    /// changed since the last fusion.
+    InlineArray<ImuSample> samples;
+
     virtual void update() override = 0;
 };
 
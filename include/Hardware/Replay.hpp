@@ -0,0 +1,112 @@
+#ifndef XI_HARDWARE_REPLAY_HPP
+#define XI_HARDWARE_REPLAY_HPP
+
+#include "../Xi/String.hpp"
+#include "GPS.hpp"
+#include "MPU.hpp"
+#include "Spatial.hpp"
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// SensorRecording — Timestamped samples as a text file
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Per-sensor sample streams, saved as one sample per line:
+ *
+ *   imu <sensor> <t> <ax> <ay> <az> <gx> <gy> <gz> <mx> <my> <mz>
+ *   gps <sensor> <t> <utc> <lat> <lng> <alt> <fix>
+ *
+ * Times are nanoseconds; units are those of ImuSample and GpsSample.
+ * Empty lines and lines starting with '#' are skipped.
+ */
+class SensorRecording {
+public:
+    InlineArray<InlineArray<ImuSample>> imu; // per sensor, in time order
+    InlineArray<InlineArray<GpsSample>> gps;
+
+    void clear();
+    void add(usz sensor, const ImuSample &s);
+    void add(usz sensor, const GpsSample &s);
+
+    /// Replaces the contents; false (and empty) on a malformed line.
+    bool parse(const String &text);
+    String serialize() const;
+
+    bool load(const String &path);
+    bool save(const String &path) const;
+
+    u64 begin() const; ///< Earliest timestamp, 0 when empty
+    u64 end() const;   ///< Latest timestamp
+    usz samples() const;
+};
+
+// -------------------------------------------------------------------------
+// ReplayMPU / ReplayGPS — Devices that play a recorded stream
+// -------------------------------------------------------------------------
+
+/// Each update() queues the samples stamped at or before `clock` and
+/// shows the newest in accel/gyro/mag, as a FIFO-draining driver would.
+class ReplayMPU : public MPUDevice {
+public:
+    InlineArray<ImuSample> stream;
+    usz cursor = 0;
+    u64 clock = 0;
+
+    void update() override;
+    bool done() const { return cursor >= stream.size(); }
+};
+
+class ReplayGPS : public GPSDevice {
+public:
+    InlineArray<GpsSample> stream;
+    usz cursor = 0;
+    u64 clock = 0;
+
+    void update() override;
+    bool done() const { return cursor >= stream.size(); }
+};
+
+// -------------------------------------------------------------------------
+// SensorReplay — A recording played through HardwareSpatial
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Owns one replay device per recorded sensor and a clock that
+ * advances through the recording.
+ *
+ * @code
+ *   SensorReplay replay;
+ *   replay.recording.load("flight.rec");
+ *   replay.attach(space);           // adds the devices, drives space.clock
+ *   while (replay.advance(10000000)) space.update();  // 100 Hz
+ * @endcode
+ */
+class SensorReplay {
+public:
+    SensorRecording recording;
+    InlineArray<ReplayMPU *> mpu;
+    InlineArray<ReplayGPS *> gps;
+    u64 now = 0;
+
+    SensorReplay() = default;
+    SensorReplay(const SensorReplay &) = delete;
+    SensorReplay &operator=(const SensorReplay &) = delete;
+    ~SensorReplay();
+
+    /// (Re)creates the devices from the recording and rewinds to its start.
+    void rewind();
+    /// Moves the clock forward; false once every stream has been played.
+    bool advance(u64 ns);
+    /// Rewinds, registers the devices with `space` and sets its clock.
+    /// `space` keeps pointers to both, so the replay must outlive its use.
+    void attach(HardwareSpatial &space);
+
+private:
+    void _release();
+};
+
+} // namespace Xi
+
+#endif
@@ -3,9 +3,12 @@
 
 #include "../Xi/Spatial.hpp"
 #include "../Xi/Array.hpp"
+#include "../Xi/Func.hpp"
+#include "../Xi/Scheduler.hpp"
 #include "MPU.hpp"
 #include "GPS.hpp"
 #include "DHT.hpp"
+#include "Fusion.hpp"
 
 namespace Xi {
 
@@ -17,20 +20,34 @@ public:
     Array<GPSDevice*> gps;
     Array<DHTDevice*> dht;
 
+    /// When false, update() only fuses; the sensors are updated elsewhere.
+    bool updateSensors = true;
+
+    /// Fuses every MPU sample batch and GPS fix; configure it (path,
+    /// gains, health limits) before the first update().
+    SensorFusion fusion;
+
+    /// Nanosecond clock used instead of the system one when set, e.g. a
+    /// SensorReplay's, so recorded data runs at its recorded times.
+    Func<u64()> clock;
+
     void update() override;
 
+    /// Registers every sensor plus a fusion node that runs after them.
+    /// Returns the fusion node id.
+    usz schedule(DeviceScheduler &scheduler, f64 hz = 0);
+
 private:
     HardwareSpatial();
 
-    // Fusion state
-    float q0, q1, q2, q3;
-    float eInt[3] = {0, 0, 0};
-    
     u64 timeOffsetNS = 0;
+    InlineArray<const ImuSample *> batches;
+    InlineArray<usz> counts;
+    InlineArray<ImuSample> snapshots; // last register reading per FIFO-less MPU
 
     u64 getSystemTimeNS();
     void syncTime(u64 nowSys);
-    void fuseSensors(float dt);
+    void fuseSensors(u64 now);
 };
 
 static HardwareSpatial &space = HardwareSpatial::getInstance();
@@ -0,0 +1,261 @@
+#ifndef RHO_ASYNC_HPP
+#define RHO_ASYNC_HPP
+
+#include "../Xi/Task.hpp"
+#include "Railway.hpp"
+#include "Tunnel.hpp"
+
+#ifdef XI_HAS_COROUTINES
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// AsyncTunnel — Awaitable view over a Tunnel's listeners
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Turns Tunnel callbacks into awaitables.
+ *
+ * Installs itself as the tunnel's packet and ready listener. Packets go to the
+ * oldest matching waiter first; unclaimed packets fall through to a packet
+ * listener that was set before, or are queued in `pending`. Waiters are
+ * intrusive nodes living in the awaiting coroutine's frame and are resumed
+ * through the EventLoop, never from inside Tunnel::parse(). The listeners
+ * that were set before are put back when the AsyncTunnel is destroyed.
+ *
+ * @code
+ *   Task<> session(EventLoop &loop, AsyncTunnel &t) {
+ *     co_await t.ready();
+ *     Packet p = co_await t.nextPacket(7);
+ *   }
+ * @endcode
+ */
+class XI_EXPORT AsyncTunnel {
+public:
+  static constexpr u64 AnyChannel = ~0ULL;
+
+  struct PacketWaiter {
+    AsyncTunnel *owner;
+    u64 channel;
+    Packet packet;
+    PacketWaiter *next = nullptr;
+    ScheduleNode node;
+
+    bool await_ready() { return owner->takePending(channel, packet); }
+    void await_suspend(std::coroutine_handle<> h) {
+      node.handle = h;
+      owner->append(owner->packetWaiters, this);
+    }
+    Packet await_resume() { return Xi::Move(packet); }
+  };
+
+  struct ReadyWaiter {
+    AsyncTunnel *owner;
+    ReadyWaiter *next = nullptr;
+    ScheduleNode node;
+
+    bool await_ready() const { return owner->tunnel->switchReady; }
+    void await_suspend(std::coroutine_handle<> h) {
+      node.handle = h;
+      owner->append(owner->readyWaiters, this);
+    }
+    void await_resume() const noexcept {}
+  };
+
+  Tunnel *tunnel;
+  EventLoop *loop;
+
+  /// Packets that arrived while nobody was waiting for their channel.
+  Array<Packet> pending;
+
+  AsyncTunnel(Tunnel &t, EventLoop &l) : tunnel(&t), loop(&l) {
+    prevPacket = Xi::Move(t.packetListener);
+    t.onPacket([this](Packet p) {
+      if (deliver(p))
+        return;
+      if (prevPacket.isValid())
+        prevPacket(p);
+      else
+        pending.push(p);
+    });
+    prevReady = Xi::Move(t.readyListener);
+    t.onReady([this]() {
+      wakeReady();
+      if (prevReady.isValid())
+        prevReady();
+    });
+  }
+
+  ~AsyncTunnel() {
+    tunnel->onPacket(Xi::Move(prevPacket));
+    tunnel->onReady(Xi::Move(prevReady));
+  }
+
+  AsyncTunnel(const AsyncTunnel &) = delete;
+  AsyncTunnel &operator=(const AsyncTunnel &) = delete;
+
+  /// Resumes with the next packet on `channel` (or any data channel).
+  PacketWaiter nextPacket(u64 channel = AnyChannel) {
+    return PacketWaiter{this, channel, Packet(), nullptr, {}};
+  }
+
+  /// Resumes once the tunnel reports switchReady.
+  ReadyWaiter ready() { return ReadyWaiter{this, nullptr, {}}; }
+
+private:
+  PacketWaiter *packetWaiters = nullptr;
+  ReadyWaiter *readyWaiters = nullptr;
+  PacketListener prevPacket; ///< Chained to, restored on destruction
+  VoidListener prevReady;
+
+  template <typename W> static void append(W *&list, W *w) {
+    W **at = &list;
+    while (*at)
+      at = &(*at)->next;
+    w->next = nullptr;
+    *at = w;
+  }
+
+  bool takePending(u64 channel, Packet &out) {
+    for (usz i = 0; i < pending.size(); ++i) {
+      if (channel == AnyChannel || pending[i].channel == channel) {
+        out = pending[i];
+        pending.splice(i, 1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool deliver(const Packet &p) {
+    PacketWaiter **at = &packetWaiters;
+    while (*at) {
+      PacketWaiter *w = *at;
+      if (w->channel == AnyChannel || w->channel == p.channel) {
+        *at = w->next;
+        w->packet = p;
+        loop->schedule(&w->node);
+        return true;
+      }
+      at = &w->next;
+    }
+    return false;
+  }
+
+  void wakeReady() {
+    ReadyWaiter *w = readyWaiters;
+    readyWaiters = nullptr;
+    while (w) {
+      ReadyWaiter *next = w->next;
+      loop->schedule(&w->node);
+      w = next;
+    }
+  }
+};
+
+// -------------------------------------------------------------------------
+// AsyncStation — Awaitable view over RailwayStation carts
+// -------------------------------------------------------------------------
+
+struct Cart {
+  Xi::String data;
+  u64 rail = 0;
+  RailwayStation *origin = nullptr;
+};
+
+/**
+ * @brief Turns RailwayStation::onCart into an awaitable "next cart" source.
+ *
+ * Like AsyncTunnel, carts no waiter claims go to the cart listener that was
+ * set before (the forwarding one RailwayStation::addStation installs, for
+ * instance) or into `pending`, and that listener is restored on destruction.
+ */
+class XI_EXPORT AsyncStation {
+public:
+  static constexpr u64 AnyRail = ~0ULL;
+
+  struct CartWaiter {
+    AsyncStation *owner;
+    u64 rail;
+    Cart cart;
+    CartWaiter *next = nullptr;
+    ScheduleNode node;
+
+    bool await_ready() { return owner->takePending(rail, cart); }
+    void await_suspend(std::coroutine_handle<> h) {
+      node.handle = h;
+      CartWaiter **at = &owner->waiters;
+      while (*at)
+        at = &(*at)->next;
+      next = nullptr;
+      *at = this;
+    }
+    Cart await_resume() { return Xi::Move(cart); }
+  };
+
+  RailwayStation *station;
+  EventLoop *loop;
+  Array<Cart> pending;
+
+  AsyncStation(RailwayStation &s, EventLoop &l) : station(&s), loop(&l) {
+    prevCart = Xi::Move(s.cartListener);
+    s.onCart([this](Xi::String data, u64 rail, RailwayStation *origin) {
+      Cart c;
+      c.data = Xi::Move(data);
+      c.rail = rail;
+      c.origin = origin;
+      if (deliver(c))
+        return;
+      if (prevCart.isValid())
+        prevCart(c.data, c.rail, c.origin);
+      else
+        pending.push(c);
+    });
+  }
+
+  ~AsyncStation() { station->onCart(Xi::Move(prevCart)); }
+
+  AsyncStation(const AsyncStation &) = delete;
+  AsyncStation &operator=(const AsyncStation &) = delete;
+
+  /// Resumes with the next cart accepted on `rail` (or on any rail).
+  CartWaiter nextCart(u64 rail = AnyRail) {
+    return CartWaiter{this, rail, Cart(), nullptr, {}};
+  }
+
+private:
+  CartWaiter *waiters = nullptr;
+  Xi::Func<void(Xi::String, u64, RailwayStation *)> prevCart;
+
+  bool takePending(u64 rail, Cart &out) {
+    for (usz i = 0; i < pending.size(); ++i) {
+      if (rail == AnyRail || pending[i].rail == rail) {
+        out = pending[i];
+        pending.splice(i, 1);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool deliver(const Cart &c) {
+    CartWaiter **at = &waiters;
+    while (*at) {
+      CartWaiter *w = *at;
+      if (w->rail == AnyRail || w->rail == c.rail) {
+        *at = w->next;
+        w->cart = c;
+        loop->schedule(&w->node);
+        return true;
+      }
+      at = &w->next;
+    }
+    return false;
+  }
+};
+
+} // namespace Xi
+
+#endif // XI_HAS_COROUTINES
+
+#endif // RHO_ASYNC_HPP
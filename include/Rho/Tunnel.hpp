@@ -5,6 +5,7 @@
 #include "../Xi/Crypto.hpp"
 #include "../Xi/Func.hpp"
 #include "../Xi/Map.hpp"
+#include "../Xi/Perf.hpp"
 #include "../Xi/String.hpp"
 
 namespace Xi {
@@ -372,6 +373,7 @@ public:
     }
   }
   void parse(const Xi::String &bundle) {
+    XI_PERF_REGION("Tunnel::parse");
     if (isAsleep)
       isAsleep = false;
     usz at = 0;
@@ -690,6 +692,7 @@ public:
   }
 
   Xi::String flush(usz bBS = 32, usz bMS = 1400) {
+    XI_PERF_REGION("Tunnel::flush");
 
     if (isAsleep)
       return Xi::String();
@@ -1,6 +1,7 @@
 #ifndef XI_ARRAY_HPP
 #define XI_ARRAY_HPP
 
+#include "ArrayExpr.hpp"
 #include "InlineArray.hpp"
 
 namespace Xi {
@@ -61,6 +62,17 @@ public:
     return *this;
   }
 
+  /// Evaluates an element-wise expression such as `a * 2.0f + b`.
+  template <typename E> Array(const ArrayExpr<E> &expr) : Array() {
+    evalInto(*this, expr);
+  }
+
+  /// Evaluates into this Array, reusing its storage when contiguous.
+  template <typename E> Array &operator=(const ArrayExpr<E> &expr) {
+    evalInto(*this, expr);
+    return *this;
+  }
+
   Array &operator=(Array &&other) noexcept {
     if (this == &other)
       return *this;
@@ -92,6 +104,13 @@ public:
 
   u8 rank() const { return _rank; }
 
+  /// Extent of dimension i. An unshaped Array is rank 1 with dim(0) == size().
+  usz dim(u8 i) const {
+    if (_dims)
+      return i < _rank ? _dims[i] : 1;
+    return i == 0 ? size() : 1;
+  }
+
   // -------------------------------------------------------------------------
   // Management
   // -------------------------------------------------------------------------
@@ -143,9 +162,8 @@ public:
    */
   void set(const T *vals, usz count) {
     allocate(0); // Clear all fragments
-    if (count > 0 && vals) {
-      pushEach(vals, count);
-    }
+    for (usz i = 0; vals && i < count; ++i)
+      push(vals[i]);
   }
 
   bool reserve(usz len) {
@@ -625,42 +643,6 @@ public:
   }
 };
 
-// -------------------------------------------------------------------------
-// Operator Overloads
-// -------------------------------------------------------------------------
-
-#define XI_ARRAY_BIN_OP(op)                                                    \
-  template <typename T>                                                        \
-  Array<T> operator op(const Array<T> &a, const Array<T> &b) {                 \
-    usz n = a.size() < b.size() ? a.size() : b.size();                         \
-    Array<T> res;                                                              \
-    res.allocate(n);                                                           \
-    for (usz i = 0; i < n; ++i)                                                \
-      res[i] = a[i] op b[i];                                                   \
-    return res;                                                                \
-  }                                                                            \
-  template <typename T> Array<T> operator op(const Array<T> &a, const T &b) {  \
-    usz n = a.size();                                                          \
-    Array<T> res;                                                              \
-    res.allocate(n);                                                           \
-    for (usz i = 0; i < n; ++i)                                                \
-      res[i] = a[i] op b;                                                      \
-    return res;                                                                \
-  }                                                                            \
-  template <typename T> Array<T> operator op(const T &a, const Array<T> &b) {  \
-    usz n = b.size();                                                          \
-    Array<T> res;                                                              \
-    res.allocate(n);                                                           \
-    for (usz i = 0; i < n; ++i)                                                \
-      res[i] = a op b[i];                                                      \
-    return res;                                                                \
-  }
-
-XI_ARRAY_BIN_OP(+)
-XI_ARRAY_BIN_OP(-)
-XI_ARRAY_BIN_OP(*)
-XI_ARRAY_BIN_OP(/)
-
 } // namespace Xi
 
 #endif // XI_ARRAY_HPP
\ No newline at end of file
@@ -0,0 +1,377 @@
+#ifndef XI_ARRAY_EXPR_HPP
+#define XI_ARRAY_EXPR_HPP
+
+#include "Primitives.hpp"
+
+namespace Xi {
+
+template <typename T> class Array;
+template <typename T> class InlineArray;
+
+// -------------------------------------------------------------------------
+// ArrayExpr — Lazy element-wise expressions over Arrays
+// -------------------------------------------------------------------------
+//
+// `a * 2.0f + b` builds a small tree of value types instead of computing
+// anything. Assigning it to an Array (or calling evalInto) walks the inputs
+// once, fragment run by fragment run, and writes each result element in a
+// single fused loop: no temporaries, no flattening of fragmented inputs.
+//
+// Every node implements:
+//   usz size() const           Elements produced (~0 for scalars)
+//   usz bind(usz i, usz n)     Position at element i; returns how many of the
+//                              next n elements are contiguous in every input
+//   Value at(usz k) const      Element i + k of the bound run
+//
+// Nodes keep pointers to named input Arrays, and evaluating an expression
+// after such an input is gone is undefined. Temporary Arrays are moved into
+// the node instead (ArrayHold), so `auto e = a + makeArray();` is safe.
+
+struct ArrayExprTag {};
+
+template <typename E> struct ArrayExpr : ArrayExprTag {
+  const E &self() const { return static_cast<const E &>(*this); }
+};
+
+template <typename X> struct IsArrayExpr {
+  static char test(const ArrayExprTag *);
+  static long test(...);
+  static const bool Value = sizeof(test((X *)nullptr)) == sizeof(char);
+};
+
+/// Position inside an Array's fragments, shared by the Array leaves.
+template <typename T> struct ArrayCursor {
+  /// Longest stretch served from the shared zero block inside a hole.
+  static constexpr usz HoleRun = 256;
+
+  usz frag = 0;
+  const T *p = nullptr;
+
+  usz bind(const InlineArray<InlineArray<T>> &fs, usz i, usz n) {
+    usz count = fs.size();
+    // Evaluation moves forward, so the cursor is usually already in place.
+    if (frag >= count || fs[frag].offset > i)
+      frag = 0;
+    while (frag < count && fs[frag].offset + fs[frag].size() <= i)
+      frag++;
+
+    usz run;
+    if (frag < count && fs[frag].offset <= i) {
+      const InlineArray<T> &f = fs[frag];
+      p = f.data() + (i - f.offset);
+      run = f.offset + f.size() - i;
+    } else {
+      // Unset elements of a sparse Array read as T(), like operator[].
+      p = zeros();
+      run = frag < count ? fs[frag].offset - i : n;
+      if (run > HoleRun)
+        run = HoleRun;
+    }
+    return run < n ? run : n;
+  }
+
+  static const T *zeros() {
+    static const T z[HoleRun] = {};
+    return z;
+  }
+};
+
+/// Leaf: reads an Array in place, following its fragments.
+template <typename T> class ArrayRef : public ArrayExpr<ArrayRef<T>> {
+public:
+  using Value = T;
+
+  explicit ArrayRef(const Array<T> &a) : arr(&a) {}
+
+  usz size() const { return arr->size(); }
+  usz bind(usz i, usz n) { return cur.bind(arr->fragments, i, n); }
+  T at(usz k) const { return cur.p[k]; }
+
+private:
+  const Array<T> *arr;
+  ArrayCursor<T> cur;
+};
+
+/// Leaf: owns an Array taken from a temporary operand. Copies share its
+/// storage, so copying the expression stays cheap.
+template <typename T> class ArrayHold : public ArrayExpr<ArrayHold<T>> {
+public:
+  using Value = T;
+
+  explicit ArrayHold(Array<T> &&a) : arr(Xi::Move(a)) {}
+
+  usz size() const { return arr.size(); }
+  usz bind(usz i, usz n) { return cur.bind(arr.fragments, i, n); }
+  T at(usz k) const { return cur.p[k]; }
+
+private:
+  Array<T> arr;
+  ArrayCursor<T> cur;
+};
+
+/// Leaf: a constant broadcast to every element.
+template <typename T> class ArrayScalar : public ArrayExpr<ArrayScalar<T>> {
+public:
+  using Value = T;
+
+  explicit ArrayScalar(const T &v) : value(v) {}
+
+  usz size() const { return ~(usz)0; }
+  usz bind(usz, usz n) { return n; }
+  T at(usz) const { return value; }
+
+private:
+  T value;
+};
+
+/// Op::apply(x) on every element of E.
+template <typename Op, typename E>
+class ArrayUnary : public ArrayExpr<ArrayUnary<Op, E>> {
+public:
+  using Value = typename E::Value;
+
+  explicit ArrayUnary(const E &e) : e(e) {}
+
+  usz size() const { return e.size(); }
+  usz bind(usz i, usz n) { return e.bind(i, n); }
+  Value at(usz k) const { return Op::apply(e.at(k)); }
+
+private:
+  E e;
+};
+
+/**
+ * @brief Op::batch(in, out, n) over blocks of E, for ops with a vectorized
+ * kernel. Blocks are small enough to stay in L1 between the two passes.
+ */
+template <typename Op, typename E>
+class ArrayBatch : public ArrayExpr<ArrayBatch<Op, E>> {
+public:
+  using Value = typename E::Value;
+  static constexpr usz Block = 256;
+
+  explicit ArrayBatch(const E &e) : e(e) {}
+
+  usz size() const { return e.size(); }
+  usz bind(usz i, usz n) {
+    usz run = e.bind(i, n < Block ? n : Block);
+    const E &c = e;
+    for (usz k = 0; k < run; ++k)
+      buf[k] = c.at(k);
+    Op::batch(buf, buf, run);
+    return run;
+  }
+  Value at(usz k) const { return buf[k]; }
+
+private:
+  E e;
+  Value buf[Block];
+};
+
+/// ArrayBatch when Op has a kernel for E's element type, else ArrayUnary.
+template <typename Op, typename E,
+          bool Batched = Op::template Batched<typename E::Value>::Value>
+struct ArrayUnaryOf {
+  using Type = ArrayUnary<Op, E>;
+};
+template <typename Op, typename E> struct ArrayUnaryOf<Op, E, true> {
+  using Type = ArrayBatch<Op, E>;
+};
+
+/// Op::apply(l, r) element-wise; as long as the shorter operand.
+template <typename Op, typename L, typename R>
+class ArrayBinary : public ArrayExpr<ArrayBinary<Op, L, R>> {
+public:
+  using Value = typename L::Value;
+
+  ArrayBinary(const L &l, const R &r) : l(l), r(r) {}
+
+  usz size() const {
+    usz a = l.size(), b = r.size();
+    return a < b ? a : b;
+  }
+  usz bind(usz i, usz n) { return r.bind(i, l.bind(i, n)); }
+  Value at(usz k) const { return Op::apply(l.at(k), r.at(k)); }
+
+private:
+  L l;
+  R r;
+};
+
+// -------------------------------------------------------------------------
+// Evaluation
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Evaluates @p expr into @p cap elements at @p dst.
+ * @return Number of elements written (the smaller of size() and @p cap).
+ *
+ * @p dst may be one of the inputs: every element only reads its own index.
+ */
+template <typename T, typename E>
+usz evalInto(T *dst, usz cap, const ArrayExpr<E> &expr) {
+  E e = expr.self(); // bind() moves cursors; work on a copy
+  usz n = e.size();
+  if (n > cap)
+    n = cap;
+  for (usz i = 0; i < n;) {
+    usz run = e.bind(i, n - i);
+    T *out = dst + i;
+    const E &c = e;
+    _Pragma("omp simd") for (usz k = 0; k < run; ++k) out[k] = c.at(k);
+    i += run;
+  }
+  return n;
+}
+
+/**
+ * @brief Evaluates @p expr into @p dst, resized to the expression's length.
+ *
+ * A contiguous @p dst is reused in place, so repeated evaluation into the
+ * same Array allocates nothing once its capacity suffices. A fragmented
+ * @p dst is replaced by a fresh contiguous result.
+ */
+template <typename T, typename E>
+void evalInto(Array<T> &dst, const ArrayExpr<E> &expr) {
+  usz frags = dst.fragments.size();
+  if (frags > 1 || (frags == 1 && dst.fragments[0].offset != 0)) {
+    // dst may also be an input; it must stay intact until the end.
+    Array<T> res;
+    evalInto(res, expr);
+    dst.fragments = Xi::Move(res.fragments);
+    return;
+  }
+  usz n = expr.self().size();
+  dst.allocate(n);
+  if (n)
+    evalInto(dst.fragments[0].data(), n, expr);
+}
+
+template <typename T, typename E>
+void evalInto(InlineArray<T> &dst, const ArrayExpr<E> &expr) {
+  usz n = expr.self().size();
+  dst.allocate(n);
+  if (n)
+    evalInto(dst.data(), n, expr);
+}
+
+// -------------------------------------------------------------------------
+// Operators
+// -------------------------------------------------------------------------
+
+namespace ArrayOp {
+struct Add {
+  template <typename T> static T apply(const T &a, const T &b) { return a + b; }
+};
+struct Sub {
+  template <typename T> static T apply(const T &a, const T &b) { return a - b; }
+};
+struct Mul {
+  template <typename T> static T apply(const T &a, const T &b) { return a * b; }
+};
+struct Div {
+  template <typename T> static T apply(const T &a, const T &b) { return a / b; }
+};
+struct Max {
+  template <typename T> static T apply(const T &a, const T &b) {
+    return a > b ? a : b;
+  }
+};
+struct Min {
+  template <typename T> static T apply(const T &a, const T &b) {
+    return a < b ? a : b;
+  }
+};
+} // namespace ArrayOp
+
+// Element type of an array-like operand.
+template <typename X> struct ArrayValueOf {
+  using Type = typename EnableIf<IsArrayExpr<X>::Value, X>::Type::Value;
+};
+template <typename T> struct ArrayValueOf<Array<T>> {
+  using Type = T;
+};
+
+template <typename X> struct IsArrayLike {
+  static const bool Value = IsArrayExpr<X>::Value;
+};
+template <typename T> struct IsArrayLike<Array<T>> {
+  static const bool Value = true;
+};
+
+// Maps an operand to its expression node: Array -> ArrayRef, expression ->
+// itself, anything else -> ArrayScalar of the element type.
+template <typename X, typename V, bool Expr = IsArrayExpr<X>::Value>
+struct ArrayOperand {
+  using Type = ArrayScalar<V>;
+  static Type wrap(const X &x) { return Type(V(x)); }
+};
+template <typename X, typename V> struct ArrayOperand<X, V, true> {
+  using Type = X;
+  static const X &wrap(const X &x) { return x; }
+};
+template <typename T, typename V> struct ArrayOperand<Array<T>, V, false> {
+  using Type = ArrayRef<T>;
+  static Type wrap(const Array<T> &a) { return Type(a); }
+};
+
+// Element type of a binary expression: taken from its array-like side.
+template <typename A, typename B, bool LeftArray = IsArrayLike<A>::Value>
+struct ArrayPairValue {
+  using Type = typename ArrayValueOf<A>::Type;
+};
+template <typename A, typename B> struct ArrayPairValue<A, B, false> {
+  using Type = typename ArrayValueOf<B>::Type;
+};
+
+template <typename Op, typename A, typename B,
+          bool Enable = IsArrayLike<A>::Value || IsArrayLike<B>::Value>
+struct ArrayBinaryOf {};
+
+template <typename Op, typename A, typename B>
+struct ArrayBinaryOf<Op, A, B, true> {
+  using V = typename ArrayPairValue<A, B>::Type;
+  using Type = ArrayBinary<Op, typename ArrayOperand<A, V>::Type,
+                           typename ArrayOperand<B, V>::Type>;
+  static Type make(const A &a, const B &b) {
+    return Type(ArrayOperand<A, V>::wrap(a), ArrayOperand<B, V>::wrap(b));
+  }
+};
+
+// Temporary Array operands pick the && overloads and are moved into an
+// ArrayHold, so the expression never points at a destroyed Array.
+#define XI_ARRAY_EXPR_OP(op, Op)                                               \
+  template <typename A, typename B>                                            \
+  typename ArrayBinaryOf<ArrayOp::Op, A, B>::Type operator op(const A &a,      \
+                                                              const B &b) {    \
+    return ArrayBinaryOf<ArrayOp::Op, A, B>::make(a, b);                       \
+  }                                                                            \
+  template <typename T, typename B>                                            \
+  typename ArrayBinaryOf<ArrayOp::Op, ArrayHold<T>, B>::Type operator op(      \
+      Array<T> &&a, const B &b) {                                              \
+    return ArrayBinaryOf<ArrayOp::Op, ArrayHold<T>, B>::make(                  \
+        ArrayHold<T>(Xi::Move(a)), b);                                         \
+  }                                                                            \
+  template <typename A, typename T>                                            \
+  typename ArrayBinaryOf<ArrayOp::Op, A, ArrayHold<T>>::Type operator op(      \
+      const A &a, Array<T> &&b) {                                              \
+    return ArrayBinaryOf<ArrayOp::Op, A, ArrayHold<T>>::make(                  \
+        a, ArrayHold<T>(Xi::Move(b)));                                         \
+  }                                                                            \
+  template <typename T, typename U>                                            \
+  typename ArrayBinaryOf<ArrayOp::Op, ArrayHold<T>, ArrayHold<U>>::Type        \
+  operator op(Array<T> &&a, Array<U> &&b) {                                    \
+    return ArrayBinaryOf<ArrayOp::Op, ArrayHold<T>, ArrayHold<U>>::make(       \
+        ArrayHold<T>(Xi::Move(a)), ArrayHold<U>(Xi::Move(b)));                 \
+  }
+
+XI_ARRAY_EXPR_OP(+, Add)
+XI_ARRAY_EXPR_OP(-, Sub)
+XI_ARRAY_EXPR_OP(*, Mul)
+XI_ARRAY_EXPR_OP(/, Div)
+
+#undef XI_ARRAY_EXPR_OP
+
+} // namespace Xi
+
+#endif // XI_ARRAY_EXPR_HPP
@@ -0,0 +1,420 @@
+#ifndef XI_ARRAY_VIEW_HPP
+#define XI_ARRAY_VIEW_HPP
+
+#include "Array.hpp"
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// ArrayView — Strided N-d windows over Array storage
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Shape + strides + base pointer over an existing block.
+ *
+ * Slicing, select, transpose/permute, broadcast and reshape all return new
+ * views of the same memory; nothing is copied until copy() (or evalInto()
+ * into an Array). A view keeps its block alive through the block's use
+ * count, so it stays valid after the Array it came from is gone. Writes
+ * through a view are visible to every Array sharing the block.
+ *
+ * Strides count elements. Broadcast axes have stride 0, so writing through
+ * a broadcast view hits the same element repeatedly.
+ *
+ * @code
+ *   ArrayView<f32> m(arr);            // arr shaped [rows, cols]
+ *   ArrayView<f32> col = m.select(1, 3);
+ *   ArrayView<f32> t = m.transpose();
+ *   Array<f32> r = Math::exp(t * 2.0f); // reads t in place
+ * @endcode
+ *
+ * Invalid requests (bad axis, incompatible shapes) return an empty view:
+ * rank() == 0 and size() == 0.
+ */
+template <typename T> class ArrayView {
+public:
+  using Value = T;
+  static constexpr u8 MaxRank = 8;
+
+  ArrayView() = default;
+
+  /// Whole InlineArray, shaped by its dims if it has any.
+  explicit ArrayView(const InlineArray<T> &a) {
+    hold(a);
+    if (a._dims && a._rank > 1)
+      layout(a._rank, a._dims);
+    else
+      layout(1, &a._length);
+  }
+
+  /**
+   * @brief Whole Array, shaped by its dims. A contiguous Array is shared; a
+   * fragmented one is flattened into a fresh block first.
+   */
+  explicit ArrayView(const Array<T> &a) {
+    usz f = a.fragments.size();
+    if (f == 1 && a.fragments[0].offset == 0) {
+      hold(a.fragments[0]);
+    } else if (f > 0) {
+      Array<T> flat = a;
+      flat.data();
+      hold(flat.fragments[0]);
+    }
+    usz dims[MaxRank];
+    u8 r = a.rank() <= MaxRank ? a.rank() : 1;
+    for (u8 i = 0; i < r; ++i)
+      dims[i] = r == 1 ? a.size() : a.dim(i);
+    layout(r, dims);
+  }
+
+  /// Unowned memory. Without @p strides the layout is dense row-major.
+  ArrayView(T *data, u8 rank, const usz *dims, const usz *strides = nullptr) {
+    base = data;
+    if (rank == 0 || rank > MaxRank)
+      return;
+    layout(rank, dims);
+    if (strides)
+      for (u8 i = 0; i < rank; ++i)
+        _strides[i] = strides[i];
+  }
+
+  // --- Shape ---
+
+  u8 rank() const { return _rank; }
+  usz dim(u8 i) const { return i < _rank ? _dims[i] : 1; }
+  usz stride(u8 i) const { return i < _rank ? _strides[i] : 0; }
+  const usz *dims() const { return _dims; }
+  const usz *strides() const { return _strides; }
+
+  /// First element (the view's origin).
+  T *data() const { return base; }
+
+  usz size() const {
+    if (_rank == 0)
+      return 0;
+    usz n = 1;
+    for (u8 i = 0; i < _rank; ++i)
+      n *= _dims[i];
+    return n;
+  }
+
+  bool empty() const { return size() == 0; }
+
+  /// Dense row-major: elements are exactly data()[0, size()).
+  bool isContiguous() const {
+    usz expect = 1;
+    for (int i = (int)_rank - 1; i >= 0; --i) {
+      if (_dims[i] != 1 && _strides[i] != expect)
+        return false;
+      expect *= _dims[i];
+    }
+    return _rank > 0;
+  }
+
+  /// Element at the given index along each axis (no bounds checks).
+  template <typename... I> T &operator()(I... idx) const {
+    static_assert(sizeof...(I) > 0, "at least one index");
+    usz ix[] = {(usz)idx...};
+    usz off = 0;
+    for (usz i = 0; i < sizeof...(I); ++i)
+      off += ix[i] * _strides[i];
+    return base[off];
+  }
+
+  // --- Derived views ---
+
+  /// Index the first axis: rank drops by one.
+  ArrayView operator[](usz i) const { return select(0, i); }
+
+  /// Fixes @p axis at @p index and drops it.
+  ArrayView select(u8 axis, usz index) const {
+    if (axis >= _rank || index >= _dims[axis] || _rank == 1)
+      return ArrayView();
+    ArrayView v = derive();
+    v.base = base + index * _strides[axis];
+    v._rank = _rank - 1;
+    for (u8 i = 0; i < v._rank; ++i) {
+      u8 src = i < axis ? i : i + 1;
+      v._dims[i] = _dims[src];
+      v._strides[i] = _strides[src];
+    }
+    return v;
+  }
+
+  /// Elements [begin, end) of @p axis taking every @p step-th one.
+  ArrayView slice(u8 axis, usz begin, usz end, usz step = 1) const {
+    if (axis >= _rank || step == 0)
+      return ArrayView();
+    if (end > _dims[axis])
+      end = _dims[axis];
+    if (begin > end)
+      begin = end;
+    ArrayView v = *this;
+    v.base = base + begin * _strides[axis];
+    v._dims[axis] = (end - begin + step - 1) / step;
+    v._strides[axis] = _strides[axis] * step;
+    return v;
+  }
+
+  /// Reverses the axes: [a, b, c] -> [c, b, a].
+  ArrayView transpose() const {
+    ArrayView v = *this;
+    for (u8 i = 0; i < _rank; ++i) {
+      v._dims[i] = _dims[_rank - 1 - i];
+      v._strides[i] = _strides[_rank - 1 - i];
+    }
+    return v;
+  }
+
+  /// Axis i of the result is axis order[i] of this view.
+  ArrayView permute(u8 rank, const u8 *order) const {
+    if (rank != _rank)
+      return ArrayView();
+    bool seen[MaxRank] = {};
+    ArrayView v = *this;
+    for (u8 i = 0; i < rank; ++i) {
+      if (order[i] >= rank || seen[order[i]])
+        return ArrayView();
+      seen[order[i]] = true;
+      v._dims[i] = _dims[order[i]];
+      v._strides[i] = _strides[order[i]];
+    }
+    return v;
+  }
+
+  /**
+   * @brief Stretches to @p dims with NumPy rules: axes are matched from the
+   * right, and missing or size-1 axes repeat with stride 0.
+   */
+  ArrayView broadcast(u8 rank, const usz *dims) const {
+    if (_rank == 0 || rank < _rank || rank > MaxRank)
+      return ArrayView();
+    ArrayView v = derive();
+    v.base = base;
+    v._rank = rank;
+    u8 lead = rank - _rank;
+    for (u8 i = 0; i < rank; ++i) {
+      v._dims[i] = dims[i];
+      if (i < lead) {
+        v._strides[i] = 0;
+        continue;
+      }
+      usz d = _dims[i - lead];
+      if (d == dims[i])
+        v._strides[i] = _strides[i - lead];
+      else if (d == 1)
+        v._strides[i] = 0;
+      else
+        return ArrayView();
+    }
+    return v;
+  }
+
+  /// Same elements under a new shape; only possible for contiguous views.
+  ArrayView reshape(u8 rank, const usz *dims) const {
+    if (!isContiguous() || rank == 0 || rank > MaxRank)
+      return ArrayView();
+    usz n = 1;
+    for (u8 i = 0; i < rank; ++i)
+      n *= dims[i];
+    if (n != size())
+      return ArrayView();
+    ArrayView v = derive();
+    v.base = base;
+    v.layout(rank, dims);
+    return v;
+  }
+
+  /// Dense, shaped copy of the viewed elements.
+  Array<T> copy() const;
+
+  // --- Run decomposition ---
+
+  /**
+   * @brief Equivalent layout with size-1 axes dropped and axes merged where
+   * the memory allows, so a contiguous view becomes one long run.
+   */
+  void coalesced(u8 &rank, usz *dims, usz *strides) const {
+    rank = 0;
+    for (u8 i = 0; i < _rank; ++i) {
+      if (_dims[i] == 1)
+        continue;
+      if (rank > 0 && strides[rank - 1] == _strides[i] * _dims[i]) {
+        dims[rank - 1] *= _dims[i];
+        strides[rank - 1] = _strides[i];
+        continue;
+      }
+      dims[rank] = _dims[i];
+      strides[rank] = _strides[i];
+      rank++;
+    }
+    if (rank == 0) {
+      dims[0] = size();
+      strides[0] = 1;
+      rank = 1;
+    }
+  }
+
+private:
+  InlineArray<T> owner; // keeps the block alive; never shaped
+  T *base = nullptr;
+  u8 _rank = 0;
+  usz _dims[MaxRank] = {};
+  usz _strides[MaxRank] = {};
+
+  void hold(const InlineArray<T> &a) {
+    owner.block = a.block;
+    owner._data = a._data;
+    owner._length = a._length;
+    owner.retain();
+    base = a._data;
+  }
+
+  /// Copy of this view's ownership, for views on the same block.
+  ArrayView derive() const {
+    ArrayView v;
+    v.owner = owner;
+    return v;
+  }
+
+  void layout(u8 rank, const usz *dims) {
+    _rank = rank;
+    usz s = 1;
+    for (int i = (int)rank - 1; i >= 0; --i) {
+      _dims[i] = dims[i];
+      _strides[i] = s;
+      s *= dims[i];
+    }
+  }
+};
+
+// -------------------------------------------------------------------------
+// Expression leaf
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Reads an ArrayView in row-major order inside ArrayExpr trees.
+ *
+ * Unit-stride runs are read in place; other strides are gathered into a
+ * small block first so the fused loop itself stays unit-stride and
+ * vectorizes. Like ArrayRef it does not own the memory.
+ */
+template <typename T> class ArrayViewRef : public ArrayExpr<ArrayViewRef<T>> {
+public:
+  using Value = T;
+  static constexpr usz Block = 256;
+
+  explicit ArrayViewRef(const ArrayView<T> &v) : base(v.data()), n(v.size()) {
+    v.coalesced(rank, dims, strides);
+  }
+
+  usz size() const { return n; }
+
+  usz bind(usz i, usz want) {
+    usz off = 0, rem = i, left = 0;
+    for (int d = (int)rank - 1; d >= 0; --d) {
+      usz idx = rem % dims[d];
+      rem /= dims[d];
+      off += idx * strides[d];
+      if (d == (int)rank - 1)
+        left = dims[d] - idx;
+    }
+    usz run = left < want ? left : want;
+    usz s = strides[rank - 1];
+    const T *src = base + off;
+    if (s == 1) {
+      p = src;
+      return run;
+    }
+    if (run > Block)
+      run = Block;
+    for (usz k = 0; k < run; ++k)
+      buf[k] = src[k * s];
+    p = buf;
+    return run;
+  }
+
+  T at(usz k) const { return p[k]; }
+
+private:
+  const T *base;
+  usz n;
+  u8 rank;
+  usz dims[ArrayView<T>::MaxRank];
+  usz strides[ArrayView<T>::MaxRank];
+  const T *p = nullptr;
+  T buf[Block];
+};
+
+template <typename T> struct ArrayValueOf<ArrayView<T>> {
+  using Type = T;
+};
+template <typename T> struct IsArrayLike<ArrayView<T>> {
+  static const bool Value = true;
+};
+template <typename T, typename V> struct ArrayOperand<ArrayView<T>, V, false> {
+  using Type = ArrayViewRef<T>;
+  static Type wrap(const ArrayView<T> &v) { return Type(v); }
+};
+
+/**
+ * @brief Evaluates @p expr into the elements of @p dst in row-major order.
+ * @return Elements written (the smaller of the two sizes).
+ *
+ * Unlike the Array overloads, @p dst may only alias an input if both walk
+ * memory in the same order (e.g. `v = v * 2`, not `v = v.transpose()`).
+ */
+template <typename T, typename E>
+usz evalInto(const ArrayView<T> &dst, const ArrayExpr<E> &expr) {
+  E e = expr.self();
+  usz total = dst.size(), es = e.size();
+  if (es < total)
+    total = es;
+  u8 rank;
+  usz dims[ArrayView<T>::MaxRank], strides[ArrayView<T>::MaxRank];
+  dst.coalesced(rank, dims, strides);
+  usz s = strides[rank - 1];
+  for (usz i = 0; i < total;) {
+    usz off = 0, rem = i, left = 0;
+    for (int d = (int)rank - 1; d >= 0; --d) {
+      usz idx = rem % dims[d];
+      rem /= dims[d];
+      off += idx * strides[d];
+      if (d == (int)rank - 1)
+        left = dims[d] - idx;
+    }
+    if (left > total - i)
+      left = total - i;
+    T *out = dst.data() + off;
+    while (left) {
+      usz run = e.bind(i, left);
+      const E &c = e;
+      if (s == 1) {
+        _Pragma("omp simd") for (usz k = 0; k < run; ++k) out[k] = c.at(k);
+      } else {
+        for (usz k = 0; k < run; ++k)
+          out[k * s] = c.at(k);
+      }
+      out += run * s;
+      i += run;
+      left -= run;
+    }
+  }
+  return total;
+}
+
+template <typename T> Array<T> ArrayView<T>::copy() const {
+  Array<T> r;
+  usz n = size();
+  if (n == 0)
+    return r;
+  r.allocate(n);
+  if (_rank > 1)
+    r.shape(_rank, _dims);
+  evalInto(r.data(), n, ArrayViewRef<T>(*this));
+  return r;
+}
+
+} // namespace Xi
+
+#endif // XI_ARRAY_VIEW_HPP
@@ -1,13 +1,21 @@
 #ifndef XI_CAMERA_HPP
 #define XI_CAMERA_HPP
 
+#include "Culling.hpp"
+#include "DrawList.hpp"
 #include "Func.hpp"
-#include "Graphics.hpp"
+#include "Hierarchy.hpp"
 #include "Mesh.hpp"
-#include "Shader.hpp"
+#include "Raster.hpp"
 #include "Tree.hpp"
 
+// Camera3 renders on the GPU (Graphics.hpp, Shader.hpp) when the library is
+// built with XI_BUILD_GRAPHICS, and through a SoftwareRenderingDevice always;
+// this header keeps the GPU objects opaque so it builds either way.
+
 namespace Xi {
+struct Shader;
+
 struct XI_EXPORT Renderable3 : public TreeItem, public Transform {
   Mesh3 *mesh = nullptr;
   Shader *shader = nullptr;
@@ -16,8 +24,9 @@ struct XI_EXPORT Renderable3 : public TreeItem, public Transform {
   // Can live on CPU or GPU via .to(device)
   String *surface = nullptr;
 
-  // GPU handle cache for rendering (managed by the rendering device)
-  Diligent::RefCntAutoPtr<Diligent::ITexture> gpuTexture;
+  // GPU handle cache for rendering (an ITexture, managed by the rendering
+  // device)
+  void *gpuTexture = nullptr;
 };
 
 struct XI_EXPORT ShaderData {
@@ -33,7 +42,9 @@ struct XI_EXPORT Camera3 : public Transform {
   i32 surfaceWidth = 0;
   i32 surfaceHeight = 0;
 
-  // The device that will provide the memory for the surface (e.g. GPU)
+  // The device that will provide the memory for the surface (e.g. GPU).
+  // A SoftwareRenderingDevice renders on the CPU instead; Renderable3s then
+  // need no shader.
   IMemoryDevice *device = nullptr;
 
   float clipStart = 0.1f;
@@ -46,13 +57,16 @@ struct XI_EXPORT Camera3 : public Transform {
   float fov = 50.0f;
   float orthoScale = 8.0f;
 
-  // Depth buffer - still managed internally for rendering
-  Diligent::RefCntAutoPtr<Diligent::ITextureView> pDSV;
+  // Depth buffer - still managed internally for rendering (an ITextureView
+  // the camera holds a reference to; GPU builds only)
+  void *pDSV = nullptr;
 
   Func<void()> onUpdate;
 
   Camera3() = default;
-  virtual ~Camera3() = default;
+  virtual ~Camera3();
+  Camera3(const Camera3 &) = delete;
+  Camera3 &operator=(const Camera3 &) = delete;
 
   /// Get the shader resource view for displaying this camera's output.
   /// Extracts it directly from the surface view.
@@ -64,9 +78,41 @@ struct XI_EXPORT Camera3 : public Transform {
   void render(void *rtv, void *dsv, i32 w, i32 h);
   void render();
 
+  /// Renderables drawn by the last render(), after frustum culling.
+  usz drawCount() const { return _visible.size(); }
+
+  /// The last GPU render()'s draws, sorted and batched.
+  const DrawList &drawList() const { return _drawList; }
+
 private:
+  // A Renderable3 found under root, in walk order; parent indexes the same
+  // list (TransformHierarchy::None at the top).
+  struct SceneEntry {
+    Renderable3 *item;
+    Mesh3 *mesh;
+    u32 parent;
+  };
+
+  // Renderable3s under root flattened into a hierarchy, and the ones with
+  // a mesh in a BVH (handle = index into _drawables). _built is the walk
+  // they were made from, _walk the current frame's.
+  InlineArray<SceneEntry> _walk, _built;
+  TransformHierarchy _scene;
+  CullBVH _bvh;
+  InlineArray<Renderable3 *> _drawables;
+  InlineArray<u32> _drawNode;
+  InlineArray<u64> _drawRevision; // mesh->boundsRevision the BVH holds
+  InlineArray<u32> _visible;
+  DrawList _drawList;
+  DrawBackend *_gpu = nullptr; // GraphicsDrawBackend, made on first draw
+
   void _ensureDepthBuffer(i32 w, i32 h);
-  static void _renderRec(TreeItem *n, Matrix4 p, const Matrix4 &vp);
+  void _collect(TreeItem *n, u32 parent);
+  bool _sceneChanged() const;
+  void _buildScene();
+  void _cull(const Matrix4 &vp);
+  void _renderRec(const Matrix4 &vp);
+  void _rasterize(SoftwareRenderingDevice *sw, const Matrix4 &vp);
 };
 } // namespace Xi
 
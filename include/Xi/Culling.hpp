@@ -0,0 +1,138 @@
+#ifndef XI_CULLING_HPP
+#define XI_CULLING_HPP
+
+#include "InlineArray.hpp"
+#include "Math.hpp"
+
+namespace Xi {
+class TransformHierarchy;
+struct CullItem;
+
+// -------------------------------------------------------------------------
+// Bounds — Axis-aligned box
+// -------------------------------------------------------------------------
+
+struct XI_EXPORT Bounds {
+  Vector3 min = {__builtin_inff(), __builtin_inff(), __builtin_inff()};
+  Vector3 max = {-__builtin_inff(), -__builtin_inff(), -__builtin_inff()};
+
+  bool empty() const { return min.x > max.x; }
+
+  void merge(const Bounds &b) {
+    min = {min.x < b.min.x ? min.x : b.min.x, min.y < b.min.y ? min.y : b.min.y,
+           min.z < b.min.z ? min.z : b.min.z};
+    max = {max.x > b.max.x ? max.x : b.max.x, max.y > b.max.y ? max.y : b.max.y,
+           max.z > b.max.z ? max.z : b.max.z};
+  }
+
+  /// Box around this one after p * M (affine part of @p m only).
+  Bounds transformed(const Matrix4 &m) const;
+
+  /// Box around @p count points of 3 floats each, @p stride floats apart.
+  static Bounds of(const f32 *xyz, usz count, usz stride = 3);
+};
+
+// -------------------------------------------------------------------------
+// Frustum — Six clip planes
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Planes (a, b, c, d) with a x + b y + c z + d >= 0 inside, taken
+ * from a view-projection matrix in this library's convention: row vectors,
+ * clip = p * VP, depth in [0, 1] (Math::perspective / Math::ortho).
+ */
+struct XI_EXPORT Frustum {
+  f32 planes[6][4];
+
+  static Frustum fromMatrix(const Matrix4 &viewProj);
+
+  bool intersects(const Bounds &b) const;
+
+  /**
+   * @brief Tests @p n boxes stored as [6, n] planes (min x, min y, min z,
+   * max x, max y, max z) and writes 1 for each visible one.
+   * @return Number of visible boxes.
+   */
+  usz test(const f32 *boxes, usz n, u8 *visible) const;
+};
+
+// -------------------------------------------------------------------------
+// CullBVH — Dynamic 4-wide bounding volume hierarchy for frustum culling
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Objects with local bounds, optionally attached to a
+ * TransformHierarchy node, in a BVH whose nodes keep their four children's
+ * boxes as SoA so one frustum plane tests all four at once.
+ *
+ * Moving objects only refit (boxes grow or shrink up to the root); adding or
+ * removing objects triggers a rebuild on the next cull(). Rebuild
+ * explicitly after large motions, when refitted boxes get loose.
+ */
+class XI_EXPORT CullBVH {
+public:
+  static constexpr u32 None = ~(u32)0;
+
+  /// Adds an object. With @p node set, world bounds follow that
+  /// hierarchy node's world matrix; otherwise @p local is world space.
+  /// Returns a handle, dense from 0 and reused after remove().
+  u32 insert(const Bounds &local, u32 node = None);
+  void remove(u32 handle);
+
+  /// Replaces an object's local bounds. Objects attached to a hierarchy
+  /// node get their new world box on the next refit().
+  void setBounds(u32 handle, const Bounds &local);
+
+  /// Refits objects whose hierarchy node's worldVersion changed since the
+  /// last call. Returns the number refitted.
+  usz refit(const TransformHierarchy &h);
+
+  /// Builds the tree from scratch: objects sorted along a Morton curve
+  /// through their centers, split into equal quarters.
+  void build();
+
+  /// Appends handles of objects whose box meets @p f to @p visible.
+  /// Subtrees entirely inside are accepted without further tests.
+  usz cull(const Frustum &f, InlineArray<u32> &visible);
+
+  usz size() const { return _live; }
+  const Bounds &worldBounds(u32 handle) const { return _objects[handle].world; }
+
+private:
+  struct Object {
+    Bounds local, world;
+    u32 leaf; // BVH node holding this object (None before build)
+    u8 slot;
+    bool live;
+  };
+
+  struct Node {
+    f32 minX[4], minY[4], minZ[4], maxX[4], maxY[4], maxZ[4];
+    u32 child[4]; // node index, object | Leaf, or None
+    u32 parent;
+    u8 slot; // index in the parent's child[]
+  };
+
+  static constexpr u32 Leaf = 0x80000000u;
+
+  InlineArray<Object> _objects;
+  // Per handle, apart from _objects so refit() scans 8 bytes per object:
+  // hierarchy node (None if detached or removed), worldVersion last applied.
+  InlineArray<u32> _node, _seen;
+  InlineArray<u32> _free;
+  InlineArray<Node> _nodes;
+  InlineArray<u8> _nodeDirty; // refit: child boxes changed
+  usz _live = 0;
+  bool _stale = true;
+
+  u32 buildRange(CullItem *items, usz n, u32 parent, u8 slot);
+  void place(u32 node, u8 slot, u32 handle);
+  void setSlot(u32 node, u8 slot, const Bounds &b);
+  Bounds nodeBounds(u32 node) const;
+  void propagate(u32 node);
+  usz acceptAll(u32 node, InlineArray<u32> &visible) const;
+};
+
+} // namespace Xi
+
+#endif // XI_CULLING_HPP
@@ -0,0 +1,133 @@
+#ifndef XI_DRAW_LIST_HPP
+#define XI_DRAW_LIST_HPP
+
+#include "InlineArray.hpp"
+#include "Math.hpp"
+
+namespace Xi {
+
+/// One mesh drawn with one pipeline. Handles are the backend's (for the
+/// Diligent backend: PSO, SRB, constant buffer, texture variable, SRV,
+/// vertex and index buffer); DrawList only compares them.
+struct XI_EXPORT DrawCommand {
+  void *pipeline = nullptr;
+  void *bindings = nullptr;
+  void *uniforms = nullptr;
+  void *textureSlot = nullptr;
+  void *texture = nullptr; ///< null keeps whatever is bound
+  void *vertices = nullptr;
+  void *indices = nullptr;
+  u32 indexCount = 0;
+  bool index16 = false;
+  /// The pipeline reads world matrices per instance and the view-projection
+  /// from its uniforms; otherwise each instance gets its own uniforms.
+  bool instanced = false;
+};
+
+// -------------------------------------------------------------------------
+// DrawBackend — What DrawList::submit() drives
+// -------------------------------------------------------------------------
+
+class XI_EXPORT DrawBackend {
+public:
+  virtual ~DrawBackend() = default;
+
+  virtual void setPipeline(void *pipeline) = 0;
+  virtual void setTexture(void *slot, void *texture) = 0;
+  virtual void commit(void *bindings) = 0;
+  virtual void setMesh(void *vertices, void *indices, bool index16) = 0;
+  virtual void setUniforms(void *uniforms, const Matrix4 &mvp,
+                           const Matrix4 &world) = 0;
+  virtual void draw(u32 indexCount) = 0;
+  virtual void drawInstanced(u32 indexCount, const Matrix4 *worlds,
+                             u32 count) = 0;
+};
+
+/// Counts calls instead of issuing them, so state-change behaviour can be
+/// checked without a GPU.
+class XI_EXPORT RecordingDrawBackend : public DrawBackend {
+public:
+  struct Counts {
+    usz pipelines = 0, textures = 0, commits = 0, meshes = 0, uniforms = 0;
+    usz draws = 0;     ///< draw() and drawInstanced() calls
+    usz instances = 0; ///< Objects drawn
+    usz triangles = 0;
+  };
+  Counts counts;
+
+  void reset() { counts = Counts(); }
+
+  void setPipeline(void *) override { counts.pipelines++; }
+  void setTexture(void *, void *) override { counts.textures++; }
+  void commit(void *) override { counts.commits++; }
+  void setMesh(void *, void *, bool) override { counts.meshes++; }
+  void setUniforms(void *, const Matrix4 &, const Matrix4 &) override {
+    counts.uniforms++;
+  }
+  void draw(u32 indexCount) override {
+    counts.draws++;
+    counts.instances++;
+    counts.triangles += indexCount / 3;
+  }
+  void drawInstanced(u32 indexCount, const Matrix4 *, u32 count) override {
+    counts.draws++;
+    counts.instances += count;
+    counts.triangles += (usz)(indexCount / 3) * count;
+  }
+};
+
+// -------------------------------------------------------------------------
+// DrawList — Sorted, batched draws for one frame
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Collects (command, world matrix) pairs, sorts them by pipeline,
+ * bindings, texture and mesh, and merges runs of identical commands into
+ * instanced batches. submit() then only touches state that changes.
+ *
+ * @code
+ *   list.clear();
+ *   for (...) list.add(command, world);
+ *   list.build();
+ *   list.submit(backend, viewProj);
+ * @endcode
+ *
+ * Sorting is stable, so equal commands keep their submission order.
+ */
+class XI_EXPORT DrawList {
+public:
+  struct Batch {
+    u32 command;        ///< Index into the added commands
+    u32 first, count;   ///< Range of instances()
+  };
+
+  bool sort = true;     ///< Off: submission order (for comparison)
+  bool instance = true; ///< Off: one draw per object even when instanced
+
+  void clear();
+  void add(const DrawCommand &command, const Matrix4 &world);
+  void build();
+  void submit(DrawBackend &backend, const Matrix4 &viewProj) const;
+
+  usz size() const { return _commands.size(); }
+  const InlineArray<Batch> &batches() const { return _batches; }
+  /// World matrices in batch order, after build().
+  const InlineArray<Matrix4> &instances() const { return _instances; }
+
+private:
+  InlineArray<DrawCommand> _commands;
+  InlineArray<Matrix4> _worlds;     // per command, as added
+  InlineArray<Matrix4> _instances;  // sorted
+  InlineArray<Batch> _batches;
+  InlineArray<u64> _keys;
+  InlineArray<u32> _order, _scratch;
+  InlineArray<void *> _idKeys;      // pointer -> dense id hash table
+  InlineArray<u32> _idValues;
+  u32 _ids = 0;
+
+  u32 _id(void *p);
+};
+
+} // namespace Xi
+
+#endif // XI_DRAW_LIST_HPP
@@ -4,6 +4,7 @@
 #include "Array.hpp"
 #include "Device.hpp"
 #include "String.hpp"
+#include "Task.hpp"
 
 #include <cstdio>
 #include <cstring>
@@ -97,6 +98,44 @@ public:
 
 FilesystemDevice *requestFS();
 
+#ifdef XI_HAS_COROUTINES
+// -------------------------------------------------------------------------
+// Coroutine helpers — run filesystem calls on EventLoop::executor
+// -------------------------------------------------------------------------
+// Paths are deep-copied so the executor thread never touches a block that
+// the caller still shares (InlineArray reference counts are not atomic).
+
+inline auto readAsync(EventLoop &loop, FilesystemDevice &fs, const String &path,
+                      u64 startPos = 0, u64 maxLength = 0) {
+  FilesystemDevice *f = &fs;
+  String p(path.data(), path.size());
+  return blocking<String>(loop, [f, p, startPos, maxLength]() {
+    return f->read(p, startPos, maxLength);
+  });
+}
+
+inline auto writeAsync(EventLoop &loop, FilesystemDevice &fs,
+                       const String &path, const String &content,
+                       i64 startPos = 0) {
+  FilesystemDevice *f = &fs;
+  String p(path.data(), path.size());
+  String c(content.data(), content.size());
+  return blocking<bool>(loop, [f, p, c, startPos]() {
+    f->write(p, c, startPos);
+    return true;
+  });
+}
+
+inline auto statAsync(EventLoop &loop, FilesystemDevice &fs, const String &path,
+                      i32 depth = 0, i32 maxChildren = 0) {
+  FilesystemDevice *f = &fs;
+  String p(path.data(), path.size());
+  return blocking<Stat>(loop, [f, p, depth, maxChildren]() {
+    return f->stat(p, depth, maxChildren);
+  });
+}
+#endif
+
 } // namespace Xi
 
 #endif // XI_FILE_HPP
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef XI_GEO_INDEX_HPP
+#define XI_GEO_INDEX_HPP
+
+#include "InlineArray.hpp"
+#include "Spatial.hpp"
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// GeoIndex — Static R-tree over points on the globe
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Radius and nearest-neighbour queries over a fixed set of
+ * (lat, lng) points, built once in O(n).
+ *
+ * Points are stored as unit vectors, so there are no seams at the
+ * antimeridian or the poles: great-circle distance is monotonic in chord
+ * length, and a query is a ball test in 3D. They are sorted along a 3D
+ * Morton curve and packed 16 to a leaf, with f32 boxes (rounded outwards)
+ * for every 16 nodes above, in the manner of a packed Hilbert R-tree.
+ * Subtrees whose box lies entirely inside the query are emitted without
+ * visiting their points.
+ *
+ * Distances are on a sphere of `radius` metres (mean Earth radius by
+ * default); use GeodeticSphere for ellipsoidal geometry.
+ *
+ * @code
+ *   GeoIndex idx;
+ *   idx.build(lat, lng, n);
+ *   InlineArray<u32> hits;
+ *   idx.within({47.37, 8.54, 0}, 500, hits);       // indices into lat/lng
+ *   idx.nearest({47.37, 8.54, 0}, 10, hits, &dist); // closest first
+ * @endcode
+ */
+class XI_EXPORT GeoIndex {
+public:
+  static const usz NodeSize = 16;
+
+  f64 radius = 6371008.8;
+
+  /// Replaces the contents; `alt` is ignored.
+  void build(const GeoPos *points, usz n);
+  void build(const f64 *lat, const f64 *lng, usz n);
+  usz size() const { return _ids.size(); }
+
+  /// Indices of the points within `meters` of `center`, in no set order.
+  void within(const GeoPos &center, f64 meters, InlineArray<u32> &out) const;
+
+  /// The `k` closest points, nearest first, and their distances in metres.
+  void nearest(const GeoPos &center, usz k, InlineArray<u32> &out,
+               InlineArray<f64> *meters = nullptr) const;
+
+  /// Great-circle distance on a sphere of `radius` metres (haversine).
+  static f64 distance(const GeoPos &a, const GeoPos &b,
+                      f64 radius = 6371008.8);
+
+private:
+  InlineArray<f64> _x, _y, _z; // unit vectors in tree order
+  InlineArray<u32> _ids;       // input index of each
+  InlineArray<f32> _boxes;     // min xyz, max xyz per node, level by level
+  InlineArray<usz> _levels;    // first node of each level; leaves first
+
+  void _unit(const GeoPos &g, f64 v[3]) const;
+  f64 _chord2(f64 meters) const;
+};
+
+} // namespace Xi
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "Math.hpp"
 #include "Device.hpp"
+#include "DrawList.hpp"
 #include <vector>
 
 // CRITICAL: Undefine Linux system macros that collide with Diligent
@@ -39,7 +40,7 @@ struct GraphicsContext {
   void setPipelineState(void *pso);
   void commitResources(void *srb);
   void bindResources(void *rtv, void *dsv, int w, int h);
-  void drawMesh(void *vb, void *ib, u32 indices);
+  void drawMesh(void *vb, void *ib, u32 indices, bool index16 = false);
   void createBuffer(void *data, u32 size, bool isIndex, void **buf);
   void *mapBuffer(void *buffer);
   void unmapBuffer(void *buffer);
@@ -48,6 +49,28 @@ struct GraphicsContext {
 
 extern GraphicsContext gContext;
 
+// DrawList backend on gContext. Keeps the per-instance matrix buffer,
+// grown as needed and refilled (map discard) for each instanced draw.
+class XI_EXPORT GraphicsDrawBackend : public DrawBackend {
+public:
+  ~GraphicsDrawBackend() override;
+
+  void setPipeline(void *pipeline) override;
+  void setTexture(void *slot, void *texture) override;
+  void commit(void *bindings) override;
+  void setMesh(void *vertices, void *indices, bool index16) override;
+  void setUniforms(void *uniforms, const Matrix4 &mvp,
+                   const Matrix4 &world) override;
+  void draw(u32 indexCount) override;
+  void drawInstanced(u32 indexCount, const Matrix4 *worlds,
+                     u32 count) override;
+
+private:
+  void *_instances = nullptr;
+  u32 _capacity = 0; // matrices
+  bool _index16 = false;
+};
+
 // 2. The Window-Specific Context
 struct SwapContext {
   Diligent::RefCntAutoPtr<Diligent::ISwapChain> chain;
@@ -0,0 +1,121 @@
+#ifndef XI_HIERARCHY_HPP
+#define XI_HIERARCHY_HPP
+
+#include "InlineArray.hpp"
+#include "Math.hpp"
+#include "Spatial.hpp"
+
+namespace Xi {
+class TreeItem;
+class WorkerPool;
+
+// -------------------------------------------------------------------------
+// TransformHierarchy — Flattened scene graph with incremental world matrices
+// -------------------------------------------------------------------------
+
+/**
+ * @brief A whole scene's parent links, local TRS and world matrices in flat
+ * arrays, parents always before children.
+ *
+ * Changing a node's local transform marks it dirty. update() composes every
+ * dirty local matrix in one SoA batch, then rewrites world matrices only in
+ * the subtrees under dirty nodes. Disjoint subtrees can go to a WorkerPool.
+ * World matrices follow Camera3: world = local * parentWorld.
+ */
+class XI_EXPORT TransformHierarchy {
+public:
+  static constexpr u32 None = ~(u32)0;
+
+  /// Appends a node under @p parent (None for a root). Returns its index,
+  /// or None if @p parent does not exist.
+  u32 add(u32 parent, Vector3 position = {0, 0, 0},
+          Vector3 rotation = {0, 0, 0}, Vector3 scale = {1, 1, 1});
+
+  /// Appends a node that mirrors @p source; sync() picks up its changes.
+  /// The Transform must outlive the hierarchy or be removed with clear().
+  u32 add(u32 parent, const Transform *source);
+
+  /**
+   * @brief Appends every Transform in the subtree at @p root, depth first.
+   * Items that are not Transforms are skipped and their children attach to
+   * the nearest Transform above, as when Camera3 renders the tree.
+   * @return Number of nodes added.
+   */
+  usz addTree(TreeItem *root, u32 parent = None);
+
+  usz size() const { return _parent.size(); }
+  u32 parent(u32 i) const { return _parent[i]; }
+  const Transform *source(u32 i) const { return _source[i]; }
+
+  Vector3 position(u32 i) const { return plane3(0, i); }
+  Vector3 rotation(u32 i) const { return plane3(3, i); }
+  Vector3 scale(u32 i) const { return plane3(6, i); }
+
+  void setPosition(u32 i, Vector3 p) {
+    setPlane3(0, i, p);
+    touch(i);
+  }
+  void setRotation(u32 i, Vector3 r) {
+    setPlane3(3, i, r);
+    touch(i);
+  }
+  void setScale(u32 i, Vector3 s) {
+    setPlane3(6, i, s);
+    touch(i);
+  }
+
+  /// Marks @p i for recomputation by the next update().
+  void touch(u32 i) {
+    if (_dirty[i])
+      return;
+    _dirty[i] = 1;
+    _pending.push(i);
+  }
+
+  /// Number of nodes marked since the last update().
+  usz dirtyCount() const { return _pending.size(); }
+
+  /// Copies TRS from bound sources whose transformVersion moved and marks
+  /// those nodes. Returns how many changed.
+  usz sync();
+
+  /// Recomputes dirty local matrices and the world matrices below them.
+  /// Returns the number of world matrices written.
+  usz update(WorkerPool *pool = nullptr);
+
+  const Matrix4 &local(u32 i) const { return _local[i]; }
+  const Matrix4 &world(u32 i) const { return _world[i]; }
+  const Matrix4 *worlds() const { return _world.data(); }
+
+  /// Bumped whenever world(i) is rewritten.
+  u32 worldVersion(u32 i) const { return _worldVersion[i]; }
+
+  void clear();
+
+private:
+  InlineArray<u32> _parent, _firstChild, _lastChild, _nextSibling;
+  InlineArray<f32> _trs[9]; // SoA planes: position, rotation, scale (x y z)
+  InlineArray<Matrix4> _local, _world;
+  InlineArray<u32> _worldVersion;
+  InlineArray<const Transform *> _source;
+  InlineArray<u32> _sourceVersion, _bound; // _bound: nodes with a source
+  InlineArray<u8> _dirty;
+  InlineArray<u32> _pending;
+  InlineArray<f32> _scratch; // batch compose planes
+
+  Vector3 plane3(usz p, u32 i) const {
+    return {_trs[p][i], _trs[p + 1][i], _trs[p + 2][i]};
+  }
+  void setPlane3(usz p, u32 i, Vector3 v) {
+    _trs[p][i] = v.x;
+    _trs[p + 1][i] = v.y;
+    _trs[p + 2][i] = v.z;
+  }
+
+  void composeLocals();
+  usz walk(u32 root);
+};
+
+} // namespace Xi
+
+#endif // XI_HIERARCHY_HPP
@@ -0,0 +1,101 @@
+#ifndef XI_HOST_MEMORY_HPP
+#define XI_HOST_MEMORY_HPP
+
+#include "Device.hpp"
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// CpuMemoryDevice — Host memory with page size, NUMA and paging control
+// -------------------------------------------------------------------------
+
+/**
+ * @brief IMemoryDevice for large CPU buffers (sample arrays, journals).
+ *
+ * Small requests are plain aligned heap allocations. Requests at or above
+ * `config.mapThreshold` are mapped directly and can use explicit huge pages,
+ * be bound to a NUMA node and be prefaulted so the first pass over the data
+ * does not pay for page faults. If a huge page reservation fails the mapping
+ * falls back to normal pages with transparent huge pages requested.
+ *
+ * The device is host-visible (map() returns the CPU pointer), so arrays that
+ * live on it are used like any other array:
+ *
+ * @code
+ *   CpuMemoryDevice mem;
+ *   mem.config.pages = CpuMemoryDevice::Huge2M;
+ *   mem.config.numaNode = 0;
+ *   InlineArray<f32> samples;
+ *   samples.allocateOn(&mem, 1 << 28);
+ * @endcode
+ *
+ * Huge pages and NUMA binding are Linux only; elsewhere the device hands out
+ * aligned heap or mmap'd memory.
+ */
+class XI_EXPORT CpuMemoryDevice : public MemoryDevice {
+public:
+  enum Pages : u8 {
+    Normal = 0,  ///< Base pages, no hint
+    Transparent, ///< Base pages with MADV_HUGEPAGE (THP)
+    Huge2M,      ///< Explicit 2 MiB hugetlb pages
+    Huge1G,      ///< Explicit 1 GiB hugetlb pages
+  };
+
+  enum Advice : u8 {
+    AdviseNone = 0,
+    AdviseSequential = 1 << 0, ///< Streaming access, read ahead aggressively
+    AdviseRandom = 1 << 1,     ///< No read-ahead
+    AdviseWillNeed = 1 << 2,   ///< Fault in soon
+    AdviseDontDump = 1 << 3,   ///< Exclude from core dumps
+    AdviseDontFork = 1 << 4,   ///< Not inherited by child processes
+  };
+
+  struct Config {
+    Pages pages = Transparent;
+    i32 numaNode = -1;            ///< -1 = no binding
+    bool prefault = false;        ///< Touch every page at allocation time
+    u8 advice = AdviseNone;       ///< Advice bits applied to mappings
+    usz alignment = 64;           ///< Minimum alignment of heap allocations
+    usz mapThreshold = 1u << 20;  ///< Smaller requests use the heap
+  };
+
+  Config config;
+
+  // Statistics
+  usz liveBytes = 0;     ///< Bytes requested by live allocations
+  usz mappedBytes = 0;   ///< Bytes reserved by live mappings (page-rounded)
+  usz hugeMappings = 0;  ///< Live mappings backed by hugetlb pages
+  usz hugeFallbacks = 0; ///< Hugetlb requests that fell back to base pages
+
+  CpuMemoryDevice() { name = "CpuMemoryDevice"; }
+  explicit CpuMemoryDevice(const Config &c) : config(c) {
+    name = "CpuMemoryDevice";
+  }
+  ~CpuMemoryDevice() override = default;
+
+  void *alloc(usz size) override;
+  void free(void *handle) override;
+  void upload(void *handle, const void *src, usz size) override;
+  void download(void *handle, void *dst, usz size) override;
+  void *view(void *handle, i32 type = 0) override;
+  void *map(void *handle) override { return view(handle); }
+
+  /// Size requested for an allocation.
+  usz sizeOf(void *handle) const;
+
+  /// True if the allocation is backed by hugetlb pages.
+  bool isHuge(void *handle) const;
+
+  /// Applies Advice bits to an existing allocation.
+  bool advise(void *handle, u8 advice);
+
+  /// Binds an existing allocation to a NUMA node (moves resident pages).
+  bool bind(void *handle, i32 numaNode);
+
+  /// Touches every page so later accesses do not fault.
+  void prefault(void *handle);
+};
+
+} // namespace Xi
+
+#endif // XI_HOST_MEMORY_HPP
@@ -363,11 +363,21 @@ public:
    */
   usz size() const { return _length; }
 
+  /**
+   * @brief Elements the current block can hold without reallocating.
+   */
+  usz capacity() const { return block ? block->capacity : 0; }
+
   /**
    * @brief Synonym for size() for JavaScript-like parity.
    */
   usz length_js() const { return _length; }
 
+  /**
+   * @brief data() as an integer, for bindings that cannot hold pointers.
+   */
+  usz address() const { return (usz)_data; }
+
   /**
    * @brief Access element at global index.
    * @param idx Global index.
@@ -434,6 +444,8 @@ public:
 
     if (block->_length + 1 > block->capacity) {
       usz new_cap = block->capacity * 2;
+      if (new_cap < XI_ARRAY_MIN_CAP)
+        new_cap = XI_ARRAY_MIN_CAP;
       Block *old = block;
       Block *nb = Block::allocate(new_cap);
       T *dst = nb->get_data();
@@ -458,9 +470,44 @@ public:
     }
   }
 
+  /**
+   * @brief Append count elements from vals.
+   *
+   * Grows the block once for the whole run and copies straight into it.
+   * Shared blocks, slices and sources inside this array first detach into
+   * a block of their own through push().
+   */
   void pushEach(const T *vals, usz count) {
+    if (count == 0)
+      return;
+    bool owned = !block || (block->useCount == 1 &&
+                            _data == block->get_data() &&
+                            _length == block->_length);
+    bool aliased = block && vals >= block->get_data() &&
+                   vals < block->get_data() + block->capacity;
+    if (!owned || aliased) {
+      InlineArray keep(*this); // vals may point into this block
+      push(vals[0]);
+      pushEach(vals + 1, count - 1);
+      return;
+    }
+    if (!block)
+      offset = 0;
+    usz need = _length + count;
+    if (!block || need > block->capacity) {
+      usz cap = block ? block->capacity * 2 : 0;
+      if (cap < need)
+        cap = need;
+      if (cap < XI_ARRAY_MIN_CAP)
+        cap = XI_ARRAY_MIN_CAP;
+      if (!reserve(cap))
+        return;
+    }
     for (usz i = 0; i < count; ++i)
-      push(vals[i]);
+      new (&_data[_length + i]) T(vals[i]);
+    _length += count;
+    block->_length = _length;
+    new (&_data[_length]) T();
   }
 
   /**
@@ -542,6 +589,8 @@ public:
       new (&_data[_length]) T();
     } else {
       usz new_cap = block->capacity * 2;
+      if (new_cap < XI_ARRAY_MIN_CAP)
+        new_cap = XI_ARRAY_MIN_CAP;
       Block *old = block;
       Block *nb = Block::allocate(new_cap);
       T *dst = nb->get_data();
@@ -581,8 +630,9 @@ public:
       return ret;
     }
 
+    // The vacated slot stays constructed: Block::destroy() still covers it.
     T ret = Xi::Move(_data[0]);
-    _data[0].~T();
+    _data[0] = T();
     _data++;
     _length--;
     offset++;
@@ -768,6 +818,13 @@ public:
    */
   IMemoryDevice *getDevice() const { return block ? block->device : nullptr; }
 
+  /**
+   * @brief Device-side handle of this array's block (nullptr on CPU).
+   */
+  void *getDeviceHandle() const {
+    return block && block->device ? block->deviceHandle : nullptr;
+  }
+
   /**
    * @brief Get the device-specific view of this array's data.
    * For GPU: returns ITextureView* or similar. For CPU: returns nullptr.
@@ -786,9 +843,31 @@ public:
   void wrapDevice(IMemoryDevice *dev, void *handle, usz count) {
     destroy();
     block = Block::wrapDevice(dev, handle, count);
-    _data = nullptr;
+    _data = (T *)dev->map(handle);
+    _length = count;
+    offset = 0;
+  }
+
+  /**
+   * @brief Replace contents with `count` elements allocated on `dev`.
+   * On host-visible devices (IMemoryDevice::map) the array is directly
+   * readable and writable; growing it migrates the data back to the heap.
+   * Elements are not constructed, so this is meant for plain data.
+   */
+  bool allocateOn(IMemoryDevice *dev, usz count) {
+    if (!dev)
+      return allocate(count);
+    destroy();
+    block = Block::allocateDevice(dev, count * sizeof(T));
+    if (!block->deviceHandle) {
+      Block::destroy(block);
+      block = nullptr;
+      return false;
+    }
+    _data = (T *)dev->map(block->deviceHandle);
     _length = count;
     offset = 0;
+    return true;
   }
 
   /**
@@ -802,8 +881,8 @@ public:
       // Already on CPU, but user requested a NEW copy.
       InlineArray<T> res;
       res.allocate(size());
-      if (_length > 0)
-        memcpy(res.data(), data(), _length * sizeof(T));
+      for (usz i = 0; i < _length; ++i)
+        res._data[i] = _data[i];
       res.offset = offset;
       res._rank = _rank;
       if (_dims) {
@@ -858,7 +937,8 @@ public:
     InlineArray<T> result;
     result.destroy();
     result.block = Block::allocateDevice(dev, byteSize);
-    result._data = nullptr; // No CPU-accessible pointer
+    // Host-visible devices keep a CPU pointer; others have none.
+    result._data = (T *)dev->map(result.block->deviceHandle);
     result._length = count;
     result.offset = src.offset;
     result._rank = src._rank;
@@ -1,11 +1,14 @@
 #ifndef XI_MATH_HPP
 #define XI_MATH_HPP
 
+#include "Array.hpp"
+#include "ArrayExpr.hpp"
+#include "ArrayView.hpp"
 #include "Primitives.hpp"
 
 namespace Xi {
 // Forward declarations
-template <typename T> class Array;
+class WorkerPool;
 
 // --- Simple POD Structs ---
 struct Vector2 {
@@ -81,9 +84,52 @@ inline f32 relu(f32 x) { return max(0.0f, x); }
 inline f32 sigmoid(f32 x) { return 1.0f / (1.0f + __builtin_expf(-x)); }
 inline f32 rsqrt(f32 x) { return 1.0f / __builtin_sqrtf(x); }
 
+// --- Vectorized Kernels (f32 buffers) ---
+// SIMD polynomial implementations selected at runtime for the widest
+// instruction set available (AVX-512, AVX2+FMA, SSE2, NEON), with a scalar
+// libm fallback. In-place use (x == y) is fine. Maximum error against the
+// correctly rounded result, measured with dev/bench_simd_math.cpp:
+//   exp, log, tanh 1 ulp; sin, cos, sigmoid 2 ulp.
+// sin/cos hold that for |x| <= 8192 (checked exhaustively); larger inputs
+// are computed with libm. The Approx variants trade accuracy for speed:
+// about 6e-5 relative error, results clamped to [2^-126, 2^128) instead of
+// reaching 0 or infinity.
+namespace Simd {
+void exp(const f32 *x, f32 *y, usz n);
+void log(const f32 *x, f32 *y, usz n);
+void sin(const f32 *x, f32 *y, usz n);
+void cos(const f32 *x, f32 *y, usz n);
+void tanh(const f32 *x, f32 *y, usz n);
+void sigmoid(const f32 *x, f32 *y, usz n);
+void expApprox(const f32 *x, f32 *y, usz n);
+void sigmoidApprox(const f32 *x, f32 *y, usz n);
+
+/// Kernel set in use: "avx512", "avx2", "sse2", "neon", "simd128",
+/// "generic", "scalar".
+const char *isa();
+
+/// Switches to a kernel set by name (null restores the default). Returns
+/// false if this CPU cannot run it. Not thread-safe; call at startup.
+bool use(const char *isa);
+} // namespace Simd
+
+inline f32 expApprox(f32 x) {
+  f32 y;
+  Simd::expApprox(&x, &y, 1);
+  return y;
+}
+inline f32 sigmoidApprox(f32 x) {
+  f32 y;
+  Simd::sigmoidApprox(&x, &y, 1);
+  return y;
+}
+
 // --- Generic Automatic Struct/Vector Overloads ---
+// (Array expressions are excluded; they have their own lazy overloads.)
 #define MATH_FUNC(name)                                                        \
-  template <typename T> inline T name(const T &v) {                            \
+  template <typename T, typename Xi::EnableIf<!IsArrayExpr<T>::Value,          \
+                                              int>::Type = 0>                  \
+  inline T name(const T &v) {                                                  \
     T res = v;                                                                 \
     f32 *pr = reinterpret_cast<f32 *>(&res);                                   \
     const f32 *pv = reinterpret_cast<const f32 *>(&v);                         \
@@ -116,10 +162,14 @@ MATH_FUNC(inverse)
 MATH_FUNC(relu)
 MATH_FUNC(sigmoid)
 MATH_FUNC(rsqrt)
+MATH_FUNC(expApprox)
+MATH_FUNC(sigmoidApprox)
 
 // --- Reductions ---
 // POD Reduction (only for types that are not Arrays)
-template <typename T> inline f32 sum(const T &v) {
+template <typename T,
+          typename Xi::EnableIf<!IsArrayExpr<T>::Value, int>::Type = 0>
+inline f32 sum(const T &v) {
   const f32 *p = reinterpret_cast<const f32 *>(&v);
   f32 s = 0;
   for (usz i = 0; i < sizeof(T) / sizeof(f32); ++i)
@@ -127,7 +177,9 @@ template <typename T> inline f32 sum(const T &v) {
   return s;
 }
 
-template <typename T> inline f32 mean(const T &v) {
+template <typename T,
+          typename Xi::EnableIf<!IsArrayExpr<T>::Value, int>::Type = 0>
+inline f32 mean(const T &v) {
   return sum(v) / (f32)(sizeof(T) / sizeof(f32));
 }
 
@@ -164,17 +216,98 @@ template <> f32 mean<f32>(const Array<f32> &a);
 template <> f32 var<f32>(const Array<f32> &a);
 template <> f32 std<f32>(const Array<f32> &a);
 
+// Fused reductions over element-wise expressions: sum(a * b) never
+// materialises a * b.
+template <typename E> f32 sum(const ArrayExpr<E> &expr) {
+  E e = expr.self();
+  usz n = e.size();
+  f32 s = 0;
+  for (usz i = 0; i < n;) {
+    usz run = e.bind(i, n - i);
+    const E &c = e;
+    _Pragma("omp simd reduction(+ : s)") for (usz k = 0; k < run; ++k) s +=
+        (f32)c.at(k);
+    i += run;
+  }
+  return s;
+}
+template <typename E> f32 mean(const ArrayExpr<E> &expr) {
+  usz n = expr.self().size();
+  return (n == 0) ? 0 : sum(expr) / (f32)n;
+}
+template <typename T> f32 sum(const ArrayView<T> &v) {
+  return sum(ArrayViewRef<T>(v));
+}
+template <typename T> f32 mean(const ArrayView<T> &v) {
+  return mean(ArrayViewRef<T>(v));
+}
+
 // --- Tensor (Element-wise) ---
+// Lazy: the result is an expression that fuses with surrounding operators and
+// is computed when assigned to an Array or passed to evalInto().
+namespace Op {
+#define TS_OP(name)                                                            \
+  struct name {                                                                \
+    template <typename T> struct Batched {                                     \
+      static const bool Value = false;                                         \
+    };                                                                         \
+    template <typename T> static T apply(const T &x) {                         \
+      return Xi::Math::name(x);                                                \
+    }                                                                          \
+  };
+// f32 inputs go through the vectorized kernels a block at a time.
+#define TS_OP_SIMD(name)                                                       \
+  struct name {                                                                \
+    template <typename T> struct Batched {                                     \
+      static const bool Value = IsSame<T, f32>::Value;                         \
+    };                                                                         \
+    template <typename T> static T apply(const T &x) {                         \
+      return Xi::Math::name(x);                                                \
+    }                                                                          \
+    static void batch(const f32 *x, f32 *y, usz n) {                           \
+      Xi::Math::Simd::name(x, y, n);                                           \
+    }                                                                          \
+  };
+TS_OP_SIMD(sin)
+TS_OP_SIMD(cos)
+TS_OP(tan)
+TS_OP(asin)
+TS_OP(acos)
+TS_OP(atan)
+TS_OP_SIMD(tanh)
+TS_OP_SIMD(exp)
+TS_OP_SIMD(log)
+TS_OP(sqrt)
+TS_OP(sqr)
+TS_OP(abs)
+TS_OP(relu)
+TS_OP_SIMD(sigmoid)
+TS_OP(rsqrt)
+TS_OP_SIMD(expApprox)
+TS_OP_SIMD(sigmoidApprox)
+#undef TS_OP
+#undef TS_OP_SIMD
+} // namespace Op
+
 #define TS_W(name)                                                             \
-  template <typename T> Array<T> name(const Array<T> &a) {                     \
-    Array<T> res;                                                              \
-    res.allocate(a.size());                                                    \
-    T *pr = res.data();                                                        \
-    const T *pa = a.data();                                                    \
-    usz n = a.size();                                                          \
-    _Pragma("omp simd") for (usz i = 0; i < n; ++i) pr[i] =                    \
-        Xi::Math::name(pa[i]);                                                 \
-    return res;                                                                \
+  template <typename T>                                                        \
+  typename ArrayUnaryOf<Op::name, ArrayRef<T>>::Type name(const Array<T> &a) { \
+    return typename ArrayUnaryOf<Op::name, ArrayRef<T>>::Type(ArrayRef<T>(a)); \
+  }                                                                            \
+  template <typename T>                                                        \
+  typename ArrayUnaryOf<Op::name, ArrayHold<T>>::Type name(Array<T> &&a) {     \
+    return typename ArrayUnaryOf<Op::name, ArrayHold<T>>::Type(                \
+        ArrayHold<T>(Xi::Move(a)));                                            \
+  }                                                                            \
+  template <typename E>                                                        \
+  typename ArrayUnaryOf<Op::name, E>::Type name(const ArrayExpr<E> &e) {       \
+    return typename ArrayUnaryOf<Op::name, E>::Type(e.self());                 \
+  }                                                                            \
+  template <typename T>                                                        \
+  typename ArrayUnaryOf<Op::name, ArrayViewRef<T>>::Type name(                 \
+      const ArrayView<T> &v) {                                                 \
+    return typename ArrayUnaryOf<Op::name, ArrayViewRef<T>>::Type(             \
+        ArrayViewRef<T>(v));                                                   \
   }
 
 TS_W(sin)
@@ -183,6 +316,7 @@ TS_W(tan)
 TS_W(asin)
 TS_W(acos)
 TS_W(atan)
+TS_W(tanh)
 TS_W(exp)
 TS_W(log)
 TS_W(sqrt)
@@ -191,6 +325,8 @@ TS_W(abs)
 TS_W(relu)
 TS_W(sigmoid)
 TS_W(rsqrt)
+TS_W(expApprox)
+TS_W(sigmoidApprox)
 
 template <typename Arr> Arr softmax(const Arr &a) {
   Arr res;
@@ -257,9 +393,288 @@ Arr matmul(const Arr &a, const Arr &b, usz M, usz N, usz P) {
   return res;
 }
 
+// Explicit specialization for Array<f32> (Tensor): runs on gemm().
+template <>
+Array<f32> matmul<Array<f32>>(const Array<f32> &a, const Array<f32> &b, usz M,
+                              usz N, usz P);
+
+// --- Dense Linear Algebra (row-major, rank-2) ---
+// Packed, cache-blocked products with per-ISA register kernels (the set
+// follows Simd::isa()). Leading dimensions count elements. Passing a
+// WorkerPool splits large products across it; small ones, and a null pool,
+// stay on the calling thread.
+
+/// C = alpha * A * B + beta * C, with A m x k, B k x n and C m x n.
+void gemm(usz m, usz n, usz k, f32 alpha, const f32 *a, usz lda,
+          const f32 *b, usz ldb, f32 beta, f32 *c, usz ldc,
+          WorkerPool *pool = nullptr);
+
+/// C = A * B accumulated exactly in i32 (cannot overflow for k < 2^17).
+void gemm(usz m, usz n, usz k, const i8 *a, usz lda, const i8 *b, usz ldb,
+          i32 *c, usz ldc, WorkerPool *pool = nullptr);
+
+/// y = alpha * A * x + beta * y, with A m x k.
+void gemv(usz m, usz k, f32 alpha, const f32 *a, usz lda, const f32 *x,
+          f32 beta, f32 *y, WorkerPool *pool = nullptr);
+
+/// y = A * x accumulated in i32.
+void gemv(usz m, usz k, const i8 *a, usz lda, const i8 *x, i32 *y,
+          WorkerPool *pool = nullptr);
+
+/**
+ * @brief [m, k] x [k, n] -> [m, n] on shaped Arrays.
+ * @return Empty if either input is not rank 2 or the inner dims differ.
+ */
+Array<f32> matmul(const Array<f32> &a, const Array<f32> &b,
+                  WorkerPool *pool = nullptr);
+Array<i32> matmul(const Array<i8> &a, const Array<i8> &b,
+                  WorkerPool *pool = nullptr);
+
+/// [m, k] x [k] -> [m]. Empty on a shape mismatch.
+Array<f32> matvec(const Array<f32> &a, const Array<f32> &x,
+                  WorkerPool *pool = nullptr);
+Array<i32> matvec(const Array<i8> &a, const Array<i8> &x,
+                  WorkerPool *pool = nullptr);
+
+/// Strided operands (transposed, sliced, broadcast) are packed in place.
+Array<f32> matmul(const ArrayView<f32> &a, const ArrayView<f32> &b,
+                  WorkerPool *pool = nullptr);
+Array<i32> matmul(const ArrayView<i8> &a, const ArrayView<i8> &b,
+                  WorkerPool *pool = nullptr);
+Array<f32> matvec(const ArrayView<f32> &a, const ArrayView<f32> &x,
+                  WorkerPool *pool = nullptr);
+Array<i32> matvec(const ArrayView<i8> &a, const ArrayView<i8> &x,
+                  WorkerPool *pool = nullptr);
+
+/// [m, n] -> [n, m], copied in tiles that fit L1. Other ranks are returned
+/// as they are.
+template <typename T> Array<T> transpose(const Array<T> &a) {
+  if (a.rank() != 2)
+    return a;
+  usz m = a.dim(0), n = a.dim(1);
+  Array<T> src = a; // shares storage; data() flattens only if fragmented
+  const T *s = src.data();
+  Array<T> r;
+  r.allocate(m * n);
+  usz d[2] = {n, m};
+  r.shape(2, d);
+  T *o = r.data();
+  const usz Tile = 32;
+  for (usz i0 = 0; i0 < m; i0 += Tile)
+    for (usz j0 = 0; j0 < n; j0 += Tile) {
+      usz i1 = i0 + Tile < m ? i0 + Tile : m;
+      usz j1 = j0 + Tile < n ? j0 + Tile : n;
+      for (usz j = j0; j < j1; ++j)
+        for (usz i = i0; i < i1; ++i)
+          o[j * m + i] = s[i * n + j];
+    }
+  return r;
+}
+
+// --- Axis Reductions ---
+// Collapse one dimension of a shaped Array: reducing [2, 3, 4] over axis 1
+// gives [2, 4]. Accumulation is in f32, like the whole-array reductions.
+
+/**
+ * @brief Folds dimension @p axis with R::apply(acc, x), starting from
+ * @p init. Empty if @p axis is out of range.
+ */
+template <typename R, typename T>
+Array<f32> reduceAxis(const Array<T> &a, u8 axis, f32 init) {
+  u8 rank = a.rank();
+  if (axis >= rank)
+    return Array<f32>();
+  usz outer = 1, inner = 1, d = a.dim(axis);
+  for (u8 i = 0; i < axis; ++i)
+    outer *= a.dim(i);
+  for (u8 i = axis + 1; i < rank; ++i)
+    inner *= a.dim(i);
+
+  Array<f32> r;
+  r.allocate(outer * inner);
+  if (rank > 2) {
+    usz *keep = new usz[rank - 1];
+    for (u8 i = 0, k = 0; i < rank; ++i)
+      if (i != axis)
+        keep[k++] = a.dim(i);
+    r.shape(rank - 1, keep);
+    delete[] keep;
+  }
+  if (outer * inner == 0)
+    return r;
+
+  Array<T> src = a;
+  const T *s = src.data();
+  f32 *o = r.data();
+  for (usz i = 0; i < outer; ++i) {
+    const T *blk = s + i * d * inner;
+    if (inner == 1) {
+      // Contiguous run: fold into independent lanes so it vectorizes.
+      const usz L = 16;
+      f32 lane[L];
+      for (usz l = 0; l < L; ++l)
+        lane[l] = init;
+      usz t = 0;
+      for (; t + L <= d; t += L) {
+        _Pragma("omp simd") for (usz l = 0; l < L; ++l) lane[l] =
+            R::apply(lane[l], (f32)blk[t + l]);
+      }
+      f32 acc = init;
+      for (usz l = 0; l < L; ++l)
+        acc = R::apply(acc, lane[l]);
+      for (; t < d; ++t)
+        acc = R::apply(acc, (f32)blk[t]);
+      o[i] = acc;
+      continue;
+    }
+    f32 *row = o + i * inner;
+    _Pragma("omp simd") for (usz j = 0; j < inner; ++j) row[j] = init;
+    for (usz t = 0; t < d; ++t) {
+      const T *x = blk + t * inner;
+      _Pragma("omp simd") for (usz j = 0; j < inner; ++j) row[j] =
+          R::apply(row[j], (f32)x[j]);
+    }
+  }
+  return r;
+}
+
+/// Views fold one select() slice at a time, in the view's own strides.
+template <typename R, typename T>
+Array<f32> reduceAxis(const ArrayView<T> &v, u8 axis, f32 init) {
+  u8 rank = v.rank();
+  if (axis >= rank)
+    return Array<f32>();
+  usz d = v.dim(axis), n = 1;
+  for (u8 i = 0; i < rank; ++i)
+    if (i != axis)
+      n *= v.dim(i);
+
+  Array<f32> r;
+  r.allocate(n);
+  if (rank > 2) {
+    usz keep[ArrayView<T>::MaxRank];
+    for (u8 i = 0, k = 0; i < rank; ++i)
+      if (i != axis)
+        keep[k++] = v.dim(i);
+    r.shape(rank - 1, keep);
+  }
+  if (n == 0)
+    return r;
+  f32 *o = r.data();
+
+  if (rank == 1) {
+    ArrayViewRef<T> ref(v);
+    f32 acc = init;
+    for (usz i = 0; i < d;) {
+      usz run = ref.bind(i, d - i);
+      for (usz k = 0; k < run; ++k)
+        acc = R::apply(acc, (f32)ref.at(k));
+      i += run;
+    }
+    o[0] = acc;
+    return r;
+  }
+  _Pragma("omp simd") for (usz i = 0; i < n; ++i) o[i] = init;
+  for (usz t = 0; t < d; ++t) {
+    ArrayViewRef<T> ref(v.select(axis, t));
+    for (usz i = 0; i < n;) {
+      usz run = ref.bind(i, n - i);
+      f32 *row = o + i;
+      const ArrayViewRef<T> &c = ref;
+      _Pragma("omp simd") for (usz k = 0; k < run; ++k) row[k] =
+          R::apply(row[k], (f32)c.at(k));
+      i += run;
+    }
+  }
+  return r;
+}
+
+template <typename T> Array<f32> sum(const ArrayView<T> &v, u8 axis) {
+  return reduceAxis<ArrayOp::Add>(v, axis, 0.0f);
+}
+template <typename T> Array<f32> mean(const ArrayView<T> &v, u8 axis) {
+  Array<f32> r = reduceAxis<ArrayOp::Add>(v, axis, 0.0f);
+  usz d = v.dim(axis);
+  if (d > 1 && axis < v.rank()) {
+    f32 inv = 1.0f / (f32)d, *o = r.data();
+    usz n = r.size();
+    _Pragma("omp simd") for (usz i = 0; i < n; ++i) o[i] *= inv;
+  }
+  return r;
+}
+template <typename T> Array<f32> max(const ArrayView<T> &v, u8 axis) {
+  return reduceAxis<ArrayOp::Max>(v, axis, -__builtin_inff());
+}
+template <typename T> Array<f32> min(const ArrayView<T> &v, u8 axis) {
+  return reduceAxis<ArrayOp::Min>(v, axis, __builtin_inff());
+}
+
+template <typename T> Array<f32> sum(const Array<T> &a, u8 axis) {
+  return reduceAxis<ArrayOp::Add>(a, axis, 0.0f);
+}
+template <typename T> Array<f32> mean(const Array<T> &a, u8 axis) {
+  Array<f32> r = reduceAxis<ArrayOp::Add>(a, axis, 0.0f);
+  usz d = a.dim(axis);
+  if (d > 1 && axis < a.rank()) {
+    f32 inv = 1.0f / (f32)d, *o = r.data();
+    usz n = r.size();
+    _Pragma("omp simd") for (usz i = 0; i < n; ++i) o[i] *= inv;
+  }
+  return r;
+}
+template <typename T> Array<f32> max(const Array<T> &a, u8 axis) {
+  return reduceAxis<ArrayOp::Max>(a, axis, -__builtin_inff());
+}
+template <typename T> Array<f32> min(const Array<T> &a, u8 axis) {
+  return reduceAxis<ArrayOp::Min>(a, axis, __builtin_inff());
+}
+
 Matrix4 multiply(const Matrix4 &a, const Matrix4 &b);
 f32 det(const Matrix4 &m);
 Matrix4 inverse(const Matrix4 &m);
+
+/// Scale, then rotate about x, y and z (radians), then translate.
+Matrix4 compose(Vector3 position, Vector3 rotation, Vector3 scale);
+
+/// p * M for a point (w = 1); column 3 is ignored.
+inline Vector3 transformPoint(const Matrix4 &m, Vector3 p) {
+  return {p.x * m.m[0][0] + p.y * m.m[1][0] + p.z * m.m[2][0] + m.m[3][0],
+          p.x * m.m[0][1] + p.y * m.m[1][1] + p.z * m.m[2][1] + m.m[3][1],
+          p.x * m.m[0][2] + p.y * m.m[1][2] + p.z * m.m[2][2] + m.m[3][2]};
+}
+
+/// v * M for a direction (w = 0).
+inline Vector3 transformVector(const Matrix4 &m, Vector3 v) {
+  return {v.x * m.m[0][0] + v.y * m.m[1][0] + v.z * m.m[2][0],
+          v.x * m.m[0][1] + v.y * m.m[1][1] + v.z * m.m[2][1],
+          v.x * m.m[0][2] + v.y * m.m[1][2] + v.z * m.m[2][2]};
+}
+
+// --- Batch Transforms (SoA) ---
+// Items are stored as planes, one per component: n points are [3, n]
+// (all x, then all y, then all z) and n matrices are [16, n], element
+// (r, c) in plane r * 4 + c. Kernels follow Simd::isa().
+
+/// Affine transform of n points; @p out may equal @p in.
+void transformPoints(const Matrix4 &m, const f32 *in, f32 *out, usz n);
+/// Same, for directions (translation not applied).
+void transformVectors(const Matrix4 &m, const f32 *in, f32 *out, usz n);
+/// c_i = a_i * b_i; @p c may equal @p a but not @p b.
+void multiply(const f32 *a, const f32 *b, f32 *c, usz n);
+/// out_i = compose(position_i, rotation_i, scale_i); inputs are [3, n].
+void compose(const f32 *position, const f32 *rotation, const f32 *scale,
+             f32 *out, usz n);
+
+/// Shaped-Array forms; a wrongly shaped input gives an empty Array.
+Array<f32> transformPoints(const Matrix4 &m, const Array<f32> &points);
+Array<f32> transformVectors(const Matrix4 &m, const Array<f32> &vectors);
+Array<f32> multiply(const Array<f32> &a, const Array<f32> &b);
+Array<f32> compose(const Array<f32> &position, const Array<f32> &rotation,
+                   const Array<f32> &scale);
+
+/// Matrix4[n] to [16, n] planes and back (out holds dim(1) matrices).
+Array<f32> toPlanes(const Matrix4 *m, usz n);
+bool fromPlanes(const Array<f32> &planes, Matrix4 *out);
 } // namespace Math
 
 // --- Vector Operators ---
@@ -1,58 +1,94 @@
 #ifndef XI_MESH
 #define XI_MESH
 
-#include "Graphics.hpp"
-
+#include "Culling.hpp"
+#include "MeshOptimize.hpp"
 #include "Spatial.hpp"
+#include "Vertex.hpp"
 
 namespace Xi {
-#pragma pack(push, 1)
-struct XI_EXPORT Vertex {
-  f32 x, y, z;
-  f32 u, v;
-  f32 nx, ny, nz;
-  u32 j[4];
-  f32 w[4];
-};
-#pragma pack(pop)
-
 struct XI_EXPORT Mesh3 {
   Array<Vertex> vertices;
   Array<u32> indices;
 
+  /// Layout upload() packs the vertices into; the Shader drawing the mesh
+  /// must be created for the same format. vertices stay full precision.
+  VertexFormat format = VertexFormat::Full;
+  /// Upload u16 indices when every index fits.
+  bool index16 = true;
+
   void *_vb = nullptr;
   void *_ib = nullptr;
+  bool _ib16 = false;
+  /// Set after editing vertices or indices. consumeDirty() turns it into
+  /// a pending upload and a boundsRevision bump, and clears it.
   bool dirty = true;
+  /// Bumped whenever the vertex positions may have changed; Camera3
+  /// refreshes a culling box only when the revision it saw moves.
+  u64 boundsRevision = 1;
 
-  void upload() {
-    // We only upload if the mesh is dirty and has data
-    if (!dirty || vertices.length() == 0)
+  /// Same as setting dirty.
+  void touch() { dirty = true; }
+
+  /// Takes up a `dirty` set since the last call. Camera3 calls it for
+  /// every drawable each frame, culled or not, so an edit reaches the
+  /// culling box even when the mesh is never uploaded.
+  void consumeDirty() {
+    if (!dirty)
       return;
+    dirty = false;
+    _uploadPending = true;
+    ++boundsRevision;
+  }
 
-    // Clean up old GPU resources before creating new ones
-    GraphicsContext::release(_vb);
-    GraphicsContext::release(_ib);
-
-    // Since our Array<Vertex> is already packed correctly,
-    // we can pass the pointer directly to the GPU buffer.
-    // This is much faster than the old manual loop!
-    gContext.createBuffer(vertices.data(),
-                          (u32)(vertices.length() * sizeof(Vertex)), false,
-                          &_vb);
-
-    // Upload indices if they exist
-    if (indices.length() > 0) {
-      gContext.createBuffer(indices.data(),
-                            (u32)(indices.length() * sizeof(u32)), true, &_ib);
+  /// Local-space box around the vertex positions, recomputed when
+  /// boundsRevision has moved since the last call.
+  const Bounds &bounds() {
+    consumeDirty();
+    if (_boundsAt != boundsRevision) {
+      _bounds = vertices.length() == 0
+                    ? Bounds()
+                    : Bounds::of(&vertices.data()->x, vertices.length(),
+                                 sizeof(Vertex) / sizeof(f32));
+      _boundsAt = boundsRevision;
     }
-
-    dirty = false;
+    return _bounds;
   }
 
-  ~Mesh3() {
-    GraphicsContext::release(_vb);
-    GraphicsContext::release(_ib);
+  /// Maps the uploaded positions back to local space; goes in front of
+  /// the world matrix.
+  Matrix4 decodeMatrix() { return MeshOpt::decodeMatrix(bounds(), format); }
+
+  /**
+   * @brief Welds identical vertices, then reorders triangles for the
+   * vertex cache and overdraw and vertices for fetch locality. Without
+   * indices the vertices are taken as a triangle list.
+   */
+  void optimize() {
+    usz n = vertices.length(), in = indices.length();
+    if (n == 0)
+      return;
+    InlineArray<Vertex> v;
+    InlineArray<u32> idx;
+    MeshOpt::weld(vertices.data(), n, in ? indices.data() : nullptr, in, v, idx);
+    MeshOpt::optimizeVertexCache(idx.data(), idx.size(), v.size());
+    MeshOpt::optimizeOverdraw(idx.data(), idx.size(), v.data(), v.size());
+    MeshOpt::optimizeVertexFetch(v, idx.data(), idx.size());
+    vertices.set(v.data(), v.size());
+    indices.set(idx.data(), idx.size());
+    touch();
   }
+
+  /// Creates the GPU vertex and index buffers after an edit. Only
+  /// libraries built with XI_BUILD_GRAPHICS have a GPU to upload to;
+  /// elsewhere the software rasterizer reads the mesh in place.
+  void upload();
+
+  bool _uploadPending = false; ///< dirty was consumed, buffers are stale
+  Bounds _bounds;
+  u64 _boundsAt = 0;
+
+  ~Mesh3();
 };
 
 } // namespace Xi
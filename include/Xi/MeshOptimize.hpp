@@ -0,0 +1,98 @@
+#ifndef XI_MESH_OPTIMIZE_HPP
+#define XI_MESH_OPTIMIZE_HPP
+
+#include "Culling.hpp"
+#include "InlineArray.hpp"
+#include "Vertex.hpp"
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// MeshOpt — CPU-side mesh processing for indexed triangle lists
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Offline passes over Vertex data, meant to run once after import,
+ * in this order:
+ *
+ * @code
+ *   MeshOpt::weld(v, vn, idx, in, verts, indices);     // share vertices
+ *   MeshOpt::optimizeVertexCache(indices.data(), in, vn);
+ *   MeshOpt::optimizeOverdraw(indices.data(), in, verts.data(), vn);
+ *   MeshOpt::optimizeVertexFetch(verts, indices.data(), in);
+ * @endcode
+ *
+ * then pack() to a compact layout and narrow() indices to u16 for upload.
+ * Mesh3::optimize() runs the whole chain on a mesh. All passes keep the
+ * triangles themselves (and their winding) intact.
+ */
+namespace MeshOpt {
+
+/// Post-transform cache behaviour of an index buffer under a FIFO cache.
+struct CacheStats {
+  f32 acmr = 0; ///< Vertex shader runs per triangle (0.5 is ideal)
+  f32 atvr = 0; ///< Vertex shader runs per vertex (1 is ideal)
+};
+
+/**
+ * @brief Merges bit-identical vertices. Without @p indices the input is a
+ * triangle list of @p vertexCount vertices. Writes the unique vertices in
+ * first-use order and the rewritten indices.
+ * @return Unique vertex count.
+ */
+XI_EXPORT usz weld(const Vertex *vertices, usz vertexCount, const u32 *indices,
+                   usz indexCount, InlineArray<Vertex> &outVertices,
+                   InlineArray<u32> &outIndices);
+
+/// Reorders triangles for the post-transform vertex cache (Forsyth's
+/// linear-speed algorithm), in place.
+XI_EXPORT void optimizeVertexCache(u32 *indices, usz indexCount,
+                                   usz vertexCount);
+
+/**
+ * @brief Reorders clusters of the cache-optimized order so triangles
+ * facing out from the mesh center come first, cutting overdraw for most
+ * views (Sander et al., "Fast triangle reordering"). Clusters are split
+ * where the cache would restart, and only while ACMR stays within
+ * @p threshold times the input's.
+ */
+XI_EXPORT void optimizeOverdraw(u32 *indices, usz indexCount,
+                                const Vertex *vertices, usz vertexCount,
+                                f32 threshold = 1.05f);
+
+/// Renumbers vertices in the order the indices first use them, so vertex
+/// fetches walk memory forwards. Returns the used vertex count; unused
+/// vertices are dropped.
+XI_EXPORT usz optimizeVertexFetch(InlineArray<Vertex> &vertices, u32 *indices,
+                                  usz indexCount);
+
+XI_EXPORT CacheStats analyzeVertexCache(const u32 *indices, usz indexCount,
+                                        usz vertexCount, u32 cacheSize = 16);
+
+/// Copies indices to u16 if every one fits. Returns false (and leaves
+/// @p out empty) otherwise.
+XI_EXPORT bool narrow(const u32 *indices, usz indexCount, InlineArray<u16> &out);
+
+/**
+ * @brief Encodes @p vertices into @p format, @p out gets
+ * count * vertexStride(format) bytes. Positions are stored relative to
+ * @p bounds; put decodeMatrix(bounds) in front of the world matrix to undo
+ * it (identity for VertexFormat::Full).
+ */
+XI_EXPORT void pack(const Vertex *vertices, usz count, VertexFormat format,
+                    const Bounds &bounds, InlineArray<u8> &out);
+
+XI_EXPORT Matrix4 decodeMatrix(const Bounds &bounds, VertexFormat format);
+
+/// IEEE half conversions, round to nearest even.
+XI_EXPORT u16 toHalf(f32 f);
+XI_EXPORT f32 fromHalf(u16 h);
+
+/// Unit normal to snorm16 octahedral coordinates and back.
+XI_EXPORT void octEncode(f32 x, f32 y, f32 z, i16 *out);
+XI_EXPORT void octDecode(const i16 *in, f32 *xyz);
+
+} // namespace MeshOpt
+} // namespace Xi
+
+#endif // XI_MESH_OPTIMIZE_HPP
@@ -0,0 +1,151 @@
+#ifndef XI_PERF_HPP
+#define XI_PERF_HPP
+
+#include "Primitives.hpp"
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// PerfCounters — Hardware event counts for the calling thread
+// -------------------------------------------------------------------------
+
+/**
+ * @brief perf_event_open counters that follow the thread which opened them.
+ *
+ * Each event is opened on its own so an event the CPU or kernel does not
+ * provide only drops that event. Virtual machines often have no PMU, and
+ * containers often deny perf_event_open; in both cases open() returns
+ * false, or opens only the software events (task clock, page faults), and
+ * available() says which events can be used. Off Linux nothing opens.
+ *
+ * Counts cover user space only, so perf_event_paranoid 2 is enough. When
+ * the kernel multiplexes more events than the PMU holds, read() scales each
+ * count by enabled / running time.
+ *
+ * @code
+ *   PerfCounters pc;
+ *   pc.open();
+ *   PerfCounters::Sample a = pc.read();
+ *   work();
+ *   PerfCounters::Sample d = pc.read() - a;
+ *   f64 ipc = d.ipc();
+ * @endcode
+ */
+class XI_EXPORT PerfCounters {
+public:
+  enum Event : u8 {
+    Cycles = 0,
+    Instructions,
+    BranchMisses,
+    L1dMisses,  ///< L1 data cache read misses
+    LlcMisses,  ///< Last level cache misses
+    DtlbMisses, ///< Data TLB read misses
+    TaskClock,  ///< ns on the CPU (software event)
+    PageFaults, ///< software event
+    EventCount
+  };
+
+  struct Sample {
+    u64 value[EventCount] = {};
+    u32 valid = 0; ///< Bit per Event that was counted
+
+    bool has(Event e) const { return (valid >> e) & 1; }
+    f64 ipc() const {
+      return has(Cycles) && has(Instructions) && value[Cycles]
+                 ? (f64)value[Instructions] / (f64)value[Cycles]
+                 : 0;
+    }
+    Sample operator-(const Sample &o) const {
+      Sample d;
+      d.valid = valid & o.valid;
+      for (int i = 0; i < EventCount; ++i)
+        d.value[i] = value[i] >= o.value[i] ? value[i] - o.value[i] : 0;
+      return d;
+    }
+    Sample &operator+=(const Sample &o) {
+      valid = valid ? valid & o.valid : o.valid;
+      for (int i = 0; i < EventCount; ++i)
+        value[i] += o.value[i];
+      return *this;
+    }
+  };
+
+  PerfCounters();
+  ~PerfCounters();
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  /// Opens every event the system allows. False if none opened.
+  bool open();
+  void close();
+
+  bool isOpen() const { return valid != 0; }
+  bool available(Event e) const { return (valid >> e) & 1; }
+  u32 events() const { return valid; }
+
+  /// Running totals since open(); subtract two reads for a region.
+  Sample read() const;
+
+  /// Short column name ("cycles", "instructions", "llc-misses", ...).
+  static const char *name(Event e);
+
+private:
+  int fds[EventCount];
+  u32 valid = 0;
+};
+
+// -------------------------------------------------------------------------
+// PerfRegion — Counters accumulated by name around library hot paths
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Totals for one XI_PERF_REGION name across all threads.
+ *
+ * Counts are inclusive: a region nested in another is counted in both.
+ */
+struct PerfRegionStats {
+  const char *name = nullptr;
+  u64 calls = 0;
+  u64 ns = 0; ///< Wall time, kept even when no counter opens
+  PerfCounters::Sample counts;
+};
+
+/**
+ * @brief Scoped marker behind XI_PERF_REGION. Each thread opens its own
+ * PerfCounters on first use.
+ *
+ * A marker costs two reads of every open counter (a syscall each, around
+ * a microsecond in total), so markers belong around calls that do real
+ * work, such as a whole Tunnel::parse, not around inner loops.
+ */
+class XI_EXPORT PerfRegion {
+public:
+  explicit PerfRegion(const char *name);
+  ~PerfRegion();
+  PerfRegion(const PerfRegion &) = delete;
+  PerfRegion &operator=(const PerfRegion &) = delete;
+
+  /// Copies up to `max` regions into `out`; returns how many exist.
+  static usz collect(PerfRegionStats *out, usz max);
+  static void reset();
+
+private:
+  usz slot;
+  i64 startNs;
+  PerfCounters::Sample start;
+};
+
+} // namespace Xi
+
+// Region markers compile to nothing unless the library is built with
+// XI_PERF_REGIONS (CMake option of the same name).
+#define XI_PERF_CAT_(a, b) a##b
+#define XI_PERF_CAT(a, b) XI_PERF_CAT_(a, b)
+#ifdef XI_PERF_REGIONS
+#define XI_PERF_REGION(name)                                                   \
+  ::Xi::PerfRegion XI_PERF_CAT(xiPerfRegion, __LINE__)(name)
+#else
+#define XI_PERF_REGION(name) ((void)0)
+#endif
+
+#endif
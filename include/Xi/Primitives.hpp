@@ -156,6 +156,15 @@ template <typename T> struct FNVHasher<T *> {
 
 usz fnvHashMix(usz k);
 
+/// One region copy executed by IMemoryDevice::transfer().
+struct TransferOp {
+    void* handle;    ///< Device allocation
+    usz offset;      ///< Byte offset inside the allocation
+    usz size;        ///< Bytes to copy
+    const void* src; ///< Upload source; null for downloads
+    void* dst;       ///< Download destination; null for uploads
+};
+
 class IMemoryDevice {
 public:
     virtual void* alloc(usz size) = 0;
@@ -164,6 +173,41 @@ public:
     virtual void  download(void* handle, void* dst, usz size) = 0;
     virtual void* view(void* handle, i32 type = 0) = 0;
     virtual void* allocSurface(i32 w, i32 h, i32 channels = 4) = 0;
+    /// CPU pointer to the allocation if the host can address it directly,
+    /// nullptr if data must go through upload()/download().
+    virtual void* map(void* handle) { (void)handle; return nullptr; }
+
+    /// Partial copies. The defaults cover host-visible devices and whole
+    /// allocations; devices with real offsets should override them.
+    virtual bool uploadRange(void* handle, usz offset, const void* src, usz size) {
+        if (u8* p = (u8*)map(handle)) {
+            __builtin_memcpy(p + offset, src, size);
+            return true;
+        }
+        if (offset != 0) return false;
+        upload(handle, src, size);
+        return true;
+    }
+    virtual bool downloadRange(void* handle, usz offset, void* dst, usz size) {
+        if (u8* p = (u8*)map(handle)) {
+            __builtin_memcpy(dst, p + offset, size);
+            return true;
+        }
+        if (offset != 0) return false;
+        download(handle, dst, size);
+        return true;
+    }
+
+    /// Executes a batch of copies in order. Devices with a command queue
+    /// override this to turn a batch into one submission.
+    virtual void transfer(const TransferOp* ops, usz count) {
+        for (usz i = 0; i < count; ++i) {
+            const TransferOp& op = ops[i];
+            if (op.src) uploadRange(op.handle, op.offset, op.src, op.size);
+            else downloadRange(op.handle, op.offset, op.dst, op.size);
+        }
+    }
+
     virtual ~IMemoryDevice() = default;
 };
 
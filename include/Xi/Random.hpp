@@ -5,18 +5,114 @@
 
 namespace Xi {
 
-extern u32 _randomPool[20];
-extern bool _randomInitialized;
-extern u32 _secureCounter;
+// -------------------------------------------------------------------------
+// RandomStream — xoshiro256** with jump-ahead
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Fast, non-cryptographic generator (period 2^256 - 1).
+ *
+ * jump() advances by 2^128 draws and longJump() by 2^192, so streams
+ * split off one seed never overlap. fill() runs eight such streams side
+ * by side on SIMD lanes; the first bulk fill splits them off with jump()
+ * and later fills continue them, so its bytes differ from those of
+ * repeated next() calls.
+ */
+class XI_EXPORT RandomStream {
+public:
+  RandomStream() { seed(0); }
+  explicit RandomStream(u64 s) { seed(s); }
+
+  void seed(u64 s);
+  /// Seeds from the operating system's entropy source.
+  void seedFromEntropy();
+
+  u64 next64() {
+    u64 *s = _s;
+    u64 r = rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+    s[2] ^= s[0], s[3] ^= s[1], s[1] ^= s[2], s[0] ^= s[3];
+    s[2] ^= t, s[3] = rotl(s[3], 45);
+    return r;
+  }
+  u32 next() { return (u32)(next64() >> 32); }
+
+  void jump();
+  void longJump();
+  void fill(u8 *buffer, usz size);
+
+private:
+  u64 _s[4];
+  u64 _lanes[4][8] = {}; // fill() streams, one per lane
+  bool _split = false;
+
+  static u64 rotl(u64 x, int k) { return (x << k) | (x >> (64 - k)); }
+  void _jump(const u64 poly[4]);
+};
+
+// -------------------------------------------------------------------------
+// SecureRandom — Buffered ChaCha20 with fast key erasure
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Cryptographic generator keyed from the OS entropy source.
+ *
+ * Each refill runs ChaCha20 under the current key, takes the first 32
+ * bytes of keystream as the next key and overwrites the old one, so
+ * state captured later cannot reproduce earlier output. Small requests
+ * are served from a buffer that is wiped as it is handed out; large ones
+ * are written straight to the caller, rekeying every Chunk bytes. The
+ * state is reseeded after fork() and every Reseed bytes.
+ */
+class XI_EXPORT SecureRandom {
+public:
+  static const usz Buffer = 1024 - 32; // one refill is 16 blocks
+  static const usz Chunk = 64 * 1024;
+  static const u64 Reseed = 1ull << 30;
+
+  SecureRandom() = default;
+  SecureRandom(const SecureRandom &) = delete;
+  SecureRandom &operator=(const SecureRandom &) = delete;
+  ~SecureRandom();
+
+  void fill(u8 *buffer, usz size);
+  /// Drops buffered output and rekeys from OS entropy.
+  void reseed();
+
+private:
+  u8 _key[32];
+  u8 _buffer[Buffer];
+  usz _available = 0;
+  u64 _sinceSeed = 0;
+  u32 _generation = 0; // fork count at seeding; 0 = not seeded
+
+  void _refill();
+};
+
+/// The calling thread's generators, created on first use. Each thread's
+/// RandomStream is split off the process seed with longJump(); the
+/// first thread to ask gets the seed itself. The process seed comes from
+/// OS entropy until randomSeed() replaces it.
+RandomStream &threadRandom();
+SecureRandom &threadSecureRandom();
+
+/// Fills from the OS entropy source (getrandom / urandom / esp_random).
+/// Slow; use it for keys and seeds only.
+void entropyFill(u8 *buffer, usz size);
+
+// --- Calling thread's generators ---
 
 u32 randomNext();
+/// Replaces the process seed, deterministically or from OS entropy. The
+/// calling thread restarts on it and threads started later split off it;
+/// threads already running keep their streams, so seed before spawning.
 void randomSeed(u32 s);
 void randomSeed();
 u32 random(u32 max);
 i32 random(i32 min, i32 max);
 f32 randomFloat();
 void randomFill(u8 *buffer, usz size);
+void secureRandomFill(u8 *buffer, usz size);
 
 } // namespace Xi
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,128 @@
+#ifndef XI_RASTER_HPP
+#define XI_RASTER_HPP
+
+#include "Device.hpp"
+#include "InlineArray.hpp"
+#include "Math.hpp"
+#include "Vertex.hpp"
+
+namespace Xi {
+class WorkerPool;
+struct RasterTri;
+
+/// RGBA8 pixels, rows top to bottom.
+struct XI_EXPORT RasterTexture {
+  const u8 *rgba = nullptr;
+  i32 width = 0, height = 0;
+};
+
+// -------------------------------------------------------------------------
+// SoftwareRenderingDevice — CPU rasterizer behind the rendering device API
+// -------------------------------------------------------------------------
+
+/**
+ * @brief A DeviceRenderingDevice that keeps its allocations in host memory
+ * and draws Mesh3 vertex data on the CPU, so rendering works without a GPU.
+ *
+ * Surfaces from allocSurface() are RGBA8 color plus an f32 depth buffer,
+ * and every view() of an allocation is its handle. Camera3 uses the device
+ * when it is its `device`; it can also be driven directly:
+ *
+ * @code
+ *   SoftwareRenderingDevice sw;
+ *   void *target = sw.allocSurface(640, 480);
+ *   sw.begin(target);
+ *   sw.draw(vertices, vertexCount, indices, indexCount, mvp, world);
+ *   sw.flush();
+ *   const u8 *rgba = (const u8 *)sw.map(target);
+ * @endcode
+ *
+ * The pipeline matches the GPU one Shader sets up: triangle lists, no face
+ * culling (unless cullBack), depth test LESS, D3D clip space (row vectors, clip = p * mvp,
+ * depth 0..1), bilinear clamped texture sampling. In place of a pixel
+ * shader the texture (or white) is lit by one directional light per vertex.
+ *
+ * flush() transforms and sets up triangles, bins them into 64x64 tiles and
+ * rasterizes the tiles 8 pixels at a time, on `pool` when one is set. Tiles
+ * draw their triangles in submission order, so output does not depend on
+ * the number of threads.
+ */
+class XI_EXPORT SoftwareRenderingDevice : public DeviceRenderingDevice {
+public:
+  static constexpr i32 TileSize = 64;
+
+  struct Stats {
+    usz draws = 0;
+    usz triangles = 0; ///< Submitted
+    usz rejected = 0;  ///< Outside the frustum, zero area or culled
+    usz binned = 0;    ///< Triangle-tile pairs
+    usz fragments = 0; ///< Pixels that passed the depth test
+  };
+
+  WorkerPool *pool = nullptr;
+  u32 clearColor = 0xff000000u; ///< RGBA8 in memory order, as a u32
+  Vector3 lightDir = {0.3f, -0.5f, 0.8f}; ///< Direction the light travels
+  f32 ambient = 0.3f;
+  bool bilinear = true;
+  /// Skip counter-clockwise (back facing, as in D3D) triangles. Off like
+  /// the GPU pipeline, which draws both sides.
+  bool cullBack = false;
+  Stats stats;
+
+  SoftwareRenderingDevice();
+  ~SoftwareRenderingDevice() override; // out of line: RasterTri is private
+
+  void *alloc(usz size) override;
+  void *allocSurface(i32 w, i32 h, i32 channels = 4) override;
+  void free(void *handle) override;
+  void upload(void *handle, const void *src, usz size) override;
+  void download(void *handle, void *dst, usz size) override;
+  void *view(void *handle, i32 type = 0) override;
+  void *map(void *handle) override;
+
+  i32 width(void *handle) const;
+  i32 height(void *handle) const;
+
+  /// Texture view of @p pixels: its surface size if it lives on this
+  /// device, otherwise a square of size()/4 pixels (empty if not square).
+  RasterTexture texture(const String &pixels) const;
+
+  /// Makes @p target (a 4-channel surface of this device) the render
+  /// target, optionally clearing color to clearColor and depth to 1.
+  /// Resets stats.
+  bool begin(void *target, bool clear = true);
+
+  /**
+   * @brief Queues a triangle list. Without @p indices the vertices are
+   * taken in order. Vertex, index and texture memory must stay valid until
+   * flush().
+   */
+  void draw(const Vertex *vertices, usz vertexCount, const u32 *indices,
+            usz indexCount, const Matrix4 &mvp, const Matrix4 &world,
+            const RasterTexture &texture = RasterTexture());
+
+  /// Rasterizes everything queued since begin() or the last flush().
+  /// Returns the number of fragments written.
+  usz flush();
+
+private:
+  struct DrawCall {
+    const Vertex *vertices;
+    const u32 *indices;
+    usz vertexCount, triangleCount;
+    usz firstVertex, firstTriangle; // into the frame-wide arrays
+    Matrix4 mvp, world;
+    RasterTexture texture;
+  };
+
+  void *_target = nullptr;
+  InlineArray<DrawCall> _draws;
+  InlineArray<f32> _clip;       // 8 floats per vertex: x y z w u v light -
+  InlineArray<RasterTri> _tris; // one batch of set-up triangles
+  InlineArray<u32> _binStart;   // per tile, into _bins
+  InlineArray<u32> _bins;
+};
+
+} // namespace Xi
+
+#endif // XI_RASTER_HPP
@@ -0,0 +1,122 @@
+#ifndef XI_SCHEDULER_HPP
+#define XI_SCHEDULER_HPP
+
+#include "Array.hpp"
+#include "Device.hpp"
+#include "Func.hpp"
+#include "Worker.hpp"
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// DeviceScheduler — Parallel update() with dependencies and rate limits
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Runs Device::update() (or any update callback) for a set of nodes
+ * once per tick, in parallel where dependencies allow.
+ *
+ * A node starts as soon as every node it depends on has finished this tick,
+ * so a slow sensor only delays the nodes that actually consume it. Nodes with
+ * a rate limit are skipped until their period has elapsed. A skipped node
+ * counts as finished for its dependents.
+ *
+ * update() runs on worker threads: devices must not touch the same state
+ * unless one depends on the other. Windows and GL contexts that are bound to
+ * one thread should stay out of the scheduler and be updated by the caller.
+ *
+ * @code
+ *   DeviceScheduler sched;
+ *   usz imu = sched.add(mpu, 200.0);
+ *   usz gps = sched.add(gpsDev, 10.0);
+ *   usz fuse = sched.add([]() { space.update(); });
+ *   sched.dependsOn(fuse, imu);
+ *   sched.dependsOn(fuse, gps);
+ *   for (;;) sched.tick();
+ * @endcode
+ */
+class XI_EXPORT DeviceScheduler {
+public:
+  static constexpr usz None = ~(usz)0;
+
+  struct Stats {
+    u64 runs = 0;        ///< update() calls
+    u64 skipped = 0;     ///< Ticks skipped by the rate limit
+    i64 lastMicros = 0;  ///< Duration of the latest update()
+    i64 maxMicros = 0;   ///< Longest update() seen
+    i64 totalMicros = 0; ///< Sum over all runs
+
+    f64 averageMicros() const {
+      return runs ? (f64)totalMicros / (f64)runs : 0.0;
+    }
+  };
+
+  WorkerPool *pool;
+
+  u64 ticks = 0;
+  i64 lastTickMicros = 0; ///< Wall time of the latest tick()
+  i64 maxTickMicros = 0;
+
+  explicit DeviceScheduler(WorkerPool &p = WorkerPool::shared()) : pool(&p) {}
+  ~DeviceScheduler();
+
+  DeviceScheduler(const DeviceScheduler &) = delete;
+  DeviceScheduler &operator=(const DeviceScheduler &) = delete;
+
+  /**
+   * @brief Registers a device. @p hz limits how often update() runs
+   * (0 = every tick).
+   * @return Node id, or the existing id if the device was already added.
+   */
+  usz add(Device *device, f64 hz = 0);
+
+  /// Registers a plain update callback (e.g. sensor fusion).
+  usz add(Func<void()> update, f64 hz = 0);
+
+  /**
+   * @brief Adds @p root and its Device::devices subtree. Each parent depends
+   * on its children, so a parent sees fresh child state.
+   * @return Node id of @p root.
+   */
+  usz addTree(Device *root, f64 hz = 0);
+
+  /**
+   * @brief Makes @p node wait for @p dependency within a tick.
+   * @return false for unknown ids or if the edge would create a cycle.
+   */
+  bool dependsOn(usz node, usz dependency);
+
+  /// Changes the rate limit of a node (0 = every tick).
+  bool setRate(usz node, f64 hz);
+
+  /// Node id of a registered device, or None.
+  usz find(Device *device) const;
+
+  const Stats *stats(usz node) const;
+  usz size() const { return nodes.size(); }
+
+  /**
+   * @brief Runs every due node once, blocking until all have finished.
+   * The calling thread helps the pool while it waits.
+   * @return Number of update() calls made.
+   */
+  usz tick();
+
+  /// Zeroes per-node and per-tick statistics.
+  void resetStats();
+
+private:
+  struct Node;
+  Array<Node *> nodes;
+  WorkerPool::Group group;
+  std::atomic<usz> ran{0};
+
+  usz insert(Node *n, f64 hz);
+  bool reaches(usz from, usz to) const;
+  void dispatch(Node *n);
+  void complete(Node *n);
+};
+
+} // namespace Xi
+
+#endif // XI_SCHEDULER_HPP
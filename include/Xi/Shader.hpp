@@ -2,6 +2,7 @@
 #define XI_SHADER
 
 #include "Graphics.hpp"
+#include "Vertex.hpp"
 #include <cstdio>
 
 namespace Xi {
@@ -12,12 +13,41 @@ struct XI_EXPORT Shader {
   void *_pso = nullptr;
   void *_srb = nullptr;
   void *_cb = nullptr;
+  // Pixel shader g_Texture / g_Texture_sampler, looked up once in create()
+  void *_texVar = nullptr;
+  void *_samplerVar = nullptr;
+
+  /// Vertex layout the input assembler reads; match the Mesh3 format.
+  /// Compact formats deliver position as float4 (w = 1, in the mesh's
+  /// quantization box, see Mesh3::decodeMatrix) and the normal as float2
+  /// octahedral coordinates; the vertex shader source is prefixed with
+  /// `#define XI_VERTEX_COMPACT 1` and `float3 xiOctDecode(float2)`.
+  VertexFormat format = VertexFormat::Full;
+
+  /// Read the world matrix per instance, as ATTRIB5..ATTRIB8 (its rows)
+  /// from a second vertex buffer, so Camera3 draws renderables sharing a
+  /// mesh and texture in one call. Primitives.g_MVP then holds the
+  /// view-projection and g_Model the identity. The vertex source is
+  /// prefixed with `#define XI_INSTANCED 1`.
+  bool instanced = false;
 
   void create() {
     if (_pso)
       return;
     printf("Xi: Shader::create() VS length: %d\n", (int)vertexSource.length());
-    createShader(vertexSource.c_str(), pixelSource.c_str(), &_pso, &_srb, &_cb);
+    String vs;
+    if (instanced)
+      vs += "#define XI_INSTANCED 1\n";
+    if (format != VertexFormat::Full)
+      vs += "#define XI_VERTEX_COMPACT 1\n"
+            "float3 xiOctDecode(float2 e) {\n"
+            "  float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+            "  if (n.z < 0.0)\n"
+            "    n.xy = (1.0 - abs(n.yx)) * (n.xy >= 0.0 ? 1.0 : -1.0);\n"
+            "  return normalize(n);\n"
+            "}\n";
+    vs += vertexSource;
+    createShader(vs.c_str(), pixelSource.c_str(), &_pso, &_srb, &_cb);
     if (!_pso) {
       printf("Error: Shader PSO creation FAILED!\n");
     } else {
@@ -65,7 +95,7 @@ private:
         Diligent::PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     P.GraphicsPipeline.RasterizerDesc.CullMode = Diligent::CULL_MODE_NONE;
 
-    // This array tells Diligent how to map your 64-byte C++ struct to the GPU
+    // These arrays tell Diligent how to map the Vertex.hpp structs to the GPU
     Diligent::LayoutElement LayoutElems[] = {
         // Attribute 0: Position (float3)
         {0, 0, 3, Diligent::VT_FLOAT32, false, 0xFFFFFFFF},
@@ -77,9 +107,28 @@ private:
         {3, 0, 4, Diligent::VT_UINT32, false, 0xFFFFFFFF},
         // Attribute 4: Weights (float4)
         {4, 0, 4, Diligent::VT_FLOAT32, false, 0xFFFFFFFF}};
+    Diligent::LayoutElement CompactElems[] = {
+        // Position (snorm16 x4), UV (half2), octahedral normal (snorm16 x2)
+        {0, 0, 4, Diligent::VT_INT16, true, 0xFFFFFFFF},
+        {1, 0, 2, Diligent::VT_FLOAT16, false, 0xFFFFFFFF},
+        {2, 0, 2, Diligent::VT_INT16, true, 0xFFFFFFFF},
+        // Joints (u8 x4), weights (unorm8 x4), skinned only
+        {3, 0, 4, Diligent::VT_UINT8, false, 0xFFFFFFFF},
+        {4, 0, 4, Diligent::VT_UINT8, true, 0xFFFFFFFF}};
 
-    P.GraphicsPipeline.InputLayout.LayoutElements = LayoutElems;
-    P.GraphicsPipeline.InputLayout.NumElements = 5;
+    Diligent::LayoutElement Elems[9];
+    u32 count = format == VertexFormat::Compact ? 3 : 5;
+    for (u32 i = 0; i < count; ++i)
+      Elems[i] = format == VertexFormat::Full ? LayoutElems[i] : CompactElems[i];
+    // World matrix rows, per instance from buffer slot 1
+    for (u32 r = 0; instanced && r < 4; ++r)
+      Elems[count++] = Diligent::LayoutElement{
+          5 + r, 1, 4, Diligent::VT_FLOAT32, false,
+          Diligent::LAYOUT_ELEMENT_AUTO_OFFSET,
+          Diligent::LAYOUT_ELEMENT_AUTO_STRIDE,
+          Diligent::INPUT_ELEMENT_FREQUENCY_PER_INSTANCE};
+    P.GraphicsPipeline.InputLayout.LayoutElements = Elems;
+    P.GraphicsPipeline.InputLayout.NumElements = count;
     P.pVS = VS;
     P.pPS = PS;
 
@@ -106,6 +155,20 @@ private:
             ->GetVariableByName(Diligent::SHADER_TYPE_VERTEX, "Primitives");
     if (v)
       v->Set((Diligent::IBuffer *)*cb);
+
+    auto *srbp = (Diligent::IShaderResourceBinding *)*srb;
+    _texVar = srbp->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture");
+    auto *sampler =
+        srbp->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture_sampler");
+    _samplerVar = sampler;
+    if (sampler) {
+      static Diligent::RefCntAutoPtr<Diligent::ISampler> pDefaultSampler;
+      if (!pDefaultSampler) {
+        Diligent::SamplerDesc SamDesc;
+        gContext.device->CreateSampler(SamDesc, &pDefaultSampler);
+      }
+      sampler->Set(pDefaultSampler);
+    }
   }
 };
 } // namespace Xi
@@ -0,0 +1,131 @@
+#ifndef XI_SHARED_MEMORY_HPP
+#define XI_SHARED_MEMORY_HPP
+
+#include "Device.hpp"
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// SharedMemoryDevice — Slab-allocated region shared between processes
+// -------------------------------------------------------------------------
+
+/**
+ * @brief IMemoryDevice whose blocks live in a memfd/shm region that several
+ * processes map at once.
+ *
+ * Handles are offsets into the region, not pointers, so a handle produced in
+ * one process is valid in every process that attached the same region. Each
+ * block carries an atomic reference count in the shared header; free() drops
+ * one reference and the block returns to the slab when the last process lets
+ * go. The region also holds a bounded lock-free ring of handles for handing
+ * blocks to another process without a copy.
+ *
+ * @code
+ *   // Producer
+ *   SharedMemoryDevice shm;
+ *   shm.create(64 << 20);            // then pass shm.fd() over a socket
+ *   String payload;
+ *   payload.allocateOn(&shm, n);     // fill payload.data()
+ *   shm.send(payload.getDeviceHandle());
+ *
+ *   // Consumer
+ *   shm.attach(fd);
+ *   String payload = shm.receive<u8>(); // zero-copy, refcounted
+ * @endcode
+ *
+ * Needs POSIX shared memory (memfd_create on Linux, shm_open elsewhere);
+ * on other targets create() and attach() return false.
+ */
+class XI_EXPORT SharedMemoryDevice : public MemoryDevice {
+public:
+  static constexpr usz MinBlock = 64;  ///< Smallest slab class (with header)
+  static constexpr usz Classes = 21;   ///< 64 B ... 64 MiB
+  static constexpr u32 RingSlots = 1024;
+
+  SharedMemoryDevice() { name = "SharedMemoryDevice"; }
+  ~SharedMemoryDevice() override { close(); }
+
+  SharedMemoryDevice(const SharedMemoryDevice &) = delete;
+  SharedMemoryDevice &operator=(const SharedMemoryDevice &) = delete;
+
+  /**
+   * @brief Creates and maps a new region of @p bytes.
+   * @param shmName If set, a named POSIX shm object (e.g. "/xi-rho") that
+   * other processes can attach by name; otherwise an anonymous memfd whose
+   * descriptor must be passed along (fork, SCM_RIGHTS).
+   */
+  bool create(usz bytes, const char *shmName = nullptr);
+
+  /// Maps a region created by another process from its descriptor.
+  bool attach(int fd);
+
+  /// Maps a named region.
+  bool attach(const char *shmName);
+
+  /// Unmaps the region. Blocks still referenced elsewhere stay valid there.
+  void close();
+
+  /// Removes a named region from the namespace (existing mappings survive).
+  static bool unlink(const char *shmName);
+
+  bool isValid() const { return base != nullptr; }
+  int fd() const { return handleFd; }
+  usz size() const { return mappedSize; }
+
+  /// Bytes handed out from the region so far (high-water mark).
+  usz usedBytes() const;
+
+  // --- IMemoryDevice ---
+  void *alloc(usz size) override;
+  void free(void *handle) override;
+  void upload(void *handle, const void *src, usz size) override;
+  void download(void *handle, void *dst, usz size) override;
+  void *view(void *handle, i32 type = 0) override;
+  void *map(void *handle) override { return view(handle); }
+
+  // --- Cross-process ownership ---
+
+  /// Adds a reference to a block (e.g. before handing it to another process).
+  void retain(void *handle);
+
+  /// Current reference count of a block (0 if the handle is invalid).
+  u32 refCount(void *handle) const;
+
+  /// Size requested when the block was allocated.
+  usz sizeOf(void *handle) const;
+
+  /**
+   * @brief Queues a handle on the shared ring. Takes its own reference,
+   * so the sender may keep or drop its array independently.
+   * @return false if the ring is full.
+   */
+  bool send(void *handle);
+
+  /// Dequeues a handle; the caller owns the reference. nullptr if empty.
+  void *receive();
+
+  /**
+   * @brief Dequeues a block and wraps it as an array without copying.
+   * The array frees its reference through this device when destroyed.
+   */
+  template <typename T> InlineArray<T> receive() {
+    InlineArray<T> out;
+    if (void *h = receive())
+      out.wrapDevice(this, h, sizeOf(h) / sizeof(T));
+    return out;
+  }
+
+private:
+  struct Header;
+  u8 *base = nullptr;
+  usz mappedSize = 0;
+  int handleFd = -1;
+
+  Header *header() const { return (Header *)base; }
+  bool mapFd(int fd, usz bytes, bool init);
+  bool validHandle(void *handle) const;
+};
+
+} // namespace Xi
+
+#endif // XI_SHARED_MEMORY_HPP
@@ -57,20 +57,59 @@ protected:
 };
 
 struct SphereConfig {
-  f32 a; // Semi-major axis (e.g., 6378137.0 for Earth)
-  f32 f; // Flattening (e.g., 1/298.257223563 for Earth)
+  f64 a; // Semi-major axis (e.g., 6378137.0 for Earth)
+  f64 f; // Flattening (e.g., 1/298.257223563 for Earth)
 };
 
 struct GeoPos {
-  f32 lat, lng, alt;
+  f64 lat, lng, alt; // degrees, degrees, metres above the ellipsoid
 };
 
+/// Earth-centred, earth-fixed coordinates in metres.
+struct Ecef {
+  f64 x, y, z;
+};
+
+/// East, north, up in metres from a local origin.
+struct Enu {
+  f64 e, n, u;
+};
+
+// -------------------------------------------------------------------------
+// GeodeticSphere — Conversions on the configured ellipsoid, in f64
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Geodetic (lat, lng, alt) <-> ECEF <-> local ENU on the ellipsoid
+ * described by `config` (WGS 84 by default; f = 0 gives a sphere).
+ *
+ * ECEF -> geodetic uses two Bowring iterations, which agree with the
+ * exact solution to well under a micrometre from the centre of the Earth
+ * out past geostationary orbit. The batch forms take structure-of-arrays
+ * input and run on f64 SIMD lanes (SSE2/NEON, AVX2 when available);
+ * input and output arrays may be the same.
+ */
 class XI_EXPORT GeodeticSphere {
 public:
   SphereConfig config;
 
   GeodeticSphere();
+  /// Treats the transform's position as ECEF metres.
   GeoPos getGeoPos(const Transform &t) const;
+
+  Ecef toEcef(const GeoPos &g) const;
+  GeoPos toGeo(const Ecef &p) const;
+  Enu toEnu(const GeoPos &origin, const Ecef &p) const;
+  Ecef fromEnu(const GeoPos &origin, const Enu &p) const;
+
+  void toEcef(const f64 *lat, const f64 *lng, const f64 *alt, f64 *x, f64 *y,
+              f64 *z, usz n) const;
+  void toGeo(const f64 *x, const f64 *y, const f64 *z, f64 *lat, f64 *lng,
+             f64 *alt, usz n) const;
+  void toEnu(const GeoPos &origin, const f64 *x, const f64 *y, const f64 *z,
+             f64 *e, f64 *nn, f64 *u, usz n) const;
+  void fromEnu(const GeoPos &origin, const f64 *e, const f64 *nn,
+               const f64 *u, f64 *x, f64 *y, f64 *z, usz n) const;
 };
 
 class XI_EXPORT Spatial : public Transform {
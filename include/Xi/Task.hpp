@@ -0,0 +1,500 @@
+#ifndef XI_TASK_HPP
+#define XI_TASK_HPP
+
+#include "Func.hpp"
+#include "Primitives.hpp"
+
+// The coroutine layer is optional: it only exists when the translation unit
+// is compiled as C++20 (or later) with coroutine support. Everything else in
+// Xi stays C++17 and callback based.
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#define XI_HAS_COROUTINES 1
+#endif
+#endif
+
+#ifdef XI_HAS_COROUTINES
+
+#include <atomic>
+#include <coroutine>
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// FramePool — Size-classed free lists for coroutine frames
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Recycles coroutine frames so that steady-state Task creation does not
+ * touch the heap.
+ *
+ * Frames are rounded up to 64-byte granules and kept in per-thread free lists.
+ * Awaiting never allocates: every awaiter lives inside the frame that awaits.
+ */
+struct FramePool {
+  static constexpr usz Granule = 64;
+  static constexpr usz Classes = 64; ///< Frames above 4 KiB bypass the pool
+
+  struct Node {
+    Node *next;
+  };
+
+  Node *freeList[Classes] = {};
+  usz live = 0;       ///< Frames currently alive
+  usz liveBytes = 0;  ///< Bytes held by live frames (rounded to granules)
+  usz pooled = 0;     ///< Frames parked in the free lists
+  usz heapAllocs = 0; ///< Calls that had to reach ::operator new
+
+  static FramePool &local() {
+    static thread_local FramePool pool;
+    return pool;
+  }
+
+  void *allocate(usz size) {
+    usz cls = (size + Granule - 1) / Granule;
+    live++;
+    if (cls >= Classes) {
+      liveBytes += size;
+      heapAllocs++;
+      return ::operator new(size);
+    }
+    liveBytes += cls * Granule;
+    if (Node *n = freeList[cls]) {
+      freeList[cls] = n->next;
+      pooled--;
+      return n;
+    }
+    heapAllocs++;
+    return ::operator new(cls * Granule);
+  }
+
+  void release(void *p, usz size) {
+    usz cls = (size + Granule - 1) / Granule;
+    if (live > 0)
+      live--;
+    if (cls >= Classes) {
+      liveBytes -= (liveBytes >= size) ? size : liveBytes;
+      ::operator delete(p);
+      return;
+    }
+    usz bytes = cls * Granule;
+    liveBytes -= (liveBytes >= bytes) ? bytes : liveBytes;
+    Node *n = (Node *)p;
+    n->next = freeList[cls];
+    freeList[cls] = n;
+    pooled++;
+  }
+
+  /// Return all parked frames to the heap.
+  void trim() {
+    for (usz i = 0; i < Classes; ++i) {
+      while (Node *n = freeList[i]) {
+        freeList[i] = n->next;
+        ::operator delete(n);
+      }
+    }
+    pooled = 0;
+  }
+
+  ~FramePool() { trim(); }
+};
+
+template <typename T = void> class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+  std::coroutine_handle<> continuation;
+  bool detached = false;
+
+  static void *operator new(usz size) {
+    return FramePool::local().allocate(size);
+  }
+  static void operator delete(void *p, usz size) {
+    FramePool::local().release(p, size);
+  }
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+
+  struct FinalAwaiter {
+    bool await_ready() noexcept { return false; }
+
+    template <typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept {
+      TaskPromiseBase &p = h.promise();
+      if (p.continuation)
+        return p.continuation;
+      if (p.detached)
+        h.destroy();
+      return std::noop_coroutine();
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  FinalAwaiter final_suspend() noexcept { return {}; }
+
+  // Xi is built without exceptions; an escaping one is a programming error.
+  void unhandled_exception() noexcept { __builtin_abort(); }
+};
+
+template <typename T> struct TaskPromise : TaskPromiseBase {
+  alignas(T) u8 storage[sizeof(T)];
+  bool hasValue = false;
+
+  Task<T> get_return_object() noexcept;
+
+  template <typename U> void return_value(U &&v) {
+    new (storage) T(static_cast<U &&>(v));
+    hasValue = true;
+  }
+
+  T &value() { return *reinterpret_cast<T *>(storage); }
+
+  ~TaskPromise() {
+    if (hasValue)
+      value().~T();
+  }
+};
+
+template <> struct TaskPromise<void> : TaskPromiseBase {
+  Task<void> get_return_object() noexcept;
+  void return_void() noexcept {}
+};
+
+} // namespace detail
+
+// -------------------------------------------------------------------------
+// Task<T> — Lazily started, awaitable coroutine
+// -------------------------------------------------------------------------
+
+/**
+ * @brief A lazily started coroutine producing a T.
+ *
+ * A Task does nothing until it is awaited, start()ed or detach()ed. Awaiting
+ * a Task uses symmetric transfer, so deep await chains do not grow the stack
+ * in optimized builds (GCC only emits the required tail call from -O1 up).
+ */
+template <typename T> class XI_EXPORT Task {
+public:
+  using promise_type = detail::TaskPromise<T>;
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() : handle(nullptr) {}
+  explicit Task(Handle h) : handle(h) {}
+
+  Task(Task &&o) noexcept : handle(o.handle) { o.handle = nullptr; }
+  Task &operator=(Task &&o) noexcept {
+    if (this != &o) {
+      reset();
+      handle = o.handle;
+      o.handle = nullptr;
+    }
+    return *this;
+  }
+
+  Task(const Task &) = delete;
+  Task &operator=(const Task &) = delete;
+
+  ~Task() { reset(); }
+
+  bool isValid() const { return handle != nullptr; }
+  bool done() const { return !handle || handle.done(); }
+
+  /**
+   * @brief Runs the task until its first suspension point.
+   */
+  void start() {
+    if (handle && !handle.done())
+      handle.resume();
+  }
+
+  /**
+   * @brief Starts the task and gives up ownership; the frame frees itself
+   * when the coroutine finishes.
+   */
+  void detach() {
+    if (!handle)
+      return;
+    Handle h = handle;
+    handle = nullptr;
+    h.promise().detached = true;
+    h.resume();
+  }
+
+  /**
+   * @brief Moves the result out of a finished task.
+   */
+  T result() {
+    if constexpr (!IsSame<T, void>::Value)
+      return Xi::Move(handle.promise().value());
+  }
+
+  // --- Awaitable interface ---
+  bool await_ready() const noexcept { return done(); }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) {
+    handle.promise().continuation = awaiting;
+    return handle;
+  }
+
+  T await_resume() { return result(); }
+
+private:
+  Handle handle;
+
+  void reset() {
+    if (handle) {
+      handle.destroy();
+      handle = nullptr;
+    }
+  }
+};
+
+namespace detail {
+template <typename T> Task<T> TaskPromise<T>::get_return_object() noexcept {
+  return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+inline Task<void> TaskPromise<void>::get_return_object() noexcept {
+  return Task<void>(
+      std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+} // namespace detail
+
+// -------------------------------------------------------------------------
+// EventLoop — Single-threaded scheduler for suspended coroutines
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Intrusive scheduling record. Awaiters embed one, so scheduling a
+ * coroutine never allocates.
+ */
+struct XI_EXPORT ScheduleNode {
+  std::coroutine_handle<> handle;
+  ScheduleNode *next = nullptr;
+  i64 deadline = 0; ///< micros(), only meaningful for timers
+};
+
+class XI_EXPORT EventLoop {
+public:
+  /// Called by run() when nothing is ready: poll sockets, pump devices, ...
+  Func<void()> onIdle;
+
+  /// Optional executor for blocking work (e.g. a worker pool). When unset,
+  /// blocking work runs on the loop itself on its next tick.
+  Func<void(Func<void()>)> executor;
+
+  EventLoop() = default;
+  EventLoop(const EventLoop &) = delete;
+  EventLoop &operator=(const EventLoop &) = delete;
+
+  /**
+   * @brief Queues a suspended coroutine to be resumed on the next tick.
+   * Must be called from the loop's own thread; use post() otherwise.
+   */
+  void schedule(ScheduleNode *n) {
+    n->next = nullptr;
+    if (tail)
+      tail->next = n;
+    else
+      head = n;
+    tail = n;
+  }
+
+  /**
+   * @brief Thread-safe variant of schedule().
+   */
+  void post(ScheduleNode *n) {
+    ScheduleNode *top = remote.load(std::memory_order_relaxed);
+    do {
+      n->next = top;
+    } while (!remote.compare_exchange_weak(top, n, std::memory_order_release,
+                                           std::memory_order_relaxed));
+  }
+
+  /**
+   * @brief Parks a node until micros() reaches its deadline.
+   */
+  void scheduleAt(ScheduleNode *n) {
+    ScheduleNode **at = &timers;
+    while (*at && (*at)->deadline <= n->deadline)
+      at = &(*at)->next;
+    n->next = *at;
+    *at = n;
+  }
+
+  /**
+   * @brief Resumes everything that is ready right now.
+   * @return Number of coroutines resumed.
+   */
+  usz runOnce() {
+    drainRemote();
+    i64 now = Xi::micros();
+    while (timers && timers->deadline <= now) {
+      ScheduleNode *n = timers;
+      timers = n->next;
+      schedule(n);
+    }
+
+    // Only run what was queued before this tick; anything scheduled while
+    // resuming waits for the next one so yield() is fair.
+    ScheduleNode *last = tail;
+    usz count = 0;
+    while (head) {
+      ScheduleNode *n = head;
+      head = n->next;
+      if (!head)
+        tail = nullptr;
+      // The node lives in the coroutine's frame; decide before resuming it.
+      bool stop = (n == last);
+      n->handle.resume();
+      count++;
+      if (stop)
+        break;
+    }
+    return count;
+  }
+
+  /**
+   * @brief Runs until no coroutine is ready, timed or expected from another
+   * thread. onIdle is invoked whenever the loop would otherwise spin.
+   */
+  void run() {
+    while (pending()) {
+      if (runOnce() == 0 && onIdle.isValid())
+        onIdle();
+    }
+  }
+
+  /**
+   * @brief Drives the loop until the given task has finished.
+   */
+  template <typename T> void runUntil(const Task<T> &task) {
+    while (!task.done()) {
+      if (runOnce() == 0 && onIdle.isValid())
+        onIdle();
+    }
+  }
+
+  bool pending() const {
+    return head || timers || inFlight.load(std::memory_order_acquire) > 0 ||
+           remote.load(std::memory_order_acquire);
+  }
+
+  /// Bookkeeping for work handed to the executor (keeps run() alive).
+  void beginExternal() { inFlight.fetch_add(1, std::memory_order_acq_rel); }
+  void endExternal(ScheduleNode *n) {
+    post(n);
+    inFlight.fetch_sub(1, std::memory_order_acq_rel);
+  }
+
+  // --- Awaitables ---
+
+  struct YieldAwaiter {
+    EventLoop *loop;
+    ScheduleNode node;
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) {
+      node.handle = h;
+      loop->schedule(&node);
+    }
+    void await_resume() const noexcept {}
+  };
+
+  struct SleepAwaiter {
+    EventLoop *loop;
+    i64 us;
+    ScheduleNode node;
+    bool await_ready() const noexcept { return us <= 0; }
+    void await_suspend(std::coroutine_handle<> h) {
+      node.handle = h;
+      node.deadline = Xi::micros() + us;
+      loop->scheduleAt(&node);
+    }
+    void await_resume() const noexcept {}
+  };
+
+  /// Let every other ready coroutine run once before continuing.
+  YieldAwaiter yield() { return YieldAwaiter{this, {}}; }
+
+  /// Suspend for at least `ms` milliseconds.
+  SleepAwaiter sleep(u64 ms) { return SleepAwaiter{this, (i64)ms * 1000, {}}; }
+
+  /// Suspend for at least `us` microseconds.
+  SleepAwaiter sleepMicros(u64 us) { return SleepAwaiter{this, (i64)us, {}}; }
+
+private:
+  ScheduleNode *head = nullptr;
+  ScheduleNode *tail = nullptr;
+  ScheduleNode *timers = nullptr;
+  std::atomic<ScheduleNode *> remote{nullptr};
+  std::atomic<usz> inFlight{0};
+
+  void drainRemote() {
+    ScheduleNode *n = remote.exchange(nullptr, std::memory_order_acquire);
+    // The remote stack is LIFO; reverse it to keep posting order.
+    ScheduleNode *rev = nullptr;
+    while (n) {
+      ScheduleNode *next = n->next;
+      n->next = rev;
+      rev = n;
+      n = next;
+    }
+    while (rev) {
+      ScheduleNode *next = rev->next;
+      schedule(rev);
+      rev = next;
+    }
+  }
+};
+
+// -------------------------------------------------------------------------
+// BlockingAwaiter — Runs a blocking call off the coroutine
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Awaitable wrapping a blocking operation (file I/O, sensor reads).
+ *
+ * The operation runs on EventLoop::executor when one is set, otherwise on the
+ * loop's next tick. Either way the awaiting coroutine resumes on the loop.
+ * The closure captures only the awaiter's address, so it stays inside
+ * Func's inline buffer.
+ */
+template <typename R, typename Op> struct BlockingAwaiter {
+  EventLoop *loop;
+  Op op;
+  R value{};
+  ScheduleNode node;
+
+  bool await_ready() const noexcept { return false; }
+
+  void await_suspend(std::coroutine_handle<> h) {
+    node.handle = h;
+    BlockingAwaiter *self = this;
+    if (loop->executor.isValid()) {
+      loop->beginExternal();
+      loop->executor(Func<void()>([self]() {
+        self->value = self->op();
+        self->loop->endExternal(&self->node);
+      }));
+    } else {
+      // No executor: do the work now and resume on the next tick, so the
+      // caller still observes a suspension point.
+      value = op();
+      loop->schedule(&node);
+    }
+  }
+
+  R await_resume() { return Xi::Move(value); }
+};
+
+template <typename R, typename Op>
+BlockingAwaiter<R, Op> blocking(EventLoop &loop, Op op) {
+  return BlockingAwaiter<R, Op>{&loop, Xi::Move(op), R(), {}};
+}
+
+} // namespace Xi
+
+#endif // XI_HAS_COROUTINES
+
+#endif // XI_TASK_HPP
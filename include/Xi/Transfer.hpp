@@ -0,0 +1,272 @@
+#ifndef XI_TRANSFER_HPP
+#define XI_TRANSFER_HPP
+
+#include "Array.hpp"
+#include "Device.hpp"
+#include "InlineArray.hpp"
+#include "Worker.hpp"
+#include <atomic>
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// DirtyRanges — Modified byte/element ranges awaiting re-upload
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Sorted, non-overlapping [begin, end) ranges. Ranges closer than
+ * `mergeGap` are joined, trading a few redundant bytes for fewer copies.
+ */
+struct XI_EXPORT DirtyRanges {
+  struct Range {
+    usz begin, end;
+  };
+
+  InlineArray<Range> ranges;
+  usz mergeGap = 0;
+
+  void mark(usz begin, usz end) {
+    if (end <= begin)
+      return;
+    // Find the first range that could touch [begin, end).
+    usz i = 0, n = ranges.size();
+    while (i < n && ranges[i].end + mergeGap < begin)
+      i++;
+    if (i == n || end + mergeGap < ranges[i].begin) {
+      insertAt(i, Range{begin, end});
+      return;
+    }
+    // Absorb every range that now overlaps.
+    Range &r = ranges[i];
+    if (begin < r.begin)
+      r.begin = begin;
+    if (end > r.end)
+      r.end = end;
+    usz j = i + 1;
+    while (j < n && ranges[j].begin <= r.end + mergeGap) {
+      if (ranges[j].end > r.end)
+        r.end = ranges[j].end;
+      j++;
+    }
+    eraseRange(i + 1, j);
+  }
+
+  void markAll(usz size) {
+    clear();
+    mark(0, size);
+  }
+
+  void clear() { ranges = InlineArray<Range>(); }
+  bool empty() const { return ranges.size() == 0; }
+  usz size() const { return ranges.size(); }
+  const Range &operator[](usz i) const { return ranges[i]; }
+
+  /// Total length covered by the ranges.
+  usz total() const {
+    usz t = 0;
+    for (usz i = 0; i < ranges.size(); ++i)
+      t += ranges[i].end - ranges[i].begin;
+    return t;
+  }
+
+private:
+  void insertAt(usz at, Range r) {
+    ranges.push(r);
+    for (usz k = ranges.size() - 1; k > at; --k)
+      ranges[k] = ranges[k - 1];
+    ranges[at] = r;
+  }
+
+  void eraseRange(usz from, usz to) {
+    usz n = ranges.size();
+    if (from >= to)
+      return;
+    for (usz k = to; k < n; ++k)
+      ranges[from + k - to] = ranges[k];
+    for (usz k = 0; k < to - from; ++k)
+      ranges.pop();
+  }
+};
+
+// -------------------------------------------------------------------------
+// TransferQueue — Batched, asynchronous IMemoryDevice copies with fences
+// -------------------------------------------------------------------------
+
+/**
+ * @brief Records uploads and downloads and hands them to the device in
+ * batches, optionally on a worker thread.
+ *
+ * Uploads smaller than `stageBelow` are copied into the batch's staging
+ * buffer when they are recorded, so the caller may reuse its memory at once.
+ * Consecutive staged uploads to adjacent ranges of the same allocation are
+ * merged into one copy. Larger uploads and all downloads touch caller
+ * memory when the batch executes: keep it alive until the batch's fence
+ * has completed.
+ *
+ * Batches execute in submission order. With a WorkerPool they run off the
+ * calling thread and overlap with whatever it does next; without one,
+ * submit() executes the batch before returning.
+ *
+ * @code
+ *   TransferQueue q(device, &WorkerPool::shared());
+ *   q.upload(gpuSamples, samples, dirty); // only modified ranges
+ *   q.upload(gpuBones, boneData, n);
+ *   u64 fence = q.submit();
+ *   simulateNextFrame();              // overlaps with the copies
+ *   q.wait(fence);
+ * @endcode
+ */
+class XI_EXPORT TransferQueue {
+public:
+  IMemoryDevice *device;
+  WorkerPool *pool;
+
+  usz stageBelow = 64 * 1024; ///< Uploads below this are staged + coalesced
+
+  // Statistics (updated at submit time)
+  u64 batches = 0;
+  u64 recordedOps = 0;  ///< upload()/download() calls
+  u64 submittedOps = 0; ///< Ops after coalescing
+  u64 stagedBytes = 0;
+  u64 directBytes = 0;
+
+  explicit TransferQueue(IMemoryDevice &dev, WorkerPool *p = nullptr)
+      : device(&dev), pool(p) {}
+  ~TransferQueue();
+
+  TransferQueue(const TransferQueue &) = delete;
+  TransferQueue &operator=(const TransferQueue &) = delete;
+
+  /// Copies @p size bytes from @p src to the allocation at @p offset.
+  void upload(void *handle, usz offset, const void *src, usz size);
+
+  /// Copies @p size bytes at @p offset of the allocation into @p dst.
+  void download(void *handle, usz offset, void *dst, usz size);
+
+  /// Uploads @p count elements into a device-resident array.
+  template <typename T>
+  void upload(const InlineArray<T> &target, const T *src, usz count,
+              usz first = 0) {
+    upload(target.getDeviceHandle(), first * sizeof(T), src,
+           count * sizeof(T));
+  }
+
+  /**
+   * @brief Uploads only the dirty element ranges of @p src into the
+   * device-resident @p target, then clears @p dirty.
+   */
+  template <typename T>
+  void upload(const InlineArray<T> &target, const InlineArray<T> &src,
+              DirtyRanges &dirty) {
+    void *h = target.getDeviceHandle();
+    for (usz i = 0; i < dirty.size(); ++i) {
+      usz b = dirty[i].begin, e = dirty[i].end;
+      if (e > src.size())
+        e = src.size();
+      if (b < e)
+        upload(h, b * sizeof(T), src.data() + b, (e - b) * sizeof(T));
+    }
+    dirty.clear();
+  }
+
+  /// Downloads a device-resident array into @p dst.
+  template <typename T>
+  void download(const InlineArray<T> &source, T *dst, usz count,
+                usz first = 0) {
+    download(source.getDeviceHandle(), first * sizeof(T), dst,
+             count * sizeof(T));
+  }
+
+  /**
+   * @brief Closes the recording batch and queues it for execution.
+   * @return Fence value; done(fence) turns true once the batch has run.
+   * Submitting an empty batch returns the latest fence.
+   */
+  u64 submit();
+
+  bool done(u64 fence) const {
+    return completed.load(std::memory_order_acquire) >= fence;
+  }
+
+  /// Blocks (helping the pool) until @p fence has completed.
+  void wait(u64 fence);
+
+  /// submit() + wait() for everything recorded so far.
+  void flush() { wait(submit()); }
+
+  u64 lastFence() const { return nextFence - 1; }
+
+private:
+  struct Record {
+    TransferOp op;
+    usz stagingAt; ///< Offset into staging, or ~0 for direct ops
+  };
+  struct Batch {
+    InlineArray<u8> staging;
+    InlineArray<TransferOp> ops;
+    u64 fence;
+  };
+
+  InlineArray<Record> recording;
+  InlineArray<u8> staging;
+
+  u64 nextFence = 1;
+  std::atomic<u64> completed{0};
+
+  // Submitted batches, drained in order by one job at a time.
+  Array<Batch *> queued;
+  std::atomic_flag queueLock = ATOMIC_FLAG_INIT;
+  bool draining = false;
+  WorkerPool::Group group;
+
+  void lock() {
+    while (queueLock.test_and_set(std::memory_order_acquire)) {
+    }
+  }
+  void unlock() { queueLock.clear(std::memory_order_release); }
+  void drain();
+};
+
+// -------------------------------------------------------------------------
+// EmulatedMemoryDevice — Discrete-device stand-in for tests and benchmarks
+// -------------------------------------------------------------------------
+
+/**
+ * @brief A MemoryDevice that behaves like memory behind a bus: the CPU cannot
+ * map it, and every call pays a fixed latency plus a bandwidth cost.
+ * transfer() is one submission for the whole batch, like a GPU copy queue
+ * fed from a staging buffer.
+ */
+class XI_EXPORT EmulatedMemoryDevice : public MemoryDevice {
+public:
+  i64 callMicros = 20;      ///< Fixed cost per submission
+  f64 bytesPerMicro = 8000; ///< ~8 GB/s link
+
+  // Statistics
+  u64 calls = 0;
+  u64 bytes = 0;
+
+  EmulatedMemoryDevice() { name = "EmulatedMemoryDevice"; }
+
+  void *alloc(usz size) override;
+  void free(void *handle) override;
+  void upload(void *handle, const void *src, usz size) override;
+  void download(void *handle, void *dst, usz size) override;
+  bool uploadRange(void *handle, usz offset, const void *src,
+                   usz size) override;
+  bool downloadRange(void *handle, usz offset, void *dst, usz size) override;
+  void transfer(const TransferOp *ops, usz count) override;
+
+  /// Direct access to the emulated storage, for validation only.
+  const u8 *contents(void *handle) const;
+
+private:
+  void charge(usz n, bool newCall);
+  u8 *range(void *handle, usz offset, usz size);
+  bool write(void *handle, usz offset, const void *src, usz size);
+  bool read(void *handle, usz offset, void *dst, usz size);
+};
+
+} // namespace Xi
+
+#endif // XI_TRANSFER_HPP
@@ -0,0 +1,52 @@
+#ifndef XI_VERTEX_HPP
+#define XI_VERTEX_HPP
+
+#include "Primitives.hpp"
+
+namespace Xi {
+#pragma pack(push, 1)
+struct XI_EXPORT Vertex {
+  f32 x, y, z;
+  f32 u, v;
+  f32 nx, ny, nz;
+  u32 j[4];
+  f32 w[4];
+};
+
+// -------------------------------------------------------------------------
+// Quantized GPU layouts (see MeshOpt::pack)
+// -------------------------------------------------------------------------
+
+/// 16 bytes: snorm16 position in the mesh's bounds (w unused), half uv,
+/// snorm16 octahedral normal.
+struct XI_EXPORT CompactVertex {
+  i16 p[4];
+  u16 uv[2];
+  i16 n[2];
+};
+
+/// 24 bytes: CompactVertex plus u8 joints and unorm8 weights summing to 255.
+struct XI_EXPORT CompactSkinnedVertex {
+  i16 p[4];
+  u16 uv[2];
+  i16 n[2];
+  u8 j[4];
+  u8 w[4];
+};
+#pragma pack(pop)
+
+/// What Mesh3 uploads and Shader's input layout expects.
+enum class VertexFormat : u8 {
+  Full,          ///< Vertex, 64 bytes
+  Compact,       ///< CompactVertex, 16 bytes
+  CompactSkinned ///< CompactSkinnedVertex, 24 bytes
+};
+
+inline usz vertexStride(VertexFormat f) {
+  return f == VertexFormat::Compact          ? sizeof(CompactVertex)
+         : f == VertexFormat::CompactSkinned ? sizeof(CompactSkinnedVertex)
+                                             : sizeof(Vertex);
+}
+} // namespace Xi
+
+#endif // XI_VERTEX_HPP
@@ -0,0 +1,81 @@
+#ifndef XI_WORKER_HPP
+#define XI_WORKER_HPP
+
+#include "Func.hpp"
+#include "Primitives.hpp"
+#include <atomic>
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// WorkerPool — Fixed set of threads draining a shared job queue
+// -------------------------------------------------------------------------
+
+/**
+ * @brief A small thread pool for fork/join style work.
+ *
+ * Jobs are Func<void()> closures; keep captures small so they stay inside the
+ * Func inline buffer. Waiting on a Group helps: the waiting thread runs queued
+ * jobs itself instead of blocking, so nested waits cannot deadlock and a pool
+ * with zero workers still makes progress.
+ *
+ * On targets without threads (Arduino, FreeRTOS, single-threaded WASM) the
+ * pool has no workers and every job runs inside wait().
+ *
+ * @code
+ *   WorkerPool::Group g;
+ *   for (usz i = 0; i < n; ++i)
+ *     pool.submit([&, i]() { work(i); }, &g);
+ *   pool.wait(g);
+ * @endcode
+ */
+class XI_EXPORT WorkerPool {
+public:
+  /// Completion counter for a set of jobs.
+  struct Group {
+    std::atomic<usz> pending{0};
+    bool done() const { return pending.load(std::memory_order_acquire) == 0; }
+  };
+
+  /**
+   * @param threads Worker count. 0 picks hardwareThreads() - 1, leaving one
+   * core for the thread that calls wait().
+   */
+  explicit WorkerPool(usz threads = 0);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  /// Number of worker threads (not counting threads that help in wait()).
+  usz size() const { return workerCount; }
+
+  /// Queues a job. If `group` is set it is counted until the job returns.
+  void submit(Func<void()> job, Group *group = nullptr);
+
+  /// Runs queued jobs on the calling thread until `group` is done.
+  void wait(Group &group);
+
+  /**
+   * @brief Splits [0, count) into chunks of at least `grain` and runs
+   * body(begin, end) for each, blocking until all chunks are done.
+   */
+  void parallelFor(usz count, const Func<void(usz, usz)> &body, usz grain = 1);
+
+  /// Logical CPU count reported by the platform (1 if unknown).
+  static usz hardwareThreads();
+
+  /// Process-wide pool, created on first use.
+  static WorkerPool &shared();
+
+private:
+  struct Impl;
+  Impl *impl;
+  usz workerCount = 0;
+
+  bool runOne();
+};
+
+} // namespace Xi
+
+#endif // XI_WORKER_HPP
@@ -0,0 +1,522 @@
+#include <Hardware/Fusion.hpp>
+
+// -------------------------------------------------------------------------
+// Three implementations of the same Mahony step:
+//   Scalar  the filter from the old HardwareSpatial::fuseSensors, per lane.
+//   Vector  one GCC vector lane per sensor (4 or 8 wide), stepping every
+//           sensor's k-th sample together; lanes without one are masked.
+//   Fixed   quaternion and errors in Q30, gyro and gains in Q16, i64
+//           products. Samples arrive as floats and are converted once.
+// Every path reads the per-sample accept flags that _screen() computed.
+// -------------------------------------------------------------------------
+
+#if defined(__GNUC__) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define XI_FUSION_VECTOR
+#if defined(__x86_64__) || defined(__i386__)
+#define XI_FUSION_X86
+#endif
+#endif
+
+#define XI_FINLINE inline __attribute__((always_inline))
+
+namespace Xi {
+
+namespace {
+
+const f32 DegToRad = 3.14159265f / 180.0f;
+const u64 MaxStepNS = 100000000ULL; // longer gaps integrate as this
+const u32 MaxRepeats = 8;
+
+XI_FINLINE f32 rsqrt(f32 x) { return 1.0f / Math::sqrt(x); }
+
+XI_FINLINE f32 stepSeconds(u64 t, u64 last) {
+    if (t <= last) return 0;
+    u64 d = t - last;
+    return (f32)(d < MaxStepNS ? d : MaxStepNS) * 1e-9f;
+}
+
+#ifdef XI_FUSION_VECTOR
+
+// Vector values only cross always_inline boundaries, so the AVX-vs-SSE
+// argument passing difference GCC warns about never applies.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef f32 V4 __attribute__((vector_size(16)));
+typedef i32 I4 __attribute__((vector_size(16)));
+typedef f32 V8 __attribute__((vector_size(32)));
+typedef i32 I8 __attribute__((vector_size(32)));
+
+// Bit-trick estimate plus two Newton steps (relative error ~5e-6); the
+// quaternion is renormalized every sample, so the error does not build up.
+template <typename V, typename I> XI_FINLINE V rsqrtV(V x) {
+    V y = (V)(0x5f375a86 - ((I)x >> 1));
+    V hx = 0.5f * x;
+    y = y * (1.5f - hx * y * y);
+    y = y * (1.5f - hx * y * y);
+    return y;
+}
+XI_FINLINE V4 rsqrt(V4 x) { return rsqrtV<V4, I4>(x); }
+XI_FINLINE V8 rsqrt(V8 x) { return rsqrtV<V8, I8>(x); }
+
+#endif
+
+template <typename T>
+XI_FINLINE void mahony(T &q0, T &q1, T &q2, T &q3, T &e0, T &e1, T &e2,
+                       T ax, T ay, T az, T gx, T gy, T gz, T dt, f32 kp,
+                       f32 ki) {
+    T r = rsqrt(ax * ax + ay * ay + az * az);
+    ax *= r; ay *= r; az *= r;
+
+    T hvx = q1 * q3 - q0 * q2;
+    T hvy = q0 * q1 + q2 * q3;
+    T hvz = q0 * q0 - 0.5f + q3 * q3;
+
+    T hex = ay * hvz - az * hvy;
+    T hey = az * hvx - ax * hvz;
+    T hez = ax * hvy - ay * hvx;
+
+    e0 += hex * dt; e1 += hey * dt; e2 += hez * dt;
+    gx += kp * hex + ki * e0;
+    gy += kp * hey + ki * e1;
+    gz += kp * hez + ki * e2;
+
+    T h = 0.5f * dt;
+    gx *= h; gy *= h; gz *= h;
+    T a = q0, b = q1, c = q2;
+    q0 += -b * gx - c * gy - q3 * gz;
+    q1 += a * gx + c * gz - q3 * gy;
+    q2 += a * gy - b * gz + q3 * gx;
+    q3 += a * gz + b * gy - c * gx;
+
+    r = rsqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    q0 *= r; q1 *= r; q2 *= r; q3 *= r;
+}
+
+#ifdef XI_FUSION_VECTOR
+
+template <typename V> XI_FINLINE V loadV(const f32 *p) {
+    V v;
+    __builtin_memcpy(&v, p, sizeof(v));
+    return v;
+}
+template <typename V> XI_FINLINE void storeV(f32 *p, V v) {
+    __builtin_memcpy(p, &v, sizeof(v));
+}
+
+struct LaneJob {
+    f32 (*q)[SensorFusion::MaxSensors];
+    f32 (*e)[SensorFusion::MaxSensors];
+    u64 *last;
+    const ImuSample *const *batches;
+    const usz *counts;
+    const u8 *const *ok;
+    usz lanes;
+    f32 kp, ki;
+};
+
+template <typename V, typename I> XI_FINLINE void laneLoop(const LaneJob &j) {
+    const usz W = sizeof(V) / sizeof(f32);
+    V q0 = loadV<V>(j.q[0]), q1 = loadV<V>(j.q[1]);
+    V q2 = loadV<V>(j.q[2]), q3 = loadV<V>(j.q[3]);
+    V e0 = loadV<V>(j.e[0]), e1 = loadV<V>(j.e[1]), e2 = loadV<V>(j.e[2]);
+    usz most = 0;
+    for (usz l = 0; l < j.lanes; ++l)
+        most = j.counts[l] > most ? j.counts[l] : most;
+
+    for (usz k = 0; k < most; ++k) {
+        // Idle lanes see a level, still sensor, so they stay finite.
+        f32 in[7][W];
+        i32 on[W];
+        bool any = false;
+        for (usz l = 0; l < W; ++l) {
+            on[l] = 0;
+            in[0][l] = 0, in[1][l] = 0, in[2][l] = 1;
+            in[3][l] = 0, in[4][l] = 0, in[5][l] = 0, in[6][l] = 0;
+            if (l >= j.lanes || k >= j.counts[l] || !j.ok[l][k]) continue;
+            const ImuSample &s = j.batches[l][k];
+            in[0][l] = s.accel.x, in[1][l] = s.accel.y, in[2][l] = s.accel.z;
+            in[3][l] = s.gyro.x * DegToRad;
+            in[4][l] = s.gyro.y * DegToRad;
+            in[5][l] = s.gyro.z * DegToRad;
+            in[6][l] = stepSeconds(s.t, j.last[l]);
+            j.last[l] = s.t;
+            on[l] = -1;
+            any = true;
+        }
+        if (!any) continue;
+        V n0 = q0, n1 = q1, n2 = q2, n3 = q3, f0 = e0, f1 = e1, f2 = e2;
+        mahony(n0, n1, n2, n3, f0, f1, f2, loadV<V>(in[0]), loadV<V>(in[1]),
+               loadV<V>(in[2]), loadV<V>(in[3]), loadV<V>(in[4]),
+               loadV<V>(in[5]), loadV<V>(in[6]), j.kp, j.ki);
+        I m;
+        __builtin_memcpy(&m, on, sizeof(m));
+        q0 = m ? n0 : q0; q1 = m ? n1 : q1; q2 = m ? n2 : q2;
+        q3 = m ? n3 : q3;
+        e0 = m ? f0 : e0; e1 = m ? f1 : e1; e2 = m ? f2 : e2;
+    }
+    storeV(j.q[0], q0); storeV(j.q[1], q1); storeV(j.q[2], q2);
+    storeV(j.q[3], q3);
+    storeV(j.e[0], e0); storeV(j.e[1], e1); storeV(j.e[2], e2);
+}
+
+typedef void (*LaneKernel)(const LaneJob &j);
+
+#if defined(XI_FUSION_X86)
+__attribute__((target("avx2,fma"))) void lanes8Avx2(const LaneJob &j) {
+    laneLoop<V8, I8>(j);
+}
+#endif
+void lanes8(const LaneJob &j) { laneLoop<V8, I8>(j); }
+void lanes4(const LaneJob &j) { laneLoop<V4, I4>(j); }
+
+bool sameName(const char *a, const char *b) {
+    while (*a && *a == *b) a++, b++;
+    return *a == *b;
+}
+
+// Up to four sensors fit one 128-bit register on every target.
+LaneKernel laneKernel(usz lanes) {
+    if (lanes <= 4) return lanes4;
+#if defined(XI_FUSION_X86)
+    const char *isa = Math::Simd::isa();
+    if (sameName(isa, "avx512") || sameName(isa, "avx2")) return lanes8Avx2;
+#endif
+    return lanes8;
+}
+
+#endif // XI_FUSION_VECTOR
+
+// --- Fixed point ---
+
+const i32 One30 = 1 << 30;
+
+XI_FINLINE i32 mul30(i32 a, i32 b) { return (i32)(((i64)a * b) >> 30); }
+
+u64 isqrt(u64 x) {
+    if (!x) return 0;
+    u64 r = (u64)1 << ((64 - __builtin_clzll(x) + 1) / 2); // >= sqrt(x)
+    for (;;) {
+        u64 y = (r + x / r) / 2;
+        if (y >= r) return r;
+        r = y;
+    }
+}
+
+XI_FINLINE i32 toQ(f32 v, f32 scale) {
+    f32 x = v * scale; // saturates instead of overflowing
+    if (x >= 2147483520.0f) return 0x7fffff80;
+    if (x <= -2147483520.0f) return -0x7fffff80;
+    return (i32)x;
+}
+
+// The integral is unbounded in the float filters; here it saturates at +-2.
+XI_FINLINE i32 accumulate(i32 e, i32 de) {
+    i64 v = (i64)e + de;
+    if (v > 0x7fffffff) return 0x7fffffff;
+    if (v < -0x7fffffff) return -0x7fffffff;
+    return (i32)v;
+}
+
+void setFromAccel(f32 *q, const Vector3 &a) {
+    f32 roll = Math::atan2(a.y, a.z);
+    f32 pitch = Math::atan2(-a.x, Math::sqrt(a.y * a.y + a.z * a.z));
+    f32 cr = Math::cos(roll * 0.5f), sr = Math::sin(roll * 0.5f);
+    f32 cp = Math::cos(pitch * 0.5f), sp = Math::sin(pitch * 0.5f);
+    q[0] = cr * cp, q[1] = sr * cp, q[2] = cr * sp, q[3] = -sr * sp;
+}
+
+} // namespace
+
+void SensorFusion::reset() {
+    for (usz l = 0; l < MaxSensors; ++l) {
+        _q[0][l] = 1, _q[1][l] = 0, _q[2][l] = 0, _q[3][l] = 0;
+        _e[0][l] = 0, _e[1][l] = 0, _e[2][l] = 0;
+        _last[l] = 0, _lastValid[l] = 0, _repeats[l] = 0;
+        _init[l] = false;
+        _prev[l] = ImuSample();
+    }
+    q[0] = 1, q[1] = 0, q[2] = 0, q[3] = 0;
+    time = 0;
+    latest = ImuSample();
+    processed = 0, rejected = 0;
+    fix = GpsSample();
+    hasFix = false, hasClockOffset = false;
+    clockOffsetNS = 0;
+    _outliers = 0;
+    _sensors = 0;
+    _fused = false;
+}
+
+void SensorFusion::process(const ImuSample *const *batches, const usz *counts,
+                           usz sensors) {
+    usz lanes = sensors < MaxSensors ? sensors : MaxSensors;
+    _sensors = lanes > _sensors ? lanes : _sensors;
+    usz valid = 0;
+    for (usz l = 0; l < lanes; ++l) valid += _screen(l, batches[l], counts[l]);
+    if (!valid) {
+        _consensus();
+        return;
+    }
+
+    switch (path) {
+#ifdef XI_FUSION_VECTOR
+    case FusionPath::Vector:
+        _vector(batches, counts, lanes);
+        break;
+#endif
+    case FusionPath::Fixed:
+        for (usz l = 0; l < lanes; ++l) _fixed(l, batches[l], counts[l]);
+        break;
+    default:
+        for (usz l = 0; l < lanes; ++l) _scalar(l, batches[l], counts[l]);
+        break;
+    }
+    _consensus();
+}
+
+// Marks which samples the filters may use and tracks sensor health.
+usz SensorFusion::_screen(usz l, const ImuSample *s, usz n) {
+    _ok[l].allocate(n);
+    f32 a2max = maxAccel * maxAccel;
+    usz valid = 0;
+    for (usz i = 0; i < n; ++i) {
+        const ImuSample &x = s[i];
+        time = x.t > time ? x.t : time;
+        f32 a2 = x.accel.x * x.accel.x + x.accel.y * x.accel.y +
+                 x.accel.z * x.accel.z;
+        // Written so NaN fails every comparison
+        bool ok = a2 > 0.01f && a2 < a2max &&
+                  Math::abs(x.gyro.x) < maxGyro &&
+                  Math::abs(x.gyro.y) < maxGyro &&
+                  Math::abs(x.gyro.z) < maxGyro;
+        if (ok) {
+            const ImuSample &p = _prev[l];
+            bool same = x.accel.x == p.accel.x && x.accel.y == p.accel.y &&
+                        x.accel.z == p.accel.z && x.gyro.x == p.gyro.x &&
+                        x.gyro.y == p.gyro.y && x.gyro.z == p.gyro.z;
+            _repeats[l] = same ? _repeats[l] + 1 : 0;
+            _prev[l] = x;
+            ok = _repeats[l] < MaxRepeats;
+        }
+        if (ok && _init[l] && x.t > _lastValid[l] + staleNS) {
+            // Back after a gap: the filter missed whatever happened.
+            f32 q0[4] = {q[0], q[1], q[2], q[3]};
+            if (!_fused) setFromAccel(q0, x.accel);
+            for (int c = 0; c < 4; ++c) _q[c][l] = q0[c];
+            _e[0][l] = 0, _e[1][l] = 0, _e[2][l] = 0;
+            _last[l] = x.t;
+        }
+        if (ok && !_init[l]) {
+            f32 q0[4];
+            setFromAccel(q0, x.accel);
+            for (int c = 0; c < 4; ++c) _q[c][l] = q0[c];
+            _last[l] = x.t;
+            _init[l] = true;
+        }
+        if (ok) _lastValid[l] = x.t;
+        _ok[l][i] = ok;
+        valid += ok;
+    }
+    processed += valid;
+    rejected += n - valid;
+    return valid;
+}
+
+void SensorFusion::_scalar(usz l, const ImuSample *s, usz n) {
+    f32 q0 = _q[0][l], q1 = _q[1][l], q2 = _q[2][l], q3 = _q[3][l];
+    f32 e0 = _e[0][l], e1 = _e[1][l], e2 = _e[2][l];
+    u64 last = _last[l];
+    const u8 *ok = _ok[l].data();
+    for (usz i = 0; i < n; ++i) {
+        if (!ok[i]) continue;
+        const ImuSample &x = s[i];
+        f32 dt = stepSeconds(x.t, last);
+        last = x.t;
+        mahony(q0, q1, q2, q3, e0, e1, e2, x.accel.x, x.accel.y, x.accel.z,
+               x.gyro.x * DegToRad, x.gyro.y * DegToRad, x.gyro.z * DegToRad,
+               dt, kp, ki);
+    }
+    _q[0][l] = q0, _q[1][l] = q1, _q[2][l] = q2, _q[3][l] = q3;
+    _e[0][l] = e0, _e[1][l] = e1, _e[2][l] = e2;
+    _last[l] = last;
+}
+
+void SensorFusion::_vector(const ImuSample *const *batches, const usz *counts,
+                           usz lanes) {
+#ifdef XI_FUSION_VECTOR
+    const u8 *ok[MaxSensors];
+    for (usz l = 0; l < lanes; ++l) ok[l] = _ok[l].data();
+    LaneJob j = {_q, _e, _last, batches, counts, ok, lanes, kp, ki};
+    laneKernel(lanes)(j);
+#else
+    for (usz l = 0; l < lanes; ++l) _scalar(l, batches[l], counts[l]);
+#endif
+}
+
+// Q30: quaternion, normalized accel, errors, dt (seconds).
+// Q16: gyro (rad/s) and gains.
+void SensorFusion::_fixed(usz l, const ImuSample *s, usz n) {
+    const f32 S30 = (f32)One30, S16 = 65536.0f;
+    i32 q0 = toQ(_q[0][l], S30), q1 = toQ(_q[1][l], S30);
+    i32 q2 = toQ(_q[2][l], S30), q3 = toQ(_q[3][l], S30);
+    i32 e0 = toQ(_e[0][l], S30), e1 = toQ(_e[1][l], S30);
+    i32 e2 = toQ(_e[2][l], S30);
+    i64 kpQ = toQ(kp, S16), kiQ = toQ(ki, S16);
+    u64 last = _last[l];
+    const u8 *ok = _ok[l].data();
+
+    for (usz i = 0; i < n; ++i) {
+        if (!ok[i]) continue;
+        const ImuSample &x = s[i];
+        u64 d = x.t > last ? x.t - last : 0;
+        d = d < MaxStepNS ? d : MaxStepNS;
+        last = x.t;
+        i32 dt = (i32)((d << 30) / 1000000000ULL);
+
+        // Accel to Q16, then to a unit vector in Q30
+        i64 ax = toQ(x.accel.x, S16), ay = toQ(x.accel.y, S16);
+        i64 az = toQ(x.accel.z, S16);
+        u64 norm = isqrt((u64)(ax * ax + ay * ay + az * az)); // Q16
+        if (!norm) continue;
+        i64 inv = ((i64)1 << 46) / (i64)norm;                  // Q30
+        i32 nx = (i32)((ax * inv) >> 16), ny = (i32)((ay * inv) >> 16);
+        i32 nz = (i32)((az * inv) >> 16);
+
+        i32 hvx = mul30(q1, q3) - mul30(q0, q2);
+        i32 hvy = mul30(q0, q1) + mul30(q2, q3);
+        i32 hvz = mul30(q0, q0) + mul30(q3, q3) - (One30 >> 1);
+
+        i32 hex = mul30(ny, hvz) - mul30(nz, hvy);
+        i32 hey = mul30(nz, hvx) - mul30(nx, hvz);
+        i32 hez = mul30(nx, hvy) - mul30(ny, hvx);
+
+        e0 = accumulate(e0, mul30(hex, dt));
+        e1 = accumulate(e1, mul30(hey, dt));
+        e2 = accumulate(e2, mul30(hez, dt));
+        i64 gx = toQ(x.gyro.x * DegToRad, S16) + ((kpQ * hex) >> 30) +
+                 ((kiQ * e0) >> 30);
+        i64 gy = toQ(x.gyro.y * DegToRad, S16) + ((kpQ * hey) >> 30) +
+                 ((kiQ * e1) >> 30);
+        i64 gz = toQ(x.gyro.z * DegToRad, S16) + ((kpQ * hez) >> 30) +
+                 ((kiQ * e2) >> 30);
+
+        // Half angle step, Q16 * Q30 >> 17 = Q30
+        i64 hx = (gx * dt) >> 17, hy = (gy * dt) >> 17, hz = (gz * dt) >> 17;
+        i64 a = q0, b = q1, c = q2, w = q3;
+        a += (-b * hx - c * hy - w * hz) >> 30;
+        b += ((i64)q0 * hx + c * hz - w * hy) >> 30;
+        c += ((i64)q0 * hy - (i64)q1 * hz + w * hx) >> 30;
+        w += ((i64)q0 * hz + (i64)q1 * hy - (i64)q2 * hx) >> 30;
+
+        // Squares in Q58 so the sum of four cannot overflow
+        u64 s2 = (u64)((a * a) >> 2) + (u64)((b * b) >> 2) +
+                 (u64)((c * c) >> 2) + (u64)((w * w) >> 2);
+        u64 len = isqrt(s2); // Q29
+        if (!len) continue;
+        i64 r = ((i64)1 << 59) / (i64)len; // Q30
+        q0 = (i32)((a * r) >> 30), q1 = (i32)((b * r) >> 30);
+        q2 = (i32)((c * r) >> 30), q3 = (i32)((w * r) >> 30);
+    }
+    _q[0][l] = q0 / S30, _q[1][l] = q1 / S30;
+    _q[2][l] = q2 / S30, _q[3][l] = q3 / S30;
+    _e[0][l] = e0 / S30, _e[1][l] = e1 / S30, _e[2][l] = e2 / S30;
+    _last[l] = last;
+}
+
+bool SensorFusion::_usable(usz l) const {
+    return l < _sensors && _init[l] && _repeats[l] < MaxRepeats &&
+           _lastValid[l] + staleNS >= time;
+}
+
+bool SensorFusion::healthy(usz l) const {
+    return _usable(l) && !(_outliers >> l & 1);
+}
+
+const f32 *SensorFusion::sensorQuaternion(usz l, f32 out[4]) const {
+    for (int c = 0; c < 4; ++c) out[c] = l < MaxSensors ? _q[c][l] : q[c];
+    return out;
+}
+
+// Sign-aligned average of the usable filters' quaternions; with three or
+// more, filters too far from the average are dropped and it is redone.
+void SensorFusion::_consensus() {
+    u32 use = 0;
+    for (usz l = 0; l < _sensors; ++l)
+        if (_usable(l)) use |= 1u << l;
+    _outliers = 0;
+    if (!use) return;
+
+    f32 avg[4];
+    for (int pass = 0; pass < 2; ++pass) {
+        avg[0] = avg[1] = avg[2] = avg[3] = 0;
+        i32 ref = -1;
+        for (usz l = 0; l < _sensors; ++l) {
+            if (!(use >> l & 1)) continue;
+            if (ref < 0) ref = (i32)l;
+            f32 d = _q[0][l] * _q[0][ref] + _q[1][l] * _q[1][ref] +
+                    _q[2][l] * _q[2][ref] + _q[3][l] * _q[3][ref];
+            f32 sign = d < 0 ? -1.0f : 1.0f;
+            for (int c = 0; c < 4; ++c) avg[c] += sign * _q[c][l];
+        }
+        f32 r = rsqrt(avg[0] * avg[0] + avg[1] * avg[1] + avg[2] * avg[2] +
+                      avg[3] * avg[3]);
+        for (int c = 0; c < 4; ++c) avg[c] *= r;
+
+        if (pass || __builtin_popcount(use) < 3) break;
+        f32 minDot = Math::cos(maxDisagree * 0.5f);
+        u32 keep = use;
+        for (usz l = 0; l < _sensors; ++l) {
+            if (!(use >> l & 1)) continue;
+            f32 d = _q[0][l] * avg[0] + _q[1][l] * avg[1] +
+                    _q[2][l] * avg[2] + _q[3][l] * avg[3];
+            if (Math::abs(d) < minDot) keep &= ~(1u << l);
+        }
+        if (keep == use || !keep) break;
+        _outliers = use & ~keep;
+        use = keep;
+    }
+
+    // Keep the output on the same hemisphere as before, so it is smooth.
+    f32 d = avg[0] * q[0] + avg[1] * q[1] + avg[2] * q[2] + avg[3] * q[3];
+    f32 sign = d < 0 ? -1.0f : 1.0f;
+    for (int c = 0; c < 4; ++c) q[c] = sign * avg[c];
+    _fused = true;
+
+    for (usz l = 0; l < _sensors; ++l)
+        if (use >> l & 1) {
+            latest = _prev[l];
+            break;
+        }
+}
+
+void SensorFusion::processGps(const GpsSample *s, usz n) {
+    for (usz i = 0; i < n; ++i) {
+        if (!s[i].fix || (hasFix && s[i].t < fix.t)) continue;
+        fix = s[i];
+        hasFix = true;
+        if (s[i].utc) {
+            clockOffsetNS = (i64)(s[i].utc - s[i].t);
+            hasClockOffset = true;
+        }
+    }
+}
+
+Vector3 SensorFusion::euler() const {
+    f32 q0 = q[0], q1 = q[1], q2 = q[2], q3 = q[3];
+    Vector3 r;
+    f32 sinr = 2 * (q0 * q1 + q2 * q3), cosr = 1 - 2 * (q1 * q1 + q2 * q2);
+    r.x = Math::atan2(sinr, cosr);
+    f32 sinp = 2 * (q0 * q2 - q3 * q1);
+    r.y = Math::abs(sinp) >= 1 ? (sinp > 0 ? 1.57f : -1.57f) : Math::asin(sinp);
+    f32 siny = 2 * (q0 * q3 + q1 * q2), cosy = 1 - 2 * (q2 * q2 + q3 * q3);
+    r.z = Math::atan2(siny, cosy);
+    return r;
+}
+
+Vector3 SensorFusion::down() const {
+    return {2.0f * (q[1] * q[3] - q[0] * q[2]),
+            2.0f * (q[0] * q[1] + q[2] * q[3]),
+            q[0] * q[0] - q[1] * q[1] - q[2] * q[2] + q[3] * q[3]};
+}
+
+} // namespace Xi
@@ -1,6 +1,4 @@
 #include <Hardware/GPS.hpp>
-#include <cstring>
-#include <cstdlib>
 
 #if defined(ARDUINO)
 #include <Arduino.h>
@@ -8,18 +6,23 @@
 
 namespace Xi {
 
+GPSDevice::GPSDevice() {
+    parser.onPosition = [this](const GPSFix &f) { queue(f); };
+}
+
+u64 GPSDevice::now() const {
+    return sampleClock.isValid() ? sampleClock() : (u64)micros() * 1000ULL;
+}
+
 void GPSDevice::update() {
 #if defined(ARDUINO)
     if (!port) return;
-    while (port->available()) {
-        char c = port->read();
-        if (c == '\n') {
-            gpsBuf[gpsIdx] = 0;
-            parseNMEA(gpsBuf);
-            gpsIdx = 0;
-        } else if (gpsIdx < 88) {
-            gpsBuf[gpsIdx++] = c;
-        }
+    u8 buf[64];
+    while (port->available() > 0) {
+        usz want = (usz)port->available();
+        usz n = port->readBytes(buf, want < sizeof(buf) ? want : sizeof(buf));
+        if (!n) break;
+        feed(buf, n);
     }
 #endif
 }
@@ -30,32 +33,27 @@ void GPSDevice::onPPS() {
     lastPPS = lastTimeSync; // Simplified
 }
 
-void GPSDevice::parseNMEA(const char *buf) {
-    if (strncmp(buf, "$GP", 3) == 0 && strstr(buf, "GGA")) {
-         char lt[15] = {}, lg[15] = {}, al[10] = {};
-         char ns = 'N', ew = 'E';
-         int cm = 0;
-         for (const char *p = buf; *p; p++) {
-            if (*p == ',') { cm++; continue; }
-            if (cm == 2) strncat(lt, p, 1);
-            if (cm == 3) ns = *p;
-            if (cm == 4) strncat(lg, p, 1);
-            if (cm == 5) ew = *p;
-            if (cm == 9) strncat(al, p, 1);
-            if (cm > 9) break;
-         }
-         if (lt[0] && lg[0]) {
-            f32 t = atof(lt), g = atof(lg);
-            f32 newLat = (int)(t/100) + (t - ((int)(t/100)*100))/60.0f;
-            f32 newLng = (int)(g/100) + (g - ((int)(g/100)*100))/60.0f;
-            if (ns == 'S') newLat = -newLat;
-            if (ew == 'W') newLng = -newLng;
-            pos.lat = newLat;
-            pos.lng = newLng;
-            pos.alt = atof(al);
-            hasFix = true;
-         }
-    }
+void GPSDevice::feed(const u8 *data, usz n) { feed(data, n, now()); }
+
+void GPSDevice::feed(const u8 *data, usz n, u64 t) {
+    feedTime = t;
+    parser.feed(data, n);
+}
+
+// Called by the parser once per position epoch.
+void GPSDevice::queue(const GPSFix &f) {
+    hasFix = f.valid;
+    if (!f.valid) return;
+    pos = f.pos();
+    u64 utc = f.utcNS();
+    if (utc) lastTimeSync = utc;
+
+    GpsSample s;
+    s.t = feedTime;
+    s.utc = utc;
+    s.pos = pos;
+    s.fix = true;
+    samples.push(s);
 }
 
 } // namespace Xi
@@ -0,0 +1,373 @@
+#include <Hardware/GPSParser.hpp>
+#include <Xi/Spatial.hpp>
+
+namespace Xi {
+
+namespace {
+
+constexpr u32 code(char a, char b, char c) {
+    return (u32)(u8)a << 16 | (u32)(u8)b << 8 | (u32)(u8)c;
+}
+
+const u32 GGA = code('G', 'G', 'A'), RMC = code('R', 'M', 'C');
+const u32 GLL = code('G', 'L', 'L'), VTG = code('V', 'T', 'G');
+const u32 GSA = code('G', 'S', 'A'), GSV = code('G', 'S', 'V');
+
+const u16 MaxSentence = 120; // NMEA says 82; some receivers run longer
+const u16 MaxUbx = 1024;
+
+const i64 Pow10[10] = {1,      10,      100,      1000,      10000,
+                       100000, 1000000, 10000000, 100000000, 1000000000};
+
+// Field value in units of 10^-digits, truncated.
+i64 scaled(i64 mant, i8 frac, int digits) {
+    if (frac < 0) frac = 0;
+    return frac <= digits ? mant * Pow10[digits - frac]
+                          : mant / Pow10[frac - digits];
+}
+
+// NMEA (d)ddmm.mmmm to 1e-7 degrees, rounded.
+i32 coordinate(i64 mant, i8 frac) {
+    if (frac < 0) frac = 0;
+    i64 unit = Pow10[frac];
+    i64 deg = mant / (100 * unit);
+    i64 minutes = mant - deg * 100 * unit; // minutes * unit
+    return (i32)(deg * 10000000 +
+                 (minutes * 10000000 + 30 * unit) / (60 * unit));
+}
+
+// hhmmss.sss to milliseconds
+u32 timeOfDay(i64 mant, i8 frac) {
+    i64 ms = scaled(mant, frac, 3);
+    i64 hms = ms / 1000;
+    return (u32)((hms / 10000) * 3600000 + (hms / 100 % 100) * 60000 +
+                 (hms % 100) * 1000 + ms % 1000);
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+u32 civilDays(i32 y, u32 m, u32 d) {
+    y -= m <= 2;
+    i32 era = (y >= 0 ? y : y - 399) / 400;
+    u32 yoe = (u32)(y - era * 400);
+    u32 doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    u32 doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return (u32)(era * 146097 + (i32)doe - 719468);
+}
+
+u8 talkerIndex(u16 t) {
+    switch (t) {
+    case 'G' << 8 | 'P': return 0;
+    case 'G' << 8 | 'L': return 1;
+    case 'G' << 8 | 'A': return 2;
+    case 'G' << 8 | 'B':
+    case 'B' << 8 | 'D': return 3;
+    case 'G' << 8 | 'Q': return 4;
+    case 'G' << 8 | 'I': return 5;
+    case 'G' << 8 | 'N': return 6;
+    default: return 7;
+    }
+}
+
+u8 hexValue(u8 c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return 0xff;
+}
+
+inline u16 le16(const u8 *p) { return (u16)(p[0] | p[1] << 8); }
+inline i32 le32(const u8 *p) {
+    return (i32)((u32)p[0] | (u32)p[1] << 8 | (u32)p[2] << 16 |
+                 (u32)p[3] << 24);
+}
+
+} // namespace
+
+u64 GPSFix::utcNS() const {
+    if (!date) return 0;
+    return ((u64)date * 86400000ULL + timeMs) * 1000000ULL;
+}
+
+GeoPos GPSFix::pos() const {
+    return {lat * 1e-7, lng * 1e-7, alt * 0.001};
+}
+
+void GPSParser::reset() { *this = GPSParser(); }
+
+usz GPSParser::feed(const u8 *data, usz n) {
+    usz done = 0;
+    for (usz i = 0; i < n; ++i) {
+        u8 c = data[i];
+        // Fast paths for the bulk of the stream: NMEA field digits, and
+        // UBX payload runs.
+        if (_state == Nmea && _field && c >= '0' && c <= '9' &&
+            _length < MaxSentence) {
+            _length++;
+            _sum ^= c;
+            if (_f.mant < 100000000000000LL && _f.frac < 9) {
+                _f.mant = _f.mant * 10 + (c - '0');
+                if (_f.frac >= 0) _f.frac++;
+            }
+            _f.digits = true;
+            continue;
+        }
+        if (_state == UbxPayload) {
+            usz run = _ubxLen - _ubxAt;
+            run = run < n - i ? run : n - i;
+            u8 a = _ckA, b = _ckB;
+            for (usz k = 0; k < run; ++k) {
+                u8 v = data[i + k];
+                if (_ubxAt + k < sizeof(_payload)) _payload[_ubxAt + k] = v;
+                a += v, b += a;
+            }
+            _ckA = a, _ckB = b;
+            _ubxAt += (u16)run;
+            if (_ubxAt == _ubxLen) _state = UbxCkA;
+            i += run - 1;
+            continue;
+        }
+        done += _byte(c);
+    }
+    return done;
+}
+
+// One byte through the state machine; true when a message completed.
+bool GPSParser::_byte(u8 c) {
+    switch (_state) {
+    case Idle:
+        if (c == '$') {
+            _state = Nmea;
+            _sum = 0, _length = 0, _field = 0, _talker = 0, _type = 0;
+            _f = Field();
+            _p = fix;
+        } else if (c == 0xB5) {
+            _state = UbxSync;
+        }
+        return false;
+
+    case Nmea:
+        if (c == '*') {
+            _endField();
+            _state = NmeaCk1;
+            return false;
+        }
+        if (c == '\r' || c == '\n' || c == '$' || ++_length > MaxSentence) {
+            // Cut short (no checksum) or runaway: drop it
+            if (_length > MaxSentence) stats.overflow++;
+            else stats.bad++;
+            _state = Idle;
+            return c == '$' ? _byte(c) : false;
+        }
+        _sum ^= c;
+        if (c == ',') {
+            _endField();
+            _f = Field();
+            _field++;
+        } else if (_field == 0) {
+            if (_length <= 2) _talker = (u16)(_talker << 8 | c);
+            else _type = (_type << 8 | c) & 0xffffff;
+        } else if (c >= '0' && c <= '9') {
+            if (_f.mant < 100000000000000LL && _f.frac < 9) {
+                _f.mant = _f.mant * 10 + (c - '0');
+                if (_f.frac >= 0) _f.frac++;
+            }
+            _f.digits = true;
+        } else if (c == '.') {
+            _f.frac = _f.frac < 0 ? 0 : _f.frac;
+        } else if (c == '-') {
+            _f.neg = true;
+        } else if (!_f.ch) {
+            _f.ch = (char)c;
+        }
+        return false;
+
+    case NmeaCk1:
+    case NmeaCk2: {
+        u8 h = hexValue(c);
+        if (h == 0xff) {
+            stats.bad++;
+            _state = Idle;
+            return c == '$' ? _byte(c) : false;
+        }
+        _ck = _state == NmeaCk1 ? (u8)(h << 4) : (u8)(_ck | h);
+        if (_state == NmeaCk1) {
+            _state = NmeaCk2;
+            return false;
+        }
+        _state = Idle;
+        if (_ck != _sum) {
+            stats.bad++;
+            return false;
+        }
+        _commitNmea();
+        return true;
+    }
+
+    case UbxSync:
+        _state = c == 0x62 ? UbxClass : Idle;
+        if (c == '$') return _byte(c);
+        return false;
+    case UbxClass:
+        _cls = c, _ckA = c, _ckB = c;
+        _state = UbxId;
+        return false;
+    case UbxId:
+        _id = c, _ckA += c, _ckB += _ckA;
+        _state = UbxLen1;
+        return false;
+    case UbxLen1:
+        _ubxLen = c, _ckA += c, _ckB += _ckA;
+        _state = UbxLen2;
+        return false;
+    case UbxLen2:
+        _ubxLen |= (u16)(c << 8), _ckA += c, _ckB += _ckA;
+        _ubxAt = 0;
+        if (_ubxLen > MaxUbx) {
+            stats.bad++;
+            _state = Idle;
+            return false;
+        }
+        _state = _ubxLen ? UbxPayload : UbxCkA;
+        return false;
+    case UbxPayload:
+        if (_ubxAt < sizeof(_payload)) _payload[_ubxAt] = c;
+        _ckA += c, _ckB += _ckA;
+        if (++_ubxAt == _ubxLen) _state = UbxCkA;
+        return false;
+    case UbxCkA:
+        if (c != _ckA) {
+            stats.bad++;
+            _state = Idle;
+            return c == '$' || c == 0xB5 ? _byte(c) : false;
+        }
+        _state = UbxCkB;
+        return false;
+    case UbxCkB:
+        _state = Idle;
+        if (c != _ckB) {
+            stats.bad++;
+            return false;
+        }
+        _commitUbx();
+        return true;
+    }
+    return false;
+}
+
+// Stores the finished field into the pending fix.
+void GPSParser::_endField() {
+    const Field &f = _f;
+    u32 type = _type;
+    i64 m = f.neg ? -f.mant : f.mant;
+    u8 k = _field;
+
+    if (type == GGA) {
+        if (k == 1 && f.digits) _p.timeMs = timeOfDay(f.mant, f.frac);
+        else if (k == 2) _p.lat = f.digits ? coordinate(f.mant, f.frac) : 0;
+        else if (k == 3 && f.ch == 'S') _p.lat = -_p.lat;
+        else if (k == 4) _p.lng = f.digits ? coordinate(f.mant, f.frac) : 0;
+        else if (k == 5 && f.ch == 'W') _p.lng = -_p.lng;
+        else if (k == 6) _p.quality = (u8)f.mant;
+        else if (k == 7) _p.satellites = (u8)f.mant;
+        else if (k == 8 && f.digits) _p.hdop = (u16)scaled(f.mant, f.frac, 2);
+        else if (k == 9 && f.digits) _p.alt = (i32)scaled(m, f.frac, 3);
+    } else if (type == RMC) {
+        if (k == 1 && f.digits) _p.timeMs = timeOfDay(f.mant, f.frac);
+        else if (k == 2) _p.valid = f.ch == 'A';
+        else if (k == 3 && f.digits) _p.lat = coordinate(f.mant, f.frac);
+        else if (k == 4 && f.ch == 'S') _p.lat = -_p.lat;
+        else if (k == 5 && f.digits) _p.lng = coordinate(f.mant, f.frac);
+        else if (k == 6 && f.ch == 'W') _p.lng = -_p.lng;
+        else if (k == 7 && f.digits) // knots
+            _p.speed = (i32)(scaled(f.mant, f.frac, 3) * 1852 / 3600);
+        else if (k == 8 && f.digits) _p.course = (i32)scaled(f.mant, f.frac, 5);
+        else if (k == 9 && f.digits && f.frac < 0) {
+            u32 d = (u32)(f.mant / 10000), mo = (u32)(f.mant / 100 % 100);
+            i32 y = (i32)(f.mant % 100);
+            if (d && mo && mo <= 12)
+                _p.date = civilDays(y < 80 ? 2000 + y : 1900 + y, mo, d);
+        }
+    } else if (type == GLL) {
+        if (k == 1 && f.digits) _p.lat = coordinate(f.mant, f.frac);
+        else if (k == 2 && f.ch == 'S') _p.lat = -_p.lat;
+        else if (k == 3 && f.digits) _p.lng = coordinate(f.mant, f.frac);
+        else if (k == 4 && f.ch == 'W') _p.lng = -_p.lng;
+        else if (k == 5 && f.digits) _p.timeMs = timeOfDay(f.mant, f.frac);
+        else if (k == 6) _p.valid = f.ch == 'A';
+    } else if (type == VTG) {
+        if (k == 1 && f.digits) _p.course = (i32)scaled(f.mant, f.frac, 5);
+        else if (k == 7 && f.digits) // km/h
+            _p.speed = (i32)(scaled(f.mant, f.frac, 3) * 1000 / 3600);
+    } else if (type == GSA) {
+        if (k == 2 && f.digits) _p.mode = (u8)f.mant;
+        else if (k == 16 && f.digits) _p.hdop = (u16)scaled(f.mant, f.frac, 2);
+    } else if (type == GSV) {
+        if (k == 3 && f.digits) {
+            _view[talkerIndex(_talker)] = (u8)f.mant;
+            u32 sum = 0;
+            for (u8 v : _view) sum += v;
+            _p.inView = (u8)(sum < 255 ? sum : 255);
+        }
+    }
+}
+
+void GPSParser::_commitNmea() {
+    stats.nmea++;
+    u32 type = _type;
+    if (type == GGA) _p.valid = _p.quality != 0;
+    else if (type != RMC && type != GLL && type != VTG && type != GSA &&
+             type != GSV) {
+        stats.ignored++;
+        return;
+    }
+    fix = _p;
+    if (type == GGA || type == RMC || type == GLL) _position(fix.timeMs);
+}
+
+// A receiver sends GGA, RMC and GLL for the same epoch; count it once.
+void GPSParser::_position(u32 epoch) {
+    if (epoch == _lastEpoch) return;
+    _lastEpoch = epoch;
+    positions++;
+    if (onPosition.isValid()) onPosition(fix);
+}
+
+void GPSParser::_commitUbx() {
+    stats.ubx++;
+    const u8 *p = _payload;
+    if (_cls == 0x01 && _id == 0x07 && _ubxLen >= 92) { // NAV-PVT
+        u8 valid = p[11], fixType = p[20];
+        bool ok = (p[21] & 1) && fixType >= 2 && fixType <= 4;
+        GPSFix f = fix;
+        if (valid & 1) {
+            u32 d = p[7], mo = p[6];
+            if (d && mo && mo <= 12) f.date = civilDays(le16(p + 4), mo, d);
+        }
+        if (valid & 2) {
+            i64 ms = (i64)p[8] * 3600000 + p[9] * 60000 + p[10] * 1000 +
+                     le32(p + 16) / 1000000;
+            f.timeMs = (u32)(ms < 0 ? ms + 86400000 : ms);
+        }
+        f.valid = ok;
+        f.quality = ok ? 1 : 0;
+        f.mode = fixType >= 3 ? 3 : fixType == 2 ? 2 : 1;
+        f.satellites = p[23];
+        f.lng = le32(p + 24);
+        f.lat = le32(p + 28);
+        f.alt = le32(p + 36);
+        f.speed = le32(p + 60);
+        f.course = le32(p + 64);
+        fix = f;
+        _position(f.timeMs);
+    } else if (_cls == 0x01 && _id == 0x02 && _ubxLen >= 28) { // NAV-POSLLH
+        fix.lng = le32(p + 4);
+        fix.lat = le32(p + 8);
+        fix.alt = le32(p + 16);
+        // No time of day here; iTOW (GPS time of week) stands in for it.
+        if (fix.valid) _position((u32)le32(p));
+    } else {
+        stats.ignored++;
+    }
+}
+
+} // namespace Xi
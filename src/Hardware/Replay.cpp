@@ -0,0 +1,245 @@
+#include <Hardware/Replay.hpp>
+#include <Xi/File.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace Xi {
+
+// --- SensorRecording ---
+
+void SensorRecording::clear() {
+    imu = InlineArray<InlineArray<ImuSample>>();
+    gps = InlineArray<InlineArray<GpsSample>>();
+}
+
+void SensorRecording::add(usz sensor, const ImuSample &s) {
+    while (imu.size() <= sensor) imu.push(InlineArray<ImuSample>());
+    imu[sensor].push(s);
+}
+
+void SensorRecording::add(usz sensor, const GpsSample &s) {
+    while (gps.size() <= sensor) gps.push(InlineArray<GpsSample>());
+    gps[sensor].push(s);
+}
+
+namespace {
+
+// Reads whitespace-separated numbers; false on anything else.
+struct Fields {
+    const char *p;
+
+    bool u(u64 &v) {
+        char *end;
+        v = strtoull(p, &end, 10);
+        if (end == p) return false;
+        p = end;
+        return true;
+    }
+    bool f(f64 &v) {
+        char *end;
+        v = strtod(p, &end);
+        if (end == p) return false;
+        p = end;
+        return true;
+    }
+    bool f(f32 &v) {
+        f64 d;
+        if (!f(d)) return false;
+        v = (f32)d;
+        return true;
+    }
+};
+
+} // namespace
+
+bool SensorRecording::parse(const String &text) {
+    clear();
+    const char *p = text.c_str();
+    while (*p) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (!*p) break;
+        const char *eol = strchr(p, '\n');
+        if (!eol) eol = p + strlen(p);
+        if (*p == '#') {
+            p = eol;
+            continue;
+        }
+
+        Fields in = {p + 3};
+        u64 sensor = 0;
+        bool ok = false;
+        if (strncmp(p, "imu", 3) == 0) {
+            ImuSample s;
+            ok = in.u(sensor) && in.u(s.t) && in.f(s.accel.x) &&
+                 in.f(s.accel.y) && in.f(s.accel.z) && in.f(s.gyro.x) &&
+                 in.f(s.gyro.y) && in.f(s.gyro.z) && in.f(s.mag.x) &&
+                 in.f(s.mag.y) && in.f(s.mag.z);
+            if (ok) add((usz)sensor, s);
+        } else if (strncmp(p, "gps", 3) == 0) {
+            GpsSample s;
+            u64 fix = 0;
+            ok = in.u(sensor) && in.u(s.t) && in.u(s.utc) && in.f(s.pos.lat) &&
+                 in.f(s.pos.lng) && in.f(s.pos.alt) && in.u(fix);
+            s.fix = fix != 0;
+            if (ok) add((usz)sensor, s);
+        }
+        // One sample per line, and nothing after it but spaces
+        while (ok && in.p < eol && (*in.p == ' ' || *in.p == '\t' ||
+                                    *in.p == '\r'))
+            in.p++;
+        if (!ok || in.p != eol) {
+            clear();
+            return false;
+        }
+        p = eol;
+    }
+    return true;
+}
+
+String SensorRecording::serialize() const {
+    String out;
+    char line[256];
+    for (usz k = 0; k < imu.size(); ++k)
+        for (usz i = 0; i < imu[k].size(); ++i) {
+            const ImuSample &s = imu[k][i];
+            snprintf(line, sizeof(line),
+                     "imu %zu %llu %.9g %.9g %.9g %.9g %.9g %.9g %.9g %.9g "
+                     "%.9g\n",
+                     (size_t)k, (unsigned long long)s.t, s.accel.x, s.accel.y,
+                     s.accel.z, s.gyro.x, s.gyro.y, s.gyro.z, s.mag.x, s.mag.y,
+                     s.mag.z);
+            out += line;
+        }
+    for (usz k = 0; k < gps.size(); ++k)
+        for (usz i = 0; i < gps[k].size(); ++i) {
+            const GpsSample &s = gps[k][i];
+            snprintf(line, sizeof(line),
+                     "gps %zu %llu %llu %.12g %.12g %.12g %d\n", (size_t)k,
+                     (unsigned long long)s.t, (unsigned long long)s.utc,
+                     s.pos.lat, s.pos.lng, s.pos.alt, s.fix ? 1 : 0);
+            out += line;
+        }
+    return out;
+}
+
+bool SensorRecording::load(const String &path) {
+    FilesystemDevice *fs = requestFS();
+    if (!fs) return false;
+    String text = fs->read(path);
+    delete fs;
+    return text.length() > 0 && parse(text);
+}
+
+bool SensorRecording::save(const String &path) const {
+    FilesystemDevice *fs = requestFS();
+    if (!fs) return false;
+    fs->write(path, serialize());
+    delete fs;
+    return true;
+}
+
+u64 SensorRecording::begin() const {
+    u64 t = ~0ULL;
+    for (usz k = 0; k < imu.size(); ++k)
+        if (imu[k].size() && imu[k][0].t < t) t = imu[k][0].t;
+    for (usz k = 0; k < gps.size(); ++k)
+        if (gps[k].size() && gps[k][0].t < t) t = gps[k][0].t;
+    return t == ~0ULL ? 0 : t;
+}
+
+u64 SensorRecording::end() const {
+    u64 t = 0;
+    for (usz k = 0; k < imu.size(); ++k)
+        if (imu[k].size() && imu[k][imu[k].size() - 1].t > t)
+            t = imu[k][imu[k].size() - 1].t;
+    for (usz k = 0; k < gps.size(); ++k)
+        if (gps[k].size() && gps[k][gps[k].size() - 1].t > t)
+            t = gps[k][gps[k].size() - 1].t;
+    return t;
+}
+
+usz SensorRecording::samples() const {
+    usz n = 0;
+    for (usz k = 0; k < imu.size(); ++k) n += imu[k].size();
+    for (usz k = 0; k < gps.size(); ++k) n += gps[k].size();
+    return n;
+}
+
+// --- Replay devices ---
+
+void ReplayMPU::update() {
+    usz from = cursor;
+    while (cursor < stream.size() && stream[cursor].t <= clock)
+        samples.push(stream[cursor++]);
+    if (cursor == from) return;
+    const ImuSample &s = stream[cursor - 1];
+    accel = s.accel;
+    gyro = s.gyro;
+    mag = s.mag;
+}
+
+void ReplayGPS::update() {
+    usz from = cursor;
+    while (cursor < stream.size() && stream[cursor].t <= clock)
+        samples.push(stream[cursor++]);
+    if (cursor == from) return;
+    const GpsSample &s = stream[cursor - 1];
+    pos = s.pos;
+    hasFix = s.fix;
+    if (s.utc) lastTimeSync = s.utc;
+}
+
+// --- SensorReplay ---
+
+SensorReplay::~SensorReplay() { _release(); }
+
+void SensorReplay::_release() {
+    for (usz i = 0; i < mpu.size(); ++i) delete mpu[i];
+    for (usz i = 0; i < gps.size(); ++i) delete gps[i];
+    mpu = InlineArray<ReplayMPU *>();
+    gps = InlineArray<ReplayGPS *>();
+}
+
+void SensorReplay::rewind() {
+    _release();
+    for (usz k = 0; k < recording.imu.size(); ++k) {
+        ReplayMPU *d = new ReplayMPU();
+        d->stream = recording.imu[k];
+        mpu.push(d);
+    }
+    for (usz k = 0; k < recording.gps.size(); ++k) {
+        ReplayGPS *d = new ReplayGPS();
+        d->stream = recording.gps[k];
+        gps.push(d);
+    }
+    // One tick before the first sample, so the first advance() delivers it
+    u64 start = recording.begin();
+    now = start ? start - 1 : 0;
+    for (usz i = 0; i < mpu.size(); ++i) mpu[i]->clock = now;
+    for (usz i = 0; i < gps.size(); ++i) gps[i]->clock = now;
+}
+
+bool SensorReplay::advance(u64 ns) {
+    now += ns;
+    bool more = false;
+    for (usz i = 0; i < mpu.size(); ++i) {
+        mpu[i]->clock = now;
+        more = more || !mpu[i]->done();
+    }
+    for (usz i = 0; i < gps.size(); ++i) {
+        gps[i]->clock = now;
+        more = more || !gps[i]->done();
+    }
+    return more;
+}
+
+void SensorReplay::attach(HardwareSpatial &space) {
+    rewind();
+    for (usz i = 0; i < mpu.size(); ++i) space.mpu.push(mpu[i]);
+    for (usz i = 0; i < gps.size(); ++i) space.gps.push(gps[i]);
+    SensorReplay *self = this;
+    space.clock = [self]() { return self->now; };
+}
+
+} // namespace Xi
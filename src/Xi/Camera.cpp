@@ -1,8 +1,20 @@
 #include "../../include/Xi/Camera.hpp"
 #include <cstdio>
 
+#ifdef XI_HAS_GRAPHICS
+#include "../../include/Xi/Graphics.hpp"
+#include "../../include/Xi/Shader.hpp"
+#endif
+
 namespace Xi {
 
+Camera3::~Camera3() {
+#ifdef XI_HAS_GRAPHICS
+    GraphicsContext::release(pDSV);
+#endif
+    delete _gpu;
+}
+
 void *Camera3::getView() {
     if (onUpdate.isValid())
         onUpdate();
@@ -40,7 +52,16 @@ void Camera3::render(void *rtv, void *dsv, i32 w, i32 h) {
     if (!root || !rtv)
         return;
 
-    gContext.bindResources(rtv, dsv, w, h);
+    auto *sw = dynamic_cast<SoftwareRenderingDevice *>(device);
+#ifdef XI_HAS_GRAPHICS
+    if (!sw)
+        gContext.bindResources(rtv, dsv, w, h);
+#else
+    // Without XI_BUILD_GRAPHICS only the software device can draw.
+    (void)dsv;
+    if (!sw)
+        return;
+#endif
 
     f32 aspect = (f32)w / (f32)h;
 
@@ -67,21 +88,35 @@ void Camera3::render(void *rtv, void *dsv, i32 w, i32 h) {
     }
 
     Matrix4 vp = Math::multiply(view, proj);
-    _renderRec(root, Math::identity(), vp);
+    _cull(vp);
+    if (sw)
+        _rasterize(sw, vp);
+#ifdef XI_HAS_GRAPHICS
+    else
+        _renderRec(vp);
+#endif
 }
 
 void Camera3::render() {
     touchGPU();
+    if (auto *sw = dynamic_cast<SoftwareRenderingDevice *>(device)) {
+        void *target = surface.deviceView(1);
+        if (sw->begin(target))
+            render(target, nullptr, surfaceWidth, surfaceHeight);
+        return;
+    }
+#ifdef XI_HAS_GRAPHICS
     void *pRTV_handle = surface.deviceView(1); // RTV
     if (!pRTV_handle)
         return;
 
     auto *pRTV = (Diligent::ITextureView *)pRTV_handle;
     _ensureDepthBuffer(surfaceWidth, surfaceHeight);
+    auto *pDepthView = (Diligent::ITextureView *)pDSV;
 
     float clearColor[] = {1.0f, 0.0f, 0.0f, 1.0f};
 
-    gContext.ctx->SetRenderTargets(1, &pRTV, pDSV, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    gContext.ctx->SetRenderTargets(1, &pRTV, pDepthView, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
     Diligent::Viewport VP;
     VP.Width = (float)surfaceWidth;
@@ -91,14 +126,16 @@ void Camera3::render() {
     gContext.ctx->SetViewports(1, &VP, 0, 0);
 
     gContext.ctx->ClearRenderTarget(pRTV, clearColor, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
-    gContext.ctx->ClearDepthStencil(pDSV, Diligent::CLEAR_DEPTH_FLAG, 1.0f, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+    gContext.ctx->ClearDepthStencil(pDepthView, Diligent::CLEAR_DEPTH_FLAG, 1.0f, 0, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
 
-    render((void *)pRTV, (void *)pDSV, surfaceWidth, surfaceHeight);
+    render((void *)pRTV, pDSV, surfaceWidth, surfaceHeight);
+#endif
 }
 
+#ifdef XI_HAS_GRAPHICS
 void Camera3::_ensureDepthBuffer(i32 w, i32 h) {
     if (pDSV) {
-        auto *pTex = pDSV->GetTexture();
+        auto *pTex = ((Diligent::ITextureView *)pDSV)->GetTexture();
         if (pTex && pTex->GetDesc().Width == (uint32_t)w && pTex->GetDesc().Height == (uint32_t)h)
             return;
     }
@@ -113,64 +150,157 @@ void Camera3::_ensureDepthBuffer(i32 w, i32 h) {
 
     Diligent::RefCntAutoPtr<Diligent::ITexture> pDepth;
     gContext.device->CreateTexture(desc, nullptr, &pDepth);
-    pDSV = pDepth->GetDefaultView(Diligent::TEXTURE_VIEW_DEPTH_STENCIL);
+    GraphicsContext::release(pDSV);
+    Diligent::ITextureView *view =
+        pDepth->GetDefaultView(Diligent::TEXTURE_VIEW_DEPTH_STENCIL);
+    view->AddRef();
+    pDSV = view;
 }
+#endif
 
-void Camera3::_renderRec(TreeItem *n, Matrix4 p, const Matrix4 &vp) {
+// Mirrors the old recursive render: only Renderable3s carry transforms,
+// anything else passes its parent's world matrix through.
+void Camera3::_collect(TreeItem *n, u32 parent) {
     if (!n) return;
 
-    Renderable3 *r = dynamic_cast<Renderable3 *>(n);
-    Matrix4 world = p;
-
-    if (r) {
-        world = Math::multiply(r->getMatrix(), p);
-
-        if (r->mesh && r->shader) {
-            r->mesh->upload();
-            r->shader->create();
-
-            ShaderData gpuData;
-            Matrix4 mvp = Math::multiply(world, vp);
-            gpuData.mvp = mvp;
-            gpuData.world = world;
-
-            r->shader->updateUniforms(&gpuData, sizeof(ShaderData));
-            if (r->shader->_pso == nullptr) {
-                printf("Error: Shader PSO is NULL for Renderable %s!\n", r->name.c_str());
-                return;
-            }
-            gContext.setPipelineState(r->shader->_pso);
-
-            if (r->shader->_srb == nullptr) {
-                printf("Error: Shader SRB is NULL for Renderable %s!\n", r->name.c_str());
-                return;
-            }
-            auto *srb = (Diligent::IShaderResourceBinding *)r->shader->_srb;
-            auto *pTexVar = srb->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture");
-            auto *pSamplerVar = srb->GetVariableByName(Diligent::SHADER_TYPE_PIXEL, "g_Texture_sampler");
-
-            if (pTexVar && r->surface) {
-                void *srv = r->surface->deviceView(0); // View type 0 = SRV
-                if (srv)
-                    pTexVar->Set((Diligent::ITextureView *)srv);
-            }
-
-            if (pSamplerVar) {
-                static Diligent::RefCntAutoPtr<Diligent::ISampler> pDefaultSampler;
-                if (!pDefaultSampler) {
-                    Diligent::SamplerDesc SamDesc;
-                    gContext.device->CreateSampler(SamDesc, &pDefaultSampler);
-                }
-                pSamplerVar->Set(pDefaultSampler);
-            }
-
-            gContext.commitResources(r->shader->_srb);
-            gContext.drawMesh(r->mesh->_vb, r->mesh->_ib, r->mesh->indices.length());
-        }
+    if (Renderable3 *r = dynamic_cast<Renderable3 *>(n)) {
+        SceneEntry e = {r, r->mesh, parent};
+        parent = (u32)_walk.size();
+        _walk.push(e);
     }
 
     for (usz i = 0; i < n->children.length(); ++i)
-        _renderRec(n->children[i], world, vp);
+        _collect(n->children[i], parent);
+}
+
+bool Camera3::_sceneChanged() const {
+    if (_walk.size() != _built.size()) return true;
+    for (usz i = 0; i < _walk.size(); ++i) {
+        const SceneEntry &a = _walk[i], &b = _built[i];
+        if (a.item != b.item || a.mesh != b.mesh || a.parent != b.parent)
+            return true;
+    }
+    return false;
+}
+
+// Entries are in walk order, parents first, so entry i becomes node i.
+void Camera3::_buildScene() {
+    InlineArray<SceneEntry> old = Xi::Move(_built);
+    _built = Xi::Move(_walk);
+    _walk = Xi::Move(old);
+
+    _scene.clear();
+    _bvh = CullBVH();
+    _drawables.allocate(0);
+    _drawNode.allocate(0);
+    _drawRevision.allocate(0);
+    for (usz i = 0; i < _built.size(); ++i) {
+        const SceneEntry &e = _built[i];
+        u32 node = _scene.add(e.parent, e.item);
+        if (!e.mesh) continue;
+        _bvh.insert(e.mesh->bounds(), node);
+        _drawables.push(e.item);
+        _drawNode.push(node);
+        _drawRevision.push(e.mesh->boundsRevision);
+    }
+}
+
+void Camera3::_cull(const Matrix4 &vp) {
+    // The tree is walked every frame, as the recursive renderer did, so
+    // added, removed or re-meshed items are never missed; the hierarchy
+    // and BVH are rebuilt only when the walk differs from the last one.
+    _walk.allocate(0);
+    _collect(root, TransformHierarchy::None);
+    if (_sceneChanged()) _buildScene();
+
+    // Only meshes edited since the last frame pay for a rescan and refit.
+    for (usz i = 0; i < _drawables.size(); ++i) {
+        Mesh3 *m = _drawables[i]->mesh;
+        m->consumeDirty();
+        if (m->boundsRevision != _drawRevision[i]) {
+            _drawRevision[i] = m->boundsRevision;
+            _bvh.setBounds((u32)i, m->bounds());
+        }
+    }
+
+    _scene.sync();
+    _scene.update();
+    _bvh.refit(_scene);
+
+    _visible.allocate(0);
+    _bvh.cull(Frustum::fromMatrix(vp), _visible);
+}
+
+#ifdef XI_HAS_GRAPHICS
+// Visible renderables become one DrawList: sorted by pipeline, texture and
+// mesh, with identical instanced ones merged, so the GPU sees each state
+// change once.
+void Camera3::_renderRec(const Matrix4 &vp) {
+    _drawList.clear();
+    for (usz v = 0; v < _visible.size(); ++v) {
+        u32 h = _visible[v];
+        Renderable3 *r = _drawables[h];
+        if (!r->shader)
+            continue;
+        const Matrix4 &world = _scene.world(_drawNode[h]);
+
+        if (!r->shader->_pso)
+            r->shader->format = r->mesh->format;
+        if (r->shader->format != r->mesh->format) {
+            printf("Error: Shader vertex format does not match the mesh of Renderable %s!\n", r->name.c_str());
+            continue;
+        }
+        r->mesh->upload();
+        r->shader->create();
+
+        if (r->shader->_pso == nullptr) {
+            printf("Error: Shader PSO is NULL for Renderable %s!\n", r->name.c_str());
+            continue;
+        }
+        if (r->shader->_srb == nullptr) {
+            printf("Error: Shader SRB is NULL for Renderable %s!\n", r->name.c_str());
+            continue;
+        }
+
+        DrawCommand c;
+        c.pipeline = r->shader->_pso;
+        c.bindings = r->shader->_srb;
+        c.uniforms = r->shader->_cb;
+        c.textureSlot = r->shader->_texVar;
+        if (c.textureSlot && r->surface)
+            c.texture = r->surface->deviceView(0); // View type 0 = SRV
+        c.vertices = r->mesh->_vb;
+        c.indices = r->mesh->_ib;
+        c.indexCount = (u32)r->mesh->indices.length();
+        c.index16 = r->mesh->_ib16;
+        c.instanced = r->shader->instanced;
+        if (!c.vertices || !c.indices || c.indexCount == 0)
+            continue;
+
+        // Quantized positions decode in front of the world matrix.
+        _drawList.add(c, r->mesh->format == VertexFormat::Full
+                             ? world
+                             : Math::multiply(r->mesh->decodeMatrix(), world));
+    }
+    _drawList.build();
+    if (!_gpu)
+        _gpu = new GraphicsDrawBackend();
+    _drawList.submit(*_gpu, vp);
+}
+#endif
+
+// The software device reads mesh and texture memory in place; no upload.
+void Camera3::_rasterize(SoftwareRenderingDevice *sw, const Matrix4 &vp) {
+    for (usz v = 0; v < _visible.size(); ++v) {
+        u32 h = _visible[v];
+        Renderable3 *r = _drawables[h];
+        const Matrix4 &world = _scene.world(_drawNode[h]);
+        Mesh3 *m = r->mesh;
+        sw->draw(m->vertices.data(), m->vertices.length(), m->indices.data(),
+                 m->indices.length(), Math::multiply(world, vp), world,
+                 r->surface ? sw->texture(*r->surface) : RasterTexture());
+    }
+    sw->flush();
 }
 
 } // namespace Xi
@@ -220,22 +220,6 @@ bool aeadOpen(const Xi::String &key, u64 nonce, AEADOptions &options) {
   return true;
 }
 
-void secureRandomFill(u8 *buffer, usz size) {
-  if (!_randomInitialized)
-    randomSeed();
-  const u8 *key = reinterpret_cast<const u8 *>(&_randomPool[4]);
-  const u8 *nonce = reinterpret_cast<const u8 *>(&_randomPool[12]);
-#if defined(__GNUC__) || defined(__clang__)
-  __builtin_memset(buffer, 0, size);
-#else
-  for (usz i = 0; i < size; ++i)
-    buffer[i] = 0;
-#endif
-  crypto_chacha20_ietf(buffer, buffer, size, key, nonce, _secureCounter);
-  u32 blocks = (u32)((size + 63) / 64);
-  _secureCounter += blocks;
-}
-
 // -------------------------------------------------------------------------
 // XEdDSA Sign & Verify (Using BLAKE2b)
 // -------------------------------------------------------------------------
@@ -0,0 +1,477 @@
+#include <Xi/Culling.hpp>
+#include <Xi/Hierarchy.hpp>
+
+// -------------------------------------------------------------------------
+// Frustum culling
+//
+// Boxes are tested against a plane through their "p-vertex", the corner
+// furthest along the plane normal: if even that corner is behind the plane
+// the box is outside. The opposite "n-vertex" tells whether the box lies
+// entirely in front. BVH nodes store their four children's boxes as SoA so
+// both corners of all four come out of one multiply-add chain per plane.
+// -------------------------------------------------------------------------
+
+#if defined(__GNUC__) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define XI_CULL_VECTOR
+#endif
+
+namespace Xi {
+
+// Build input: an object's Morton code and handle.
+struct CullItem {
+  u32 code, id;
+};
+
+namespace {
+
+inline f32 absf(f32 v) { return v < 0 ? -v : v; }
+
+#ifdef XI_CULL_VECTOR
+typedef f32 V4 __attribute__((vector_size(16)));
+typedef i32 I4 __attribute__((vector_size(16)));
+
+inline V4 load4(const f32 *p) {
+  V4 v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline u32 lanes(I4 m) {
+  return (m[0] ? 1u : 0u) | (m[1] ? 2u : 0u) | (m[2] ? 4u : 0u) |
+         (m[3] ? 8u : 0u);
+}
+#endif
+
+// Spreads the low 10 bits of v to every third bit.
+u32 spread3(u32 v) {
+  v &= 0x3ffu;
+  v = (v | v << 16) & 0x030000ffu;
+  v = (v | v << 8) & 0x0300f00fu;
+  v = (v | v << 4) & 0x030c30c3u;
+  v = (v | v << 2) & 0x09249249u;
+  return v;
+}
+
+// LSD radix sort by code, 8 bits per pass; @p tmp holds n items.
+void sortCodes(CullItem *items, CullItem *tmp, usz n) {
+  for (u32 shift = 0; shift < 32; shift += 8) {
+    usz count[257] = {0};
+    for (usz i = 0; i < n; ++i)
+      count[((items[i].code >> shift) & 0xff) + 1]++;
+    for (usz b = 0; b < 256; ++b)
+      count[b + 1] += count[b];
+    for (usz i = 0; i < n; ++i)
+      tmp[count[(items[i].code >> shift) & 0xff]++] = items[i];
+    CullItem *t = items;
+    items = tmp;
+    tmp = t;
+  }
+}
+
+} // namespace
+
+// -------------------------------------------------------------------------
+// Bounds
+// -------------------------------------------------------------------------
+
+// Arvo: the new center is the old one transformed, the new half extents are
+// the old ones through |M|.
+Bounds Bounds::transformed(const Matrix4 &m) const {
+  if (empty())
+    return Bounds();
+  f32 c[3] = {(min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f,
+              (min.z + max.z) * 0.5f};
+  f32 e[3] = {(max.x - min.x) * 0.5f, (max.y - min.y) * 0.5f,
+              (max.z - min.z) * 0.5f};
+  f32 nc[3], ne[3];
+  for (int j = 0; j < 3; ++j) {
+    nc[j] = m.m[3][j];
+    ne[j] = 0;
+    for (int i = 0; i < 3; ++i) {
+      nc[j] += c[i] * m.m[i][j];
+      ne[j] += e[i] * absf(m.m[i][j]);
+    }
+  }
+  Bounds r;
+  r.min = {nc[0] - ne[0], nc[1] - ne[1], nc[2] - ne[2]};
+  r.max = {nc[0] + ne[0], nc[1] + ne[1], nc[2] + ne[2]};
+  return r;
+}
+
+Bounds Bounds::of(const f32 *xyz, usz count, usz stride) {
+  Bounds r;
+  if (!xyz || count == 0)
+    return r;
+  f32 x0 = xyz[0], y0 = xyz[1], z0 = xyz[2];
+  f32 x1 = x0, y1 = y0, z1 = z0;
+  _Pragma("omp simd reduction(min : x0, y0, z0) reduction(max : x1, y1, z1)")
+  for (usz i = 0; i < count; ++i) {
+    const f32 *p = xyz + i * stride;
+    x0 = p[0] < x0 ? p[0] : x0;
+    y0 = p[1] < y0 ? p[1] : y0;
+    z0 = p[2] < z0 ? p[2] : z0;
+    x1 = p[0] > x1 ? p[0] : x1;
+    y1 = p[1] > y1 ? p[1] : y1;
+    z1 = p[2] > z1 ? p[2] : z1;
+  }
+  r.min = {x0, y0, z0};
+  r.max = {x1, y1, z1};
+  return r;
+}
+
+// -------------------------------------------------------------------------
+// Frustum
+// -------------------------------------------------------------------------
+
+// clip = p * VP, so each clip coordinate is p dotted with a column of VP.
+// Inside means -w <= x <= w, -w <= y <= w and 0 <= z <= w.
+Frustum Frustum::fromMatrix(const Matrix4 &vp) {
+  Frustum f;
+  static const i8 sides[6][2] = {{0, 1}, {0, -1}, {1, 1},
+                                 {1, -1}, {2, 0}, {2, -1}};
+  for (int p = 0; p < 6; ++p) {
+    int axis = sides[p][0];
+    f32 w = (f32)sides[p][1];
+    for (int i = 0; i < 4; ++i)
+      f.planes[p][i] = vp.m[i][axis] + w * vp.m[i][3];
+    if (sides[p][1] == -1)
+      for (int i = 0; i < 4; ++i)
+        f.planes[p][i] = -f.planes[p][i];
+  }
+  return f;
+}
+
+bool Frustum::intersects(const Bounds &b) const {
+  if (b.empty())
+    return false;
+  for (int p = 0; p < 6; ++p) {
+    const f32 *n = planes[p];
+    f32 d = n[0] * (n[0] >= 0 ? b.max.x : b.min.x) +
+            n[1] * (n[1] >= 0 ? b.max.y : b.min.y) +
+            n[2] * (n[2] >= 0 ? b.max.z : b.min.z) + n[3];
+    if (d < 0)
+      return false;
+  }
+  return true;
+}
+
+usz Frustum::test(const f32 *boxes, usz n, u8 *visible) const {
+  const f32 *lo = boxes, *hi = boxes + 3 * n;
+  usz count = 0;
+  for (usz i = 0; i < n; ++i)
+    visible[i] = 1;
+  // One pass per plane; the p-vertex choice is per plane, not per box.
+  for (int p = 0; p < 6; ++p) {
+    const f32 *n4 = planes[p];
+    const f32 *px = (n4[0] >= 0 ? hi : lo), *py = (n4[1] >= 0 ? hi : lo) + n,
+              *pz = (n4[2] >= 0 ? hi : lo) + 2 * n;
+    f32 a = n4[0], b = n4[1], c = n4[2], d = n4[3];
+    _Pragma("omp simd")
+    for (usz i = 0; i < n; ++i)
+      visible[i] &= (u8)(a * px[i] + b * py[i] + c * pz[i] + d >= 0);
+  }
+  for (usz i = 0; i < n; ++i)
+    count += visible[i];
+  return count;
+}
+
+// -------------------------------------------------------------------------
+// CullBVH
+// -------------------------------------------------------------------------
+
+u32 CullBVH::insert(const Bounds &local, u32 node) {
+  Object o;
+  o.local = local;
+  if (node == None)
+    o.world = local;
+  o.leaf = None;
+  o.slot = 0;
+  o.live = true;
+  u32 h;
+  if (_free.size() > 0) {
+    h = _free.pop();
+    _objects[h] = o;
+    _node[h] = node;
+    _seen[h] = ~(u32)0;
+  } else {
+    h = (u32)_objects.size();
+    _objects.push(o);
+    _node.push(node);
+    _seen.push(~(u32)0);
+  }
+  _live++;
+  _stale = true;
+  return h;
+}
+
+void CullBVH::remove(u32 handle) {
+  if (handle >= _objects.size() || !_objects[handle].live)
+    return;
+  Object &o = _objects[handle];
+  o.live = false;
+  _node[handle] = None;
+  _live--;
+  _free.push(handle);
+  // Empty the slot in place; the tree stays valid without a rebuild.
+  if (!_stale && o.leaf != None) {
+    _nodes[o.leaf].child[o.slot] = None;
+    setSlot(o.leaf, o.slot, Bounds());
+    propagate(o.leaf);
+  }
+  o.leaf = None;
+}
+
+void CullBVH::setBounds(u32 handle, const Bounds &local) {
+  if (handle >= _objects.size() || !_objects[handle].live)
+    return;
+  Object &o = _objects[handle];
+  o.local = local;
+  if (_node[handle] != None) {
+    _seen[handle] = ~(u32)0;
+    return;
+  }
+  o.world = local;
+  if (!_stale && o.leaf != None) {
+    setSlot(o.leaf, o.slot, local);
+    propagate(o.leaf);
+  }
+}
+
+usz CullBVH::refit(const TransformHierarchy &h) {
+  usz count = 0;
+  bool tree = !_stale && _nodes.size() > 0;
+  usz nodes = h.size();
+  for (usz i = 0; i < _objects.size(); ++i) {
+    u32 n = _node[i];
+    if (n >= nodes) // also None: detached or removed
+      continue;
+    u32 v = h.worldVersion(n);
+    if (v == _seen[i])
+      continue;
+    _seen[i] = v;
+    Object &o = _objects[i];
+    o.world = o.local.transformed(h.world(n));
+    count++;
+    if (tree && o.leaf != None) {
+      setSlot(o.leaf, o.slot, o.world);
+      _nodeDirty[o.leaf] = 1;
+    }
+  }
+  // Parents precede children, so one backwards sweep settles every level.
+  if (tree && count > 0)
+    for (usz n = _nodes.size(); n-- > 1;) {
+      if (!_nodeDirty[n])
+        continue;
+      _nodeDirty[n] = 0;
+      const Node &node = _nodes[n];
+      setSlot(node.parent, node.slot, nodeBounds((u32)n));
+      _nodeDirty[node.parent] = 1;
+    }
+  if (tree)
+    _nodeDirty[0] = 0;
+  return count;
+}
+
+// Orders objects along a Morton curve through their box centers, so
+// equal-count splits of the order give spatially compact subtrees.
+void CullBVH::build() {
+  _stale = false;
+  _nodes.allocate(0);
+  Bounds all;
+  for (usz i = 0; i < _objects.size(); ++i) {
+    Object &o = _objects[i];
+    o.leaf = None;
+    if (o.live && !o.world.empty())
+      all.merge(o.world);
+  }
+  if (_live == 0)
+    return;
+  f32 lo[3] = {all.min.x, all.min.y, all.min.z};
+  // One scale for all axes keeps the grid cells cubic in flat scenes.
+  f32 extent = all.max.x - all.min.x;
+  extent = all.max.y - all.min.y > extent ? all.max.y - all.min.y : extent;
+  extent = all.max.z - all.min.z > extent ? all.max.z - all.min.z : extent;
+  f32 scale = all.empty() || !(extent > 0) ? 0 : 1023.0f / extent;
+
+  InlineArray<CullItem> items;
+  items.allocate(2 * _live);
+  CullItem *it = items.data();
+  usz k = 0;
+  for (usz i = 0; i < _objects.size(); ++i) {
+    const Object &o = _objects[i];
+    if (!o.live)
+      continue;
+    u32 code = 0;
+    if (!o.world.empty()) {
+      f32 c[3] = {(o.world.min.x + o.world.max.x) * 0.5f,
+                  (o.world.min.y + o.world.max.y) * 0.5f,
+                  (o.world.min.z + o.world.max.z) * 0.5f};
+      for (int a = 0; a < 3; ++a)
+        code |= spread3((u32)((c[a] - lo[a]) * scale)) << a;
+    }
+    it[k].code = code;
+    it[k].id = (u32)i;
+    k++;
+  }
+  sortCodes(it, it + k, k);
+  _nodes.reserve(k / 2 + 1);
+  buildRange(it, k, None, 0);
+  _nodeDirty.allocate(_nodes.size());
+  for (usz i = 0; i < _nodes.size(); ++i)
+    _nodeDirty[i] = 0;
+}
+
+// Splits the range in four equal parts and recurses on every quarter
+// holding more than one object.
+u32 CullBVH::buildRange(CullItem *items, usz n, u32 parent, u8 slot) {
+  u32 me = (u32)_nodes.size();
+  Node blank;
+  for (u8 k = 0; k < 4; ++k) {
+    blank.minX[k] = blank.minY[k] = blank.minZ[k] = __builtin_inff();
+    blank.maxX[k] = blank.maxY[k] = blank.maxZ[k] = -__builtin_inff();
+    blank.child[k] = None;
+  }
+  blank.parent = parent;
+  blank.slot = slot;
+  _nodes.push(blank);
+
+  if (n <= 4) {
+    for (u8 k = 0; k < n; ++k)
+      place(me, k, items[k].id);
+    return me;
+  }
+  usz cut[5] = {0, n / 4, n / 2, n / 2 + (n - n / 2) / 2, n};
+  for (u8 k = 0; k < 4; ++k) {
+    usz len = cut[k + 1] - cut[k];
+    if (len == 1) {
+      place(me, k, items[cut[k]].id);
+      continue;
+    }
+    u32 child = buildRange(items + cut[k], len, me, k);
+    _nodes[me].child[k] = child;
+    setSlot(me, k, nodeBounds(child));
+  }
+  return me;
+}
+
+void CullBVH::place(u32 node, u8 slot, u32 handle) {
+  Object &o = _objects[handle];
+  o.leaf = node;
+  o.slot = slot;
+  _nodes[node].child[slot] = handle | Leaf;
+  setSlot(node, slot, o.world);
+}
+
+void CullBVH::setSlot(u32 node, u8 slot, const Bounds &b) {
+  Node &n = _nodes[node];
+  n.minX[slot] = b.min.x;
+  n.minY[slot] = b.min.y;
+  n.minZ[slot] = b.min.z;
+  n.maxX[slot] = b.max.x;
+  n.maxY[slot] = b.max.y;
+  n.maxZ[slot] = b.max.z;
+}
+
+Bounds CullBVH::nodeBounds(u32 node) const {
+  const Node &n = _nodes[node];
+  Bounds b;
+  for (u8 k = 0; k < 4; ++k) {
+    Bounds s;
+    s.min = {n.minX[k], n.minY[k], n.minZ[k]};
+    s.max = {n.maxX[k], n.maxY[k], n.maxZ[k]};
+    b.merge(s);
+  }
+  return b;
+}
+
+void CullBVH::propagate(u32 node) {
+  while (_nodes[node].parent != None) {
+    const Node &n = _nodes[node];
+    setSlot(n.parent, n.slot, nodeBounds(node));
+    node = n.parent;
+  }
+}
+
+usz CullBVH::acceptAll(u32 node, InlineArray<u32> &visible) const {
+  usz count = 0;
+  const Node &n = _nodes[node];
+  for (u8 k = 0; k < 4; ++k) {
+    u32 c = n.child[k];
+    if (c == None)
+      continue;
+    if (c & Leaf) {
+      visible.push(c & ~Leaf);
+      count++;
+    } else {
+      count += acceptAll(c, visible);
+    }
+  }
+  return count;
+}
+
+usz CullBVH::cull(const Frustum &f, InlineArray<u32> &visible) {
+  if (_stale)
+    build();
+  if (_nodes.size() == 0)
+    return 0;
+
+  // Equal splits keep the depth at log4(n); three entries per level
+  // stay on the stack, so 256 covers any u32 object count.
+  u32 stack[256];
+  usz sp = 0, count = 0;
+  stack[sp++] = 0;
+  while (sp > 0) {
+    const Node &n = _nodes[stack[--sp]];
+    u32 out, cross;
+#ifdef XI_CULL_VECTOR
+    V4 lo[3] = {load4(n.minX), load4(n.minY), load4(n.minZ)};
+    V4 hi[3] = {load4(n.maxX), load4(n.maxY), load4(n.maxZ)};
+    I4 o = {0, 0, 0, 0}, x = {0, 0, 0, 0};
+    for (int p = 0; p < 6; ++p) {
+      const f32 *pl = f.planes[p];
+      V4 far = V4{} + pl[3], near = far;
+      for (int a = 0; a < 3; ++a) {
+        bool pos = pl[a] >= 0;
+        far += pl[a] * (pos ? hi[a] : lo[a]);
+        near += pl[a] * (pos ? lo[a] : hi[a]);
+      }
+      o |= far < 0;
+      x |= near < 0;
+    }
+    out = lanes(o);
+    cross = lanes(x);
+#else
+    out = cross = 0;
+    const f32 *lo[3] = {n.minX, n.minY, n.minZ};
+    const f32 *hi[3] = {n.maxX, n.maxY, n.maxZ};
+    for (int k = 0; k < 4; ++k)
+      for (int p = 0; p < 6; ++p) {
+        const f32 *pl = f.planes[p];
+        f32 far = pl[3], near = pl[3];
+        for (int a = 0; a < 3; ++a) {
+          bool pos = pl[a] >= 0;
+          far += pl[a] * (pos ? hi[a][k] : lo[a][k]);
+          near += pl[a] * (pos ? lo[a][k] : hi[a][k]);
+        }
+        out |= (far < 0 ? 1u : 0u) << k;
+        cross |= (near < 0 ? 1u : 0u) << k;
+      }
+#endif
+    for (int k = 0; k < 4; ++k) {
+      u32 c = n.child[k];
+      if (c == None || (out >> k & 1))
+        continue;
+      if (c & Leaf) {
+        visible.push(c & ~Leaf);
+        count++;
+      } else if (!(cross >> k & 1) || sp == 256) {
+        count += acceptAll(c, visible);
+      } else {
+        stack[sp++] = c;
+      }
+    }
+  }
+  return count;
+}
+
+} // namespace Xi
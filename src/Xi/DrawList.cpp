@@ -0,0 +1,193 @@
+#include <Xi/DrawList.hpp>
+
+namespace Xi {
+
+namespace {
+
+bool sameCommand(const DrawCommand &a, const DrawCommand &b) {
+  return a.pipeline == b.pipeline && a.bindings == b.bindings &&
+         a.uniforms == b.uniforms && a.textureSlot == b.textureSlot &&
+         a.texture == b.texture && a.vertices == b.vertices &&
+         a.indices == b.indices && a.indexCount == b.indexCount &&
+         a.index16 == b.index16 && a.instanced == b.instanced;
+}
+
+inline usz hashPointer(void *p) {
+  u64 x = (u64)(usz)p;
+  x ^= x >> 33;
+  x *= 0xff51afd7ed558ccdull;
+  x ^= x >> 33;
+  return (usz)x;
+}
+
+} // namespace
+
+void DrawList::clear() {
+  _commands.allocate(0);
+  _worlds.allocate(0);
+  _instances.allocate(0);
+  _batches.allocate(0);
+  _ids = 0;
+  for (usz i = 0; i < _idKeys.size(); ++i)
+    _idKeys[i] = nullptr;
+}
+
+void DrawList::add(const DrawCommand &command, const Matrix4 &world) {
+  _commands.push(command);
+  _worlds.push(world);
+}
+
+// Dense ids in first-seen order (0 is null), so keys are small and the
+// sort order does not depend on where things were allocated. Ids past 16
+// bits share the last value: grouping gets coarser, merging stays exact.
+u32 DrawList::_id(void *p) {
+  if (!p)
+    return 0;
+  if ((_ids + 1) * 2 > _idKeys.size()) {
+    InlineArray<void *> keys = _idKeys;
+    InlineArray<u32> values = _idValues;
+    usz cap = _idKeys.size() ? _idKeys.size() * 2 : 64;
+    _idKeys = InlineArray<void *>();
+    _idValues = InlineArray<u32>();
+    _idKeys.allocate(cap);
+    _idValues.allocate(cap);
+    for (usz i = 0; i < keys.size(); ++i) {
+      if (!keys[i])
+        continue;
+      usz s = hashPointer(keys[i]) & (cap - 1);
+      while (_idKeys[s])
+        s = (s + 1) & (cap - 1);
+      _idKeys[s] = keys[i];
+      _idValues[s] = values[i];
+    }
+  }
+  usz mask = _idKeys.size() - 1, s = hashPointer(p) & mask;
+  while (_idKeys[s] && _idKeys[s] != p)
+    s = (s + 1) & mask;
+  if (!_idKeys[s]) {
+    _idKeys[s] = p;
+    _idValues[s] = ++_ids;
+  }
+  return _idValues[s] < 0xffffu ? _idValues[s] : 0xffffu;
+}
+
+void DrawList::build() {
+  usz n = _commands.size();
+  _batches.allocate(0);
+  _instances.allocate(n);
+  _order.allocate(n);
+  for (usz i = 0; i < n; ++i)
+    _order[i] = (u32)i;
+
+  if (sort && n > 1) {
+    // Key: pipeline, bindings, texture, vertex buffer; 16 bits each.
+    _keys.allocate(n);
+    for (usz i = 0; i < n; ++i) {
+      const DrawCommand &c = _commands[i];
+      _keys[i] = (u64)_id(c.pipeline) << 48 | (u64)_id(c.bindings) << 32 |
+                 (u64)_id(c.texture) << 16 | (u64)_id(c.vertices);
+    }
+    // Stable LSD radix sort of the order, 8 bits per pass; passes where
+    // every key has the same digit (most, ids being small) are skipped.
+    _scratch.allocate(n);
+    u32 *src = _order.data(), *dst = _scratch.data();
+    InlineArray<u32> count;
+    count.allocate(256);
+    for (u32 shift = 0; shift < 64; shift += 8) {
+      u32 d0 = (u32)(_keys[0] >> shift) & 0xffu;
+      bool same = true;
+      for (usz i = 1; i < n && same; ++i)
+        same = ((u32)(_keys[i] >> shift) & 0xffu) == d0;
+      if (same)
+        continue;
+      for (usz d = 0; d < count.size(); ++d)
+        count[d] = 0;
+      for (usz i = 0; i < n; ++i)
+        count[(u32)(_keys[src[i]] >> shift) & 0xffu]++;
+      u32 sum = 0;
+      for (usz d = 0; d < count.size(); ++d) {
+        u32 c = count[d];
+        count[d] = sum;
+        sum += c;
+      }
+      for (usz i = 0; i < n; ++i)
+        dst[count[(u32)(_keys[src[i]] >> shift) & 0xffu]++] = src[i];
+      u32 *t = src;
+      src = dst;
+      dst = t;
+    }
+    if (src != _order.data())
+      for (usz i = 0; i < n; ++i)
+        _order[i] = src[i];
+  }
+
+  for (usz k = 0; k < n; ++k) {
+    u32 i = _order[k];
+    _instances[k] = _worlds[i];
+    if (_batches.size() > 0) {
+      Batch &b = _batches[_batches.size() - 1];
+      if (sameCommand(_commands[b.command], _commands[i])) {
+        b.count++;
+        continue;
+      }
+    }
+    Batch b;
+    b.command = i;
+    b.first = (u32)k;
+    b.count = 1;
+    _batches.push(b);
+  }
+}
+
+void DrawList::submit(DrawBackend &backend, const Matrix4 &viewProj) const {
+  const Matrix4 identity = Math::identity();
+  DrawCommand cur;
+  bool first = true, viewProjSet = false;
+  for (usz bi = 0; bi < _batches.size(); ++bi) {
+    const Batch &b = _batches[bi];
+    const DrawCommand &c = _commands[b.command];
+
+    if (first || c.pipeline != cur.pipeline) {
+      backend.setPipeline(c.pipeline);
+      viewProjSet = false;
+    }
+    bool texture = c.texture && (first || c.texture != cur.texture ||
+                                 c.textureSlot != cur.textureSlot);
+    if (texture)
+      backend.setTexture(c.textureSlot, c.texture);
+    if (first || texture || c.bindings != cur.bindings)
+      backend.commit(c.bindings);
+    if (first || c.vertices != cur.vertices || c.indices != cur.indices ||
+        c.index16 != cur.index16)
+      backend.setMesh(c.vertices, c.indices, c.index16);
+
+    const Matrix4 *w = _instances.data() + b.first;
+    if (c.instanced) {
+      if (!viewProjSet || c.uniforms != cur.uniforms) {
+        backend.setUniforms(c.uniforms, viewProj, identity);
+        viewProjSet = true;
+      }
+      if (instance) {
+        backend.drawInstanced(c.indexCount, w, b.count);
+      } else {
+        for (u32 i = 0; i < b.count; ++i)
+          backend.drawInstanced(c.indexCount, w + i, 1);
+      }
+    } else {
+      for (u32 i = 0; i < b.count; ++i) {
+        backend.setUniforms(c.uniforms, Math::multiply(w[i], viewProj), w[i]);
+        backend.draw(c.indexCount);
+      }
+      viewProjSet = false;
+    }
+
+    void *bound = c.texture ? c.texture : cur.texture;
+    void *slot = c.texture ? c.textureSlot : cur.textureSlot;
+    cur = c;
+    cur.texture = bound;
+    cur.textureSlot = slot;
+    first = false;
+  }
+}
+
+} // namespace Xi
@@ -0,0 +1,341 @@
+#include <Xi/GeoIndex.hpp>
+#include <math.h>
+
+namespace Xi {
+
+namespace {
+
+const f64 Pi = 3.14159265358979323846;
+const f64 DegToRad = Pi / 180;
+
+// Spreads the low 21 bits of v three apart.
+u64 spread3(u64 v) {
+  v &= 0x1fffff;
+  v = (v | v << 32) & 0x1f00000000ffffULL;
+  v = (v | v << 16) & 0x1f0000ff0000ffULL;
+  v = (v | v << 8) & 0x100f00f00f00f00fULL;
+  v = (v | v << 4) & 0x10c30c30c30c30c3ULL;
+  v = (v | v << 2) & 0x1249249249249249ULL;
+  return v;
+}
+
+u64 quantize(f64 v) { return (u64)((v + 1) * (0.5 * 0x1fffff) + 0.5); }
+
+// LSD radix sort of 63-bit keys, 11 bits a pass, carrying ids. Passes in
+// which every key has the same digit are skipped.
+void radixSort(InlineArray<u64> &keys, InlineArray<u32> &ids) {
+  usz n = keys.size();
+  InlineArray<u64> k2;
+  InlineArray<u32> i2;
+  k2.allocate(n);
+  i2.allocate(n);
+  u64 *ka = keys.data(), *kb = k2.data();
+  u32 *ia = ids.data(), *ib = i2.data();
+  usz count[2048];
+  for (u32 shift = 0; shift < 63; shift += 11) {
+    for (usz &c : count)
+      c = 0;
+    for (usz i = 0; i < n; ++i)
+      count[(ka[i] >> shift) & 2047]++;
+    if (count[(ka[0] >> shift) & 2047] == n)
+      continue;
+    usz sum = 0;
+    for (usz &c : count) {
+      usz t = c;
+      c = sum;
+      sum += t;
+    }
+    for (usz i = 0; i < n; ++i) {
+      usz at = count[(ka[i] >> shift) & 2047]++;
+      kb[at] = ka[i];
+      ib[at] = ia[i];
+    }
+    u64 *tk = ka;
+    ka = kb, kb = tk;
+    u32 *ti = ia;
+    ia = ib, ib = ti;
+  }
+  if (ka != keys.data()) {
+    keys = k2;
+    ids = i2;
+  }
+}
+
+f32 down(f64 v) {
+  f32 r = (f32)v;
+  return (f64)r > v ? nextafterf(r, -__builtin_inff()) : r;
+}
+f32 up(f64 v) {
+  f32 r = (f32)v;
+  return (f64)r < v ? nextafterf(r, __builtin_inff()) : r;
+}
+
+// Squared distance from c to the nearest and the farthest point of a box.
+void boxDist(const f32 *b, const f64 c[3], f64 &lo, f64 &hi) {
+  lo = 0, hi = 0;
+  for (int k = 0; k < 3; ++k) {
+    f64 a = c[k] - b[k], z = b[k + 3] - c[k];
+    f64 o = a < 0 ? -a : z < 0 ? -z : 0;
+    f64 f = a > z ? a : z;
+    lo += o * o;
+    hi += f * f;
+  }
+}
+
+struct Visit {
+  usz level, node;
+};
+
+struct Candidate {
+  f64 d2;
+  usz level; // ~0 for a point
+  usz at;
+};
+
+void heapPush(InlineArray<Candidate> &h, const Candidate &c) {
+  h.push(c);
+  Candidate *d = h.data();
+  usz i = h.size() - 1;
+  while (i && d[(i - 1) / 2].d2 > d[i].d2) {
+    Candidate t = d[i];
+    d[i] = d[(i - 1) / 2];
+    d[(i - 1) / 2] = t;
+    i = (i - 1) / 2;
+  }
+}
+
+Candidate heapPop(InlineArray<Candidate> &h) {
+  Candidate *d = h.data();
+  Candidate top = d[0];
+  d[0] = d[h.size() - 1];
+  h.pop();
+  d = h.data();
+  usz n = h.size(), i = 0;
+  for (;;) {
+    usz l = 2 * i + 1, m = i;
+    if (l < n && d[l].d2 < d[m].d2)
+      m = l;
+    if (l + 1 < n && d[l + 1].d2 < d[m].d2)
+      m = l + 1;
+    if (m == i)
+      break;
+    Candidate t = d[i];
+    d[i] = d[m];
+    d[m] = t;
+    i = m;
+  }
+  return top;
+}
+
+} // namespace
+
+// --- Build ---
+
+void GeoIndex::build(const GeoPos *points, usz n) {
+  InlineArray<f64> lat, lng;
+  lat.allocate(n);
+  lng.allocate(n);
+  for (usz i = 0; i < n; ++i)
+    lat[i] = points[i].lat, lng[i] = points[i].lng;
+  build(lat.data(), lng.data(), n);
+}
+
+void GeoIndex::build(const f64 *lat, const f64 *lng, usz n) {
+  _x.allocate(0), _y.allocate(0), _z.allocate(0);
+  _ids.allocate(0), _boxes.allocate(0), _levels.allocate(0);
+  if (!n)
+    return;
+
+  // Unit vectors through the batch conversion on a unit sphere.
+  GeodeticSphere unit;
+  unit.config = {1, 0};
+  InlineArray<f64> x, y, z;
+  x.allocate(n), y.allocate(n), z.allocate(n);
+  unit.toEcef(lat, lng, z.data(), x.data(), y.data(), z.data(), n);
+
+  InlineArray<u64> keys;
+  keys.allocate(n);
+  _ids.allocate(n);
+  for (usz i = 0; i < n; ++i) {
+    keys[i] = spread3(quantize(x[i])) | spread3(quantize(y[i])) << 1 |
+              spread3(quantize(z[i])) << 2;
+    _ids[i] = (u32)i;
+  }
+  radixSort(keys, _ids);
+  keys = InlineArray<u64>();
+
+  _x.allocate(n), _y.allocate(n), _z.allocate(n);
+  for (usz i = 0; i < n; ++i) {
+    u32 j = _ids[i];
+    _x[i] = x[j], _y[i] = y[j], _z[i] = z[j];
+  }
+
+  usz nodes = 0, c = n;
+  do {
+    c = (c + NodeSize - 1) / NodeSize;
+    nodes += c;
+  } while (c > 1);
+  _boxes.allocate(nodes * 6);
+  f32 *box = _boxes.data();
+
+  // Leaves, rounded outwards so f32 never excludes a point.
+  usz count = (n + NodeSize - 1) / NodeSize;
+  _levels.push(0);
+  for (usz b = 0; b < count; ++b, box += 6) {
+    f64 lo[3] = {2, 2, 2}, hi[3] = {-2, -2, -2};
+    usz end = (b + 1) * NodeSize < n ? (b + 1) * NodeSize : n;
+    for (usz i = b * NodeSize; i < end; ++i) {
+      f64 v[3] = {_x[i], _y[i], _z[i]};
+      for (int k = 0; k < 3; ++k) {
+        lo[k] = v[k] < lo[k] ? v[k] : lo[k];
+        hi[k] = v[k] > hi[k] ? v[k] : hi[k];
+      }
+    }
+    for (int k = 0; k < 3; ++k)
+      box[k] = down(lo[k]), box[k + 3] = up(hi[k]);
+  }
+  while (count > 1) {
+    usz first = _levels[_levels.size() - 1];
+    usz parents = (count + NodeSize - 1) / NodeSize;
+    _levels.push(first + count);
+    for (usz p = 0; p < parents; ++p, box += 6) {
+      const f32 *c = _boxes.data() + (first + p * NodeSize) * 6;
+      usz end = (p + 1) * NodeSize < count ? (p + 1) * NodeSize : count;
+      for (int k = 0; k < 6; ++k)
+        box[k] = c[k];
+      for (usz i = p * NodeSize + 1; i < end; ++i) {
+        c += 6;
+        for (int k = 0; k < 3; ++k) {
+          box[k] = c[k] < box[k] ? c[k] : box[k];
+          box[k + 3] = c[k + 3] > box[k + 3] ? c[k + 3] : box[k + 3];
+        }
+      }
+    }
+    count = parents;
+  }
+  _levels.push(nodes);
+}
+
+// --- Queries ---
+
+void GeoIndex::_unit(const GeoPos &g, f64 v[3]) const {
+  f64 cl = cos(g.lat * DegToRad);
+  v[0] = cl * cos(g.lng * DegToRad);
+  v[1] = cl * sin(g.lng * DegToRad);
+  v[2] = sin(g.lat * DegToRad);
+}
+
+f64 GeoIndex::_chord2(f64 meters) const {
+  f64 a = meters / radius;
+  if (a < 0)
+    return -1;
+  if (a >= Pi)
+    return 5; // beyond the antipode: everything
+  f64 s = 2 * sin(a / 2);
+  return s * s;
+}
+
+void GeoIndex::within(const GeoPos &center, f64 meters,
+                      InlineArray<u32> &out) const {
+  out.allocate(0);
+  usz n = size();
+  f64 t2 = _chord2(meters);
+  if (!n || t2 < 0)
+    return;
+  f64 c[3];
+  _unit(center, c);
+
+  // Depth-first; at most NodeSize - 1 siblings wait per level.
+  Visit stack[NodeSize * 24];
+  usz top = 0;
+  usz levels = _levels.size() - 1;
+  stack[top++] = {levels - 1, 0};
+  while (top) {
+    Visit v = stack[--top];
+    usz first = _levels[v.level];
+    f64 lo, hi;
+    boxDist(_boxes.data() + (first + v.node) * 6, c, lo, hi);
+    if (lo > t2)
+      continue;
+    usz span = NodeSize;
+    for (usz l = 0; l < v.level; ++l)
+      span *= NodeSize;
+    usz begin = v.node * span;
+    usz end = begin + span < n ? begin + span : n;
+    if (hi <= t2) {
+      for (usz i = begin; i < end; ++i)
+        out.push(_ids[i]);
+      continue;
+    }
+    if (v.level == 0) {
+      for (usz i = begin; i < end; ++i) {
+        f64 dx = _x[i] - c[0], dy = _y[i] - c[1], dz = _z[i] - c[2];
+        if (dx * dx + dy * dy + dz * dz <= t2)
+          out.push(_ids[i]);
+      }
+      continue;
+    }
+    usz children = _levels[v.level] - _levels[v.level - 1];
+    usz last = (v.node + 1) * NodeSize < children ? (v.node + 1) * NodeSize
+                                                  : children;
+    for (usz i = v.node * NodeSize; i < last; ++i)
+      stack[top++] = {v.level - 1, i};
+  }
+}
+
+void GeoIndex::nearest(const GeoPos &center, usz k, InlineArray<u32> &out,
+                       InlineArray<f64> *meters) const {
+  out.allocate(0);
+  if (meters)
+    meters->allocate(0);
+  usz n = size();
+  if (!n || !k)
+    return;
+  f64 c[3];
+  _unit(center, c);
+
+  // Best-first: nodes queue by their nearest possible point and points by
+  // their own distance, so points leave the queue in distance order.
+  const usz Point = ~(usz)0;
+  InlineArray<Candidate> queue;
+  usz levels = _levels.size() - 1;
+  heapPush(queue, {0, levels - 1, 0});
+  while (queue.size() && out.size() < k) {
+    Candidate q = heapPop(queue);
+    if (q.level == Point) {
+      out.push(_ids[q.at]);
+      if (meters) {
+        f64 h = sqrt(q.d2) / 2;
+        meters->push(2 * radius * asin(h < 1 ? h : 1));
+      }
+      continue;
+    }
+    if (q.level == 0) {
+      usz end = (q.at + 1) * NodeSize < n ? (q.at + 1) * NodeSize : n;
+      for (usz i = q.at * NodeSize; i < end; ++i) {
+        f64 dx = _x[i] - c[0], dy = _y[i] - c[1], dz = _z[i] - c[2];
+        heapPush(queue, {dx * dx + dy * dy + dz * dz, Point, i});
+      }
+      continue;
+    }
+    usz first = _levels[q.level - 1];
+    usz children = _levels[q.level] - first;
+    usz last = (q.at + 1) * NodeSize < children ? (q.at + 1) * NodeSize
+                                                : children;
+    for (usz i = q.at * NodeSize; i < last; ++i) {
+      f64 lo, hi;
+      boxDist(_boxes.data() + (first + i) * 6, c, lo, hi);
+      heapPush(queue, {lo, q.level - 1, i});
+    }
+  }
+}
+
+f64 GeoIndex::distance(const GeoPos &a, const GeoPos &b, f64 radius) {
+  f64 sl = sin((b.lat - a.lat) * DegToRad / 2);
+  f64 sg = sin((b.lng - a.lng) * DegToRad / 2);
+  f64 h = sl * sl + cos(a.lat * DegToRad) * cos(b.lat * DegToRad) * sg * sg;
+  h = sqrt(h);
+  return 2 * radius * asin(h < 1 ? h : 1);
+}
+
+} // namespace Xi
@@ -0,0 +1,373 @@
+#include <Xi/Spatial.hpp>
+#include <math.h>
+
+// -------------------------------------------------------------------------
+// GeodeticSphere conversions.
+//
+// ECEF -> geodetic (Bowring 1976, iterated): with p = hypot(x, y), the
+// reduced latitude b starts at atan2(z, (1 - f) p) and each step does
+//   lat = atan2(z + e'^2 b_axis sin^3 b, p - e^2 a cos^3 b)
+//   b   = atan2((1 - f) sin lat, cos lat)
+// carried as unnormalized (cos, sin) pairs, so only the final latitude
+// and the longitude need an atan2. Convergence is cubic: two steps reach
+// f64 precision. h = p cos lat + z sin lat - a sqrt(1 - e^2 sin^2 lat).
+//
+// The batch kernels run the same formulas on GCC f64 vectors with their
+// own sincos / atan2 (Cephes polynomials, ~1 ulp) and a Newton rsqrt,
+// so they build for any target; x86 gets an AVX2 clone. A partial last
+// block is padded and run through the same kernel, so every element gets
+// bit-identical results wherever it sits in the array.
+// -------------------------------------------------------------------------
+
+#if defined(__GNUC__) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define XI_GEO_VECTOR
+#if defined(__x86_64__) || defined(__i386__)
+#define XI_GEO_X86
+#endif
+#endif
+
+#define XI_GINLINE inline __attribute__((always_inline))
+
+namespace Xi {
+
+namespace {
+
+const f64 Pi = 3.14159265358979323846;
+const f64 DegToRad = Pi / 180, RadToDeg = 180 / Pi;
+
+struct Ellipsoid {
+  f64 a, b, f, e2, ep2;
+};
+
+Ellipsoid ellipsoid(const SphereConfig &c) {
+  Ellipsoid E;
+  E.a = c.a;
+  E.f = c.f;
+  E.b = c.a * (1 - c.f);
+  E.e2 = c.f * (2 - c.f);
+  E.ep2 = E.e2 / (1 - E.e2);
+  return E;
+}
+
+// Local frame axes at an origin: rows east, north, up in ECEF.
+struct Frame {
+  f64 r[3][3];
+  Ecef o;
+};
+
+Frame frame(const GeodeticSphere &s, const GeoPos &origin) {
+  f64 sl = sin(origin.lat * DegToRad), cl = cos(origin.lat * DegToRad);
+  f64 sg = sin(origin.lng * DegToRad), cg = cos(origin.lng * DegToRad);
+  Frame F = {{{-sg, cg, 0}, {-sl * cg, -sl * sg, cl}, {cl * cg, cl * sg, sl}},
+             s.toEcef(origin)};
+  return F;
+}
+
+#ifdef XI_GEO_VECTOR
+
+// Vector values only cross always_inline boundaries, so the AVX-vs-SSE
+// argument passing difference GCC warns about never applies.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef f64 V2 __attribute__((vector_size(16)));
+typedef i64 I2 __attribute__((vector_size(16)));
+typedef f64 V4 __attribute__((vector_size(32)));
+typedef i64 I4 __attribute__((vector_size(32)));
+
+template <typename V> XI_GINLINE V splat(f64 x) { return V{} + x; }
+
+template <typename V> XI_GINLINE V loadV(const f64 *p) {
+  V v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+template <typename V> XI_GINLINE void storeV(f64 *p, V v) {
+  __builtin_memcpy(p, &v, sizeof(v));
+}
+
+// 1/sqrt(x): bit-trick estimate, four Newton steps (~1 ulp). x = 0 gives
+// a huge finite value, so x * rsqrt(x) is 0 there.
+template <typename V, typename I> XI_GINLINE V rsqrtV(V x) {
+  x = x > 1e-300 ? x : splat<V>(1e-300);
+  V y = (V)((I{} + 0x5fe6eb50c7b537a9LL) - ((I)x >> 1));
+  V h = 0.5 * x;
+  y = y * (1.5 - h * y * y);
+  y = y * (1.5 - h * y * y);
+  y = y * (1.5 - h * y * y);
+  y = y * (1.5 - h * y * y);
+  return y;
+}
+
+// sin and cos of x (|x| < 1e6): reduce by pi/2 in three parts, then the
+// Cephes polynomials on [-pi/4, pi/4] and a quadrant swap.
+template <typename V, typename I> XI_GINLINE void sincosV(V x, V &s, V &c) {
+  const f64 Magic = 6755399441055744.0; // 1.5 * 2^52: rounds to integer
+  V t = x * 0.63661977236758134308 + Magic;
+  I q = (I)t;
+  V k = t - Magic;
+  V r = x - k * 1.57079632673412561417e+00;
+  r = r - k * 6.07710050630396597660e-11;
+  r = r - k * 2.02226624871116645580e-21;
+  V z = r * r;
+  V ps = ((((( 1.58962301576546568060e-10 * z - 2.50507477628578072866e-8) *
+       z + 2.75573136213857245213e-6) * z - 1.98412698295895385996e-4) *
+       z + 8.33333333332211858878e-3) * z - 1.66666666666666307295e-1);
+  V pc = (((((-1.13585365213876817300e-11 * z + 2.08757008419747316778e-9) *
+       z - 2.75573141792967388112e-7) * z + 2.48015872888517045348e-5) *
+       z - 1.38888888888730564116e-3) * z + 4.16666666666665929218e-2);
+  V sr = r + r * z * ps;
+  V cr = 1.0 - 0.5 * z + z * z * pc;
+  I swap = (q & 1) != 0;
+  V s0 = swap ? cr : sr, c0 = swap ? sr : cr;
+  s = (q & 2) != 0 ? -s0 : s0;
+  c = ((q + 1) & 2) != 0 ? -c0 : c0;
+}
+
+// atan(t) for t in [0, 1] (Cephes rational form)
+template <typename V, typename I> XI_GINLINE V atan01(V t) {
+  I mid = t > 0.66;
+  V x = mid ? (t - 1.0) / (t + 1.0) : t;
+  V z = x * x;
+  V p = ((((-8.750608600031904122785e-1 * z - 1.615753718733365076637e1) *
+       z - 7.500855792314704667340e1) * z - 1.228866684490136173410e2) *
+       z - 6.485021904942025371773e1);
+  V q = (((((z + 2.485846490142306297962e1) * z + 1.650270098316988542046e2) *
+       z + 4.328810604912902668951e2) * z + 4.853903996359136964868e2) *
+       z + 1.945506571482613964425e2);
+  V y = x + x * (z * p / q);
+  return mid ? y + (0.78539816339744830962 + 0.5 * 6.123233995736765886130e-17)
+             : y;
+}
+
+template <typename V, typename I> XI_GINLINE V atan2V(V y, V x) {
+  const I Sign = I{} + (i64)(1ULL << 63);
+  V ay = (V)((I)y & ~Sign), ax = (V)((I)x & ~Sign);
+  I swap = ay > ax;
+  V lo = swap ? ax : ay, hi = swap ? ay : ax;
+  V t = lo / (hi > 0 ? hi : splat<V>(1.0));
+  V r = atan01<V, I>(t);
+  r = swap ? 1.57079632679489661923 - r : r;
+  r = x < 0 ? 3.14159265358979323846 - r : r;
+  return (V)((I)r | ((I)y & Sign));
+}
+
+template <typename V, typename I>
+XI_GINLINE void toGeoBlock(const Ellipsoid &E, V x, V y, V z, V &lat, V &lng,
+                           V &alt) {
+  V p = x * x + y * y;
+  p = p * rsqrtV<V, I>(p);
+  V cb = (1 - E.f) * p, sb = z;
+  V num = z, den = p;
+  for (int it = 0; it < 2; ++it) {
+    V r = rsqrtV<V, I>(cb * cb + sb * sb);
+    cb *= r, sb *= r;
+    num = z + E.ep2 * E.b * sb * sb * sb;
+    den = p - E.e2 * E.a * cb * cb * cb;
+    cb = den, sb = (1 - E.f) * num;
+  }
+  V r = rsqrtV<V, I>(num * num + den * den);
+  V sl = num * r, cl = den * r;
+  V w = 1.0 - E.e2 * sl * sl;
+  alt = p * cl + z * sl - E.a * (w * rsqrtV<V, I>(w));
+  lat = atan2V<V, I>(num, den) * RadToDeg;
+  lng = atan2V<V, I>(y, x) * RadToDeg;
+}
+
+template <typename V, typename I>
+XI_GINLINE void toEcefBlock(const Ellipsoid &E, V lat, V lng, V alt, V &x,
+                            V &y, V &z) {
+  V sl, cl, sg, cg;
+  sincosV<V, I>(lat * DegToRad, sl, cl);
+  sincosV<V, I>(lng * DegToRad, sg, cg);
+  V N = E.a * rsqrtV<V, I>(1.0 - E.e2 * sl * sl);
+  V h = (N + alt) * cl;
+  x = h * cg;
+  y = h * sg;
+  z = (N * (1 - E.e2) + alt) * sl;
+}
+
+// Runs a block function over SoA arrays, W lanes at a time.
+template <typename V, typename I, typename F>
+XI_GINLINE void blocks(const f64 *a, const f64 *b, const f64 *c, f64 *o0,
+                       f64 *o1, f64 *o2, usz n, F f) {
+  const usz W = sizeof(V) / sizeof(f64);
+  usz i = 0;
+  for (; i + W <= n; i += W) {
+    V r0, r1, r2;
+    f(loadV<V>(a + i), loadV<V>(b + i), loadV<V>(c + i), r0, r1, r2);
+    storeV(o0 + i, r0), storeV(o1 + i, r1), storeV(o2 + i, r2);
+  }
+  if (i == n)
+    return;
+  f64 in[3][W], out[3][W];
+  for (usz k = 0; k < W; ++k) {
+    usz j = i + k < n ? i + k : i;
+    in[0][k] = a[j], in[1][k] = b[j], in[2][k] = c[j];
+  }
+  V r0, r1, r2;
+  f(loadV<V>(in[0]), loadV<V>(in[1]), loadV<V>(in[2]), r0, r1, r2);
+  storeV(out[0], r0), storeV(out[1], r1), storeV(out[2], r2);
+  for (usz k = 0; i + k < n; ++k)
+    o0[i + k] = out[0][k], o1[i + k] = out[1][k], o2[i + k] = out[2][k];
+}
+
+struct Batch {
+  const Ellipsoid *E;
+  const f64 *a, *b, *c;
+  f64 *o0, *o1, *o2;
+  usz n;
+};
+
+template <typename V, typename I> XI_GINLINE void toGeoLoop(const Batch &j) {
+  const Ellipsoid &E = *j.E;
+  blocks<V, I>(j.a, j.b, j.c, j.o0, j.o1, j.o2, j.n,
+               [&](V x, V y, V z, V &la, V &lo, V &al)
+                   __attribute__((always_inline)) {
+                     toGeoBlock<V, I>(E, x, y, z, la, lo, al);
+                   });
+}
+
+template <typename V, typename I> XI_GINLINE void toEcefLoop(const Batch &j) {
+  const Ellipsoid &E = *j.E;
+  blocks<V, I>(j.a, j.b, j.c, j.o0, j.o1, j.o2, j.n,
+               [&](V la, V lo, V al, V &x, V &y, V &z)
+                   __attribute__((always_inline)) {
+                     toEcefBlock<V, I>(E, la, lo, al, x, y, z);
+                   });
+}
+
+typedef void (*BatchKernel)(const Batch &j);
+
+#if defined(XI_GEO_X86)
+__attribute__((target("avx2,fma"))) void toGeoAvx2(const Batch &j) {
+  toGeoLoop<V4, I4>(j);
+}
+__attribute__((target("avx2,fma"))) void toEcefAvx2(const Batch &j) {
+  toEcefLoop<V4, I4>(j);
+}
+#endif
+void toGeoBase(const Batch &j) { toGeoLoop<V2, I2>(j); }
+void toEcefBase(const Batch &j) { toEcefLoop<V2, I2>(j); }
+
+bool sameName(const char *a, const char *b) {
+  while (*a && *a == *b)
+    a++, b++;
+  return *a == *b;
+}
+
+bool useAvx2() {
+#if defined(XI_GEO_X86)
+  const char *isa = Math::Simd::isa();
+  return sameName(isa, "avx512") || sameName(isa, "avx2");
+#else
+  return false;
+#endif
+}
+
+#endif // XI_GEO_VECTOR
+
+} // namespace
+
+// --- Single points ---
+
+Ecef GeodeticSphere::toEcef(const GeoPos &g) const {
+  Ellipsoid E = ellipsoid(config);
+  f64 sl = sin(g.lat * DegToRad), cl = cos(g.lat * DegToRad);
+  f64 sg = sin(g.lng * DegToRad), cg = cos(g.lng * DegToRad);
+  f64 N = E.a / sqrt(1 - E.e2 * sl * sl);
+  return {(N + g.alt) * cl * cg, (N + g.alt) * cl * sg,
+          (N * (1 - E.e2) + g.alt) * sl};
+}
+
+GeoPos GeodeticSphere::toGeo(const Ecef &q) const {
+  Ellipsoid E = ellipsoid(config);
+  f64 p = sqrt(q.x * q.x + q.y * q.y);
+  if (p == 0 && q.z == 0)
+    return {0, 0, -E.b};
+  f64 cb = (1 - E.f) * p, sb = q.z, num = q.z, den = p;
+  for (int it = 0; it < 2; ++it) {
+    f64 r = 1 / sqrt(cb * cb + sb * sb);
+    cb *= r, sb *= r;
+    num = q.z + E.ep2 * E.b * sb * sb * sb;
+    den = p - E.e2 * E.a * cb * cb * cb;
+    cb = den, sb = (1 - E.f) * num;
+  }
+  f64 r = 1 / sqrt(num * num + den * den);
+  f64 sl = num * r, cl = den * r;
+  return {atan2(num, den) * RadToDeg, atan2(q.y, q.x) * RadToDeg,
+          p * cl + q.z * sl - E.a * sqrt(1 - E.e2 * sl * sl)};
+}
+
+Enu GeodeticSphere::toEnu(const GeoPos &origin, const Ecef &p) const {
+  Frame F = frame(*this, origin);
+  f64 d[3] = {p.x - F.o.x, p.y - F.o.y, p.z - F.o.z};
+  f64 r[3];
+  for (int k = 0; k < 3; ++k)
+    r[k] = F.r[k][0] * d[0] + F.r[k][1] * d[1] + F.r[k][2] * d[2];
+  return {r[0], r[1], r[2]};
+}
+
+Ecef GeodeticSphere::fromEnu(const GeoPos &origin, const Enu &p) const {
+  Frame F = frame(*this, origin);
+  f64 v[3] = {p.e, p.n, p.u}, r[3];
+  for (int k = 0; k < 3; ++k)
+    r[k] = F.r[0][k] * v[0] + F.r[1][k] * v[1] + F.r[2][k] * v[2];
+  return {F.o.x + r[0], F.o.y + r[1], F.o.z + r[2]};
+}
+
+// --- Batches ---
+
+void GeodeticSphere::toEcef(const f64 *lat, const f64 *lng, const f64 *alt,
+                            f64 *x, f64 *y, f64 *z, usz n) const {
+#ifdef XI_GEO_VECTOR
+  Ellipsoid E = ellipsoid(config);
+  Batch j = {&E, lat, lng, alt, x, y, z, n};
+  (useAvx2() ? toEcefAvx2 : toEcefBase)(j);
+#else
+  for (usz i = 0; i < n; ++i) {
+    Ecef p = toEcef(GeoPos{lat[i], lng[i], alt[i]});
+    x[i] = p.x, y[i] = p.y, z[i] = p.z;
+  }
+#endif
+}
+
+void GeodeticSphere::toGeo(const f64 *x, const f64 *y, const f64 *z, f64 *lat,
+                           f64 *lng, f64 *alt, usz n) const {
+#ifdef XI_GEO_VECTOR
+  Ellipsoid E = ellipsoid(config);
+  Batch j = {&E, x, y, z, lat, lng, alt, n};
+  (useAvx2() ? toGeoAvx2 : toGeoBase)(j);
+#else
+  for (usz i = 0; i < n; ++i) {
+    GeoPos g = toGeo(Ecef{x[i], y[i], z[i]});
+    lat[i] = g.lat, lng[i] = g.lng, alt[i] = g.alt;
+  }
+#endif
+}
+
+// The rotation is plain multiply-add, which the compiler vectorizes.
+void GeodeticSphere::toEnu(const GeoPos &origin, const f64 *x, const f64 *y,
+                           const f64 *z, f64 *e, f64 *nn, f64 *u,
+                           usz n) const {
+  Frame F = frame(*this, origin);
+  for (usz i = 0; i < n; ++i) {
+    f64 dx = x[i] - F.o.x, dy = y[i] - F.o.y, dz = z[i] - F.o.z;
+    e[i] = F.r[0][0] * dx + F.r[0][1] * dy;
+    nn[i] = F.r[1][0] * dx + F.r[1][1] * dy + F.r[1][2] * dz;
+    u[i] = F.r[2][0] * dx + F.r[2][1] * dy + F.r[2][2] * dz;
+  }
+}
+
+void GeodeticSphere::fromEnu(const GeoPos &origin, const f64 *e,
+                             const f64 *nn, const f64 *u, f64 *x, f64 *y,
+                             f64 *z, usz n) const {
+  Frame F = frame(*this, origin);
+  for (usz i = 0; i < n; ++i) {
+    f64 a = e[i], b = nn[i], c = u[i];
+    x[i] = F.o.x + F.r[0][0] * a + F.r[1][0] * b + F.r[2][0] * c;
+    y[i] = F.o.y + F.r[0][1] * a + F.r[1][1] * b + F.r[2][1] * c;
+    z[i] = F.o.z + F.r[1][2] * b + F.r[2][2] * c;
+  }
+}
+
+} // namespace Xi
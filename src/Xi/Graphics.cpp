@@ -126,7 +126,7 @@ void GraphicsContext::bindResources(void *rtv, void *dsv, int w, int h) {
   ctx->SetScissorRects(1, &S, w, h);
 }
 
-void GraphicsContext::drawMesh(void *vb, void *ib, u32 indices) {
+void GraphicsContext::drawMesh(void *vb, void *ib, u32 indices, bool index16) {
   if (vb == nullptr || ib == nullptr || indices == 0) {
     return;
   }
@@ -143,7 +143,7 @@ void GraphicsContext::drawMesh(void *vb, void *ib, u32 indices) {
 
   Diligent::DrawIndexedAttribs DrawAttrs;
   DrawAttrs.NumIndices = indices;
-  DrawAttrs.IndexType = Diligent::VT_UINT32;
+  DrawAttrs.IndexType = index16 ? Diligent::VT_UINT16 : Diligent::VT_UINT32;
   DrawAttrs.Flags = Diligent::DRAW_FLAG_VERIFY_ALL;
 
   ctx->DrawIndexed(DrawAttrs);
@@ -162,6 +162,98 @@ void GraphicsContext::createBuffer(void *data, u32 size, bool isIndex,
   device->CreateBuffer(D, &Init, (Diligent::IBuffer **)buf);
 }
 
+// -------------------------------------------------------------------------
+// GraphicsDrawBackend
+// -------------------------------------------------------------------------
+
+GraphicsDrawBackend::~GraphicsDrawBackend() { GraphicsContext::release(_instances); }
+
+void GraphicsDrawBackend::setPipeline(void *pipeline) {
+  gContext.setPipelineState(pipeline);
+}
+
+void GraphicsDrawBackend::setTexture(void *slot, void *texture) {
+  if (slot && texture)
+    ((Diligent::IShaderResourceVariable *)slot)
+        ->Set((Diligent::ITextureView *)texture);
+}
+
+void GraphicsDrawBackend::commit(void *bindings) {
+  gContext.commitResources(bindings);
+}
+
+void GraphicsDrawBackend::setMesh(void *vertices, void *indices, bool index16) {
+  Diligent::Uint64 offset = 0;
+  Diligent::IBuffer *pVBs[] = {(Diligent::IBuffer *)vertices};
+  gContext.ctx->SetVertexBuffers(
+      0, 1, pVBs, &offset, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+      Diligent::SET_VERTEX_BUFFERS_FLAG_RESET);
+  gContext.ctx->SetIndexBuffer((Diligent::IBuffer *)indices, 0,
+                               Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION);
+  _index16 = index16;
+}
+
+void GraphicsDrawBackend::setUniforms(void *uniforms, const Matrix4 &mvp,
+                                      const Matrix4 &world) {
+  // Matches ShaderData: g_MVP then g_Model
+  void *m = gContext.mapBuffer(uniforms);
+  if (m) {
+    memcpy(m, &mvp, sizeof(Matrix4));
+    memcpy((u8 *)m + sizeof(Matrix4), &world, sizeof(Matrix4));
+    gContext.unmapBuffer(uniforms);
+  }
+}
+
+void GraphicsDrawBackend::draw(u32 indexCount) {
+  if (indexCount == 0)
+    return;
+  Diligent::DrawIndexedAttribs DrawAttrs;
+  DrawAttrs.NumIndices = indexCount;
+  DrawAttrs.IndexType = _index16 ? Diligent::VT_UINT16 : Diligent::VT_UINT32;
+  DrawAttrs.Flags = Diligent::DRAW_FLAG_VERIFY_ALL;
+  gContext.ctx->DrawIndexed(DrawAttrs);
+}
+
+void GraphicsDrawBackend::drawInstanced(u32 indexCount, const Matrix4 *worlds,
+                                        u32 count) {
+  if (indexCount == 0 || count == 0 || !gContext.device)
+    return;
+  if (count > _capacity) {
+    GraphicsContext::release(_instances);
+    _instances = nullptr;
+    _capacity = count < 256 ? 256 : count;
+    Diligent::BufferDesc D;
+    D.Name = "Xi_Instances";
+    D.BindFlags = Diligent::BIND_VERTEX_BUFFER;
+    D.Usage = Diligent::USAGE_DYNAMIC;
+    D.CPUAccessFlags = Diligent::CPU_ACCESS_WRITE;
+    D.Size = (Diligent::Uint64)_capacity * sizeof(Matrix4);
+    gContext.device->CreateBuffer(D, nullptr, (Diligent::IBuffer **)&_instances);
+    if (!_instances) {
+      _capacity = 0;
+      return;
+    }
+  }
+  void *m = gContext.mapBuffer(_instances);
+  if (!m)
+    return;
+  memcpy(m, worlds, (usz)count * sizeof(Matrix4));
+  gContext.unmapBuffer(_instances);
+
+  Diligent::Uint64 offset = 0;
+  Diligent::IBuffer *pVBs[] = {(Diligent::IBuffer *)_instances};
+  gContext.ctx->SetVertexBuffers(
+      1, 1, pVBs, &offset, Diligent::RESOURCE_STATE_TRANSITION_MODE_TRANSITION,
+      Diligent::SET_VERTEX_BUFFERS_FLAG_NONE);
+
+  Diligent::DrawIndexedAttribs DrawAttrs;
+  DrawAttrs.NumIndices = indexCount;
+  DrawAttrs.NumInstances = count;
+  DrawAttrs.IndexType = _index16 ? Diligent::VT_UINT16 : Diligent::VT_UINT32;
+  DrawAttrs.Flags = Diligent::DRAW_FLAG_VERIFY_ALL;
+  gContext.ctx->DrawIndexed(DrawAttrs);
+}
+
 void *GraphicsContext::mapBuffer(void *buffer) {
   if (!buffer || !ctx)
     return nullptr;
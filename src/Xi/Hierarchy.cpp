@@ -0,0 +1,174 @@
+#include <Xi/Hierarchy.hpp>
+#include <Xi/Tree.hpp>
+#include <Xi/Worker.hpp>
+
+#include <atomic>
+
+namespace Xi {
+
+u32 TransformHierarchy::add(u32 parent, Vector3 position, Vector3 rotation,
+                            Vector3 scale) {
+  if (parent != None && parent >= size())
+    return None;
+  u32 i = (u32)size();
+  _parent.push(parent);
+  _firstChild.push(None);
+  _lastChild.push(None);
+  _nextSibling.push(None);
+  if (parent != None) {
+    if (_lastChild[parent] == None)
+      _firstChild[parent] = i;
+    else
+      _nextSibling[_lastChild[parent]] = i;
+    _lastChild[parent] = i;
+  }
+  const Vector3 trs[3] = {position, rotation, scale};
+  for (usz p = 0; p < 3; ++p) {
+    _trs[p * 3].push(trs[p].x);
+    _trs[p * 3 + 1].push(trs[p].y);
+    _trs[p * 3 + 2].push(trs[p].z);
+  }
+  Matrix4 id = Math::identity();
+  _local.push(id);
+  _world.push(id);
+  _worldVersion.push(0);
+  _source.push(nullptr);
+  _sourceVersion.push(0);
+  _dirty.push(0);
+  touch(i);
+  return i;
+}
+
+u32 TransformHierarchy::add(u32 parent, const Transform *source) {
+  if (!source)
+    return add(parent);
+  u32 i = add(parent, source->getPosition(), source->getRotation(),
+              source->getScale());
+  if (i == None)
+    return None;
+  _source[i] = source;
+  _sourceVersion[i] = source->transformVersion;
+  _bound.push(i);
+  return i;
+}
+
+usz TransformHierarchy::addTree(TreeItem *root, u32 parent) {
+  if (!root)
+    return 0;
+  usz added = 0;
+  if (Transform *t = dynamic_cast<Transform *>(root)) {
+    parent = add(parent, t);
+    if (parent == None)
+      return 0;
+    added++;
+  }
+  for (usz c = 0; c < root->children.length(); ++c)
+    added += addTree(root->children[c], parent);
+  return added;
+}
+
+usz TransformHierarchy::sync() {
+  usz changed = 0;
+  for (usz b = 0; b < _bound.size(); ++b) {
+    u32 i = _bound[b];
+    const Transform *t = _source[i];
+    if (t->transformVersion == _sourceVersion[i])
+      continue;
+    _sourceVersion[i] = t->transformVersion;
+    setPlane3(0, i, t->getPosition());
+    setPlane3(3, i, t->getRotation());
+    setPlane3(6, i, t->getScale());
+    touch(i);
+    changed++;
+  }
+  return changed;
+}
+
+// Gathers the dirty nodes' TRS into planes, composes them in one batch and
+// scatters the matrices back.
+void TransformHierarchy::composeLocals() {
+  usz k = _pending.size();
+  _scratch.allocate(25 * k);
+  f32 *in = _scratch.data(), *out = in + 9 * k;
+  for (usz p = 0; p < 9; ++p) {
+    const f32 *src = _trs[p].data();
+    f32 *dst = in + p * k;
+    for (usz j = 0; j < k; ++j)
+      dst[j] = src[_pending[j]];
+  }
+  Math::compose(in, in + 3 * k, in + 6 * k, out, k);
+  for (usz j = 0; j < k; ++j) {
+    f32 *m = &_local[_pending[j]].m[0][0];
+    for (usz e = 0; e < 16; ++e)
+      m[e] = out[e * k + j];
+  }
+}
+
+// Rewrites world matrices of @p root and its descendants, depth first
+// without a stack: down to the first child, across to the next sibling,
+// back up when a level is exhausted.
+usz TransformHierarchy::walk(u32 root) {
+  usz count = 0;
+  u32 i = root;
+  for (;;) {
+    u32 p = _parent[i];
+    _world[i] = p == None ? _local[i] : Math::multiply(_local[i], _world[p]);
+    _worldVersion[i]++;
+    count++;
+    if (_firstChild[i] != None) {
+      i = _firstChild[i];
+      continue;
+    }
+    while (i != root && _nextSibling[i] == None)
+      i = _parent[i];
+    if (i == root)
+      return count;
+    i = _nextSibling[i];
+  }
+}
+
+usz TransformHierarchy::update(WorkerPool *pool) {
+  usz k = _pending.size();
+  if (k == 0)
+    return 0;
+  composeLocals();
+
+  // Subtree roots: dirty nodes with no dirty ancestor. Their subtrees are
+  // disjoint and each reads only its own, already final, parent world.
+  InlineArray<u32> roots;
+  for (usz j = 0; j < k; ++j) {
+    u32 i = _pending[j], p = _parent[i];
+    while (p != None && !_dirty[p])
+      p = _parent[p];
+    if (p == None)
+      roots.push(i);
+  }
+
+  usz written = 0;
+  usz n = roots.size();
+  if (pool && pool->size() > 0 && n > 1) {
+    std::atomic<usz> total(0);
+    pool->parallelFor(
+        n,
+        [&](usz begin, usz end) {
+          usz c = 0;
+          for (usz r = begin; r < end; ++r)
+            c += walk(roots[r]);
+          total.fetch_add(c, std::memory_order_relaxed);
+        },
+        16);
+    written = total.load();
+  } else {
+    for (usz r = 0; r < n; ++r)
+      written += walk(roots[r]);
+  }
+
+  for (usz j = 0; j < k; ++j)
+    _dirty[_pending[j]] = 0;
+  _pending.allocate(0);
+  return written;
+}
+
+void TransformHierarchy::clear() { *this = TransformHierarchy(); }
+
+} // namespace Xi
@@ -0,0 +1,264 @@
+#include "../../include/Xi/HostMemory.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__) && !defined(ARDUINO)
+#define XI_HOST_MMAP
+#define XI_HOST_LINUX
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif (defined(__APPLE__) || defined(__unix__)) && !defined(__EMSCRIPTEN__)
+#define XI_HOST_MMAP
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace Xi {
+
+namespace {
+
+enum Kind : u8 { Heap = 0, Mapped, HugeMapped };
+
+// The handle handed out by CpuMemoryDevice. Kept apart from the data so a
+// 2 MiB aligned mapping is not pushed onto an extra page by a header.
+struct HostAllocation {
+  u8 *ptr;
+  usz size;   ///< Requested
+  usz mapped; ///< Length of the mapping (0 for heap)
+  usz page;   ///< Page size used to prefault
+  Kind kind;
+};
+
+inline HostAllocation *rec(void *handle) { return (HostAllocation *)handle; }
+
+usz roundUp(usz v, usz to) { return (v + to - 1) / to * to; }
+
+usz basePage() {
+#ifdef XI_HOST_MMAP
+  long p = sysconf(_SC_PAGESIZE);
+  return p > 0 ? (usz)p : 4096;
+#else
+  return 4096;
+#endif
+}
+
+u8 *heapAlloc(usz size, usz align) {
+  // Every allocator below wants a power of two no smaller than a pointer.
+  usz pow2 = sizeof(void *);
+  while (pow2 < align)
+    pow2 <<= 1;
+  align = pow2;
+#if defined(_WIN32)
+  return (u8 *)_aligned_malloc(size, align);
+#elif defined(ARDUINO)
+  (void)align;
+  return (u8 *)malloc(size);
+#else
+  void *p = nullptr;
+  if (posix_memalign(&p, align, size) != 0)
+    return nullptr;
+  return (u8 *)p;
+#endif
+}
+
+void heapFree(u8 *p) {
+#if defined(_WIN32)
+  _aligned_free(p);
+#else
+  ::free(p);
+#endif
+}
+
+#ifdef XI_HOST_LINUX
+// mbind(2) without a libnuma dependency.
+bool numaBind(void *p, usz len, i32 node) {
+  if (node < 0)
+    return true;
+  const usz Words = 16; // up to 1024 nodes
+  if ((usz)node >= Words * 64)
+    return false;
+  unsigned long mask[Words] = {};
+  mask[node / 64] |= 1UL << (node % 64);
+  const int MPOL_BIND_ = 2;
+  const unsigned MPOL_MF_MOVE_ = 1u << 1;
+  return syscall(SYS_mbind, p, len, MPOL_BIND_, mask, Words * 64,
+                 MPOL_MF_MOVE_) == 0;
+}
+#endif
+
+} // namespace
+
+void *CpuMemoryDevice::alloc(usz size) {
+  if (size == 0)
+    size = 1;
+  HostAllocation *a = new HostAllocation();
+  a->size = size;
+  a->mapped = 0;
+  a->page = basePage();
+  a->kind = Heap;
+  a->ptr = nullptr;
+
+#ifdef XI_HOST_MMAP
+  if (size >= config.mapThreshold) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef XI_HOST_LINUX
+    if (config.pages == Huge2M || config.pages == Huge1G) {
+      const int shift = config.pages == Huge2M ? 21 : 30;
+      usz huge = (usz)1 << shift;
+      usz len = roundUp(size, huge);
+      void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                     flags | MAP_HUGETLB | (shift << MAP_HUGE_SHIFT), -1, 0);
+      if (p != MAP_FAILED) {
+        a->ptr = (u8 *)p;
+        a->mapped = len;
+        a->page = huge;
+        a->kind = HugeMapped;
+      } else {
+        hugeFallbacks++;
+      }
+    }
+#endif
+    if (!a->ptr) {
+      usz len = roundUp(size, a->page);
+      void *p = mmap(nullptr, len, PROT_READ | PROT_WRITE, flags, -1, 0);
+      if (p != MAP_FAILED) {
+        a->ptr = (u8 *)p;
+        a->mapped = len;
+        a->kind = Mapped;
+#ifdef XI_HOST_LINUX
+        if (config.pages != Normal)
+          madvise(p, len, MADV_HUGEPAGE);
+#endif
+      }
+    }
+  }
+#endif
+
+  if (!a->ptr) {
+    a->ptr = heapAlloc(size, config.alignment);
+    if (!a->ptr) {
+      delete a;
+      return nullptr;
+    }
+  }
+
+  if (a->kind != Heap) {
+#ifdef XI_HOST_LINUX
+    numaBind(a->ptr, a->mapped, config.numaNode);
+#endif
+    if (config.advice)
+      advise(a, config.advice);
+    mappedBytes += a->mapped;
+    if (a->kind == HugeMapped)
+      hugeMappings++;
+  }
+  if (config.prefault)
+    prefault(a);
+
+  liveBytes += size;
+  return a;
+}
+
+void CpuMemoryDevice::free(void *handle) {
+  if (!handle)
+    return;
+  HostAllocation *a = rec(handle);
+  liveBytes -= a->size;
+  if (a->kind == Heap) {
+    heapFree(a->ptr);
+  } else {
+    mappedBytes -= a->mapped;
+    if (a->kind == HugeMapped)
+      hugeMappings--;
+#ifdef XI_HOST_MMAP
+    munmap(a->ptr, a->mapped);
+#endif
+  }
+  delete a;
+}
+
+void CpuMemoryDevice::upload(void *handle, const void *src, usz size) {
+  if (!handle || !src)
+    return;
+  HostAllocation *a = rec(handle);
+  memcpy(a->ptr, src, size < a->size ? size : a->size);
+}
+
+void CpuMemoryDevice::download(void *handle, void *dst, usz size) {
+  if (!handle || !dst)
+    return;
+  HostAllocation *a = rec(handle);
+  memcpy(dst, a->ptr, size < a->size ? size : a->size);
+}
+
+void *CpuMemoryDevice::view(void *handle, i32 type) {
+  (void)type;
+  return handle ? rec(handle)->ptr : nullptr;
+}
+
+usz CpuMemoryDevice::sizeOf(void *handle) const {
+  return handle ? rec(handle)->size : 0;
+}
+
+bool CpuMemoryDevice::isHuge(void *handle) const {
+  return handle && rec(handle)->kind == HugeMapped;
+}
+
+bool CpuMemoryDevice::advise(void *handle, u8 advice) {
+  if (!handle)
+    return false;
+  HostAllocation *a = rec(handle);
+  if (a->kind == Heap)
+    return false; // heap memory shares pages with other allocations
+#ifdef XI_HOST_MMAP
+  bool ok = true;
+  if (advice & AdviseSequential)
+    ok &= madvise(a->ptr, a->mapped, MADV_SEQUENTIAL) == 0;
+  if (advice & AdviseRandom)
+    ok &= madvise(a->ptr, a->mapped, MADV_RANDOM) == 0;
+  if (advice & AdviseWillNeed)
+    ok &= madvise(a->ptr, a->mapped, MADV_WILLNEED) == 0;
+#ifdef XI_HOST_LINUX
+  if (advice & AdviseDontDump)
+    ok &= madvise(a->ptr, a->mapped, MADV_DONTDUMP) == 0;
+  if (advice & AdviseDontFork)
+    ok &= madvise(a->ptr, a->mapped, MADV_DONTFORK) == 0;
+#endif
+  return ok;
+#else
+  (void)advice;
+  return false;
+#endif
+}
+
+bool CpuMemoryDevice::bind(void *handle, i32 numaNode) {
+  if (!handle)
+    return false;
+  HostAllocation *a = rec(handle);
+  if (a->kind == Heap)
+    return false;
+#ifdef XI_HOST_LINUX
+  return numaBind(a->ptr, a->mapped, numaNode);
+#else
+  (void)numaNode;
+  return false;
+#endif
+}
+
+void CpuMemoryDevice::prefault(void *handle) {
+  if (!handle)
+    return;
+  HostAllocation *a = rec(handle);
+  // Writing a byte back forces the page in (on the bound node) without
+  // changing its contents.
+  volatile u8 *p = a->ptr;
+  usz len = a->kind == Heap ? a->size : a->mapped;
+  for (usz off = 0; off < len; off += a->page)
+    p[off] = p[off];
+}
+
+} // namespace Xi
@@ -102,90 +102,7 @@ Matrix4 ortho(f32 l, f32 r_, f32 b, f32 t, f32 n, f32 f) {
   return r;
 }
 
-Matrix4 transpose(const Matrix4 &m) {
-  Matrix4 r;
-  for (int i = 0; i < 4; ++i)
-    for (int j = 0; j < 4; ++j)
-      r.m[i][j] = m.m[j][i];
-  return r;
-}
-
-Matrix4 multiply(const Matrix4 &a, const Matrix4 &b) {
-  Matrix4 r = {{{0}}};
-  for (int i = 0; i < 4; ++i) {
-    for (int k = 0; k < 4; ++k) {
-      f32 aik = a.m[i][k];
-      _Pragma("omp simd") for (int j = 0; j < 4; ++j) {
-        r.m[i][j] += aik * b.m[k][j];
-      }
-    }
-  }
-  return r;
-}
-
-f32 det(const Matrix4 &m) {
-  f32 a = m.m[0][0], b = m.m[0][1], c = m.m[0][2], d = m.m[0][3];
-  f32 e = m.m[1][0], f = m.m[1][1], g = m.m[1][2], h = m.m[1][3];
-  f32 i = m.m[2][0], j = m.m[2][1], k = m.m[2][2], l = m.m[2][3];
-  f32 n = m.m[3][0], o = m.m[3][1], p = m.m[3][2], q = m.m[3][3];
-
-  return a * (f * (k * q - l * p) - g * (j * q - l * o) + h * (j * p - k * o)) -
-         b * (e * (k * q - l * p) - g * (i * q - l * n) + h * (i * p - k * n)) +
-         c * (e * (j * q - l * o) - f * (i * q - l * n) + h * (i * o - j * n)) -
-         d * (e * (j * p - k * o) - f * (i * p - k * n) + g * (i * o - j * n));
-}
-
-Matrix4 inverse(const Matrix4 &m) {
-  f32 d = det(m);
-  if (Xi::Math::abs(d) < 1e-8f)
-    return identity();
-  f32 invDet = 1.0f / d;
-
-  f32 a = m.m[0][0], b = m.m[0][1], c = m.m[0][2], d_ = m.m[0][3];
-  f32 e = m.m[1][0], f = m.m[1][1], g = m.m[1][2], h = m.m[1][3];
-  f32 i = m.m[2][0], j = m.m[2][1], k = m.m[2][2], l = m.m[2][3];
-  f32 n = m.m[3][0], o = m.m[3][1], p = m.m[3][2], q = m.m[3][3];
-
-  Matrix4 res;
-  res.m[0][0] = invDet * (f * (k * q - l * p) - g * (j * q - l * o) +
-                          h * (j * p - k * o));
-  res.m[1][0] = -invDet * (e * (k * q - l * p) - g * (i * q - l * n) +
-                           h * (i * p - k * n));
-  res.m[2][0] = invDet * (e * (j * q - l * o) - f * (i * q - l * n) +
-                          h * (i * o - j * n));
-  res.m[3][0] = -invDet * (e * (j * p - k * o) - f * (i * p - k * n) +
-                           g * (i * o - j * n));
-
-  res.m[0][1] = -invDet * (b * (k * q - l * p) - c * (j * q - l * o) +
-                           d_ * (j * p - k * o));
-  res.m[1][1] = invDet * (a * (k * q - l * p) - c * (i * q - l * n) +
-                          d_ * (i * p - k * n));
-  res.m[2][1] = -invDet * (a * (j * q - l * o) - b * (i * q - l * n) +
-                           d_ * (i * o - j * n));
-  res.m[3][1] = invDet * (a * (j * p - k * o) - b * (i * p - k * n) +
-                          c * (i * o - j * n));
-
-  res.m[0][2] = invDet * (b * (g * q - h * p) - c * (f * q - h * o) +
-                          d_ * (f * p - g * o));
-  res.m[1][2] = -invDet * (a * (g * q - h * p) - c * (e * q - h * n) +
-                           d_ * (e * p - g * n));
-  res.m[2][2] = invDet * (a * (f * q - h * o) - b * (e * q - h * n) +
-                          d_ * (e * o - f * n));
-  res.m[3][2] = -invDet * (a * (f * p - g * o) - b * (e * p - g * n) +
-                           c * (e * o - f * n));
-
-  res.m[0][3] = -invDet * (b * (g * l - h * k) - c * (f * l - h * j) +
-                           d_ * (f * k - g * j));
-  res.m[1][3] = invDet * (a * (g * l - h * k) - c * (e * l - h * i) +
-                          d_ * (e * k - g * i));
-  res.m[2][3] = -invDet * (a * (f * l - h * j) - b * (e * l - h * i) +
-                           d_ * (e * j - f * i));
-  res.m[3][3] = invDet * (a * (f * k - g * j) - b * (e * k - g * i) +
-                          c * (e * j - f * i));
-
-  return res;
-}
-f32 sum(const Array<f32> &a) {
+template <> f32 sum<f32>(const Array<f32> &a) {
     f32 s = 0;
     for (usz i = 0; i < a.fragments.size(); ++i) {
         const auto &f = a.fragments.data()[i];
@@ -196,12 +113,12 @@ f32 sum(const Array<f32> &a) {
     return s;
 }
 
-f32 mean(const Array<f32> &a) {
+template <> f32 mean<f32>(const Array<f32> &a) {
     usz n = a.size();
     return (n == 0) ? 0 : sum(a) / (f32)n;
 }
 
-f32 var(const Array<f32> &a) {
+template <> f32 var<f32>(const Array<f32> &a) {
     usz n = a.size();
     if (n == 0) return 0;
     f32 m = mean(a);
@@ -218,9 +135,9 @@ f32 var(const Array<f32> &a) {
     return v / (f32)n;
 }
 
-f32 std(const Array<f32> &a) { return Xi::Math::sqrt(var(a)); }
+template <> f32 std<f32>(const Array<f32> &a) { return Xi::Math::sqrt(var(a)); }
 
-Array<f32> softmax(const Array<f32> &a) {
+template <> Array<f32> softmax<Array<f32>>(const Array<f32> &a) {
     Array<f32> res;
     usz n = a.size();
     res.allocate(n);
@@ -232,20 +149,22 @@ Array<f32> softmax(const Array<f32> &a) {
         for (usz k = 0; k < count; ++k)
             if (d[k] > maxVal) maxVal = d[k];
     }
+    // exp(d - max) per fragment through the vectorized kernel, in place in
+    // the (contiguous) result.
+    f32 *r = res.data();
     f32 sumExp = 0;
     for (usz i = 0; i < a.fragments.size(); ++i) {
         const auto &f = a.fragments.data()[i];
         const f32 *d = f.data();
         usz count = f.size();
-        usz offset = f.offset;
-        for (usz k = 0; k < count; ++k) {
-            f32 e = Xi::Math::exp(d[k] - maxVal);
-            res[offset + k] = e;
-            sumExp += e;
-        }
+        f32 *out = r + f.offset;
+        for (usz k = 0; k < count; ++k) out[k] = d[k] - maxVal;
+        Simd::exp(out, out, count);
+        _Pragma("omp simd reduction(+ : sumExp)")
+        for (usz k = 0; k < count; ++k) sumExp += out[k];
     }
     f32 invSumExp = 1.0f / sumExp;
-    for (usz i = 0; i < n; i++) res[i] *= invSumExp;
+    _Pragma("omp simd") for (usz i = 0; i < n; i++) r[i] *= invSumExp;
     return res;
 }
 
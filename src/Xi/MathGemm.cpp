@@ -0,0 +1,828 @@
+#include <Xi/Array.hpp>
+#include <Xi/Math.hpp>
+#include <Xi/Worker.hpp>
+
+// -------------------------------------------------------------------------
+// Dense matrix products (row-major)
+//
+// GEMM follows the Goto/BLIS layering. C is walked in NC-wide column panels
+// and K in KC-deep slices. Each KC x NC slice of B is packed once into
+// NR-wide strips (L3/L2 resident), each MC x KC block of A into MR-tall
+// strips (L2), and a register micro-kernel accumulates an MR x NR tile of C
+// over the whole slice (one B strip in L1). Packing also zero-pads the ragged
+// edges, so the micro-kernel never branches on shape.
+//
+// Micro-kernels are written with vector extensions and instantiated per
+// instruction set like the kernels in MathSimd.cpp; the set follows
+// Simd::isa(), so Simd::use("scalar") also selects the plain loops here.
+// int8 products are packed as pairs of sign-extended 16-bit values so that
+// x86 can use pmaddwd (two multiply-adds per 32-bit lane, exact in i32).
+// -------------------------------------------------------------------------
+
+#if defined(__GNUC__) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define XI_GEMM_VECTOR
+#if defined(__x86_64__) || defined(__i386__)
+#define XI_GEMM_X86
+#include <immintrin.h>
+#endif
+#endif
+
+namespace Xi {
+namespace Math {
+
+namespace {
+
+// Below this many multiply-adds packing costs more than it saves.
+const usz DirectLimit = 24 * 24 * 24;
+// Below this many multiply-adds a pool is not worth waking.
+const usz ParallelLimit = 128 * 128 * 128;
+
+/// Heap buffer aligned to a cache line, reused across calls on one thread.
+struct Scratch {
+  u8 *raw = nullptr;
+  usz bytes = 0;
+
+  ~Scratch() { delete[] raw; }
+
+  template <typename T> T *get(usz count) {
+    usz need = count * sizeof(T) + 64;
+    if (need > bytes) {
+      delete[] raw;
+      raw = new u8[need];
+      bytes = need;
+    }
+    return (T *)(((usz)raw + 63) & ~(usz)63);
+  }
+};
+
+struct GemmShape {
+  usz mr, nr, kc, mc, nc;
+};
+
+typedef void (*KernelF32)(usz kc, const f32 *pa, const f32 *pb, f32 *c,
+                          usz ldc, f32 alpha, usz m, usz n);
+typedef void (*KernelI8)(usz kp, const i32 *pa, const i32 *pb, i32 *c,
+                         usz ldc, usz m, usz n);
+typedef void (*GemvF32)(usz m, usz k, f32 alpha, const f32 *a, usz lda,
+                        const f32 *x, f32 beta, f32 *y);
+typedef void (*GemvI8)(usz m, usz k, const i8 *a, usz lda, const i8 *x,
+                       i32 *y);
+
+struct GemmTable {
+  const char *isa;
+  GemmShape f32Shape, i8Shape; // i8 kc counts k pairs
+  KernelF32 f32Kernel;
+  KernelI8 i8Kernel;
+  GemvF32 f32Gemv;
+  GemvI8 i8Gemv;
+};
+
+// --- Scalar ---
+
+void scalarGemvF32(usz m, usz k, f32 alpha, const f32 *a, usz lda,
+                   const f32 *x, f32 beta, f32 *y) {
+  for (usz i = 0; i < m; ++i) {
+    const f32 *row = a + i * lda;
+    f32 s = 0;
+    for (usz p = 0; p < k; ++p)
+      s += row[p] * x[p];
+    y[i] = alpha * s + (beta == 0 ? 0.0f : beta * y[i]);
+  }
+}
+
+void scalarGemvI8(usz m, usz k, const i8 *a, usz lda, const i8 *x, i32 *y) {
+  for (usz i = 0; i < m; ++i) {
+    const i8 *row = a + i * lda;
+    i32 s = 0;
+    for (usz p = 0; p < k; ++p)
+      s += (i32)row[p] * (i32)x[p];
+    y[i] = s;
+  }
+}
+
+// No micro-kernels: every product takes the direct loops, which need no
+// packing memory (what small targets want anyway).
+const GemmTable scalarGemm = {"scalar", {}, {}, nullptr, nullptr,
+                              scalarGemvF32, scalarGemvI8};
+
+#ifdef XI_GEMM_VECTOR
+
+#define XI_VINLINE inline __attribute__((always_inline))
+
+#if !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+template <int W> struct Lanes {
+  typedef f32 V __attribute__((vector_size(W * 4)));
+  typedef i32 I __attribute__((vector_size(W * 4)));
+};
+
+/// Two signed 16-bit multiply-adds per 32-bit lane (pmaddwd semantics).
+template <int W> struct Madd {
+  typedef typename Lanes<W>::I I;
+  static XI_VINLINE I apply(I a, I b) {
+    return ((a << 16) >> 16) * ((b << 16) >> 16) + (a >> 16) * (b >> 16);
+  }
+};
+
+#if defined(XI_GEMM_X86)
+#if defined(__SSE2__)
+template <> struct Madd<4> {
+  typedef Lanes<4>::I I;
+  static XI_VINLINE I apply(I a, I b) {
+    return (I)_mm_madd_epi16((__m128i)a, (__m128i)b);
+  }
+};
+#endif
+// Not always_inline: these only become inlinable once the generic kernel has
+// been inlined into its AVX2/AVX-512 entry point, which the optimizer does.
+template <> struct Madd<8> {
+  typedef Lanes<8>::I I;
+  __attribute__((target("avx2"))) static inline I apply(I a, I b) {
+    return (I)_mm256_madd_epi16((__m256i)a, (__m256i)b);
+  }
+};
+template <> struct Madd<16> {
+  typedef Lanes<16>::I I;
+  __attribute__((target("avx512f,avx512bw"))) static inline I apply(I a, I b) {
+    return (I)_mm512_madd_epi16((__m512i)a, (__m512i)b);
+  }
+};
+#endif
+
+/// MR x (NV * W) tile: C += alpha * A_strip * B_strip.
+template <int W, int MR, int NV>
+XI_VINLINE void kernelF32(usz kc, const f32 *pa, const f32 *pb, f32 *c,
+                          usz ldc, f32 alpha, usz m, usz n) {
+  typedef typename Lanes<W>::V V;
+  V acc[MR][NV];
+#pragma GCC unroll 32
+  for (int r = 0; r < MR; ++r)
+#pragma GCC unroll 4
+    for (int v = 0; v < NV; ++v)
+      acc[r][v] = V{};
+
+  for (usz p = 0; p < kc; ++p, pa += MR, pb += NV * W) {
+    V b[NV];
+#pragma GCC unroll 4
+    for (int v = 0; v < NV; ++v)
+      __builtin_memcpy(&b[v], pb + v * W, sizeof(V));
+#pragma GCC unroll 32
+    for (int r = 0; r < MR; ++r) {
+      V a = pa[r] - V{}; // broadcast (x - 0 folds away; 0 + x does not)
+#pragma GCC unroll 4
+      for (int v = 0; v < NV; ++v)
+        acc[r][v] += a * b[v];
+    }
+  }
+
+  if (m == (usz)MR && n == (usz)(NV * W)) {
+#pragma GCC unroll 32
+    for (int r = 0; r < MR; ++r)
+#pragma GCC unroll 4
+      for (int v = 0; v < NV; ++v) {
+        V cv;
+        __builtin_memcpy(&cv, c + r * ldc + v * W, sizeof(V));
+        cv += acc[r][v] * alpha;
+        __builtin_memcpy(c + r * ldc + v * W, &cv, sizeof(V));
+      }
+    return;
+  }
+  f32 tile[MR][NV * W];
+  __builtin_memcpy(tile, acc, sizeof(tile));
+  for (usz r = 0; r < m; ++r)
+    for (usz j = 0; j < n; ++j)
+      c[r * ldc + j] += alpha * tile[r][j];
+}
+
+/// Same tiling over packed i16 pairs: C += A_strip * B_strip in i32.
+template <int W, int MR, int NV>
+XI_VINLINE void kernelI8(usz kp, const i32 *pa, const i32 *pb, i32 *c,
+                         usz ldc, usz m, usz n) {
+  typedef typename Lanes<W>::I I;
+  I acc[MR][NV];
+#pragma GCC unroll 32
+  for (int r = 0; r < MR; ++r)
+#pragma GCC unroll 4
+    for (int v = 0; v < NV; ++v)
+      acc[r][v] = I{};
+
+  for (usz p = 0; p < kp; ++p, pa += MR, pb += NV * W) {
+    I b[NV];
+#pragma GCC unroll 4
+    for (int v = 0; v < NV; ++v)
+      __builtin_memcpy(&b[v], pb + v * W, sizeof(I));
+#pragma GCC unroll 32
+    for (int r = 0; r < MR; ++r) {
+      I a = I{} + pa[r];
+#pragma GCC unroll 4
+      for (int v = 0; v < NV; ++v)
+        acc[r][v] += Madd<W>::apply(a, b[v]);
+    }
+  }
+
+  if (m == (usz)MR && n == (usz)(NV * W)) {
+#pragma GCC unroll 32
+    for (int r = 0; r < MR; ++r)
+#pragma GCC unroll 4
+      for (int v = 0; v < NV; ++v) {
+        I cv;
+        __builtin_memcpy(&cv, c + r * ldc + v * W, sizeof(I));
+        cv += acc[r][v];
+        __builtin_memcpy(c + r * ldc + v * W, &cv, sizeof(I));
+      }
+    return;
+  }
+  i32 tile[MR][NV * W];
+  __builtin_memcpy(tile, acc, sizeof(tile));
+  for (usz r = 0; r < m; ++r)
+    for (usz j = 0; j < n; ++j)
+      c[r * ldc + j] += tile[r][j];
+}
+
+/// Four rows at a time so every load of x feeds four accumulators.
+template <int W>
+XI_VINLINE void gemvF32(usz m, usz k, f32 alpha, const f32 *a, usz lda,
+                        const f32 *x, f32 beta, f32 *y) {
+  typedef typename Lanes<W>::V V;
+  usz i = 0;
+  for (; i + 4 <= m; i += 4) {
+    const f32 *r0 = a + i * lda, *r1 = r0 + lda, *r2 = r1 + lda,
+              *r3 = r2 + lda;
+    V s0 = {}, s1 = {}, s2 = {}, s3 = {};
+    usz p = 0;
+    for (; p + W <= k; p += W) {
+      V xv, a0, a1, a2, a3;
+      __builtin_memcpy(&xv, x + p, sizeof(V));
+      __builtin_memcpy(&a0, r0 + p, sizeof(V));
+      __builtin_memcpy(&a1, r1 + p, sizeof(V));
+      __builtin_memcpy(&a2, r2 + p, sizeof(V));
+      __builtin_memcpy(&a3, r3 + p, sizeof(V));
+      s0 += a0 * xv;
+      s1 += a1 * xv;
+      s2 += a2 * xv;
+      s3 += a3 * xv;
+    }
+    f32 t[4] = {0, 0, 0, 0};
+    for (int l = 0; l < W; ++l) {
+      t[0] += s0[l];
+      t[1] += s1[l];
+      t[2] += s2[l];
+      t[3] += s3[l];
+    }
+    for (; p < k; ++p) {
+      t[0] += r0[p] * x[p];
+      t[1] += r1[p] * x[p];
+      t[2] += r2[p] * x[p];
+      t[3] += r3[p] * x[p];
+    }
+    for (int r = 0; r < 4; ++r)
+      y[i + r] = alpha * t[r] + (beta == 0 ? 0.0f : beta * y[i + r]);
+  }
+  for (; i < m; ++i) {
+    const f32 *row = a + i * lda;
+    V s = {};
+    usz p = 0;
+    for (; p + W <= k; p += W) {
+      V xv, av;
+      __builtin_memcpy(&xv, x + p, sizeof(V));
+      __builtin_memcpy(&av, row + p, sizeof(V));
+      s += av * xv;
+    }
+    f32 t = 0;
+    for (int l = 0; l < W; ++l)
+      t += s[l];
+    for (; p < k; ++p)
+      t += row[p] * x[p];
+    y[i] = alpha * t + (beta == 0 ? 0.0f : beta * y[i]);
+  }
+}
+
+// The vectorizer turns this widening dot product into pmaddwd/vpdpbusd-style
+// sequences on its own; only the target attribute matters.
+XI_VINLINE void gemvI8(usz m, usz k, const i8 *a, usz lda, const i8 *x,
+                       i32 *y) {
+  for (usz i = 0; i < m; ++i) {
+    const i8 *row = a + i * lda;
+    i32 s = 0;
+    _Pragma("omp simd reduction(+ : s)") for (usz p = 0; p < k; ++p) s +=
+        (i32)row[p] * (i32)x[p];
+    y[i] = s;
+  }
+}
+
+#define XI_GEMM_TABLE(ns, name, W, MR, NV, IMR, INV, TARGET)                   \
+  namespace ns {                                                               \
+  TARGET void f32Kernel(usz kc, const f32 *pa, const f32 *pb, f32 *c,          \
+                        usz ldc, f32 alpha, usz m, usz n) {                    \
+    kernelF32<W, MR, NV>(kc, pa, pb, c, ldc, alpha, m, n);                     \
+  }                                                                            \
+  TARGET void i8Kernel(usz kp, const i32 *pa, const i32 *pb, i32 *c, usz ldc,  \
+                       usz m, usz n) {                                         \
+    kernelI8<W, IMR, INV>(kp, pa, pb, c, ldc, m, n);                           \
+  }                                                                            \
+  TARGET void f32Gemv(usz m, usz k, f32 alpha, const f32 *a, usz lda,          \
+                      const f32 *x, f32 beta, f32 *y) {                        \
+    gemvF32<W>(m, k, alpha, a, lda, x, beta, y);                               \
+  }                                                                            \
+  TARGET void i8Gemv(usz m, usz k, const i8 *a, usz lda, const i8 *x,          \
+                     i32 *y) {                                                 \
+    gemvI8(m, k, a, lda, x, y);                                                \
+  }                                                                            \
+  const GemmTable table = {name,                                               \
+                           {MR, NV * W, 256, MR * (96 / MR), 4096},            \
+                           {IMR, INV * W, 256, IMR * (96 / IMR), 4096},        \
+                           f32Kernel,                                          \
+                           i8Kernel,                                           \
+                           f32Gemv,                                            \
+                           i8Gemv};                                            \
+  }
+
+// Register budgets: MR * NV accumulators plus NV B vectors and a broadcast.
+#if defined(XI_GEMM_X86)
+XI_GEMM_TABLE(avx512, "avx512", 16, 12, 2, 12, 2,
+              __attribute__((target("avx512f,avx512bw,avx2,fma"))))
+XI_GEMM_TABLE(avx2, "avx2", 8, 6, 2, 6, 2,
+              __attribute__((target("avx2,fma"))))
+#if defined(__SSE2__)
+XI_GEMM_TABLE(sse2, "sse2", 4, 4, 2, 4, 2, )
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+XI_GEMM_TABLE(neon, "neon", 4, 8, 2, 8, 2, )
+#elif defined(__wasm_simd128__)
+XI_GEMM_TABLE(simd128, "simd128", 4, 4, 2, 4, 2, )
+#else
+XI_GEMM_TABLE(generic, "generic", 4, 4, 2, 4, 2, )
+#endif
+
+#undef XI_GEMM_TABLE
+
+#endif // XI_GEMM_VECTOR
+
+/// Kernels matching the transcendental set chosen by Simd::use().
+const GemmTable &gemmTable() {
+  const char *isa = Simd::isa();
+  const GemmTable *tables[] = {
+#if defined(XI_GEMM_X86)
+      &avx512::table, &avx2::table,
+#if defined(__SSE2__)
+      &sse2::table,
+#endif
+#elif defined(XI_GEMM_VECTOR) && (defined(__ARM_NEON) || defined(__aarch64__))
+      &neon::table,
+#elif defined(XI_GEMM_VECTOR) && defined(__wasm_simd128__)
+      &simd128::table,
+#elif defined(XI_GEMM_VECTOR)
+      &generic::table,
+#endif
+      &scalarGemm};
+  for (const GemmTable *t : tables) {
+    const char *a = t->isa, *b = isa;
+    while (*a && *a == *b)
+      a++, b++;
+    if (*a != *b)
+      continue;
+#if defined(XI_GEMM_X86)
+    // The AVX-512 transcendentals only need AVX512F; pmaddwd on zmm needs BW.
+    if (t == &avx512::table && !__builtin_cpu_supports("avx512bw"))
+      return avx2::table;
+#endif
+    return *t;
+  }
+  return scalarGemm;
+}
+
+// --- Packing ---
+// Inputs are addressed with a row stride (rs) and a column stride (cs), so
+// transposed and sliced views pack directly, without an intermediate copy.
+
+/// A block (m x k) into MR-row strips, k-major inside each strip.
+void packA(const f32 *a, usz rs, usz cs, usz m, usz k, usz mr, f32 *out) {
+  for (usz i = 0; i < m; i += mr) {
+    usz rows = m - i < mr ? m - i : mr;
+    for (usz p = 0; p < k; ++p) {
+      const f32 *src = a + i * rs + p * cs;
+      for (usz r = 0; r < rows; ++r)
+        out[r] = src[r * rs];
+      for (usz r = rows; r < mr; ++r)
+        out[r] = 0;
+      out += mr;
+    }
+  }
+}
+
+/// B slice (k x n) into NR-column strips, k-major inside each strip.
+void packB(const f32 *b, usz rs, usz cs, usz k, usz n, usz nr, f32 *out) {
+  for (usz j = 0; j < n; j += nr) {
+    usz cols = n - j < nr ? n - j : nr;
+    for (usz p = 0; p < k; ++p) {
+      const f32 *src = b + p * rs + j * cs;
+      if (cs == 1)
+        for (usz c = 0; c < cols; ++c)
+          out[c] = src[c];
+      else
+        for (usz c = 0; c < cols; ++c)
+          out[c] = src[c * cs];
+      for (usz c = cols; c < nr; ++c)
+        out[c] = 0;
+      out += nr;
+    }
+  }
+}
+
+inline i32 pair(i8 lo, i8 hi) {
+  return (i32)(((u32)(u16)(i16)hi << 16) | (u32)(u16)(i16)lo);
+}
+
+/// As packA, with consecutive k values paired into one i32 (odd k padded).
+void packA(const i8 *a, usz rs, usz cs, usz m, usz k, usz mr, i32 *out) {
+  for (usz i = 0; i < m; i += mr) {
+    usz rows = m - i < mr ? m - i : mr;
+    for (usz p = 0; p < k; p += 2) {
+      for (usz r = 0; r < rows; ++r) {
+        const i8 *src = a + (i + r) * rs + p * cs;
+        out[r] = pair(src[0], p + 1 < k ? src[cs] : 0);
+      }
+      for (usz r = rows; r < mr; ++r)
+        out[r] = 0;
+      out += mr;
+    }
+  }
+}
+
+void packB(const i8 *b, usz rs, usz cs, usz k, usz n, usz nr, i32 *out) {
+  for (usz j = 0; j < n; j += nr) {
+    usz cols = n - j < nr ? n - j : nr;
+    for (usz p = 0; p < k; p += 2) {
+      const i8 *s0 = b + p * rs + j * cs;
+      const i8 *s1 = p + 1 < k ? s0 + rs : nullptr;
+      for (usz c = 0; c < cols; ++c)
+        out[c] = pair(s0[c * cs], s1 ? s1[c * cs] : 0);
+      for (usz c = cols; c < nr; ++c)
+        out[c] = 0;
+      out += nr;
+    }
+  }
+}
+
+// --- Blocked driver ---
+
+template <typename In, typename Out> struct Gemm {
+  typedef i32 Packed; // i8 inputs pack as i16 pairs
+  static const usz KStep = 2;
+};
+template <> struct Gemm<f32, f32> {
+  typedef f32 Packed;
+  static const usz KStep = 1;
+};
+
+/// Operand addressing: element (i, j) is at p[i * rs + j * cs].
+template <typename T> struct Strided {
+  const T *p;
+  usz rs, cs;
+  const T *at(usz i, usz j) const { return p + i * rs + j * cs; }
+};
+
+/**
+ * C += alpha * A * B over blocks, with rows of each panel split across
+ * @p pool. The caller has already applied beta to C.
+ */
+template <typename In, typename Out, typename Kernel>
+void blocked(usz m, usz n, usz k, Out alpha, Strided<In> a, Strided<In> b,
+             Out *c, usz ldc, const GemmShape &s, Kernel kernel,
+             WorkerPool *pool) {
+  typedef typename Gemm<In, Out>::Packed P;
+  const usz step = Gemm<In, Out>::KStep;
+  const usz kcIn = s.kc * step; // input k per slice
+  // Per call, not per thread: a thread waiting on the pool may run another
+  // product while this one's packed B is still being read.
+  Scratch bScratch;
+  P *pb = bScratch.get<P>(((s.nc + s.nr - 1) / s.nr * s.nr) * s.kc);
+
+  usz mBlocks = (m + s.mc - 1) / s.mc;
+  bool parallel = pool && pool->size() > 0 && m * n * k >= ParallelLimit &&
+                  mBlocks > 1;
+
+  for (usz jc = 0; jc < n; jc += s.nc) {
+    usz nc = n - jc < s.nc ? n - jc : s.nc;
+    for (usz pc = 0; pc < k; pc += kcIn) {
+      usz kc = k - pc < kcIn ? k - pc : kcIn;
+      usz kcp = (kc + step - 1) / step; // packed depth
+      packB(b.at(pc, jc), b.rs, b.cs, kc, nc, s.nr, pb);
+
+      auto rows = [&](usz begin, usz end) {
+        // Safe per thread: nothing in here waits on the pool.
+        static thread_local Scratch aScratch;
+        P *pa = aScratch.get<P>(s.mc * s.kc);
+        for (usz blk = begin; blk < end; ++blk) {
+          usz ic = blk * s.mc;
+          usz mc = m - ic < s.mc ? m - ic : s.mc;
+          packA(a.at(ic, pc), a.rs, a.cs, mc, kc, s.mr, pa);
+          for (usz jr = 0; jr < nc; jr += s.nr) {
+            usz nr = nc - jr < s.nr ? nc - jr : s.nr;
+            const P *bs = pb + (jr / s.nr) * s.nr * kcp;
+            for (usz ir = 0; ir < mc; ir += s.mr) {
+              usz mr = mc - ir < s.mr ? mc - ir : s.mr;
+              kernel(kcp, pa + (ir / s.mr) * s.mr * kcp, bs,
+                     c + (ic + ir) * ldc + jc + jr, ldc, alpha, mr, nr);
+            }
+          }
+        }
+      };
+      if (parallel)
+        pool->parallelFor(mBlocks, rows);
+      else
+        rows(0, mBlocks);
+    }
+  }
+}
+
+struct KernelI8Adapter {
+  KernelI8 fn;
+  void operator()(usz kp, const i32 *pa, const i32 *pb, i32 *c, usz ldc, i32,
+                  usz m, usz n) const {
+    fn(kp, pa, pb, c, ldc, m, n);
+  }
+};
+
+// --- Strided entry points ---
+
+void productF32(usz m, usz n, usz k, f32 alpha, Strided<f32> a,
+                Strided<f32> b, f32 beta, f32 *c, usz ldc, WorkerPool *pool);
+
+/// y = alpha * A * x + beta * y for any strides of A and x.
+void matvecF32(usz m, usz k, f32 alpha, Strided<f32> a, const f32 *x,
+               usz incx, f32 beta, f32 *y, WorkerPool *pool) {
+  if (m == 0)
+    return;
+  Scratch xs;
+  if (incx != 1) {
+    f32 *g = xs.get<f32>(k);
+    for (usz p = 0; p < k; ++p)
+      g[p] = x[p * incx];
+    x = g;
+  }
+  const GemmTable &t = gemmTable();
+  if (a.cs == 1) {
+    // Bandwidth bound: threads only help once A is well past the caches.
+    if (pool && pool->size() > 0 && m * k >= ((usz)1 << 20)) {
+      pool->parallelFor(
+          m,
+          [&](usz begin, usz end) {
+            t.f32Gemv(end - begin, k, alpha, a.at(begin, 0), a.rs, x, beta,
+                      y + begin);
+          },
+          64);
+      return;
+    }
+    t.f32Gemv(m, k, alpha, a.p, a.rs, x, beta, y);
+    return;
+  }
+  for (usz i = 0; i < m; ++i)
+    y[i] = beta == 0 ? 0.0f : beta * y[i];
+  if (a.rs == 1) {
+    // Columns of A are contiguous (a transposed view): accumulate them.
+    for (usz p = 0; p < k; ++p) {
+      f32 s = alpha * x[p];
+      const f32 *col = a.at(0, p);
+      _Pragma("omp simd") for (usz i = 0; i < m; ++i) y[i] += s * col[i];
+    }
+    return;
+  }
+  productF32(m, 1, k, alpha, a, Strided<f32>{x, 1, 1}, 1.0f, y, 1, pool);
+}
+
+void productF32(usz m, usz n, usz k, f32 alpha, Strided<f32> a,
+                Strided<f32> b, f32 beta, f32 *c, usz ldc, WorkerPool *pool) {
+  if (m == 0 || n == 0)
+    return;
+  for (usz i = 0; i < m; ++i) {
+    f32 *row = c + i * ldc;
+    if (beta == 0) {
+      for (usz j = 0; j < n; ++j)
+        row[j] = 0;
+    } else if (beta != 1) {
+      _Pragma("omp simd") for (usz j = 0; j < n; ++j) row[j] *= beta;
+    }
+  }
+  if (k == 0 || alpha == 0)
+    return;
+
+  const GemmTable &t = gemmTable();
+  if (n == 1 && (a.cs == 1 || a.rs == 1)) {
+    // A single column is a GEMV.
+    if (ldc == 1) {
+      matvecF32(m, k, alpha, a, b.p, b.rs, 1.0f, c, pool);
+      return;
+    }
+    Scratch ys;
+    f32 *y = ys.get<f32>(m);
+    matvecF32(m, k, alpha, a, b.p, b.rs, 0.0f, y, pool);
+    for (usz i = 0; i < m; ++i)
+      c[i * ldc] += y[i];
+    return;
+  }
+  if (m * n * k <= DirectLimit || !t.f32Kernel) {
+    for (usz i = 0; i < m; ++i) {
+      f32 *row = c + i * ldc;
+      for (usz p = 0; p < k; ++p) {
+        f32 s = alpha * *a.at(i, p);
+        const f32 *src = b.at(p, 0);
+        if (b.cs == 1) {
+          _Pragma("omp simd") for (usz j = 0; j < n; ++j) row[j] +=
+              s * src[j];
+        } else {
+          for (usz j = 0; j < n; ++j)
+            row[j] += s * src[j * b.cs];
+        }
+      }
+    }
+    return;
+  }
+  blocked<f32, f32>(m, n, k, alpha, a, b, c, ldc, t.f32Shape, t.f32Kernel,
+                    pool);
+}
+
+void productI8(usz m, usz n, usz k, Strided<i8> a, Strided<i8> b, i32 *c,
+               usz ldc, WorkerPool *pool) {
+  if (m == 0 || n == 0)
+    return;
+  for (usz i = 0; i < m; ++i)
+    for (usz j = 0; j < n; ++j)
+      c[i * ldc + j] = 0;
+  if (k == 0)
+    return;
+
+  const GemmTable &t = gemmTable();
+  if (m * n * k <= DirectLimit || !t.i8Kernel) {
+    for (usz i = 0; i < m; ++i) {
+      i32 *row = c + i * ldc;
+      for (usz p = 0; p < k; ++p) {
+        i32 s = *a.at(i, p);
+        const i8 *src = b.at(p, 0);
+        for (usz j = 0; j < n; ++j)
+          row[j] += s * (i32)src[j * b.cs];
+      }
+    }
+    return;
+  }
+  blocked<i8, i32>(m, n, k, 1, a, b, c, ldc, t.i8Shape,
+                   KernelI8Adapter{t.i8Kernel}, pool);
+}
+
+void matvecI8(usz m, usz k, Strided<i8> a, const i8 *x, usz incx, i32 *y,
+              WorkerPool *pool) {
+  if (m == 0)
+    return;
+  if (a.cs == 1 && incx == 1) {
+    const GemmTable &t = gemmTable();
+    if (pool && pool->size() > 0 && m * k >= ((usz)1 << 21)) {
+      pool->parallelFor(
+          m,
+          [&](usz begin, usz end) {
+            t.i8Gemv(end - begin, k, a.at(begin, 0), a.rs, x, y + begin);
+          },
+          64);
+      return;
+    }
+    t.i8Gemv(m, k, a.p, a.rs, x, y);
+    return;
+  }
+  productI8(m, 1, k, a, Strided<i8>{x, incx, 1}, y, 1, pool);
+}
+
+template <typename Out> Array<Out> shaped(usz rows, usz cols) {
+  Array<Out> r;
+  r.allocate(rows * cols);
+  usz d[2] = {rows, cols};
+  r.shape(2, d);
+  return r;
+}
+
+template <typename T> Strided<T> strided(const ArrayView<T> &v) {
+  return Strided<T>{v.data(), v.stride(0), v.stride(1)};
+}
+
+} // namespace
+
+// -------------------------------------------------------------------------
+// Pointer API
+// -------------------------------------------------------------------------
+
+void gemm(usz m, usz n, usz k, f32 alpha, const f32 *a, usz lda,
+          const f32 *b, usz ldb, f32 beta, f32 *c, usz ldc, WorkerPool *pool) {
+  productF32(m, n, k, alpha, Strided<f32>{a, lda, 1}, Strided<f32>{b, ldb, 1},
+             beta, c, ldc, pool);
+}
+
+void gemm(usz m, usz n, usz k, const i8 *a, usz lda, const i8 *b, usz ldb,
+          i32 *c, usz ldc, WorkerPool *pool) {
+  productI8(m, n, k, Strided<i8>{a, lda, 1}, Strided<i8>{b, ldb, 1}, c, ldc,
+            pool);
+}
+
+void gemv(usz m, usz k, f32 alpha, const f32 *a, usz lda, const f32 *x,
+          f32 beta, f32 *y, WorkerPool *pool) {
+  matvecF32(m, k, alpha, Strided<f32>{a, lda, 1}, x, 1, beta, y, pool);
+}
+
+void gemv(usz m, usz k, const i8 *a, usz lda, const i8 *x, i32 *y,
+          WorkerPool *pool) {
+  matvecI8(m, k, Strided<i8>{a, lda, 1}, x, 1, y, pool);
+}
+
+// -------------------------------------------------------------------------
+// Array / ArrayView API
+// -------------------------------------------------------------------------
+
+Array<f32> matmul(const ArrayView<f32> &a, const ArrayView<f32> &b,
+                  WorkerPool *pool) {
+  if (a.rank() != 2 || b.rank() != 2 || a.dim(1) != b.dim(0))
+    return Array<f32>();
+  usz m = a.dim(0), k = a.dim(1), n = b.dim(1);
+  Array<f32> r = shaped<f32>(m, n);
+  if (m && n)
+    productF32(m, n, k, 1.0f, strided(a), strided(b), 0.0f, r.data(), n,
+               pool);
+  return r;
+}
+
+Array<i32> matmul(const ArrayView<i8> &a, const ArrayView<i8> &b,
+                  WorkerPool *pool) {
+  if (a.rank() != 2 || b.rank() != 2 || a.dim(1) != b.dim(0))
+    return Array<i32>();
+  usz m = a.dim(0), k = a.dim(1), n = b.dim(1);
+  Array<i32> r = shaped<i32>(m, n);
+  if (m && n)
+    productI8(m, n, k, strided(a), strided(b), r.data(), n, pool);
+  return r;
+}
+
+Array<f32> matvec(const ArrayView<f32> &a, const ArrayView<f32> &x,
+                  WorkerPool *pool) {
+  if (a.rank() != 2 || x.rank() != 1 || a.dim(1) != x.dim(0))
+    return Array<f32>();
+  Array<f32> y;
+  y.allocate(a.dim(0));
+  matvecF32(a.dim(0), a.dim(1), 1.0f, strided(a), x.data(), x.stride(0), 0.0f,
+            y.data(), pool);
+  return y;
+}
+
+Array<i32> matvec(const ArrayView<i8> &a, const ArrayView<i8> &x,
+                  WorkerPool *pool) {
+  if (a.rank() != 2 || x.rank() != 1 || a.dim(1) != x.dim(0))
+    return Array<i32>();
+  Array<i32> y;
+  y.allocate(a.dim(0));
+  matvecI8(a.dim(0), a.dim(1), strided(a), x.data(), x.stride(0), y.data(),
+           pool);
+  return y;
+}
+
+Array<f32> matmul(const Array<f32> &a, const Array<f32> &b,
+                  WorkerPool *pool) {
+  return matmul(ArrayView<f32>(a), ArrayView<f32>(b), pool);
+}
+
+Array<i32> matmul(const Array<i8> &a, const Array<i8> &b, WorkerPool *pool) {
+  return matmul(ArrayView<i8>(a), ArrayView<i8>(b), pool);
+}
+
+// x is taken as a flat vector whatever its shape.
+Array<f32> matvec(const Array<f32> &a, const Array<f32> &x,
+                  WorkerPool *pool) {
+  usz k = x.size();
+  return matvec(ArrayView<f32>(a), ArrayView<f32>(x).reshape(1, &k), pool);
+}
+
+Array<i32> matvec(const Array<i8> &a, const Array<i8> &x, WorkerPool *pool) {
+  usz k = x.size();
+  return matvec(ArrayView<i8>(a), ArrayView<i8>(x).reshape(1, &k), pool);
+}
+
+template <>
+Array<f32> matmul<Array<f32>>(const Array<f32> &a, const Array<f32> &b, usz M,
+                              usz N, usz P) {
+  Array<f32> res;
+  res.allocate(M * P);
+  if (M * P == 0)
+    return res;
+  if (a.size() < M * N || b.size() < N * P) {
+    // Short inputs read as zero past their end, like the generic version.
+    for (usz i = 0; i < M * P; ++i)
+      res[i] = 0;
+    for (usz i = 0; i < M; ++i)
+      for (usz k = 0; k < N; ++k)
+        for (usz j = 0; j < P; ++j)
+          res[i * P + j] += a[i * N + k] * b[k * P + j];
+    return res;
+  }
+  ArrayView<f32> va(a), vb(b);
+  gemm(M, P, N, 1.0f, va.data(), N, vb.data(), P, 0.0f, res.data(), P);
+  return res;
+}
+
+} // namespace Math
+} // namespace Xi
@@ -0,0 +1,489 @@
+#include <Xi/Math.hpp>
+
+// -------------------------------------------------------------------------
+// Matrix4 kernels and SoA batch transforms
+//
+// A single Matrix4 is four rows of 4-lane vectors (SSE on x86, NEON on ARM,
+// via GCC/Clang vector extensions); points are row vectors, p' = p * M.
+// Batches are structure-of-arrays planes, one plane per component, so every
+// lane holds a different item and the loops are plain element-wise code.
+// Those loops are compiled once per instruction set and follow Simd::isa().
+// -------------------------------------------------------------------------
+
+#if defined(__GNUC__) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define XI_MATRIX_VECTOR
+#if defined(__x86_64__) || defined(__i386__)
+#define XI_MATRIX_X86
+#endif
+#endif
+
+#define XI_MINLINE inline __attribute__((always_inline))
+
+namespace Xi {
+namespace Math {
+
+namespace {
+
+#ifdef XI_MATRIX_VECTOR
+
+typedef f32 V4 __attribute__((vector_size(16)));
+typedef i32 I4 __attribute__((vector_size(16)));
+
+// Lanes 0-3 pick from a, 4-7 from b.
+#if defined(__clang__)
+#define XI_SHUF(a, b, i, j, k, l) __builtin_shufflevector(a, b, i, j, k, l)
+#else
+#define XI_SHUF(a, b, i, j, k, l) __builtin_shuffle(a, b, I4{i, j, k, l})
+#endif
+#define XI_SWZ(v, i, j, k, l) XI_SHUF(v, v, i, j, k, l)
+
+XI_MINLINE V4 load(const f32 *p) {
+  V4 v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+XI_MINLINE void store(f32 *p, V4 v) { __builtin_memcpy(p, &v, sizeof(v)); }
+
+// 2x2 blocks are stored row-major in one vector: [m00 m01 m10 m11].
+XI_MINLINE V4 mat2Mul(V4 a, V4 b) {
+  return a * XI_SWZ(b, 0, 3, 0, 3) + XI_SWZ(a, 1, 0, 3, 2) * XI_SWZ(b, 2, 1, 2, 1);
+}
+
+// adj(a) * b
+XI_MINLINE V4 mat2AdjMul(V4 a, V4 b) {
+  return XI_SWZ(a, 3, 3, 0, 0) * b - XI_SWZ(a, 1, 1, 2, 2) * XI_SWZ(b, 2, 3, 0, 1);
+}
+
+// a * adj(b)
+XI_MINLINE V4 mat2MulAdj(V4 a, V4 b) {
+  return a * XI_SWZ(b, 3, 0, 3, 0) - XI_SWZ(a, 1, 0, 3, 2) * XI_SWZ(b, 2, 1, 2, 1);
+}
+
+/**
+ * @brief M split into 2x2 blocks [A B; C D] with the pieces both det() and
+ * inverse() need (block-wise inverse via adjugates).
+ */
+struct Blocks {
+  V4 a, b, c, d;
+  V4 detA, detB, detC, detD; // broadcast
+  V4 adjAB, adjDC;           // adj(A) B, adj(D) C
+  V4 det;                    // broadcast |M|
+
+  XI_MINLINE explicit Blocks(const Matrix4 &m) {
+    V4 r0 = load(m.m[0]), r1 = load(m.m[1]), r2 = load(m.m[2]),
+       r3 = load(m.m[3]);
+    a = XI_SHUF(r0, r1, 0, 1, 4, 5);
+    b = XI_SHUF(r0, r1, 2, 3, 6, 7);
+    c = XI_SHUF(r2, r3, 0, 1, 4, 5);
+    d = XI_SHUF(r2, r3, 2, 3, 6, 7);
+    V4 sub = XI_SHUF(r0, r2, 0, 2, 4, 6) * XI_SHUF(r1, r3, 1, 3, 5, 7) -
+             XI_SHUF(r0, r2, 1, 3, 5, 7) * XI_SHUF(r1, r3, 0, 2, 4, 6);
+    detA = XI_SWZ(sub, 0, 0, 0, 0);
+    detB = XI_SWZ(sub, 1, 1, 1, 1);
+    detC = XI_SWZ(sub, 2, 2, 2, 2);
+    detD = XI_SWZ(sub, 3, 3, 3, 3);
+    adjDC = mat2AdjMul(d, c);
+    adjAB = mat2AdjMul(a, b);
+    // |M| = |A||D| + |B||C| - tr(adj(A) B adj(D) C)
+    V4 tr = adjAB * XI_SWZ(adjDC, 0, 2, 1, 3);
+    tr = tr + XI_SWZ(tr, 1, 0, 3, 2);
+    tr = tr + XI_SWZ(tr, 2, 3, 0, 1);
+    det = detA * detD + detB * detC - tr;
+  }
+};
+
+#endif // XI_MATRIX_VECTOR
+
+// --- Batch loops ---
+
+// Items per pass: keeps every plane a pass touches in L1.
+const usz Chunk = 256;
+
+// Scale, then rotate about x, y and z, then translate (S Rx Ry Rz T).
+// Element (r, c) goes to o[(r * 4 + c) * stride].
+XI_MINLINE void composeItem(f32 sx, f32 cx, f32 sy, f32 cy, f32 sz, f32 cz,
+                            f32 px, f32 py, f32 pz, f32 kx, f32 ky, f32 kz,
+                            f32 *o, usz stride) {
+  f32 sxsy = sx * sy, cxsy = cx * sy;
+  o[0 * stride] = cy * cz * kx;
+  o[1 * stride] = cy * sz * kx;
+  o[2 * stride] = -sy * kx;
+  o[3 * stride] = 0;
+  o[4 * stride] = (sxsy * cz - cx * sz) * ky;
+  o[5 * stride] = (sxsy * sz + cx * cz) * ky;
+  o[6 * stride] = sx * cy * ky;
+  o[7 * stride] = 0;
+  o[8 * stride] = (cxsy * cz + sx * sz) * kz;
+  o[9 * stride] = (cxsy * sz - sx * cz) * kz;
+  o[10 * stride] = cx * cy * kz;
+  o[11 * stride] = 0;
+  o[12 * stride] = px;
+  o[13 * stride] = py;
+  o[14 * stride] = pz;
+  o[15 * stride] = 1;
+}
+
+// w = 1 for points, 0 for directions; column 3 is ignored (affine).
+XI_MINLINE void pointsLoop(const f32 *m, const f32 *in, f32 *out, usz n,
+                           f32 w) {
+  const f32 *x = in, *y = in + n, *z = in + 2 * n;
+  f32 *ox = out, *oy = out + n, *oz = out + 2 * n;
+  const f32 m00 = m[0], m01 = m[1], m02 = m[2], m10 = m[4], m11 = m[5],
+            m12 = m[6], m20 = m[8], m21 = m[9], m22 = m[10], tx = m[12] * w,
+            ty = m[13] * w, tz = m[14] * w;
+  _Pragma("omp simd") for (usz i = 0; i < n; ++i) {
+    f32 px = x[i], py = y[i], pz = z[i];
+    ox[i] = px * m00 + py * m10 + pz * m20 + tx;
+    oy[i] = px * m01 + py * m11 + pz * m21 + ty;
+    oz[i] = px * m02 + py * m12 + pz * m22 + tz;
+  }
+}
+
+// Row r of a is loaded before row r of c is stored, so c may alias a.
+XI_MINLINE void multiplyLoop(const f32 *a, const f32 *b, f32 *c, usz n) {
+  _Pragma("omp simd") for (usz i = 0; i < n; ++i) {
+    _Pragma("GCC unroll 4") for (usz r = 0; r < 4; ++r) {
+      f32 a0 = a[(r * 4 + 0) * n + i], a1 = a[(r * 4 + 1) * n + i],
+          a2 = a[(r * 4 + 2) * n + i], a3 = a[(r * 4 + 3) * n + i];
+#define XI_DOT(col)                                                            \
+  (a0 * b[(col)*n + i] + a1 * b[(4 + (col)) * n + i] +                         \
+   a2 * b[(8 + (col)) * n + i] + a3 * b[(12 + (col)) * n + i])
+      f32 o0 = XI_DOT(0), o1 = XI_DOT(1), o2 = XI_DOT(2), o3 = XI_DOT(3);
+#undef XI_DOT
+      c[(r * 4 + 0) * n + i] = o0;
+      c[(r * 4 + 1) * n + i] = o1;
+      c[(r * 4 + 2) * n + i] = o2;
+      c[(r * 4 + 3) * n + i] = o3;
+    }
+  }
+}
+
+XI_MINLINE void composeLoop(const f32 *position, const f32 *rotation,
+                            const f32 *scale, f32 *out, usz n) {
+  f32 s[3][Chunk], c[3][Chunk];
+  for (usz i0 = 0; i0 < n; i0 += Chunk) {
+    usz len = n - i0 < Chunk ? n - i0 : Chunk;
+    for (usz k = 0; k < 3; ++k) {
+      Simd::sin(rotation + k * n + i0, s[k], len);
+      Simd::cos(rotation + k * n + i0, c[k], len);
+    }
+    const f32 *px = position + i0, *py = position + n + i0,
+              *pz = position + 2 * n + i0, *kx = scale + i0,
+              *ky = scale + n + i0, *kz = scale + 2 * n + i0;
+    f32 *o = out + i0;
+    _Pragma("omp simd") for (usz i = 0; i < len; ++i)
+        composeItem(s[0][i], c[0][i], s[1][i], c[1][i], s[2][i], c[2][i],
+                    px[i], py[i], pz[i], kx[i], ky[i], kz[i], o + i, n);
+  }
+}
+
+typedef void (*PointsKernel)(const f32 *m, const f32 *in, f32 *out, usz n,
+                             f32 w);
+typedef void (*MultiplyKernel)(const f32 *a, const f32 *b, f32 *c, usz n);
+typedef void (*ComposeKernel)(const f32 *position, const f32 *rotation,
+                              const f32 *scale, f32 *out, usz n);
+
+struct BatchTable {
+  const char *isa;
+  PointsKernel points;
+  MultiplyKernel multiply;
+  ComposeKernel compose;
+};
+
+#define XI_BATCH_TABLE(ns, name, TARGET)                                       \
+  namespace ns {                                                               \
+  TARGET void points(const f32 *m, const f32 *in, f32 *out, usz n, f32 w) {    \
+    pointsLoop(m, in, out, n, w);                                              \
+  }                                                                            \
+  TARGET void multiply(const f32 *a, const f32 *b, f32 *c, usz n) {            \
+    multiplyLoop(a, b, c, n);                                                  \
+  }                                                                            \
+  TARGET void compose(const f32 *p, const f32 *r, const f32 *s, f32 *o,        \
+                      usz n) {                                                 \
+    composeLoop(p, r, s, o, n);                                                \
+  }                                                                            \
+  const BatchTable table = {name, points, multiply, compose};                  \
+  }
+
+#if defined(XI_MATRIX_X86)
+XI_BATCH_TABLE(avx512, "avx512", __attribute__((target("avx512f,avx2,fma"))))
+XI_BATCH_TABLE(avx2, "avx2", __attribute__((target("avx2,fma"))))
+#endif
+XI_BATCH_TABLE(base, "base", )
+
+#undef XI_BATCH_TABLE
+
+bool sameName(const char *a, const char *b) {
+  while (*a && *a == *b)
+    a++, b++;
+  return *a == *b;
+}
+
+// Simd::use() may switch sets at runtime, so this follows it on every call.
+const BatchTable &batchTable() {
+#if defined(XI_MATRIX_X86)
+  const char *isa = Simd::isa();
+  if (sameName(isa, avx512::table.isa))
+    return avx512::table;
+  if (sameName(isa, avx2::table.isa))
+    return avx2::table;
+#endif
+  return base::table;
+}
+
+} // namespace
+
+// --- Single matrices ---
+
+#ifdef XI_MATRIX_VECTOR
+
+Matrix4 transpose(const Matrix4 &m) {
+  V4 r0 = load(m.m[0]), r1 = load(m.m[1]), r2 = load(m.m[2]),
+     r3 = load(m.m[3]);
+  V4 t0 = XI_SHUF(r0, r1, 0, 4, 1, 5), t1 = XI_SHUF(r2, r3, 0, 4, 1, 5),
+     t2 = XI_SHUF(r0, r1, 2, 6, 3, 7), t3 = XI_SHUF(r2, r3, 2, 6, 3, 7);
+  Matrix4 r;
+  store(r.m[0], XI_SHUF(t0, t1, 0, 1, 4, 5));
+  store(r.m[1], XI_SHUF(t0, t1, 2, 3, 6, 7));
+  store(r.m[2], XI_SHUF(t2, t3, 0, 1, 4, 5));
+  store(r.m[3], XI_SHUF(t2, t3, 2, 3, 6, 7));
+  return r;
+}
+
+Matrix4 multiply(const Matrix4 &a, const Matrix4 &b) {
+  V4 b0 = load(b.m[0]), b1 = load(b.m[1]), b2 = load(b.m[2]),
+     b3 = load(b.m[3]);
+  Matrix4 r;
+  for (int i = 0; i < 4; ++i)
+    store(r.m[i], b0 * a.m[i][0] + b1 * a.m[i][1] + b2 * a.m[i][2] +
+                      b3 * a.m[i][3]);
+  return r;
+}
+
+f32 det(const Matrix4 &m) { return Blocks(m).det[0]; }
+
+Matrix4 inverse(const Matrix4 &m) {
+  Blocks k(m);
+  if (Xi::Math::abs(k.det[0]) < 1e-8f)
+    return identity();
+  // Adjugate blocks of M; the inverse is them over |M|, with the 2x2
+  // adjugate shuffle folded into the final stores.
+  V4 x = k.detD * k.a - mat2Mul(k.b, k.adjDC);
+  V4 w = k.detA * k.d - mat2Mul(k.c, k.adjAB);
+  V4 y = k.detB * k.c - mat2MulAdj(k.d, k.adjAB);
+  V4 z = k.detC * k.b - mat2MulAdj(k.a, k.adjDC);
+  V4 inv = V4{1.0f, -1.0f, -1.0f, 1.0f} / k.det;
+  x = x * inv;
+  y = y * inv;
+  z = z * inv;
+  w = w * inv;
+  Matrix4 r;
+  store(r.m[0], XI_SHUF(x, y, 3, 1, 7, 5));
+  store(r.m[1], XI_SHUF(x, y, 2, 0, 6, 4));
+  store(r.m[2], XI_SHUF(z, w, 3, 1, 7, 5));
+  store(r.m[3], XI_SHUF(z, w, 2, 0, 6, 4));
+  return r;
+}
+
+#else
+
+Matrix4 transpose(const Matrix4 &m) {
+  Matrix4 r;
+  for (int i = 0; i < 4; ++i)
+    for (int j = 0; j < 4; ++j)
+      r.m[i][j] = m.m[j][i];
+  return r;
+}
+
+Matrix4 multiply(const Matrix4 &a, const Matrix4 &b) {
+  Matrix4 r = {{{0}}};
+  for (int i = 0; i < 4; ++i) {
+    for (int k = 0; k < 4; ++k) {
+      f32 aik = a.m[i][k];
+      _Pragma("omp simd") for (int j = 0; j < 4; ++j) {
+        r.m[i][j] += aik * b.m[k][j];
+      }
+    }
+  }
+  return r;
+}
+
+f32 det(const Matrix4 &m) {
+  f32 a = m.m[0][0], b = m.m[0][1], c = m.m[0][2], d = m.m[0][3];
+  f32 e = m.m[1][0], f = m.m[1][1], g = m.m[1][2], h = m.m[1][3];
+  f32 i = m.m[2][0], j = m.m[2][1], k = m.m[2][2], l = m.m[2][3];
+  f32 n = m.m[3][0], o = m.m[3][1], p = m.m[3][2], q = m.m[3][3];
+
+  return a * (f * (k * q - l * p) - g * (j * q - l * o) + h * (j * p - k * o)) -
+         b * (e * (k * q - l * p) - g * (i * q - l * n) + h * (i * p - k * n)) +
+         c * (e * (j * q - l * o) - f * (i * q - l * n) + h * (i * o - j * n)) -
+         d * (e * (j * p - k * o) - f * (i * p - k * n) + g * (i * o - j * n));
+}
+
+Matrix4 inverse(const Matrix4 &m) {
+  f32 d = det(m);
+  if (Xi::Math::abs(d) < 1e-8f)
+    return identity();
+  f32 invDet = 1.0f / d;
+
+  f32 a = m.m[0][0], b = m.m[0][1], c = m.m[0][2], d_ = m.m[0][3];
+  f32 e = m.m[1][0], f = m.m[1][1], g = m.m[1][2], h = m.m[1][3];
+  f32 i = m.m[2][0], j = m.m[2][1], k = m.m[2][2], l = m.m[2][3];
+  f32 n = m.m[3][0], o = m.m[3][1], p = m.m[3][2], q = m.m[3][3];
+
+  Matrix4 res;
+  res.m[0][0] = invDet * (f * (k * q - l * p) - g * (j * q - l * o) +
+                          h * (j * p - k * o));
+  res.m[1][0] = -invDet * (e * (k * q - l * p) - g * (i * q - l * n) +
+                           h * (i * p - k * n));
+  res.m[2][0] = invDet * (e * (j * q - l * o) - f * (i * q - l * n) +
+                          h * (i * o - j * n));
+  res.m[3][0] = -invDet * (e * (j * p - k * o) - f * (i * p - k * n) +
+                           g * (i * o - j * n));
+
+  res.m[0][1] = -invDet * (b * (k * q - l * p) - c * (j * q - l * o) +
+                           d_ * (j * p - k * o));
+  res.m[1][1] = invDet * (a * (k * q - l * p) - c * (i * q - l * n) +
+                          d_ * (i * p - k * n));
+  res.m[2][1] = -invDet * (a * (j * q - l * o) - b * (i * q - l * n) +
+                           d_ * (i * o - j * n));
+  res.m[3][1] = invDet * (a * (j * p - k * o) - b * (i * p - k * n) +
+                          c * (i * o - j * n));
+
+  res.m[0][2] = invDet * (b * (g * q - h * p) - c * (f * q - h * o) +
+                          d_ * (f * p - g * o));
+  res.m[1][2] = -invDet * (a * (g * q - h * p) - c * (e * q - h * n) +
+                           d_ * (e * p - g * n));
+  res.m[2][2] = invDet * (a * (f * q - h * o) - b * (e * q - h * n) +
+                          d_ * (e * o - f * n));
+  res.m[3][2] = -invDet * (a * (f * p - g * o) - b * (e * p - g * n) +
+                           c * (e * o - f * n));
+
+  res.m[0][3] = -invDet * (b * (g * l - h * k) - c * (f * l - h * j) +
+                           d_ * (f * k - g * j));
+  res.m[1][3] = invDet * (a * (g * l - h * k) - c * (e * l - h * i) +
+                          d_ * (e * k - g * i));
+  res.m[2][3] = -invDet * (a * (f * l - h * j) - b * (e * l - h * i) +
+                           d_ * (e * j - f * i));
+  res.m[3][3] = invDet * (a * (f * k - g * j) - b * (e * k - g * i) +
+                          c * (e * j - f * i));
+
+  return res;
+}
+
+#endif // XI_MATRIX_VECTOR
+
+Matrix4 compose(Vector3 position, Vector3 rotation, Vector3 scale) {
+  Matrix4 r;
+  composeItem(sin(rotation.x), cos(rotation.x), sin(rotation.y),
+              cos(rotation.y), sin(rotation.z), cos(rotation.z), position.x,
+              position.y, position.z, scale.x, scale.y, scale.z, &r.m[0][0],
+              1);
+  return r;
+}
+
+// --- Batches ---
+
+void transformPoints(const Matrix4 &m, const f32 *in, f32 *out, usz n) {
+  batchTable().points(&m.m[0][0], in, out, n, 1.0f);
+}
+
+void transformVectors(const Matrix4 &m, const f32 *in, f32 *out, usz n) {
+  batchTable().points(&m.m[0][0], in, out, n, 0.0f);
+}
+
+void multiply(const f32 *a, const f32 *b, f32 *c, usz n) {
+  batchTable().multiply(a, b, c, n);
+}
+
+void compose(const f32 *position, const f32 *rotation, const f32 *scale,
+             f32 *out, usz n) {
+  batchTable().compose(position, rotation, scale, out, n);
+}
+
+namespace {
+
+// Planes of a [rows, n] Array, or null if it is not shaped that way.
+const f32 *planes(const ArrayView<f32> &v, usz rows) {
+  if (v.rank() != 2 || v.dim(0) != rows)
+    return nullptr;
+  return v.data();
+}
+
+Array<f32> shaped(usz rows, usz n) {
+  Array<f32> r;
+  r.allocate(rows * n);
+  usz d[2] = {rows, n};
+  r.shape(2, d);
+  return r;
+}
+
+Array<f32> transformPlanes(const Matrix4 &m, const Array<f32> &points,
+                           f32 w) {
+  ArrayView<f32> v(points);
+  const f32 *in = planes(v, 3);
+  if (!in)
+    return Array<f32>();
+  usz n = v.dim(1);
+  Array<f32> r = shaped(3, n);
+  batchTable().points(&m.m[0][0], in, r.data(), n, w);
+  return r;
+}
+
+} // namespace
+
+Array<f32> transformPoints(const Matrix4 &m, const Array<f32> &points) {
+  return transformPlanes(m, points, 1.0f);
+}
+
+Array<f32> transformVectors(const Matrix4 &m, const Array<f32> &vectors) {
+  return transformPlanes(m, vectors, 0.0f);
+}
+
+Array<f32> multiply(const Array<f32> &a, const Array<f32> &b) {
+  ArrayView<f32> va(a), vb(b);
+  const f32 *pa = planes(va, 16), *pb = planes(vb, 16);
+  if (!pa || !pb || va.dim(1) != vb.dim(1))
+    return Array<f32>();
+  usz n = va.dim(1);
+  Array<f32> r = shaped(16, n);
+  batchTable().multiply(pa, pb, r.data(), n);
+  return r;
+}
+
+Array<f32> compose(const Array<f32> &position, const Array<f32> &rotation,
+                   const Array<f32> &scale) {
+  ArrayView<f32> vp(position), vr(rotation), vs(scale);
+  const f32 *p = planes(vp, 3), *r = planes(vr, 3), *s = planes(vs, 3);
+  if (!p || !r || !s || vr.dim(1) != vp.dim(1) || vs.dim(1) != vp.dim(1))
+    return Array<f32>();
+  usz n = vp.dim(1);
+  Array<f32> out = shaped(16, n);
+  batchTable().compose(p, r, s, out.data(), n);
+  return out;
+}
+
+Array<f32> toPlanes(const Matrix4 *m, usz n) {
+  Array<f32> r = shaped(16, n);
+  f32 *o = r.data();
+  for (usz i = 0; i < n; ++i)
+    for (usz e = 0; e < 16; ++e)
+      o[e * n + i] = (&m[i].m[0][0])[e];
+  return r;
+}
+
+bool fromPlanes(const Array<f32> &planes16, Matrix4 *out) {
+  ArrayView<f32> v(planes16);
+  const f32 *p = planes(v, 16);
+  if (!p)
+    return false;
+  usz n = v.dim(1);
+  for (usz i = 0; i < n; ++i)
+    for (usz e = 0; e < 16; ++e)
+      (&out[i].m[0][0])[e] = p[e * n + i];
+  return true;
+}
+
+} // namespace Math
+} // namespace Xi
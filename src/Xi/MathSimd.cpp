@@ -0,0 +1,479 @@
+#include <Xi/Math.hpp>
+#include <atomic>
+
+// -------------------------------------------------------------------------
+// Vectorized f32 transcendentals
+//
+// One polynomial implementation per function, written with GCC/Clang vector
+// extensions and instantiated per instruction set: SSE2 (4 lanes), AVX2+FMA
+// (8) and AVX-512 (16) on x86, NEON (4) on ARM, SIMD128 (4) on WebAssembly
+// built with -msimd128, generic 4-lane elsewhere.
+// The widest set the CPU supports is picked on first use. Compilers without
+// vector extensions, and microcontrollers, get the scalar libm loops.
+//
+// Approximations follow Cephes (argument reduction + minimax polynomial).
+// -------------------------------------------------------------------------
+
+#if defined(__GNUC__) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define XI_SIMD_VECTOR
+#if defined(__x86_64__) || defined(__i386__)
+#define XI_SIMD_X86
+#endif
+#endif
+
+namespace Xi {
+namespace Math {
+namespace Simd {
+
+namespace {
+
+typedef void (*Kernel)(const f32 *x, f32 *y, usz n);
+
+struct Table {
+  const char *isa;
+  Kernel exp, log, sin, cos, tanh, sigmoid, expApprox, sigmoidApprox;
+};
+
+// --- Scalar (libm) ---
+
+#define XI_SCALAR_KERNEL(name, expr)                                           \
+  void name(const f32 *x, f32 *y, usz n) {                                     \
+    for (usz i = 0; i < n; ++i) {                                              \
+      f32 v = x[i];                                                            \
+      y[i] = expr;                                                             \
+    }                                                                          \
+  }
+
+XI_SCALAR_KERNEL(scalarExp, __builtin_expf(v))
+XI_SCALAR_KERNEL(scalarLog, __builtin_logf(v))
+XI_SCALAR_KERNEL(scalarSin, __builtin_sinf(v))
+XI_SCALAR_KERNEL(scalarCos, __builtin_cosf(v))
+XI_SCALAR_KERNEL(scalarTanh, __builtin_tanhf(v))
+XI_SCALAR_KERNEL(scalarSigmoid, 1.0f / (1.0f + __builtin_expf(-v)))
+
+#undef XI_SCALAR_KERNEL
+
+const Table scalarTable = {"scalar",   scalarExp,     scalarLog,
+                           scalarSin,  scalarCos,     scalarTanh,
+                           scalarSigmoid, scalarExp, scalarSigmoid};
+
+#ifdef XI_SIMD_VECTOR
+
+#define XI_VINLINE inline __attribute__((always_inline))
+
+// The helpers take and return wide vectors but are always inlined into the
+// target-specific loops, so the ABI note GCC emits for them does not apply.
+#if !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+template <int W> struct Lanes {
+  typedef f32 V __attribute__((vector_size(W * 4)));
+  typedef i32 I __attribute__((vector_size(W * 4)));
+};
+
+template <typename V> XI_VINLINE V splat(f32 s) { return V{} + s; }
+
+template <typename V, typename I> XI_VINLINE V select(I m, V a, V b) {
+  return (V)(((I)a & m) | ((I)b & ~m));
+}
+
+template <typename V, typename I> XI_VINLINE V bits(I i) { return (V)i; }
+
+template <typename I> XI_VINLINE I signBit() { return I{} + (i32)0x80000000; }
+
+// Multiplies by 2^k for k in [-150, 128] without overflowing the exponent
+// field, so results stay correct down through the subnormals.
+template <typename V, typename I> XI_VINLINE V scale2(V p, I k) {
+  I k1 = k >> 1;
+  I k2 = k - k1;
+  return p * bits<V, I>((k1 + 127) << 23) * bits<V, I>((k2 + 127) << 23);
+}
+
+// exp: x = k ln2 + r, |r| <= ln2/2; e^r by a degree-6 polynomial.
+template <typename V, typename I> XI_VINLINE V vexp(V x) {
+  const f32 hi = 88.72283905f, lo = -103.972084f;
+  I nan = x != x;
+  V xc = select<V, I>(x > hi, splat<V>(hi), x);
+  xc = select<V, I>(xc < lo, splat<V>(lo), xc);
+  xc = select<V, I>(nan, V{}, xc);
+
+  V t = xc * 1.44269504088896341f;
+  I k = __builtin_convertvector(
+      t + select<V, I>(t < 0.0f, splat<V>(-0.5f), splat<V>(0.5f)), I);
+  V n = __builtin_convertvector(k, V);
+  V r = xc - n * 0.693359375f;
+  r = r + n * 2.12194440e-4f;
+
+  V z = r * r;
+  V p = 1.9875691500e-4f * r + 1.3981999507e-3f;
+  p = p * r + 8.3334519073e-3f;
+  p = p * r + 4.1665795894e-2f;
+  p = p * r + 1.6666665459e-1f;
+  p = p * r + 5.0000001201e-1f;
+  p = p * z + r + 1.0f;
+
+  V y = scale2<V, I>(p, k);
+  y = select<V, I>(x > hi, splat<V>(__builtin_inff()), y);
+  y = select<V, I>(x < lo, V{}, y);
+  return select<V, I>(nan, x, y);
+}
+
+// log: x = m 2^e with m in [sqrt(1/2), sqrt(2)); log(m) by a degree-9
+// polynomial in m - 1.
+template <typename V, typename I> XI_VINLINE V vlog(V x) {
+  // Subnormals are scaled into the normal range first. (Single compares only:
+  // GCC scalarizes AND-ed AVX-512 compare masks.)
+  I sub = x < 1.17549435e-38f;
+  V xs = select<V, I>(sub, x * 8388608.0f, x);
+  I b = (I)xs;
+  I e = ((b >> 23) & 0xff) - 126;
+  e = e - (sub & 23);
+  V m = bits<V, I>((b & 0x807fffff) | 0x3f000000); // [0.5, 1)
+
+  I small = m < 0.707106781186547524f;
+  V ef = __builtin_convertvector(e, V) - select<V, I>(small, splat<V>(1.0f),
+                                                      V{});
+  m = m - 1.0f + select<V, I>(small, m, V{});
+
+  V z = m * m;
+  V p = 7.0376836292e-2f * m - 1.1514610310e-1f;
+  p = p * m + 1.1676998740e-1f;
+  p = p * m - 1.2420140846e-1f;
+  p = p * m + 1.4249322787e-1f;
+  p = p * m - 1.6668057665e-1f;
+  p = p * m + 2.0000714765e-1f;
+  p = p * m - 2.4999993993e-1f;
+  p = p * m + 3.3333331174e-1f;
+  V y = p * m * z;
+  y = y - ef * 2.12194440e-4f;
+  y = y - 0.5f * z;
+  y = m + y + ef * 0.693359375f;
+
+  y = select<V, I>(x == 0.0f, splat<V>(-__builtin_inff()), y);
+  y = select<V, I>(x == __builtin_inff(), x, y);
+  return select<V, I>(x >= 0.0f, y, splat<V>(__builtin_nanf(""))); // < 0, NaN
+}
+
+// sin/cos: reduce by multiples of pi/4 (four-part Cody-Waite, the first
+// three exact for j < 2^13), then a sine
+// or cosine polynomial on [-pi/4, pi/4] depending on the octant.
+// Accurate for |x| <= 8192; the caller sends larger lanes to libm.
+template <typename V, typename I> XI_VINLINE V vsincos(V x, bool cosine) {
+  I sign = (I)x & signBit<I>();
+  V a = (V)((I)x & ~signBit<I>());
+
+  I j = __builtin_convertvector(a * 1.27323954473516f, I);
+  j = (j + 1) & ~1;
+  V y = __builtin_convertvector(j, V);
+  if (cosine) {
+    j = j - 2;
+    sign = (~j & 4) << 29;
+  } else {
+    sign = sign ^ ((j & 4) << 29);
+  }
+  I useSin = (j & 2) == 0;
+
+  a = a - y * 0.78515625f;
+  a = a - y * 2.4187564849853515625e-4f;
+  a = a - y * 3.7747668102383614e-8f;
+  a = a - y * 1.2816720757972595e-12f;
+  V z = a * a;
+
+  V c = 2.443315711809948e-5f * z - 1.388731625493765e-3f;
+  c = c * z + 4.166664568298827e-2f;
+  c = c * z * z - 0.5f * z + 1.0f;
+
+  V s = -1.9515295891e-4f * z + 8.3321608736e-3f;
+  s = s * z - 1.6666654611e-1f;
+  s = s * z * a + a;
+
+  return (V)((I)select<V, I>(useSin, s, c) ^ sign);
+}
+
+// tanh: odd polynomial below 0.625, 1 - 2 / (e^2|x| + 1) above.
+template <typename V, typename I> XI_VINLINE V vtanh(V x) {
+  I sign = (I)x & signBit<I>();
+  V a = (V)((I)x & ~signBit<I>());
+  V z = x * x;
+  V p = -5.70498872745e-3f * z + 2.06390887954e-2f;
+  p = p * z - 5.37397155531e-2f;
+  p = p * z + 1.33314422036e-1f;
+  p = p * z - 3.33332819422e-1f;
+  p = p * z * a + a;
+
+  V e = vexp<V, I>(a + a);
+  V q = 1.0f - 2.0f / (e + 1.0f);
+  return (V)((I)select<V, I>(a < 0.625f, p, q) | sign);
+}
+
+// sigmoid: e / (1 + e) with e = exp(-|x|), so the negative tail keeps its
+// precision instead of collapsing to 1 / inf.
+template <typename V, typename I> XI_VINLINE V vsigmoid(V x) {
+  V e = vexp<V, I>((V)((I)x | signBit<I>()));
+  return select<V, I>(x < 0.0f, e, splat<V>(1.0f)) / (1.0f + e);
+}
+
+// Approximate exp: one-constant reduction and a degree-4 polynomial for
+// 2^f. Inputs are clamped to [-87.3, 88.7]; no infinities or subnormals.
+template <typename V, typename I> XI_VINLINE V vexpApprox(V x) {
+  V t = x * 1.44269504088896341f;
+  t = select<V, I>(t > 127.9f, splat<V>(127.9f), t);
+  t = select<V, I>(t < -126.0f, splat<V>(-126.0f), t);
+  I k = __builtin_convertvector(
+      t + select<V, I>(t < 0.0f, splat<V>(-0.5f), splat<V>(0.5f)), I);
+  V f = t - __builtin_convertvector(k, V);
+  V p = 9.618129e-3f * f + 5.550411e-2f;
+  p = p * f + 2.402265e-1f;
+  p = p * f + 6.931472e-1f;
+  p = p * f + 1.0f;
+  return p * bits<V, I>((k + 127) << 23);
+}
+
+template <typename V, typename I> XI_VINLINE V vsigmoidApprox(V x) {
+  return 1.0f / (1.0f + vexpApprox<V, I>(-x));
+}
+
+// --- Per-ISA loops ---
+
+struct OpExp {
+  template <typename V, typename I> static XI_VINLINE V eval(V x) {
+    return vexp<V, I>(x);
+  }
+  static f32 ref(f32 x) { return __builtin_expf(x); }
+};
+struct OpLog {
+  template <typename V, typename I> static XI_VINLINE V eval(V x) {
+    return vlog<V, I>(x);
+  }
+  static f32 ref(f32 x) { return __builtin_logf(x); }
+};
+struct OpSin {
+  template <typename V, typename I> static XI_VINLINE V eval(V x) {
+    return vsincos<V, I>(x, false);
+  }
+  static f32 ref(f32 x) { return __builtin_sinf(x); }
+};
+struct OpCos {
+  template <typename V, typename I> static XI_VINLINE V eval(V x) {
+    return vsincos<V, I>(x, true);
+  }
+  static f32 ref(f32 x) { return __builtin_cosf(x); }
+};
+struct OpTanh {
+  template <typename V, typename I> static XI_VINLINE V eval(V x) {
+    return vtanh<V, I>(x);
+  }
+  static f32 ref(f32 x) { return __builtin_tanhf(x); }
+};
+struct OpSigmoid {
+  template <typename V, typename I> static XI_VINLINE V eval(V x) {
+    return vsigmoid<V, I>(x);
+  }
+  static f32 ref(f32 x) { return 1.0f / (1.0f + __builtin_expf(-x)); }
+};
+struct OpExpApprox {
+  template <typename V, typename I> static XI_VINLINE V eval(V x) {
+    return vexpApprox<V, I>(x);
+  }
+};
+struct OpSigmoidApprox {
+  template <typename V, typename I> static XI_VINLINE V eval(V x) {
+    return vsigmoidApprox<V, I>(x);
+  }
+};
+
+template <int W, typename Op>
+XI_VINLINE void run(const f32 *x, f32 *y, usz n) {
+  typedef typename Lanes<W>::V V;
+  typedef typename Lanes<W>::I I;
+  usz i = 0;
+  for (; i + W <= n; i += W) {
+    V v;
+    __builtin_memcpy(&v, x + i, sizeof(V));
+    v = Op::template eval<V, I>(v);
+    __builtin_memcpy(y + i, &v, sizeof(V));
+  }
+  if (i < n) {
+    V v = {};
+    __builtin_memcpy(&v, x + i, (n - i) * sizeof(f32));
+    v = Op::template eval<V, I>(v);
+    __builtin_memcpy(y + i, &v, (n - i) * sizeof(f32));
+  }
+}
+
+// sin/cos lose accuracy beyond |x| = 8192; redo those elements with libm.
+template <int W, typename Op>
+XI_VINLINE void trigStep(const f32 *x, f32 *y, usz m) {
+  typedef typename Lanes<W>::V V;
+  typedef typename Lanes<W>::I I;
+  V v = {};
+  if (m == (usz)W)
+    __builtin_memcpy(&v, x, sizeof(V));
+  else
+    __builtin_memcpy(&v, x, m * sizeof(f32));
+  V a = (V)((I)v & ~signBit<I>());
+  I big = ~(a <= 8192.0f); // also NaN and infinities
+  V r = Op::template eval<V, I>(v);
+
+  i32 lanes[W];
+  __builtin_memcpy(lanes, &big, sizeof(lanes));
+  i32 any = 0;
+  for (int l = 0; l < W; ++l)
+    any |= lanes[l];
+  if (any) {
+    f32 out[W];
+    __builtin_memcpy(out, &r, sizeof(out));
+    for (usz l = 0; l < m; ++l)
+      if (lanes[l])
+        out[l] = Op::ref(x[l]);
+    __builtin_memcpy(&r, out, sizeof(out));
+  }
+  if (m == (usz)W)
+    __builtin_memcpy(y, &r, sizeof(V));
+  else
+    __builtin_memcpy(y, &r, m * sizeof(f32));
+}
+
+template <int W, typename Op>
+XI_VINLINE void runTrig(const f32 *x, f32 *y, usz n) {
+  usz i = 0;
+  for (; i + W <= n; i += W)
+    trigStep<W, Op>(x + i, y + i, W);
+  if (i < n)
+    trigStep<W, Op>(x + i, y + i, n - i);
+}
+
+#define XI_SIMD_TABLE(ns, name, W, TARGET)                                     \
+  namespace ns {                                                               \
+  TARGET void exp(const f32 *x, f32 *y, usz n) { run<W, OpExp>(x, y, n); }     \
+  TARGET void log(const f32 *x, f32 *y, usz n) { run<W, OpLog>(x, y, n); }     \
+  TARGET void sin(const f32 *x, f32 *y, usz n) { runTrig<W, OpSin>(x, y, n); } \
+  TARGET void cos(const f32 *x, f32 *y, usz n) { runTrig<W, OpCos>(x, y, n); } \
+  TARGET void tanh(const f32 *x, f32 *y, usz n) { run<W, OpTanh>(x, y, n); }  \
+  TARGET void sigmoid(const f32 *x, f32 *y, usz n) {                           \
+    run<W, OpSigmoid>(x, y, n);                                                \
+  }                                                                            \
+  TARGET void expApprox(const f32 *x, f32 *y, usz n) {                         \
+    run<W, OpExpApprox>(x, y, n);                                              \
+  }                                                                            \
+  TARGET void sigmoidApprox(const f32 *x, f32 *y, usz n) {                     \
+    run<W, OpSigmoidApprox>(x, y, n);                                          \
+  }                                                                            \
+  const Table table = {name, exp,     log,       sin,                         \
+                       cos,  tanh,    sigmoid,   expApprox,                   \
+                       sigmoidApprox};                                         \
+  }
+
+#if defined(XI_SIMD_X86)
+XI_SIMD_TABLE(avx512, "avx512", 16,
+              __attribute__((target("avx512f,avx2,fma"))))
+XI_SIMD_TABLE(avx2, "avx2", 8, __attribute__((target("avx2,fma"))))
+#if defined(__SSE2__)
+XI_SIMD_TABLE(sse2, "sse2", 4, )
+#endif
+#elif defined(__ARM_NEON) || defined(__aarch64__)
+XI_SIMD_TABLE(neon, "neon", 4, )
+#elif defined(__wasm_simd128__)
+XI_SIMD_TABLE(simd128, "simd128", 4, )
+#else
+XI_SIMD_TABLE(generic, "generic", 4, )
+#endif
+
+#undef XI_SIMD_TABLE
+
+#endif // XI_SIMD_VECTOR
+
+// --- Dispatch ---
+
+const Table *best() {
+#if defined(XI_SIMD_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f"))
+    return &avx512::table;
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return &avx2::table;
+#if defined(__SSE2__)
+  return &sse2::table;
+#endif
+#elif defined(XI_SIMD_VECTOR) && (defined(__ARM_NEON) || defined(__aarch64__))
+  return &neon::table;
+#elif defined(XI_SIMD_VECTOR) && defined(__wasm_simd128__)
+  return &simd128::table;
+#elif defined(XI_SIMD_VECTOR)
+  return &generic::table;
+#endif
+  return &scalarTable;
+}
+
+// Picked on first use, from whichever thread gets there first (GEMM or
+// softmax on several WorkerPool threads at once). Every thread computes
+// the same best(), so relaxed order suffices; tables are static.
+std::atomic<const Table *> active(nullptr);
+
+inline const Table &table() {
+  const Table *t = active.load(std::memory_order_relaxed);
+  if (!t) {
+    t = best();
+    active.store(t, std::memory_order_relaxed);
+  }
+  return *t;
+}
+
+} // namespace
+
+void exp(const f32 *x, f32 *y, usz n) { table().exp(x, y, n); }
+void log(const f32 *x, f32 *y, usz n) { table().log(x, y, n); }
+void sin(const f32 *x, f32 *y, usz n) { table().sin(x, y, n); }
+void cos(const f32 *x, f32 *y, usz n) { table().cos(x, y, n); }
+void tanh(const f32 *x, f32 *y, usz n) { table().tanh(x, y, n); }
+void sigmoid(const f32 *x, f32 *y, usz n) { table().sigmoid(x, y, n); }
+void expApprox(const f32 *x, f32 *y, usz n) { table().expApprox(x, y, n); }
+void sigmoidApprox(const f32 *x, f32 *y, usz n) {
+  table().sigmoidApprox(x, y, n);
+}
+
+const char *isa() { return table().isa; }
+
+bool use(const char *name) {
+#if defined(XI_SIMD_X86)
+  __builtin_cpu_init();
+#endif
+  const Table *candidates[] = {
+#if defined(XI_SIMD_X86)
+      __builtin_cpu_supports("avx512f") ? &avx512::table : nullptr,
+      __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")
+          ? &avx2::table
+          : nullptr,
+#if defined(__SSE2__)
+      &sse2::table,
+#endif
+#elif defined(XI_SIMD_VECTOR) && (defined(__ARM_NEON) || defined(__aarch64__))
+      &neon::table,
+#elif defined(XI_SIMD_VECTOR) && defined(__wasm_simd128__)
+      &simd128::table,
+#elif defined(XI_SIMD_VECTOR)
+      &generic::table,
+#endif
+      &scalarTable};
+  if (!name) {
+    active.store(best(), std::memory_order_relaxed);
+    return true;
+  }
+  for (const Table *t : candidates) {
+    if (!t)
+      continue;
+    const char *a = t->isa, *b = name;
+    while (*a && *a == *b)
+      a++, b++;
+    if (*a == *b) {
+      active.store(t, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace Simd
+} // namespace Math
+} // namespace Xi
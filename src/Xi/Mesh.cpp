@@ -0,0 +1,61 @@
+#include "../../include/Xi/Mesh.hpp"
+
+#ifdef XI_HAS_GRAPHICS
+#include "../../include/Xi/Graphics.hpp"
+#endif
+
+// The GPU half of Mesh3. Without XI_BUILD_GRAPHICS there are no buffers to
+// create or release, and Mesh.hpp stays free of the Diligent headers.
+
+namespace Xi {
+
+void Mesh3::upload() {
+  consumeDirty();
+#ifdef XI_HAS_GRAPHICS
+  // We only upload after an edit, and only if the mesh has data
+  if (!_uploadPending || vertices.length() == 0)
+    return;
+
+  // Clean up old GPU resources before creating new ones
+  GraphicsContext::release(_vb);
+  GraphicsContext::release(_ib);
+
+  // Full vertices are already packed correctly and go up directly.
+  if (format == VertexFormat::Full) {
+    gContext.createBuffer(vertices.data(),
+                          (u32)(vertices.length() * sizeof(Vertex)), false,
+                          &_vb);
+  } else {
+    InlineArray<u8> packed;
+    MeshOpt::pack(vertices.data(), vertices.length(), format, bounds(),
+                  packed);
+    gContext.createBuffer(packed.data(), (u32)packed.size(), false, &_vb);
+  }
+
+  // Upload indices if they exist
+  _ib16 = false;
+  if (indices.length() > 0) {
+    InlineArray<u16> narrow;
+    if (index16 && MeshOpt::narrow(indices.data(), indices.length(), narrow)) {
+      gContext.createBuffer(narrow.data(), (u32)(narrow.size() * sizeof(u16)),
+                            true, &_ib);
+      _ib16 = true;
+    } else {
+      gContext.createBuffer(indices.data(),
+                            (u32)(indices.length() * sizeof(u32)), true,
+                            &_ib);
+    }
+  }
+
+  _uploadPending = false;
+#endif
+}
+
+Mesh3::~Mesh3() {
+#ifdef XI_HAS_GRAPHICS
+  GraphicsContext::release(_vb);
+  GraphicsContext::release(_ib);
+#endif
+}
+
+} // namespace Xi
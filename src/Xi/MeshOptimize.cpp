@@ -0,0 +1,641 @@
+#include <Xi/MeshOptimize.hpp>
+
+namespace Xi {
+namespace MeshOpt {
+namespace {
+
+const u32 None = ~(u32)0;
+
+inline f32 absf(f32 x) { return x < 0 ? -x : x; }
+inline f32 clampf(f32 x, f32 lo, f32 hi) { return x < lo ? lo : (x > hi ? hi : x); }
+inline i32 roundi(f32 x) { return (i32)(x < 0 ? x - 0.5f : x + 0.5f); }
+
+u32 hashVertex(const Vertex &v) {
+  u32 w[sizeof(Vertex) / 4];
+  __builtin_memcpy(w, &v, sizeof(w));
+  u32 h = 2166136261u;
+  for (usz i = 0; i < sizeof(w) / 4; ++i) {
+    h ^= w[i];
+    h *= 16777619u;
+    h ^= h >> 15;
+  }
+  return h;
+}
+
+// FIFO post-transform cache: a vertex is resident while fewer than `size`
+// misses happened since it was loaded.
+struct Fifo {
+  InlineArray<u32> stamp;
+  u32 misses = 0, size;
+
+  Fifo(usz vertexCount, u32 cacheSize) : size(cacheSize) {
+    stamp.allocate(vertexCount);
+  }
+  bool hit(u32 v) const { return stamp[v] && misses - stamp[v] < size; }
+  u32 touch(u32 v) {
+    if (hit(v))
+      return 0;
+    stamp[v] = ++misses;
+    return 1;
+  }
+  void reset() { misses += size; }
+};
+
+bool validIndices(const u32 *indices, usz count, usz vertexCount) {
+  for (usz i = 0; i < count; ++i)
+    if (indices[i] >= vertexCount)
+      return false;
+  return true;
+}
+
+// Stable descending sort of (key, value) pairs, bottom-up merge.
+struct Keyed {
+  f32 key;
+  u32 value;
+};
+
+void sortDescending(InlineArray<Keyed> &a) {
+  usz n = a.size();
+  InlineArray<Keyed> tmp;
+  tmp.allocate(n);
+  Keyed *src = a.data(), *dst = tmp.data();
+  for (usz width = 1; width < n; width *= 2) {
+    for (usz lo = 0; lo < n; lo += 2 * width) {
+      usz mid = lo + width < n ? lo + width : n;
+      usz hi = lo + 2 * width < n ? lo + 2 * width : n;
+      usz i = lo, j = mid, k = lo;
+      while (i < mid && j < hi)
+        dst[k++] = src[j].key > src[i].key ? src[j++] : src[i++];
+      while (i < mid)
+        dst[k++] = src[i++];
+      while (j < hi)
+        dst[k++] = src[j++];
+    }
+    Keyed *t = src;
+    src = dst;
+    dst = t;
+  }
+  if (src != a.data())
+    for (usz i = 0; i < n; ++i)
+      a[i] = src[i];
+}
+
+// Forsyth's vertex scores.
+const u32 CacheSize = 32;
+const u32 MaxValence = 32;
+
+struct ScoreTables {
+  f32 cache[CacheSize];
+  f32 valence[MaxValence + 1];
+
+  ScoreTables() {
+    for (u32 i = 0; i < CacheSize; ++i) {
+      if (i < 3) {
+        cache[i] = 0.75f; // the last triangle's vertices, equally
+      } else {
+        f32 s = 1.0f - (f32)(i - 3) / (f32)(CacheSize - 3);
+        cache[i] = s * Math::sqrt(s); // ^1.5
+      }
+    }
+    valence[0] = 0;
+    for (u32 i = 1; i <= MaxValence; ++i)
+      valence[i] = 2.0f / Math::sqrt((f32)i);
+  }
+
+  f32 score(i32 pos, u32 remaining) const {
+    if (remaining == 0)
+      return -1.0f;
+    f32 s = pos >= 0 ? cache[pos] : 0;
+    return s + valence[remaining < MaxValence ? remaining : MaxValence];
+  }
+};
+
+} // namespace
+
+// -------------------------------------------------------------------------
+// Welding
+// -------------------------------------------------------------------------
+
+usz weld(const Vertex *vertices, usz vertexCount, const u32 *indices,
+         usz indexCount, InlineArray<Vertex> &outVertices,
+         InlineArray<u32> &outIndices) {
+  outVertices.allocate(0);
+  outIndices.allocate(0);
+  if (!vertices || vertexCount == 0)
+    return 0;
+  usz count = indices ? indexCount - indexCount % 3 : vertexCount - vertexCount % 3;
+
+  usz cap = 16;
+  while (cap < vertexCount * 2)
+    cap *= 2;
+  InlineArray<u32> table, remap;
+  table.allocate(cap);
+  remap.allocate(vertexCount);
+  for (usz i = 0; i < cap; ++i)
+    table[i] = None;
+  for (usz i = 0; i < vertexCount; ++i)
+    remap[i] = None;
+
+  outIndices.reserve(count);
+  for (usz t = 0; t < count; t += 3) {
+    u32 src[3];
+    bool ok = true;
+    for (int c = 0; c < 3; ++c) {
+      src[c] = indices ? indices[t + c] : (u32)(t + c);
+      ok = ok && src[c] < vertexCount;
+    }
+    if (!ok)
+      continue; // drop triangles with out-of-range indices
+    for (int c = 0; c < 3; ++c) {
+      u32 s = src[c];
+      if (remap[s] == None) {
+        usz slot = hashVertex(vertices[s]) & (cap - 1);
+        while (table[slot] != None &&
+               __builtin_memcmp(&outVertices[table[slot]], &vertices[s],
+                                sizeof(Vertex)) != 0)
+          slot = (slot + 1) & (cap - 1);
+        if (table[slot] == None) {
+          table[slot] = (u32)outVertices.size();
+          outVertices.push(vertices[s]);
+        }
+        remap[s] = table[slot];
+      }
+      outIndices.push(remap[s]);
+    }
+  }
+  return outVertices.size();
+}
+
+// -------------------------------------------------------------------------
+// Vertex cache (Forsyth)
+// -------------------------------------------------------------------------
+
+void optimizeVertexCache(u32 *indices, usz indexCount, usz vertexCount) {
+  usz triCount = indexCount / 3;
+  if (!indices || triCount < 2 || !validIndices(indices, triCount * 3, vertexCount))
+    return;
+  static const ScoreTables scores;
+
+  // Triangles per vertex (CSR); each vertex's live triangles are the
+  // first remaining[v] of its slice.
+  InlineArray<u32> offset, remaining, adj;
+  offset.allocate(vertexCount + 1);
+  remaining.allocate(vertexCount);
+  for (usz i = 0; i < triCount * 3; ++i)
+    remaining[indices[i]]++;
+  for (usz v = 0; v < vertexCount; ++v)
+    offset[v + 1] = offset[v] + remaining[v];
+  adj.allocate(triCount * 3);
+  {
+    InlineArray<u32> fill;
+    fill.allocate(vertexCount);
+    for (usz t = 0; t < triCount; ++t)
+      for (int c = 0; c < 3; ++c) {
+        u32 v = indices[t * 3 + c];
+        adj[offset[v] + fill[v]++] = (u32)t;
+      }
+  }
+
+  InlineArray<i32> cachePos;
+  InlineArray<f32> vScore, tScore;
+  InlineArray<u8> emitted;
+  cachePos.allocate(vertexCount);
+  vScore.allocate(vertexCount);
+  tScore.allocate(triCount);
+  emitted.allocate(triCount);
+  for (usz v = 0; v < vertexCount; ++v) {
+    cachePos[v] = -1;
+    vScore[v] = scores.score(-1, remaining[v]);
+  }
+  u32 best = 0;
+  f32 bestScore = -1.0f;
+  for (usz t = 0; t < triCount; ++t) {
+    const u32 *i = indices + t * 3;
+    tScore[t] = vScore[i[0]] + vScore[i[1]] + vScore[i[2]];
+    if (tScore[t] > bestScore)
+      bestScore = tScore[t], best = (u32)t;
+  }
+
+  InlineArray<u32> out;
+  out.allocate(triCount * 3);
+  u32 cache[CacheSize + 3], next[CacheSize + 3];
+  u32 cached = 0;
+  usz cursor = 0;
+
+  for (usz n = 0; n < triCount; ++n) {
+    const u32 *tri = indices + best * 3;
+    emitted[best] = 1;
+    for (int c = 0; c < 3; ++c) {
+      u32 v = tri[c];
+      out[n * 3 + c] = v;
+      // Take the triangle out of v's live list.
+      u32 *list = adj.data() + offset[v];
+      for (u32 k = 0; k < remaining[v]; ++k)
+        if (list[k] == best) {
+          list[k] = list[--remaining[v]];
+          break;
+        }
+    }
+
+    // New LRU order: the triangle's vertices, then the old cache.
+    u32 m = 0;
+    for (int c = 0; c < 3; ++c)
+      next[m++] = tri[c];
+    for (u32 k = 0; k < cached; ++k) {
+      u32 v = cache[k];
+      if (v != tri[0] && v != tri[1] && v != tri[2])
+        next[m++] = v;
+    }
+    for (u32 k = CacheSize; k < m; ++k)
+      cachePos[next[k]] = -1; // fell out
+    cached = m < CacheSize ? m : CacheSize;
+    for (u32 k = 0; k < m; ++k) {
+      u32 v = next[k];
+      if (k < CacheSize) {
+        cache[k] = v;
+        cachePos[v] = (i32)k;
+      }
+      vScore[v] = scores.score(cachePos[v], remaining[v]);
+    }
+
+    // Best live triangle touching the cache.
+    bestScore = -1.0f;
+    best = None;
+    for (u32 k = 0; k < cached; ++k) {
+      u32 v = cache[k];
+      const u32 *list = adj.data() + offset[v];
+      for (u32 q = 0; q < remaining[v]; ++q) {
+        u32 t = list[q];
+        const u32 *i = indices + t * 3;
+        f32 s = vScore[i[0]] + vScore[i[1]] + vScore[i[2]];
+        tScore[t] = s;
+        if (s > bestScore)
+          bestScore = s, best = t;
+      }
+    }
+    if (best == None) {
+      // Cache exhausted: continue with the next unemitted triangle.
+      while (cursor < triCount && emitted[cursor])
+        cursor++;
+      if (cursor == triCount)
+        break;
+      best = (u32)cursor;
+    }
+  }
+  for (usz i = 0; i < triCount * 3; ++i)
+    indices[i] = out[i];
+}
+
+// -------------------------------------------------------------------------
+// Overdraw
+// -------------------------------------------------------------------------
+
+void optimizeOverdraw(u32 *indices, usz indexCount, const Vertex *vertices,
+                      usz vertexCount, f32 threshold) {
+  usz triCount = indexCount / 3;
+  if (!indices || !vertices || triCount < 2 ||
+      !validIndices(indices, triCount * 3, vertexCount))
+    return;
+  const u32 cacheSize = 16;
+
+  // Hard boundaries: triangles whose three vertices all miss the cache.
+  InlineArray<u32> hard;
+  {
+    Fifo fifo(vertexCount, cacheSize);
+    for (usz t = 0; t < triCount; ++t) {
+      u32 m = 0;
+      for (int c = 0; c < 3; ++c)
+        m += fifo.touch(indices[t * 3 + c]);
+      if (t == 0 || m == 3)
+        hard.push((u32)t);
+    }
+  }
+  hard.push((u32)triCount);
+
+  // Soft boundaries: inside each hard cluster, cut as soon as the part so
+  // far, started with an empty cache, is within threshold of the cluster's
+  // own ACMR. Reordering whole parts then costs at most that much.
+  InlineArray<u32> clusters;
+  {
+    Fifo fifo(vertexCount, cacheSize);
+    for (usz h = 0; h + 1 < hard.size(); ++h) {
+      u32 begin = hard[h], end = hard[h + 1];
+      fifo.reset();
+      u32 misses = 0;
+      for (u32 t = begin; t < end; ++t)
+        for (int c = 0; c < 3; ++c)
+          misses += fifo.touch(indices[t * 3 + c]);
+      f32 limit = (f32)misses / (f32)(end - begin) * threshold;
+
+      fifo.reset();
+      u32 start = begin;
+      misses = 0;
+      clusters.push(begin);
+      for (u32 t = begin; t < end; ++t) {
+        for (int c = 0; c < 3; ++c)
+          misses += fifo.touch(indices[t * 3 + c]);
+        if (t + 1 < end && (f32)misses / (f32)(t + 1 - start) <= limit) {
+          clusters.push(t + 1);
+          start = t + 1;
+          misses = 0;
+          fifo.reset();
+        }
+      }
+    }
+  }
+  usz clusterCount = clusters.size();
+  clusters.push((u32)triCount);
+  if (clusterCount < 2)
+    return;
+
+  // Area-weighted centroids and normals; outward-facing clusters first.
+  f64 mesh[3] = {0, 0, 0}, meshArea = 0;
+  InlineArray<f32> info; // cx cy cz nx ny nz per cluster
+  info.allocate(clusterCount * 6);
+  for (usz k = 0; k < clusterCount; ++k) {
+    f32 *ci = info.data() + k * 6;
+    f32 area = 0;
+    for (u32 t = clusters[k]; t < clusters[k + 1]; ++t) {
+      const Vertex &a = vertices[indices[t * 3]], &b = vertices[indices[t * 3 + 1]],
+                   &c = vertices[indices[t * 3 + 2]];
+      f32 e1[3] = {b.x - a.x, b.y - a.y, b.z - a.z};
+      f32 e2[3] = {c.x - a.x, c.y - a.y, c.z - a.z};
+      f32 n[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                  e1[0] * e2[1] - e1[1] * e2[0]};
+      f32 w = Math::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+      ci[0] += (a.x + b.x + c.x) * w;
+      ci[1] += (a.y + b.y + c.y) * w;
+      ci[2] += (a.z + b.z + c.z) * w;
+      ci[3] += n[0], ci[4] += n[1], ci[5] += n[2];
+      area += w;
+    }
+    for (int q = 0; q < 3; ++q)
+      mesh[q] += ci[q];
+    meshArea += area;
+    f32 inv = area > 0 ? 1.0f / (3.0f * area) : 0;
+    for (int q = 0; q < 3; ++q)
+      ci[q] *= inv;
+  }
+  f32 center[3];
+  for (int q = 0; q < 3; ++q)
+    center[q] = meshArea > 0 ? (f32)(mesh[q] / (3.0 * meshArea)) : 0;
+
+  InlineArray<Keyed> order;
+  order.allocate(clusterCount);
+  for (usz k = 0; k < clusterCount; ++k) {
+    const f32 *ci = info.data() + k * 6;
+    f32 nl = Math::sqrt(ci[3] * ci[3] + ci[4] * ci[4] + ci[5] * ci[5]);
+    f32 d = 0;
+    if (nl > 0)
+      for (int q = 0; q < 3; ++q)
+        d += (ci[q] - center[q]) * ci[3 + q] / nl;
+    order[k].key = d;
+    order[k].value = (u32)k;
+  }
+  sortDescending(order);
+
+  InlineArray<u32> out;
+  out.allocate(triCount * 3);
+  usz n = 0;
+  for (usz k = 0; k < clusterCount; ++k) {
+    u32 c = order[k].value;
+    for (u32 t = clusters[c]; t < clusters[c + 1]; ++t)
+      for (int q = 0; q < 3; ++q)
+        out[n++] = indices[t * 3 + q];
+  }
+  for (usz i = 0; i < n; ++i)
+    indices[i] = out[i];
+}
+
+// -------------------------------------------------------------------------
+// Vertex fetch, analysis, indices
+// -------------------------------------------------------------------------
+
+usz optimizeVertexFetch(InlineArray<Vertex> &vertices, u32 *indices,
+                        usz indexCount) {
+  usz vertexCount = vertices.size();
+  if (!indices || !validIndices(indices, indexCount, vertexCount))
+    return vertexCount;
+  InlineArray<u32> remap;
+  remap.allocate(vertexCount);
+  for (usz v = 0; v < vertexCount; ++v)
+    remap[v] = None;
+  InlineArray<Vertex> out;
+  out.reserve(vertexCount);
+  for (usz i = 0; i < indexCount; ++i) {
+    u32 v = indices[i];
+    if (remap[v] == None) {
+      remap[v] = (u32)out.size();
+      out.push(vertices[v]);
+    }
+    indices[i] = remap[v];
+  }
+  vertices = out;
+  return out.size();
+}
+
+CacheStats analyzeVertexCache(const u32 *indices, usz indexCount,
+                              usz vertexCount, u32 cacheSize) {
+  CacheStats s;
+  usz triCount = indexCount / 3;
+  if (!indices || triCount == 0 || cacheSize == 0 ||
+      !validIndices(indices, triCount * 3, vertexCount))
+    return s;
+  Fifo fifo(vertexCount, cacheSize);
+  InlineArray<u8> used;
+  used.allocate(vertexCount);
+  usz misses = 0, unique = 0;
+  for (usz i = 0; i < triCount * 3; ++i) {
+    u32 v = indices[i];
+    misses += fifo.touch(v);
+    if (!used[v])
+      used[v] = 1, unique++;
+  }
+  s.acmr = (f32)misses / (f32)triCount;
+  s.atvr = (f32)misses / (f32)unique;
+  return s;
+}
+
+bool narrow(const u32 *indices, usz indexCount, InlineArray<u16> &out) {
+  out.allocate(0);
+  for (usz i = 0; i < indexCount; ++i)
+    if (indices[i] > 0xffffu)
+      return false;
+  out.allocate(indexCount);
+  for (usz i = 0; i < indexCount; ++i)
+    out[i] = (u16)indices[i];
+  return true;
+}
+
+// -------------------------------------------------------------------------
+// Quantization
+// -------------------------------------------------------------------------
+
+u16 toHalf(f32 f) {
+  u32 x;
+  __builtin_memcpy(&x, &f, 4);
+  u32 sign = (x >> 16) & 0x8000u;
+  u32 a = x & 0x7fffffffu;
+  if (a >= 0x7f800000u) // inf, nan
+    return (u16)(sign | 0x7c00u | (a > 0x7f800000u ? 0x200u : 0));
+  if (a >= 0x477ff000u) // rounds past the largest half
+    return (u16)(sign | 0x7c00u);
+  if (a < 0x38800000u) { // subnormal half (or zero)
+    if (a < 0x33000000u)
+      return (u16)sign;
+    u32 e = a >> 23, m = (a & 0x7fffffu) | 0x800000u;
+    u32 shift = 126 - e; // 14..24
+    u32 h = m >> shift, rest = m & ((1u << shift) - 1), half = 1u << (shift - 1);
+    if (rest > half || (rest == half && (h & 1)))
+      h++;
+    return (u16)(sign | h);
+  }
+  u32 h = ((a - 0x38000000u) >> 13);
+  u32 rest = a & 0x1fffu;
+  if (rest > 0x1000u || (rest == 0x1000u && (h & 1)))
+    h++;
+  return (u16)(sign | h);
+}
+
+f32 fromHalf(u16 h) {
+  u32 sign = (u32)(h & 0x8000u) << 16, e = (h >> 10) & 0x1fu, m = h & 0x3ffu;
+  u32 x;
+  if (e == 0x1f) {
+    x = sign | 0x7f800000u | (m << 13);
+  } else if (e == 0) {
+    f32 v = (f32)m * (1.0f / 16777216.0f); // m * 2^-24
+    return sign ? -v : v;
+  } else {
+    x = sign | ((e + 112) << 23) | (m << 13);
+  }
+  f32 f;
+  __builtin_memcpy(&f, &x, 4);
+  return f;
+}
+
+void octEncode(f32 x, f32 y, f32 z, i16 *out) {
+  f32 l1 = absf(x) + absf(y) + absf(z);
+  if (!(l1 > 0)) {
+    out[0] = out[1] = 0;
+    return;
+  }
+  x /= l1, y /= l1;
+  if (z < 0) {
+    f32 ox = (1.0f - absf(y)) * (x < 0 ? -1.0f : 1.0f);
+    f32 oy = (1.0f - absf(x)) * (y < 0 ? -1.0f : 1.0f);
+    x = ox, y = oy;
+  }
+  out[0] = (i16)roundi(clampf(x, -1, 1) * 32767.0f);
+  out[1] = (i16)roundi(clampf(y, -1, 1) * 32767.0f);
+}
+
+void octDecode(const i16 *in, f32 *xyz) {
+  f32 x = clampf(in[0] / 32767.0f, -1, 1), y = clampf(in[1] / 32767.0f, -1, 1);
+  f32 z = 1.0f - absf(x) - absf(y);
+  if (z < 0) {
+    f32 ox = (1.0f - absf(y)) * (x < 0 ? -1.0f : 1.0f);
+    f32 oy = (1.0f - absf(x)) * (y < 0 ? -1.0f : 1.0f);
+    x = ox, y = oy;
+  }
+  f32 l = Math::sqrt(x * x + y * y + z * z);
+  xyz[0] = x / l, xyz[1] = y / l, xyz[2] = z / l;
+}
+
+namespace {
+
+// Positions map to [-1, 1] around the box center with one scale for all
+// axes, so the decode matrix is a uniform scale and normals transformed by
+// the world matrix only need renormalizing.
+void quantBox(const Bounds &b, f32 *center, f32 &extent) {
+  if (b.empty()) {
+    center[0] = center[1] = center[2] = 0;
+    extent = 1;
+    return;
+  }
+  center[0] = (b.min.x + b.max.x) * 0.5f;
+  center[1] = (b.min.y + b.max.y) * 0.5f;
+  center[2] = (b.min.z + b.max.z) * 0.5f;
+  f32 e = b.max.x - b.min.x;
+  e = b.max.y - b.min.y > e ? b.max.y - b.min.y : e;
+  e = b.max.z - b.min.z > e ? b.max.z - b.min.z : e;
+  extent = e > 0 ? e * 0.5f : 1.0f;
+}
+
+inline i16 snorm16(f32 v) { return (i16)roundi(clampf(v, -1, 1) * 32767.0f); }
+
+template <typename C> void packCommon(const Vertex &v, const f32 *c, f32 inv, C &o) {
+  o.p[0] = snorm16((v.x - c[0]) * inv);
+  o.p[1] = snorm16((v.y - c[1]) * inv);
+  o.p[2] = snorm16((v.z - c[2]) * inv);
+  o.p[3] = 32767; // w reads as 1
+  o.uv[0] = toHalf(v.u);
+  o.uv[1] = toHalf(v.v);
+  octEncode(v.nx, v.ny, v.nz, o.n);
+}
+
+// Weights to unorm8 summing to exactly 255; the rounding error goes to the
+// largest weight.
+void packWeights(const Vertex &v, CompactSkinnedVertex &o) {
+  f32 sum = 0;
+  for (int k = 0; k < 4; ++k) {
+    o.j[k] = (u8)(v.j[k] < 255 ? v.j[k] : 255);
+    sum += v.w[k] > 0 ? v.w[k] : 0;
+  }
+  if (!(sum > 0)) {
+    o.w[0] = 255, o.w[1] = o.w[2] = o.w[3] = 0;
+    return;
+  }
+  i32 total = 0, big = 0;
+  for (int k = 0; k < 4; ++k) {
+    f32 w = v.w[k] > 0 ? v.w[k] : 0;
+    o.w[k] = (u8)roundi(w / sum * 255.0f);
+    total += o.w[k];
+    if (v.w[k] > v.w[big])
+      big = k;
+  }
+  o.w[big] = (u8)(o.w[big] + (255 - total));
+}
+
+} // namespace
+
+void pack(const Vertex *vertices, usz count, VertexFormat format,
+          const Bounds &bounds, InlineArray<u8> &out) {
+  usz stride = vertexStride(format);
+  out.allocate(count * stride);
+  if (!vertices || count == 0)
+    return;
+  if (format == VertexFormat::Full) {
+    __builtin_memcpy(out.data(), vertices, count * stride);
+    return;
+  }
+  f32 c[3], extent;
+  quantBox(bounds, c, extent);
+  f32 inv = 1.0f / extent;
+  u8 *dst = out.data();
+  for (usz i = 0; i < count; ++i, dst += stride) {
+    if (format == VertexFormat::Compact) {
+      CompactVertex o;
+      packCommon(vertices[i], c, inv, o);
+      __builtin_memcpy(dst, &o, sizeof(o));
+    } else {
+      CompactSkinnedVertex o;
+      packCommon(vertices[i], c, inv, o);
+      packWeights(vertices[i], o);
+      __builtin_memcpy(dst, &o, sizeof(o));
+    }
+  }
+}
+
+Matrix4 decodeMatrix(const Bounds &bounds, VertexFormat format) {
+  Matrix4 m = Math::identity();
+  if (format == VertexFormat::Full)
+    return m;
+  f32 c[3], e;
+  quantBox(bounds, c, e);
+  m.m[0][0] = m.m[1][1] = m.m[2][2] = e;
+  m.m[3][0] = c[0], m.m[3][1] = c[1], m.m[3][2] = c[2];
+  return m;
+}
+
+} // namespace MeshOpt
+} // namespace Xi
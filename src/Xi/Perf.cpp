@@ -0,0 +1,241 @@
+#include "../../include/Xi/Perf.hpp"
+
+#include <atomic>
+#include <string.h>
+
+#if defined(__linux__) && !defined(ARDUINO) && !defined(__EMSCRIPTEN__)
+#define XI_PERF_LINUX
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#endif
+
+namespace Xi {
+
+namespace {
+
+i64 monotonicNs() {
+#if defined(__unix__) || defined(__APPLE__)
+  timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (i64)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#else
+  return 0;
+#endif
+}
+
+#ifdef XI_PERF_LINUX
+struct EventSpec {
+  u32 type;
+  u64 config;
+};
+
+u64 cacheEvent(u64 cache, u64 op, u64 result) {
+  return cache | (op << 8) | (result << 16);
+}
+
+EventSpec spec(PerfCounters::Event e) {
+  switch (e) {
+  case PerfCounters::Cycles:
+    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES};
+  case PerfCounters::Instructions:
+    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS};
+  case PerfCounters::BranchMisses:
+    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES};
+  case PerfCounters::L1dMisses:
+    return {PERF_TYPE_HW_CACHE,
+            cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ,
+                       PERF_COUNT_HW_CACHE_RESULT_MISS)};
+  case PerfCounters::LlcMisses:
+    return {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES};
+  case PerfCounters::DtlbMisses:
+    return {PERF_TYPE_HW_CACHE,
+            cacheEvent(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                       PERF_COUNT_HW_CACHE_RESULT_MISS)};
+  case PerfCounters::TaskClock:
+    return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK};
+  default:
+    return {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS};
+  }
+}
+
+int openEvent(PerfCounters::Event e) {
+  EventSpec s = spec(e);
+  perf_event_attr attr;
+  memset(&attr, 0, sizeof attr);
+  attr.size = sizeof attr;
+  attr.type = s.type;
+  attr.config = s.config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format =
+      PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  // pid 0, cpu -1: this thread on whichever CPU it runs.
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+} // namespace
+
+// ----------------------------------------------------------------------------
+// PerfCounters
+// ----------------------------------------------------------------------------
+
+PerfCounters::PerfCounters() {
+  for (int i = 0; i < EventCount; ++i)
+    fds[i] = -1;
+}
+
+PerfCounters::~PerfCounters() { close(); }
+
+bool PerfCounters::open() {
+  close();
+#ifdef XI_PERF_LINUX
+  for (int i = 0; i < EventCount; ++i) {
+    fds[i] = openEvent((Event)i);
+    if (fds[i] >= 0)
+      valid |= 1u << i;
+  }
+#endif
+  return valid != 0;
+}
+
+void PerfCounters::close() {
+#ifdef XI_PERF_LINUX
+  for (int i = 0; i < EventCount; ++i)
+    if (fds[i] >= 0)
+      ::close(fds[i]);
+#endif
+  for (int i = 0; i < EventCount; ++i)
+    fds[i] = -1;
+  valid = 0;
+}
+
+PerfCounters::Sample PerfCounters::read() const {
+  Sample s;
+#ifdef XI_PERF_LINUX
+  for (int i = 0; i < EventCount; ++i) {
+    if (fds[i] < 0)
+      continue;
+    u64 v[3]; // value, time enabled, time running
+    if (::read(fds[i], v, sizeof v) != (ssize_t)sizeof v || !v[2])
+      continue;
+    s.value[i] = v[2] < v[1] ? (u64)((f64)v[0] * v[1] / v[2]) : v[0];
+    s.valid |= 1u << i;
+  }
+#endif
+  return s;
+}
+
+const char *PerfCounters::name(Event e) {
+  switch (e) {
+  case Cycles:
+    return "cycles";
+  case Instructions:
+    return "instructions";
+  case BranchMisses:
+    return "branch-misses";
+  case L1dMisses:
+    return "l1d-misses";
+  case LlcMisses:
+    return "llc-misses";
+  case DtlbMisses:
+    return "dtlb-misses";
+  case TaskClock:
+    return "task-clock";
+  case PageFaults:
+    return "page-faults";
+  default:
+    return "";
+  }
+}
+
+// ----------------------------------------------------------------------------
+// PerfRegion
+// ----------------------------------------------------------------------------
+
+namespace {
+
+const usz MaxRegions = 64;
+
+PerfRegionStats regions[MaxRegions];
+usz regionCount = 0;
+std::atomic_flag regionLock = ATOMIC_FLAG_INIT;
+
+void lockRegions() {
+  while (regionLock.test_and_set(std::memory_order_acquire)) {
+  }
+}
+void unlockRegions() { regionLock.clear(std::memory_order_release); }
+
+// One counter set per thread, opened by the first marker the thread hits.
+PerfCounters &threadCounters() {
+  thread_local PerfCounters counters;
+  thread_local bool tried = false;
+  if (!tried) {
+    tried = true;
+    counters.open();
+  }
+  return counters;
+}
+
+usz findRegion(const char *name) {
+  lockRegions();
+  usz i = 0;
+  for (; i < regionCount; ++i)
+    if (regions[i].name == name || !strcmp(regions[i].name, name))
+      break;
+  if (i == regionCount && regionCount < MaxRegions) {
+    regions[i] = PerfRegionStats();
+    regions[i].name = name;
+    ++regionCount;
+  }
+  unlockRegions();
+  return i; // MaxRegions when the table is full
+}
+
+} // namespace
+
+PerfRegion::PerfRegion(const char *name) : slot(findRegion(name)) {
+  start = threadCounters().read();
+  startNs = monotonicNs();
+}
+
+PerfRegion::~PerfRegion() {
+  i64 endNs = monotonicNs();
+  PerfCounters::Sample d = threadCounters().read() - start;
+  if (slot >= MaxRegions)
+    return;
+  lockRegions();
+  PerfRegionStats &r = regions[slot];
+  if (!r.calls)
+    r.counts.valid = d.valid;
+  r.counts += d;
+  r.ns += (u64)(endNs - startNs);
+  ++r.calls;
+  unlockRegions();
+}
+
+usz PerfRegion::collect(PerfRegionStats *out, usz max) {
+  lockRegions();
+  usz n = regionCount;
+  for (usz i = 0; i < n && i < max; ++i)
+    out[i] = regions[i];
+  unlockRegions();
+  return n;
+}
+
+void PerfRegion::reset() {
+  lockRegions();
+  for (usz i = 0; i < regionCount; ++i) {
+    const char *name = regions[i].name;
+    regions[i] = PerfRegionStats();
+    regions[i].name = name;
+  }
+  unlockRegions();
+}
+
+} // namespace Xi
@@ -1,92 +1,494 @@
 #include "../../include/Xi/Random.hpp"
+#include "../../include/Xi/Math.hpp"
+#include <atomic>
 #include <fcntl.h>
 #include <string.h>
 #include <sys/time.h>
 #include <time.h>
 #include <unistd.h>
 
-#if __has_include(<sys/mman.h>) && defined(__linux__)
-#include <sys/mman.h>
+#if defined(__linux__) && __has_include(<sys/random.h>)
+#include <sys/random.h>
+#define XI_GETRANDOM
+#endif
+#if (defined(__linux__) || defined(__APPLE__)) && __has_include(<pthread.h>)
+#include <pthread.h>
+#define XI_ATFORK
+#endif
+#if defined(ESP_PLATFORM)
+#include <esp_random.h>
+#endif
+
+#if defined(__GNUC__) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define XI_RANDOM_VECTOR
+#if defined(__x86_64__) || defined(__i386__)
+#define XI_RANDOM_X86
+#endif
 #endif
 
 namespace Xi {
 
-alignas(64) u32 _randomPool[20] = {
-    123456789, 362436069, 521288629, 88675123, 0, 0, 0, 0, 0, 0,
-    0,         0,         0,         0,        0, 0, 0, 0, 0, 0};
-bool _randomInitialized = false;
-u32 _secureCounter = 0;
-
-u32 randomNext() {
-  u32 t = _randomPool[3];
-  u32 s = _randomPool[0];
-  _randomPool[3] = _randomPool[2];
-  _randomPool[2] = _randomPool[1];
-  _randomPool[1] = s;
-  t ^= t << 11;
-  t ^= t >> 8;
-  _randomPool[0] = t ^ s ^ (s >> 19);
-  return _randomPool[0];
-}
-
-void randomSeed(u32 s) {
-  for (int i = 0; i < 20; i++) {
-    s = 1812433253U * (s ^ (s >> 30)) + i;
-    _randomPool[i] = s;
+namespace {
+
+// Stores that the optimizer may not drop.
+void wipe(void *p, usz n) {
+  volatile u8 *b = (volatile u8 *)p;
+  while (n--)
+    *b++ = 0;
+}
+
+u64 splitmix(u64 &x) {
+  u64 z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+bool sameName(const char *a, const char *b) {
+  while (*a && *a == *b)
+    a++, b++;
+  return *a == *b;
+}
+
+} // namespace
+
+// -------------------------------------------------------------------------
+// Lane kernels
+//
+// Written once over a lane type V: plain u32 / u64 gives the scalar
+// code, GCC vectors give SSE2/NEON, and x86 adds an AVX2 clone picked at
+// runtime (the same scheme as Raster). Only generic vector operators are
+// used, so every variant inlines into its target-specific caller.
+// -------------------------------------------------------------------------
+
+namespace {
+
+#define XI_RINLINE inline __attribute__((always_inline))
+
+#ifdef XI_RANDOM_VECTOR
+// Vector values only cross always_inline boundaries, so the AVX-vs-SSE
+// argument passing difference GCC warns about never applies.
+#pragma GCC diagnostic ignored "-Wpsabi"
+typedef u32 C4 __attribute__((vector_size(16)));
+typedef u32 C8 __attribute__((vector_size(32)));
+typedef u64 X4 __attribute__((vector_size(32)));
+typedef u64 X8 __attribute__((vector_size(64)));
+#else
+#undef XI_RINLINE
+#define XI_RINLINE inline
+#endif
+
+template <typename V, typename T> XI_RINLINE V load(const T *p) {
+  V v;
+  memcpy(&v, p, sizeof(V));
+  return v;
+}
+template <typename V, typename T> XI_RINLINE void store(T *p, V v) {
+  memcpy(p, &v, sizeof(V));
+}
+
+// --- ChaCha20 (RFC 8439 block function, zero nonce) ---
+
+template <typename V> XI_RINLINE V rotl32(V x, int k) {
+  return (x << k) | (x >> (32 - k));
+}
+
+#define XI_QR(a, b, c, d)                                                     \
+  a += b, d ^= a, d = rotl32(d, 16), c += d, b ^= c, b = rotl32(b, 12),       \
+  a += b, d ^= a, d = rotl32(d, 8), c += d, b ^= c, b = rotl32(b, 7)
+
+/// W consecutive blocks from `counter`, one per lane, into out[W * 64].
+template <typename V>
+XI_RINLINE void chachaBlocks(const u32 key[8], u32 counter, u8 *out) {
+  const usz W = sizeof(V) / 4;
+  u32 lane[W];
+  for (usz j = 0; j < W; ++j)
+    lane[j] = counter + (u32)j;
+  V in[16];
+  in[0] = V{} + 0x61707865u, in[1] = V{} + 0x3320646eu;
+  in[2] = V{} + 0x79622d32u, in[3] = V{} + 0x6b206574u;
+  for (int k = 0; k < 8; ++k)
+    in[4 + k] = V{} + key[k];
+  in[12] = load<V>(lane);
+  in[13] = in[14] = in[15] = V{};
+  V x[16];
+  for (int k = 0; k < 16; ++k)
+    x[k] = in[k];
+  for (int r = 0; r < 10; ++r) {
+    XI_QR(x[0], x[4], x[8], x[12]);
+    XI_QR(x[1], x[5], x[9], x[13]);
+    XI_QR(x[2], x[6], x[10], x[14]);
+    XI_QR(x[3], x[7], x[11], x[15]);
+    XI_QR(x[0], x[5], x[10], x[15]);
+    XI_QR(x[1], x[6], x[11], x[12]);
+    XI_QR(x[2], x[7], x[8], x[13]);
+    XI_QR(x[3], x[4], x[9], x[14]);
   }
-  for (int i = 0; i < 10; i++)
-    randomNext();
-  _randomInitialized = true;
+  // Words come out lane-major; blocks are word-major (little-endian).
+  u32 words[16][W];
+  for (int k = 0; k < 16; ++k)
+    store(words[k], x[k] + in[k]);
+  for (usz j = 0; j < W; ++j)
+    for (int k = 0; k < 16; ++k)
+      memcpy(out + j * 64 + k * 4, &words[k][j], 4);
 }
 
-void randomSeed() {
-#if defined(__linux__) || defined(__APPLE__)
-  int fd = open("/dev/urandom", O_RDONLY);
-  if (fd >= 0) {
-    read(fd, _randomPool, sizeof(_randomPool));
-    close(fd);
-    _randomInitialized = true;
+#undef XI_QR
+
+struct Keystream {
+  const u32 *key;
+  u32 counter;
+  u8 *out;
+  usz size;
+};
+
+template <typename V> XI_RINLINE void chachaLoop(const Keystream &k) {
+  const usz Bytes = sizeof(V) / 4 * 64;
+  u32 counter = k.counter;
+  usz at = 0;
+  for (; at + Bytes <= k.size; at += Bytes, counter += Bytes / 64)
+    chachaBlocks<V>(k.key, counter, k.out + at);
+  if (at < k.size) {
+    u8 tail[Bytes];
+    chachaBlocks<V>(k.key, counter, tail);
+    memcpy(k.out + at, tail, k.size - at);
+    wipe(tail, Bytes);
   }
-#elif defined(ESP_PLATFORM)
-  for (int i = 0; i < 20; i++)
-    _randomPool[i] = esp_random();
+}
+
+// --- xoshiro256** lanes ---
+
+template <typename V> XI_RINLINE V rotl64(V x, int k) {
+  return (x << k) | (x >> (64 - k));
+}
+
+struct LaneFill {
+  u64 (*lanes)[8];
+  u8 *out;
+  usz size;
+};
+
+template <typename V> XI_RINLINE void xoshiroLoop(const LaneFill &f) {
+  const usz W = sizeof(V) / 8, Bytes = sizeof(V);
+  for (usz base = 0; base < 8; base += W) {
+    // Each lane group owns a share of the output, Bytes at a time.
+    V s0 = load<V>(f.lanes[0] + base), s1 = load<V>(f.lanes[1] + base);
+    V s2 = load<V>(f.lanes[2] + base), s3 = load<V>(f.lanes[3] + base);
+    for (usz at = base * 8; at < f.size; at += 64) {
+      V m = (s1 << 2) + s1; // * 5
+      m = rotl64(m, 7);
+      V r = (m << 3) + m; // * 9
+      V t = s1 << 17;
+      s2 ^= s0, s3 ^= s1, s1 ^= s2, s0 ^= s3;
+      s2 ^= t, s3 = rotl64(s3, 45);
+      if (at + Bytes <= f.size) {
+        store(f.out + at, r);
+      } else {
+        u8 tail[Bytes];
+        store(tail, r);
+        memcpy(f.out + at, tail, f.size - at);
+      }
+    }
+    store(f.lanes[0] + base, s0), store(f.lanes[1] + base, s1);
+    store(f.lanes[2] + base, s2), store(f.lanes[3] + base, s3);
+  }
+}
+
+typedef void (*ChachaKernel)(const Keystream &k);
+typedef void (*LaneKernel)(const LaneFill &f);
+
+#if defined(XI_RANDOM_X86)
+__attribute__((target("avx2"))) void chachaAvx2(const Keystream &k) {
+  chachaLoop<C8>(k);
+}
+__attribute__((target("avx2"))) void xoshiroAvx2(const LaneFill &f) {
+  xoshiroLoop<X8>(f);
+}
+#endif
+#ifdef XI_RANDOM_VECTOR
+void chachaBase(const Keystream &k) { chachaLoop<C4>(k); }
+void xoshiroBase(const LaneFill &f) { xoshiroLoop<X4>(f); }
 #else
-  randomSeed(987654321);
+void chachaBase(const Keystream &k) { chachaLoop<u32>(k); }
+void xoshiroBase(const LaneFill &f) { xoshiroLoop<u64>(f); }
 #endif
 
-#if defined(__linux__) && __has_include(<sys/mman.h>)
-  madvise(_randomPool, sizeof(_randomPool), MADV_WIPEONFORK);
+struct Kernels {
+  ChachaKernel chacha = chachaBase;
+  LaneKernel xoshiro = xoshiroBase;
+
+  Kernels() {
+#if defined(XI_RANDOM_X86)
+    const char *isa = Math::Simd::isa();
+    if (sameName(isa, "avx2") || sameName(isa, "avx512")) {
+      chacha = chachaAvx2;
+      xoshiro = xoshiroAvx2;
+    }
 #endif
+  }
+};
+
+const Kernels &kernels() {
+  static Kernels k;
+  return k;
 }
 
-u32 random(u32 max) {
-  if (max == 0)
-    return 0;
-  return randomNext() % max;
+void keystream(const u8 key[32], u32 counter, u8 *out, usz size) {
+  u32 words[8];
+  memcpy(words, key, 32);
+  kernels().chacha({words, counter, out, size});
+  wipe(words, sizeof(words));
 }
 
+// --- Process-wide state ---
+
+std::atomic<u32> forks(1);
+
+#ifdef XI_ATFORK
+void onFork() { forks.fetch_add(1, std::memory_order_relaxed); }
+#endif
+
+u32 forkGeneration() {
+#ifdef XI_ATFORK
+  static int registered = pthread_atfork(nullptr, nullptr, onFork);
+  (void)registered;
+#endif
+  return forks.load(std::memory_order_relaxed);
+}
+
+// Hands each new thread the next longJump()-separated stream of the
+// process seed, which comes from OS entropy unless randomSeed() set it.
+struct Spawner {
+  std::atomic_flag lock = ATOMIC_FLAG_INIT;
+  RandomStream next;
+
+  Spawner() { next.seedFromEntropy(); }
+
+  RandomStream take() {
+    while (lock.test_and_set(std::memory_order_acquire))
+      ;
+    RandomStream s = next;
+    next.longJump();
+    lock.clear(std::memory_order_release);
+    return s;
+  }
+
+  // Makes `seed` the process seed; the caller gets it as its own stream.
+  RandomStream restart(const RandomStream &seed) {
+    while (lock.test_and_set(std::memory_order_acquire))
+      ;
+    next = seed;
+    lock.clear(std::memory_order_release);
+    return take();
+  }
+};
+
+Spawner &spawner() {
+  static Spawner s;
+  return s;
+}
+
+} // namespace
+
+// -------------------------------------------------------------------------
+// Entropy
+// -------------------------------------------------------------------------
+
+void entropyFill(u8 *buffer, usz size) {
+  usz got = 0;
+#if defined(XI_GETRANDOM)
+  while (got < size) {
+    ssize_t n = getrandom(buffer + got, size - got, 0);
+    if (n <= 0)
+      break;
+    got += (usz)n;
+  }
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+  if (got < size) {
+    int fd = open("/dev/urandom", O_RDONLY);
+    if (fd >= 0) {
+      while (got < size) {
+        ssize_t n = read(fd, buffer + got, size - got);
+        if (n <= 0)
+          break;
+        got += (usz)n;
+      }
+      close(fd);
+    }
+  }
+#elif defined(ESP_PLATFORM)
+  esp_fill_random(buffer + got, size - got);
+  got = size;
+#endif
+  if (got < size) {
+    // No entropy source: clock-seeded, so at least not constant.
+    RandomStream s((u64)micros() ^ ((u64)time(nullptr) << 32));
+    s.fill(buffer + got, size - got);
+  }
+}
+
+// -------------------------------------------------------------------------
+// RandomStream
+// -------------------------------------------------------------------------
+
+void RandomStream::seed(u64 s) {
+  for (u64 &w : _s)
+    w = splitmix(s);
+  _split = false;
+}
+
+void RandomStream::seedFromEntropy() {
+  entropyFill((u8 *)_s, sizeof(_s));
+  if (!(_s[0] | _s[1] | _s[2] | _s[3]))
+    _s[0] = 1; // the one state xoshiro cannot leave
+  _split = false;
+}
+
+void RandomStream::_jump(const u64 poly[4]) {
+  u64 t[4] = {0, 0, 0, 0};
+  for (int i = 0; i < 4; ++i)
+    for (int b = 0; b < 64; ++b) {
+      if (poly[i] & (1ULL << b))
+        for (int k = 0; k < 4; ++k)
+          t[k] ^= _s[k];
+      next64();
+    }
+  for (int k = 0; k < 4; ++k)
+    _s[k] = t[k];
+}
+
+void RandomStream::jump() {
+  static const u64 Poly[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                              0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+  _jump(Poly);
+}
+
+void RandomStream::longJump() {
+  static const u64 Poly[4] = {0x76e15d3efefdcbbfULL, 0xc5004e441c522fb3ULL,
+                              0x77710069854ee241ULL, 0x39109bb02acbe635ULL};
+  _jump(Poly);
+}
+
+void RandomStream::fill(u8 *buffer, usz size) {
+  if (size < 256) {
+    usz i = 0;
+    for (; i + 8 <= size; i += 8) {
+      u64 r = next64();
+      memcpy(buffer + i, &r, 8);
+    }
+    if (i < size) {
+      u64 r = next64();
+      memcpy(buffer + i, &r, size - i);
+    }
+    return;
+  }
+  if (!_split) {
+    for (int lane = 0; lane < 8; ++lane) {
+      jump();
+      for (int k = 0; k < 4; ++k)
+        _lanes[k][lane] = _s[k];
+    }
+    _split = true;
+  }
+  kernels().xoshiro({_lanes, buffer, size});
+}
+
+// -------------------------------------------------------------------------
+// SecureRandom
+// -------------------------------------------------------------------------
+
+SecureRandom::~SecureRandom() {
+  wipe(_key, sizeof(_key));
+  wipe(_buffer, sizeof(_buffer));
+}
+
+void SecureRandom::reseed() {
+  entropyFill(_key, sizeof(_key));
+  wipe(_buffer, sizeof(_buffer));
+  _available = 0;
+  _sinceSeed = 0;
+  _generation = forkGeneration();
+}
+
+void SecureRandom::_refill() {
+  u8 block[32 + Buffer];
+  keystream(_key, 0, block, sizeof(block));
+  memcpy(_key, block, 32);
+  memcpy(_buffer, block + 32, Buffer);
+  wipe(block, sizeof(block));
+  _available = Buffer;
+}
+
+void SecureRandom::fill(u8 *buffer, usz size) {
+  if (_generation != forkGeneration() || _sinceSeed >= Reseed)
+    reseed();
+  _sinceSeed += size;
+
+  if (size > Buffer) {
+    // Straight to the caller: block 0 rekeys, blocks 1.. are output.
+    while (size) {
+      usz n = size < Chunk ? size : Chunk;
+      u8 next[64];
+      keystream(_key, 0, next, 64);
+      keystream(_key, 1, buffer, n);
+      memcpy(_key, next, 32);
+      wipe(next, sizeof(next));
+      buffer += n, size -= n;
+    }
+    return;
+  }
+  while (size) {
+    if (!_available)
+      _refill();
+    usz n = size < _available ? size : _available;
+    u8 *src = _buffer + (Buffer - _available);
+    memcpy(buffer, src, n);
+    wipe(src, n);
+    _available -= n;
+    buffer += n, size -= n;
+  }
+}
+
+// -------------------------------------------------------------------------
+// Calling thread's generators
+// -------------------------------------------------------------------------
+
+RandomStream &threadRandom() {
+  static thread_local RandomStream stream(spawner().take());
+  return stream;
+}
+
+SecureRandom &threadSecureRandom() {
+  static thread_local SecureRandom secure;
+  return secure;
+}
+
+u32 randomNext() { return threadRandom().next(); }
+
+void randomSeed(u32 s) { threadRandom() = spawner().restart(RandomStream(s)); }
+
+void randomSeed() {
+  RandomStream s;
+  s.seedFromEntropy();
+  threadRandom() = spawner().restart(s);
+}
+
+// Lemire's multiply-shift: no division, bias below 2^-32 * max.
+u32 random(u32 max) { return (u32)(((u64)randomNext() * max) >> 32); }
+
 i32 random(i32 min, i32 max) {
   if (min >= max)
     return min;
-  return min + (i32)(randomNext() % (u32)(max - min));
+  return (i32)((u32)min + random((u32)max - (u32)min));
 }
 
 f32 randomFloat() { return (f32)randomNext() / 4294967295.0f; }
 
-void randomFill(u8 *buffer, usz size) {
-  usz i = 0;
-  while (i + 4 <= size) {
-    u32 r = randomNext();
-    memcpy(buffer + i, &r, 4);
-    i += 4;
-  }
-  if (i < size) {
-    u32 r = randomNext();
-    while (i < size) {
-      buffer[i++] = (u8)(r & 0xFF);
-      r >>= 8;
-    }
-  }
+void randomFill(u8 *buffer, usz size) { threadRandom().fill(buffer, size); }
+
+void secureRandomFill(u8 *buffer, usz size) {
+  threadSecureRandom().fill(buffer, size);
 }
 
 } // namespace Xi
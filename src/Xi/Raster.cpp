@@ -0,0 +1,802 @@
+#include <Xi/Raster.hpp>
+#include <Xi/String.hpp>
+#include <Xi/Worker.hpp>
+
+#include <atomic>
+
+// -------------------------------------------------------------------------
+// Software rasterizer
+//
+// flush() runs in batches of triangles so memory stays bounded:
+//   1. vertices to clip space, with per-vertex lighting (once per frame),
+//   2. triangle setup: reject, clip to the near plane, project, and turn
+//      into edge functions and attribute planes,
+//   3. binning into 64x64 tiles,
+//   4. per tile, on a worker: copy the tile's color and depth into a local
+//      buffer, walk its triangles in order 8 pixels at a time, copy back.
+// Edge functions and planes are evaluated in float relative to each
+// triangle's bounding box corner, so large screens keep their precision.
+// -------------------------------------------------------------------------
+
+#if defined(__GNUC__) && !defined(ARDUINO) && !defined(ESP_PLATFORM)
+#define XI_RASTER_VECTOR
+#if defined(__x86_64__) || defined(__i386__)
+#define XI_RASTER_X86
+#endif
+#endif
+
+#define XI_RINLINE inline __attribute__((always_inline))
+
+namespace Xi {
+
+/// A triangle ready to rasterize. Edge i is E = A x + B y + C with x, y
+/// relative to (ox, oy), inside where E > 0 (or E == 0 on inclusive edges,
+/// so shared edges belong to exactly one triangle). Planes give z, 1/w,
+/// u/w, v/w and light/w the same way.
+struct RasterTri {
+  f32 edge[3][3];
+  f32 plane[5][3];
+  f32 ox, oy;
+  i32 x0, y0, x1, y1; // pixel box, end exclusive; x0 >= x1 when unused
+  u32 draw;
+  u8 inclusive[3];
+  u8 clip; // needs near-plane clipping after the parallel pass
+};
+
+namespace {
+
+enum { PZ = 0, PIW, PUW, PVW, PLW };
+
+const usz BatchTriangles = 1 << 16;
+
+struct Surface {
+  u8 *pixels;
+  usz size;
+  i32 width, height, channels;
+  f32 *depth;
+};
+
+inline Surface *surf(void *h) { return (Surface *)h; }
+
+inline f32 minf(f32 a, f32 b) { return a < b ? a : b; }
+inline f32 maxf(f32 a, f32 b) { return a > b ? a : b; }
+
+// Clip-space vertex: x y z w u v light (8th float is padding).
+struct ClipVertex {
+  f32 a[7];
+};
+
+ClipVertex lerp(const ClipVertex &p, const ClipVertex &q, f32 t) {
+  ClipVertex r;
+  for (int k = 0; k < 7; ++k)
+    r.a[k] = p.a[k] + (q.a[k] - p.a[k]) * t;
+  return r;
+}
+
+// Outside bits for the six clip planes.
+u32 outcode(const ClipVertex &v) {
+  f32 x = v.a[0], y = v.a[1], z = v.a[2], w = v.a[3];
+  return (x < -w ? 1u : 0u) | (x > w ? 2u : 0u) | (y < -w ? 4u : 0u) |
+         (y > w ? 8u : 0u) | (z < 0 ? 16u : 0u) | (z > w ? 32u : 0u);
+}
+
+// Projects and sets up one triangle. Returns false (and marks the slot
+// unused) if it covers no pixel centers' box, has no area or is culled.
+bool setup(const ClipVertex *v0, const ClipVertex *v1, const ClipVertex *v2,
+           i32 width, i32 height, u32 draw, bool cullBack, RasterTri &t) {
+  t.x0 = t.x1 = 0;
+  t.clip = 0;
+  t.draw = draw;
+  const ClipVertex *v[3] = {v0, v1, v2};
+  f32 sx[3], sy[3], iw[3];
+  for (int i = 0; i < 3; ++i) {
+    iw[i] = 1.0f / v[i]->a[3];
+    sx[i] = (v[i]->a[0] * iw[i] * 0.5f + 0.5f) * (f32)width;
+    sy[i] = (0.5f - v[i]->a[1] * iw[i] * 0.5f) * (f32)height;
+  }
+  // Pixel centers sit at +0.5; the box holds the centers the triangle can
+  // cover, so most sub-pixel triangles end here.
+  f32 lx = minf(sx[0], minf(sx[1], sx[2])), hx = maxf(sx[0], maxf(sx[1], sx[2]));
+  f32 ly = minf(sy[0], minf(sy[1], sy[2])), hy = maxf(sy[0], maxf(sy[1], sy[2]));
+  if (!(lx < (f32)width && hx > 0 && ly < (f32)height && hy > 0))
+    return false;
+  i32 x0 = (i32)Math::ceil(maxf(0, lx - 0.5f));
+  i32 x1 = (i32)minf((f32)width, Math::floor(hx - 0.5f) + 1.0f);
+  i32 y0 = (i32)Math::ceil(maxf(0, ly - 0.5f));
+  i32 y1 = (i32)minf((f32)height, Math::floor(hy - 0.5f) + 1.0f);
+  if (x0 >= x1 || y0 >= y1)
+    return false;
+  f32 at[5][3];
+  for (int i = 0; i < 3; ++i) {
+    at[PZ][i] = v[i]->a[2] * iw[i];
+    at[PIW][i] = iw[i];
+    at[PUW][i] = v[i]->a[4] * iw[i];
+    at[PVW][i] = v[i]->a[5] * iw[i];
+    at[PLW][i] = v[i]->a[6] * iw[i];
+  }
+  t.ox = (f32)x0;
+  t.oy = (f32)y0;
+  f32 px[3], py[3];
+  for (int i = 0; i < 3; ++i) {
+    px[i] = sx[i] - t.ox;
+    py[i] = sy[i] - t.oy;
+  }
+  f32 area = (px[1] - px[0]) * (py[2] - py[0]) - (py[1] - py[0]) * (px[2] - px[0]);
+  // y points down, so positive area is clockwise: front facing in D3D.
+  if (!(area > 0 || (area < 0 && !cullBack)))
+    return false;
+  f32 s = area > 0 ? 1.0f : -1.0f;
+  area *= s;
+  for (int i = 0; i < 3; ++i) {
+    int a = (i + 1) % 3, b = (i + 2) % 3;
+    f32 A = (py[a] - py[b]) * s, B = (px[b] - px[a]) * s;
+    t.edge[i][0] = A;
+    t.edge[i][1] = B;
+    t.edge[i][2] = -(A * px[a] + B * py[a]);
+    t.inclusive[i] = A > 0 || (A == 0 && B > 0);
+  }
+  f32 inv = 1.0f / area;
+  for (int p = 0; p < 5; ++p)
+    for (int k = 0; k < 3; ++k)
+      t.plane[p][k] = (at[p][0] * t.edge[0][k] + at[p][1] * t.edge[1][k] +
+                       at[p][2] * t.edge[2][k]) *
+                      inv;
+  t.x0 = x0;
+  t.x1 = x1;
+  t.y0 = y0;
+  t.y1 = y1;
+  return true;
+}
+
+// Clips against z >= 0 and sets up the one or two resulting triangles.
+usz clipNear(const ClipVertex *const *in, i32 width, i32 height, u32 draw,
+             bool cullBack, RasterTri *out) {
+  ClipVertex poly[4];
+  usz n = 0;
+  for (int i = 0; i < 3; ++i) {
+    const ClipVertex &p = *in[i], &q = *in[(i + 1) % 3];
+    bool pin = p.a[2] >= 0, qin = q.a[2] >= 0;
+    if (pin)
+      poly[n++] = p;
+    if (pin != qin)
+      poly[n++] = lerp(p, q, p.a[2] / (p.a[2] - q.a[2]));
+  }
+  usz count = 0;
+  for (usz k = 2; k < n; ++k)
+    if (setup(&poly[0], &poly[k - 1], &poly[k], width, height, draw,
+              cullBack, out[count]))
+      count++;
+  return count;
+}
+
+// Bilinear, clamped to the edge, into 0..255 floats.
+void sample(const RasterTexture &tex, f32 u, f32 v, bool bilinear, f32 *rgba) {
+  i32 w = tex.width, h = tex.height;
+  f32 fx = u * (f32)w - 0.5f, fy = v * (f32)h - 0.5f;
+  if (!(fx == fx))
+    fx = 0;
+  if (!(fy == fy))
+    fy = 0;
+  fx = minf(maxf(fx, -1.0f), (f32)w);
+  fy = minf(maxf(fy, -1.0f), (f32)h);
+  if (!bilinear) {
+    i32 x = (i32)(fx + 0.5f), y = (i32)(fy + 0.5f);
+    x = x < 0 ? 0 : (x >= w ? w - 1 : x);
+    y = y < 0 ? 0 : (y >= h ? h - 1 : y);
+    const u8 *p = tex.rgba + ((usz)y * (usz)w + (usz)x) * 4;
+    for (int c = 0; c < 4; ++c)
+      rgba[c] = p[c];
+    return;
+  }
+  i32 ix = (i32)(fx + 1.0f) - 1, iy = (i32)(fy + 1.0f) - 1; // floor
+  f32 ax = fx - (f32)ix, ay = fy - (f32)iy;
+  i32 xa = ix < 0 ? 0 : ix, xb = ix + 1 >= w ? w - 1 : ix + 1;
+  i32 ya = iy < 0 ? 0 : iy, yb = iy + 1 >= h ? h - 1 : iy + 1;
+  xa = xa >= w ? w - 1 : xa;
+  ya = ya >= h ? h - 1 : ya;
+  xb = xb < 0 ? 0 : xb;
+  yb = yb < 0 ? 0 : yb;
+  const u8 *r0 = tex.rgba + (usz)ya * (usz)w * 4,
+           *r1 = tex.rgba + (usz)yb * (usz)w * 4;
+  for (int c = 0; c < 4; ++c) {
+    f32 top = r0[xa * 4 + c] + (r0[xb * 4 + c] - r0[xa * 4 + c]) * ax;
+    f32 bot = r1[xa * 4 + c] + (r1[xb * 4 + c] - r1[xa * 4 + c]) * ax;
+    rgba[c] = top + (bot - top) * ay;
+  }
+}
+
+// One tile's work. Color and depth are TileSize x TileSize, row stride
+// TileSize, origin (x0, y0).
+struct TileJob {
+  const RasterTri *tris;
+  const u32 *list;
+  usz count;
+  i32 x0, y0, x1, y1;
+  u32 *color;
+  f32 *depth;
+  const RasterTexture *textures; // per draw
+  bool bilinear;
+};
+
+const i32 TS = SoftwareRenderingDevice::TileSize;
+
+#ifdef XI_RASTER_VECTOR
+
+// 8-lane values only cross always_inline boundaries, so the AVX-vs-SSE
+// argument passing difference GCC warns about never applies.
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+typedef f32 V8 __attribute__((vector_size(32)));
+typedef i32 I8 __attribute__((vector_size(32)));
+typedef u32 U8 __attribute__((vector_size(32)));
+
+XI_RINLINE V8 loadV(const f32 *p) {
+  V8 v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+XI_RINLINE U8 loadU(const u32 *p) {
+  U8 v;
+  __builtin_memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+XI_RINLINE bool any(I8 m) {
+  u64 q[4];
+  __builtin_memcpy(q, &m, sizeof(q));
+  return (q[0] | q[1] | q[2] | q[3]) != 0;
+}
+
+XI_RINLINE I8 inside(V8 e, bool inclusive) {
+  return inclusive ? (I8)(e >= 0) : (I8)(e > 0);
+}
+
+XI_RINLINE usz tileLoop(const TileJob &j) {
+  const V8 lane = {0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f};
+  const I8 laneI = {0, 1, 2, 3, 4, 5, 6, 7};
+  usz frags = 0;
+  for (usz n = 0; n < j.count; ++n) {
+    const RasterTri &t = j.tris[j.list[n]];
+    i32 x0 = t.x0 > j.x0 ? t.x0 : j.x0, x1 = t.x1 < j.x1 ? t.x1 : j.x1;
+    i32 y0 = t.y0 > j.y0 ? t.y0 : j.y0, y1 = t.y1 < j.y1 ? t.y1 : j.y1;
+    if (x0 >= x1 || y0 >= y1)
+      continue;
+    const RasterTexture &tex = j.textures[t.draw];
+    bool textured = tex.rgba && tex.width > 0 && tex.height > 0;
+    i32 bx0 = j.x0 + ((x0 - j.x0) & ~7);
+    const f32(*e)[3] = t.edge;
+    const f32(*p)[3] = t.plane;
+    for (i32 y = y0; y < y1; ++y) {
+      f32 fy = (f32)y + 0.5f - t.oy;
+      f32 c0 = e[0][1] * fy + e[0][2], c1 = e[1][1] * fy + e[1][2],
+          c2 = e[2][1] * fy + e[2][2];
+      f32 cz = p[PZ][1] * fy + p[PZ][2];
+      for (i32 x = bx0; x < x1; x += 8) {
+        V8 fx = lane + ((f32)x - t.ox);
+        I8 xi = laneI + x;
+        I8 m = inside(e[0][0] * fx + c0, t.inclusive[0]) &
+               inside(e[1][0] * fx + c1, t.inclusive[1]) &
+               inside(e[2][0] * fx + c2, t.inclusive[2]) & (xi >= x0) &
+               (xi < x1);
+        if (!any(m))
+          continue;
+        usz at = (usz)(y - j.y0) * TS + (usz)(x - j.x0);
+        V8 z = p[PZ][0] * fx + cz;
+        V8 d = loadV(j.depth + at);
+        m &= (I8)(z < d);
+        if (!any(m))
+          continue;
+        I8 zi = ((I8)z & m) | ((I8)d & ~m);
+        __builtin_memcpy(j.depth + at, &zi, sizeof(zi));
+
+        V8 iw = p[PIW][0] * fx + (p[PIW][1] * fy + p[PIW][2]);
+        V8 w = 1.0f / iw;
+        V8 light = (p[PLW][0] * fx + (p[PLW][1] * fy + p[PLW][2])) * w;
+        V8 r, g, b, a;
+        if (textured) {
+          V8 u = (p[PUW][0] * fx + (p[PUW][1] * fy + p[PUW][2])) * w;
+          V8 v = (p[PVW][0] * fx + (p[PVW][1] * fy + p[PVW][2])) * w;
+          f32 rs[8], gs[8], bs[8], as[8];
+          for (int l = 0; l < 8; ++l) {
+            f32 px[4] = {0, 0, 0, 0};
+            if (m[l])
+              sample(tex, u[l], v[l], j.bilinear, px);
+            rs[l] = px[0], gs[l] = px[1], bs[l] = px[2], as[l] = px[3];
+          }
+          r = loadV(rs), g = loadV(gs), b = loadV(bs), a = loadV(as);
+        } else {
+          r = g = b = a = V8{} + 255.0f;
+        }
+        V8 lo = V8{}, hi = V8{} + 255.0f;
+        r *= light, g *= light, b *= light;
+        r = r < lo ? lo : (r > hi ? hi : r);
+        g = g < lo ? lo : (g > hi ? hi : g);
+        b = b < lo ? lo : (b > hi ? hi : b);
+        U8 px = __builtin_convertvector(r, U8) |
+                __builtin_convertvector(g, U8) << 8 |
+                __builtin_convertvector(b, U8) << 16 |
+                __builtin_convertvector(a, U8) << 24;
+        U8 old = loadU(j.color + at);
+        px = (px & (U8)m) | (old & ~(U8)m);
+        __builtin_memcpy(j.color + at, &px, sizeof(px));
+        for (int l = 0; l < 8; ++l)
+          frags += m[l] ? 1 : 0;
+      }
+    }
+  }
+  return frags;
+}
+
+#else
+
+inline u32 pack(f32 r, f32 g, f32 b, f32 a) {
+  u32 ri = (u32)minf(maxf(r, 0), 255.0f), gi = (u32)minf(maxf(g, 0), 255.0f),
+      bi = (u32)minf(maxf(b, 0), 255.0f), ai = (u32)minf(maxf(a, 0), 255.0f);
+  return ri | gi << 8 | bi << 16 | ai << 24;
+}
+
+usz tileLoop(const TileJob &j) {
+  usz frags = 0;
+  for (usz n = 0; n < j.count; ++n) {
+    const RasterTri &t = j.tris[j.list[n]];
+    i32 x0 = t.x0 > j.x0 ? t.x0 : j.x0, x1 = t.x1 < j.x1 ? t.x1 : j.x1;
+    i32 y0 = t.y0 > j.y0 ? t.y0 : j.y0, y1 = t.y1 < j.y1 ? t.y1 : j.y1;
+    const RasterTexture &tex = j.textures[t.draw];
+    bool textured = tex.rgba && tex.width > 0 && tex.height > 0;
+    for (i32 y = y0; y < y1; ++y)
+      for (i32 x = x0; x < x1; ++x) {
+        f32 fx = (f32)x + 0.5f - t.ox, fy = (f32)y + 0.5f - t.oy;
+        bool in = true;
+        for (int k = 0; k < 3; ++k) {
+          f32 e = t.edge[k][0] * fx + t.edge[k][1] * fy + t.edge[k][2];
+          in = in && (t.inclusive[k] ? e >= 0 : e > 0);
+        }
+        if (!in)
+          continue;
+        const f32(*p)[3] = t.plane;
+        usz at = (usz)(y - j.y0) * TS + (usz)(x - j.x0);
+        f32 z = p[PZ][0] * fx + p[PZ][1] * fy + p[PZ][2];
+        if (!(z < j.depth[at]))
+          continue;
+        j.depth[at] = z;
+        f32 w = 1.0f / (p[PIW][0] * fx + p[PIW][1] * fy + p[PIW][2]);
+        f32 light = (p[PLW][0] * fx + p[PLW][1] * fy + p[PLW][2]) * w;
+        f32 c[4] = {255.0f, 255.0f, 255.0f, 255.0f};
+        if (textured)
+          sample(tex, (p[PUW][0] * fx + p[PUW][1] * fy + p[PUW][2]) * w,
+                 (p[PVW][0] * fx + p[PVW][1] * fy + p[PVW][2]) * w, j.bilinear,
+                 c);
+        j.color[at] = pack(c[0] * light, c[1] * light, c[2] * light, c[3]);
+        frags++;
+      }
+  }
+  return frags;
+}
+
+#endif
+
+typedef usz (*TileKernel)(const TileJob &j);
+
+#if defined(XI_RASTER_X86)
+__attribute__((target("avx2,fma"))) usz tileAvx2(const TileJob &j) {
+  return tileLoop(j);
+}
+#endif
+usz tileBase(const TileJob &j) { return tileLoop(j); }
+
+bool sameName(const char *a, const char *b) {
+  while (*a && *a == *b)
+    a++, b++;
+  return *a == *b;
+}
+
+// 8-wide rows fill a 256-bit register; AVX-512 runs the AVX2 kernel.
+TileKernel tileKernel() {
+#if defined(XI_RASTER_X86)
+  const char *isa = Math::Simd::isa();
+  if (sameName(isa, "avx512") || sameName(isa, "avx2"))
+    return tileAvx2;
+#endif
+  return tileBase;
+}
+
+// Runs body(i) for i in [0, count) on the pool's threads and the caller,
+// handing out indices one at a time (tiles vary a lot in cost).
+template <typename F> void dynamicFor(WorkerPool *pool, usz count, F body) {
+  if (!pool || pool->size() == 0 || count < 2) {
+    for (usz i = 0; i < count; ++i)
+      body(i);
+    return;
+  }
+  std::atomic<usz> next(0);
+  usz parts = pool->size() + 1;
+  pool->parallelFor(
+      parts,
+      [&](usz, usz) {
+        for (usz i; (i = next.fetch_add(1, std::memory_order_relaxed)) < count;)
+          body(i);
+      },
+      1);
+}
+
+// Splits [0, count) into ranges of at least grain on the pool.
+template <typename F>
+void rangeFor(WorkerPool *pool, usz count, usz grain, F body) {
+  if (!pool || pool->size() == 0 || count <= grain) {
+    body((usz)0, count);
+    return;
+  }
+  pool->parallelFor(
+      count, [&](usz begin, usz end) { body(begin, end); }, grain);
+}
+
+} // namespace
+
+// -------------------------------------------------------------------------
+// Memory
+// -------------------------------------------------------------------------
+
+SoftwareRenderingDevice::SoftwareRenderingDevice() {
+  name = "SoftwareRenderingDevice";
+}
+
+SoftwareRenderingDevice::~SoftwareRenderingDevice() = default;
+
+void *SoftwareRenderingDevice::alloc(usz size) {
+  Surface *s = new Surface();
+  s->pixels = new u8[size ? size : 1];
+  s->size = size;
+  s->width = s->height = s->channels = 0;
+  s->depth = nullptr;
+  return s;
+}
+
+void *SoftwareRenderingDevice::allocSurface(i32 w, i32 h, i32 channels) {
+  if (w <= 0 || h <= 0 || channels <= 0)
+    return nullptr;
+  Surface *s = (Surface *)alloc((usz)w * (usz)h * (usz)channels);
+  s->width = w;
+  s->height = h;
+  s->channels = channels;
+  return s;
+}
+
+void SoftwareRenderingDevice::free(void *handle) {
+  if (!handle)
+    return;
+  if (handle == _target)
+    _target = nullptr;
+  Surface *s = surf(handle);
+  delete[] s->pixels;
+  delete[] s->depth;
+  delete s;
+}
+
+void SoftwareRenderingDevice::upload(void *handle, const void *src, usz size) {
+  if (!handle || !src)
+    return;
+  Surface *s = surf(handle);
+  __builtin_memcpy(s->pixels, src, size < s->size ? size : s->size);
+}
+
+void SoftwareRenderingDevice::download(void *handle, void *dst, usz size) {
+  if (!handle || !dst)
+    return;
+  Surface *s = surf(handle);
+  __builtin_memcpy(dst, s->pixels, size < s->size ? size : s->size);
+}
+
+void *SoftwareRenderingDevice::view(void *handle, i32 type) {
+  (void)type;
+  return handle;
+}
+
+void *SoftwareRenderingDevice::map(void *handle) {
+  return handle ? surf(handle)->pixels : nullptr;
+}
+
+i32 SoftwareRenderingDevice::width(void *handle) const {
+  return handle ? surf(handle)->width : 0;
+}
+
+i32 SoftwareRenderingDevice::height(void *handle) const {
+  return handle ? surf(handle)->height : 0;
+}
+
+RasterTexture SoftwareRenderingDevice::texture(const String &pixels) const {
+  RasterTexture t;
+  if (pixels.getDevice() == this) {
+    Surface *s = surf(pixels.getDeviceHandle());
+    if (s->channels != 4)
+      return t;
+    t.rgba = s->pixels;
+    t.width = s->width;
+    t.height = s->height;
+    return t;
+  }
+  usz n = pixels.size() / 4, side = 0;
+  while ((side + 1) * (side + 1) <= n)
+    side++;
+  if (side == 0 || side * side * 4 != pixels.size())
+    return t;
+  t.rgba = (const u8 *)pixels.data();
+  t.width = t.height = (i32)side;
+  return t;
+}
+
+// -------------------------------------------------------------------------
+// Rendering
+// -------------------------------------------------------------------------
+
+bool SoftwareRenderingDevice::begin(void *target, bool clear) {
+  _target = nullptr;
+  _draws.allocate(0);
+  stats = Stats();
+  if (!target)
+    return false;
+  Surface *s = surf(target);
+  if (s->channels != 4 || s->width <= 0 || s->height <= 0)
+    return false;
+  usz n = (usz)s->width * (usz)s->height;
+  if (!s->depth) {
+    s->depth = new f32[n];
+    clear = true;
+  }
+  if (clear) {
+    u32 *c = (u32 *)s->pixels;
+    for (usz i = 0; i < n; ++i) {
+      c[i] = clearColor;
+      s->depth[i] = 1.0f;
+    }
+  }
+  _target = target;
+  return true;
+}
+
+void SoftwareRenderingDevice::draw(const Vertex *vertices, usz vertexCount,
+                                   const u32 *indices, usz indexCount,
+                                   const Matrix4 &mvp, const Matrix4 &world,
+                                   const RasterTexture &texture) {
+  if (!_target || !vertices || vertexCount == 0)
+    return;
+  DrawCall d;
+  d.vertices = vertices;
+  d.indices = indices;
+  d.vertexCount = vertexCount;
+  d.triangleCount = (indices ? indexCount : vertexCount) / 3;
+  d.firstVertex = d.firstTriangle = 0;
+  d.mvp = mvp;
+  d.world = world;
+  d.texture = texture;
+  if (d.triangleCount == 0)
+    return;
+  _draws.push(d);
+  stats.draws++;
+  stats.triangles += d.triangleCount;
+}
+
+usz SoftwareRenderingDevice::flush() {
+  if (!_target || _draws.size() == 0)
+    return 0;
+  Surface *s = surf(_target);
+  const i32 W = s->width, H = s->height;
+  const i32 tilesX = (W + TS - 1) / TS, tilesY = (H + TS - 1) / TS;
+  const usz tiles = (usz)tilesX * (usz)tilesY;
+
+  usz vertices = 0, triangles = 0;
+  InlineArray<RasterTexture> textures;
+  for (usz i = 0; i < _draws.size(); ++i) {
+    DrawCall &d = _draws[i];
+    d.firstVertex = vertices;
+    d.firstTriangle = triangles;
+    vertices += d.vertexCount;
+    triangles += d.triangleCount;
+    textures.push(d.texture);
+  }
+  const usz drawCount = _draws.size();
+  const DrawCall *draws = _draws.data();
+
+  // Light direction, normalized and pointing towards the light.
+  f32 L[3] = {-lightDir.x, -lightDir.y, -lightDir.z};
+  f32 len = Math::sqrt(L[0] * L[0] + L[1] * L[1] + L[2] * L[2]);
+  for (int k = 0; k < 3; ++k)
+    L[k] = len > 0 ? L[k] / len : 0;
+  const f32 amb = ambient;
+
+  // 1. Vertices. Ranges may span several draws.
+  _clip.allocate(8 * vertices);
+  f32 *clip = _clip.data();
+  rangeFor(pool, vertices, 4096, [&](usz begin, usz end) {
+    usz di = 0;
+    while (di + 1 < drawCount && draws[di + 1].firstVertex <= begin)
+      di++;
+    for (usz g = begin; g < end; ++g) {
+      while (g >= draws[di].firstVertex + draws[di].vertexCount)
+        di++;
+      const DrawCall &d = draws[di];
+      const Vertex &v = d.vertices[g - d.firstVertex];
+      const f32(*m)[4] = d.mvp.m;
+      const f32(*w)[4] = d.world.m;
+      f32 *o = clip + 8 * g;
+      for (int k = 0; k < 4; ++k)
+        o[k] = v.x * m[0][k] + v.y * m[1][k] + v.z * m[2][k] + m[3][k];
+      o[4] = v.u;
+      o[5] = v.v;
+      f32 n[3];
+      for (int k = 0; k < 3; ++k)
+        n[k] = v.nx * w[0][k] + v.ny * w[1][k] + v.nz * w[2][k];
+      f32 nl = n[0] * n[0] + n[1] * n[1] + n[2] * n[2];
+      f32 lambert = n[0] * L[0] + n[1] * L[1] + n[2] * L[2];
+      lambert = nl > 0 && lambert > 0 ? lambert / Math::sqrt(nl) : 0;
+      o[6] = amb + (1.0f - amb) * lambert;
+      o[7] = 0;
+    }
+  });
+
+  const bool cull = cullBack;
+  TileKernel kernel = tileKernel();
+  usz frags = 0;
+  std::atomic<usz> rejected(0), fragTotal(0);
+  InlineArray<RasterTri> extra;
+  _binStart.allocate(tiles + 1);
+
+  for (usz first = 0; first < triangles; first += BatchTriangles) {
+    usz n = triangles - first < BatchTriangles ? triangles - first
+                                               : BatchTriangles;
+    _tris.allocate(n);
+    RasterTri *tris = _tris.data();
+
+    // 2. Setup; near-clipped triangles are finished serially below.
+    rangeFor(pool, n, 1024, [&](usz begin, usz end) {
+      usz di = 0, rej = 0;
+      while (di + 1 < drawCount && draws[di + 1].firstTriangle <= first + begin)
+        di++;
+      for (usz k = begin; k < end; ++k) {
+        usz g = first + k;
+        while (g >= draws[di].firstTriangle + draws[di].triangleCount)
+          di++;
+        const DrawCall &d = draws[di];
+        usz local = g - d.firstTriangle;
+        u32 idx[3];
+        for (int c = 0; c < 3; ++c)
+          idx[c] = d.indices ? d.indices[local * 3 + c] : (u32)(local * 3 + c);
+        RasterTri &t = tris[k];
+        t.x0 = t.x1 = 0;
+        t.clip = 0;
+        if (idx[0] >= d.vertexCount || idx[1] >= d.vertexCount ||
+            idx[2] >= d.vertexCount) {
+          rej++;
+          continue;
+        }
+        const ClipVertex *v[3];
+        for (int c = 0; c < 3; ++c)
+          v[c] = (const ClipVertex *)(clip + 8 * (d.firstVertex + idx[c]));
+        u32 o0 = outcode(*v[0]), o1 = outcode(*v[1]), o2 = outcode(*v[2]);
+        if (o0 & o1 & o2) {
+          rej++;
+          continue;
+        }
+        if ((o0 | o1 | o2) & 16u) {
+          t.clip = 1;
+          t.draw = (u32)di;
+          continue;
+        }
+        if (!setup(v[0], v[1], v[2], W, H, (u32)di, cull, t))
+          rej++;
+      }
+      rejected.fetch_add(rej, std::memory_order_relaxed);
+    });
+
+    extra.allocate(0);
+    for (usz k = 0; k < n; ++k) {
+      RasterTri &t = tris[k];
+      if (!t.clip)
+        continue;
+      const DrawCall &d = draws[t.draw];
+      usz local = first + k - d.firstTriangle;
+      const ClipVertex *v[3];
+      for (int c = 0; c < 3; ++c) {
+        u32 i = d.indices ? d.indices[local * 3 + c] : (u32)(local * 3 + c);
+        v[c] = (const ClipVertex *)(clip + 8 * (d.firstVertex + i));
+      }
+      RasterTri out[2];
+      usz made = clipNear(v, W, H, t.draw, cull, out);
+      if (made == 0) {
+        t.x0 = t.x1 = 0;
+        rejected.fetch_add(1, std::memory_order_relaxed);
+        continue;
+      }
+      t = out[0];
+      if (made > 1)
+        extra.push(out[1]);
+    }
+    if (extra.size() > 0) {
+      _tris.allocate(n + extra.size());
+      tris = _tris.data();
+      for (usz k = 0; k < extra.size(); ++k)
+        tris[n + k] = extra[k];
+    }
+    usz total = _tris.size();
+
+    // 3. Binning: count, prefix sums, fill.
+    u32 *start = _binStart.data();
+    for (usz t = 0; t <= tiles; ++t)
+      start[t] = 0;
+    for (usz k = 0; k < total; ++k) {
+      const RasterTri &t = tris[k];
+      if (t.x0 >= t.x1)
+        continue;
+      for (i32 ty = t.y0 / TS; ty <= (t.y1 - 1) / TS; ++ty)
+        for (i32 tx = t.x0 / TS; tx <= (t.x1 - 1) / TS; ++tx)
+          start[(usz)ty * tilesX + tx + 1]++;
+    }
+    for (usz t = 0; t < tiles; ++t)
+      start[t + 1] += start[t];
+    usz binned = start[tiles];
+    stats.binned += binned;
+    _bins.allocate(binned);
+    u32 *bins = _bins.data();
+    {
+      InlineArray<u32> cursor;
+      cursor.allocate(tiles);
+      for (usz t = 0; t < tiles; ++t)
+        cursor[t] = start[t];
+      for (usz k = 0; k < total; ++k) {
+        const RasterTri &t = tris[k];
+        if (t.x0 >= t.x1)
+          continue;
+        for (i32 ty = t.y0 / TS; ty <= (t.y1 - 1) / TS; ++ty)
+          for (i32 tx = t.x0 / TS; tx <= (t.x1 - 1) / TS; ++tx)
+            bins[cursor[(usz)ty * tilesX + tx]++] = (u32)k;
+      }
+    }
+
+    // 4. Tiles with work.
+    InlineArray<u32> active;
+    for (usz t = 0; t < tiles; ++t)
+      if (start[t + 1] > start[t])
+        active.push((u32)t);
+    const RasterTexture *tex = textures.data();
+    const bool bil = bilinear;
+    u32 *frame = (u32 *)s->pixels;
+    f32 *frameDepth = s->depth;
+    dynamicFor(pool, active.size(), [&](usz a) {
+      u32 tile = active[a];
+      u32 color[TS * TS];
+      f32 depth[TS * TS];
+      TileJob j;
+      j.tris = tris;
+      j.list = bins + start[tile];
+      j.count = start[tile + 1] - start[tile];
+      j.x0 = (i32)(tile % (u32)tilesX) * TS;
+      j.y0 = (i32)(tile / (u32)tilesX) * TS;
+      j.x1 = j.x0 + TS < W ? j.x0 + TS : W;
+      j.y1 = j.y0 + TS < H ? j.y0 + TS : H;
+      j.color = color;
+      j.depth = depth;
+      j.textures = tex;
+      j.bilinear = bil;
+      usz cols = (usz)(j.x1 - j.x0);
+      for (i32 y = j.y0; y < j.y1; ++y) {
+        usz row = (usz)y * (usz)W + (usz)j.x0, at = (usz)(y - j.y0) * TS;
+        __builtin_memcpy(color + at, frame + row, cols * 4);
+        __builtin_memcpy(depth + at, frameDepth + row, cols * 4);
+      }
+      usz f = kernel(j);
+      for (i32 y = j.y0; y < j.y1; ++y) {
+        usz row = (usz)y * (usz)W + (usz)j.x0, at = (usz)(y - j.y0) * TS;
+        __builtin_memcpy(frame + row, color + at, cols * 4);
+        __builtin_memcpy(frameDepth + row, depth + at, cols * 4);
+      }
+      fragTotal.fetch_add(f, std::memory_order_relaxed);
+    });
+  }
+
+  frags = fragTotal.load();
+  stats.rejected += rejected.load();
+  stats.fragments += frags;
+  _draws.allocate(0);
+  return frags;
+}
+
+} // namespace Xi
@@ -1,3 +1,4 @@
+#include <Xi/Perf.hpp>
 #include <Xi/Regex.hpp>
 
 namespace Xi {
@@ -493,6 +494,7 @@ bool Regex::runVM(const String &in, int start, const Array<Inst> &prog, bool rev
 }
 
 Array<RegexMatch> Regex::matchAll(const String &input, int maxMatches, u64 limitUs) const {
+    XI_PERF_REGION("Regex::matchAll");
     Array<RegexMatch> res;
     if (maxMatches == 0)
         maxMatches = 1000000;
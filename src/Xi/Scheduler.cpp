@@ -0,0 +1,190 @@
+#include "../../include/Xi/Scheduler.hpp"
+
+namespace Xi {
+
+struct DeviceScheduler::Node {
+  Device *device = nullptr;
+  Func<void()> update;
+  Array<usz> dependencies;
+  Array<Node *> dependents;
+
+  i64 periodMicros = 0;
+  i64 nextDue = 0;
+  bool due = false;
+  std::atomic<usz> remaining{0};
+
+  Stats stats;
+};
+
+DeviceScheduler::~DeviceScheduler() {
+  for (usz i = 0; i < nodes.size(); ++i)
+    delete nodes[i];
+}
+
+static i64 periodOf(f64 hz) { return hz > 0 ? (i64)(1000000.0 / hz) : 0; }
+
+usz DeviceScheduler::insert(Node *n, f64 hz) {
+  n->periodMicros = periodOf(hz);
+  nodes.push(n);
+  return nodes.size() - 1;
+}
+
+usz DeviceScheduler::add(Device *device, f64 hz) {
+  if (!device)
+    return None;
+  usz existing = find(device);
+  if (existing != None)
+    return existing;
+  Node *n = new Node();
+  n->device = device;
+  return insert(n, hz);
+}
+
+usz DeviceScheduler::add(Func<void()> update, f64 hz) {
+  if (!update.isValid())
+    return None;
+  Node *n = new Node();
+  n->update = Xi::Move(update);
+  return insert(n, hz);
+}
+
+usz DeviceScheduler::addTree(Device *root, f64 hz) {
+  usz id = add(root, hz);
+  if (id == None)
+    return None;
+  for (usz i = 0; i < root->devices.size(); ++i) {
+    usz child = addTree(root->devices[i], hz);
+    if (child != None)
+      dependsOn(id, child);
+  }
+  return id;
+}
+
+bool DeviceScheduler::reaches(usz from, usz to) const {
+  if (from == to)
+    return true;
+  const Node *n = nodes[from];
+  for (usz i = 0; i < n->dependencies.size(); ++i)
+    if (reaches(n->dependencies[i], to))
+      return true;
+  return false;
+}
+
+bool DeviceScheduler::dependsOn(usz node, usz dependency) {
+  if (node >= nodes.size() || dependency >= nodes.size())
+    return false;
+  // node -> dependency closes a cycle if dependency already waits on node.
+  if (reaches(dependency, node))
+    return false;
+  Node *n = nodes[node];
+  for (usz i = 0; i < n->dependencies.size(); ++i)
+    if (n->dependencies[i] == dependency)
+      return true;
+  n->dependencies.push(dependency);
+  nodes[dependency]->dependents.push(n);
+  return true;
+}
+
+bool DeviceScheduler::setRate(usz node, f64 hz) {
+  if (node >= nodes.size())
+    return false;
+  nodes[node]->periodMicros = periodOf(hz);
+  nodes[node]->nextDue = 0;
+  return true;
+}
+
+usz DeviceScheduler::find(Device *device) const {
+  for (usz i = 0; i < nodes.size(); ++i)
+    if (nodes[i]->device == device)
+      return i;
+  return None;
+}
+
+const DeviceScheduler::Stats *DeviceScheduler::stats(usz node) const {
+  return node < nodes.size() ? &nodes[node]->stats : nullptr;
+}
+
+void DeviceScheduler::resetStats() {
+  for (usz i = 0; i < nodes.size(); ++i)
+    nodes[i]->stats = Stats();
+  ticks = 0;
+  lastTickMicros = 0;
+  maxTickMicros = 0;
+}
+
+void DeviceScheduler::complete(Node *n) {
+  // Read-only access: the const operator[] never reallocates, so workers can
+  // walk the same lists concurrently.
+  const Array<Node *> &dependents = n->dependents;
+  for (usz i = 0; i < dependents.size(); ++i) {
+    Node *d = dependents[i];
+    if (d->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      dispatch(d);
+  }
+}
+
+void DeviceScheduler::dispatch(Node *n) {
+  if (!n->due) {
+    complete(n);
+    return;
+  }
+  DeviceScheduler *self = this;
+  pool->submit(
+      [self, n]() {
+        i64 t0 = Xi::micros();
+        if (n->device)
+          n->device->update();
+        else
+          n->update();
+        i64 dt = Xi::micros() - t0;
+
+        Stats &s = n->stats;
+        s.runs++;
+        s.lastMicros = dt;
+        s.totalMicros += dt;
+        if (dt > s.maxMicros)
+          s.maxMicros = dt;
+        self->ran.fetch_add(1, std::memory_order_relaxed);
+
+        // Dependents are submitted before this job leaves the group, so the
+        // group cannot drain while work is still pending.
+        self->complete(n);
+      },
+      &group);
+}
+
+usz DeviceScheduler::tick() {
+  i64 start = Xi::micros();
+  usz count = nodes.size();
+
+  for (usz i = 0; i < count; ++i) {
+    Node *n = nodes[i];
+    n->due = n->periodMicros == 0 || start >= n->nextDue;
+    if (n->due && n->periodMicros) {
+      // Keep a steady cadence, but don't replay missed periods in a burst.
+      n->nextDue += n->periodMicros;
+      if (n->nextDue <= start)
+        n->nextDue = start + n->periodMicros;
+    } else if (!n->due) {
+      n->stats.skipped++;
+    }
+    n->remaining.store(n->dependencies.size(), std::memory_order_relaxed);
+  }
+
+  ran.store(0, std::memory_order_relaxed);
+  for (usz i = 0; i < count; ++i) {
+    Node *n = nodes[i];
+    if (n->dependencies.size() == 0)
+      dispatch(n);
+  }
+  pool->wait(group);
+
+  i64 dt = Xi::micros() - start;
+  ticks++;
+  lastTickMicros = dt;
+  if (dt > maxTickMicros)
+    maxTickMicros = dt;
+  return ran.load(std::memory_order_relaxed);
+}
+
+} // namespace Xi
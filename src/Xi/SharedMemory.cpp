@@ -0,0 +1,369 @@
+#include "../../include/Xi/SharedMemory.hpp"
+
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+
+#if (defined(__linux__) || defined(__APPLE__) || defined(__unix__)) &&        \
+    !defined(ARDUINO) && !defined(__EMSCRIPTEN__)
+#define XI_SHM_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Xi {
+
+// -------------------------------------------------------------------------
+// Region layout
+//
+//   [Header | ring cells | blocks ...]
+//
+// Everything in the region is addressed by offset. Free lists are Treiber
+// stacks whose heads pack a 40-bit (offset / 16) with a 24-bit ABA tag.
+// -------------------------------------------------------------------------
+
+static_assert(sizeof(std::atomic<u64>) == sizeof(u64) &&
+                  std::atomic<u64>::is_always_lock_free,
+              "shared memory needs address-free 64-bit atomics");
+
+static constexpr u64 ShmMagic = 0x5869536C61624D31ULL; // "XiSlabM1"
+static constexpr usz BlockAlign = 16;
+
+struct BlockHeader {
+  std::atomic<u32> refs;
+  u32 cls;
+  u64 sizeOrNext; ///< Requested size while live, next free offset when free
+};
+static_assert(sizeof(BlockHeader) == BlockAlign, "block header is 16 bytes");
+
+struct RingCell {
+  std::atomic<u64> seq;
+  u64 value;
+};
+
+struct SharedMemoryDevice::Header {
+  u64 magic;
+  u64 size;
+  u64 dataStart;
+  std::atomic<u64> bump;
+  std::atomic<u64> freeLists[Classes];
+  alignas(64) std::atomic<u64> enqueuePos;
+  alignas(64) std::atomic<u64> dequeuePos;
+  alignas(64) RingCell ring[RingSlots];
+};
+
+static inline u64 packHead(u64 offset, u64 tag) {
+  return ((tag & 0xFFFFFFULL) << 40) | (offset / BlockAlign);
+}
+static inline u64 headOffset(u64 head) {
+  return (head & 0xFFFFFFFFFFULL) * BlockAlign;
+}
+static inline u64 headTag(u64 head) { return head >> 40; }
+
+static inline usz classBytes(usz cls) {
+  return SharedMemoryDevice::MinBlock << cls;
+}
+
+// -------------------------------------------------------------------------
+// Mapping
+// -------------------------------------------------------------------------
+
+bool SharedMemoryDevice::mapFd(int fd, usz bytes, bool init) {
+#ifdef XI_SHM_POSIX
+  void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (p == MAP_FAILED)
+    return false;
+  base = (u8 *)p;
+  mappedSize = bytes;
+  handleFd = fd;
+
+  Header *h = header();
+  if (init) {
+    // A fresh memfd/shm object is zero-filled, so the atomics are already
+    // valid zeroes; only the non-zero fields need writing.
+    h->size = bytes;
+    h->dataStart = (sizeof(Header) + 63) & ~(u64)63;
+    h->bump.store(h->dataStart, std::memory_order_relaxed);
+    for (u32 i = 0; i < RingSlots; ++i)
+      h->ring[i].seq.store(i, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    h->magic = ShmMagic;
+  } else if (h->magic != ShmMagic || h->size != bytes) {
+    close();
+    return false;
+  }
+  return true;
+#else
+  (void)fd;
+  (void)bytes;
+  (void)init;
+  return false;
+#endif
+}
+
+bool SharedMemoryDevice::create(usz bytes, const char *shmName) {
+#ifdef XI_SHM_POSIX
+  close();
+  if (bytes < sizeof(Header) + classBytes(0))
+    bytes = sizeof(Header) + ((usz)1 << 20);
+  int fd = -1;
+  if (shmName) {
+    fd = shm_open(shmName, O_RDWR | O_CREAT | O_EXCL, 0600);
+  } else {
+#if defined(__linux__)
+    fd = memfd_create("xi-shm", MFD_CLOEXEC);
+#else
+    // No memfd: create a uniquely named object and unlink it right away.
+    char tmp[64];
+    snprintf(tmp, sizeof(tmp), "/xi-shm-%d-%p", (int)getpid(), (void *)this);
+    fd = shm_open(tmp, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd >= 0)
+      shm_unlink(tmp);
+#endif
+  }
+  if (fd < 0)
+    return false;
+  if (ftruncate(fd, (off_t)bytes) != 0 || !mapFd(fd, bytes, true)) {
+    ::close(fd);
+    if (shmName)
+      shm_unlink(shmName);
+    return false;
+  }
+  return true;
+#else
+  (void)bytes;
+  (void)shmName;
+  return false;
+#endif
+}
+
+bool SharedMemoryDevice::attach(int fd) {
+#ifdef XI_SHM_POSIX
+  close();
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0 || st.st_size <= 0)
+    return false;
+  return mapFd(fd, (usz)st.st_size, false);
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
+bool SharedMemoryDevice::attach(const char *shmName) {
+#ifdef XI_SHM_POSIX
+  int fd = shm_open(shmName, O_RDWR, 0600);
+  if (fd < 0)
+    return false;
+  if (!attach(fd)) {
+    ::close(fd);
+    return false;
+  }
+  return true;
+#else
+  (void)shmName;
+  return false;
+#endif
+}
+
+void SharedMemoryDevice::close() {
+#ifdef XI_SHM_POSIX
+  if (base)
+    munmap(base, mappedSize);
+  if (handleFd >= 0)
+    ::close(handleFd);
+#endif
+  base = nullptr;
+  mappedSize = 0;
+  handleFd = -1;
+}
+
+bool SharedMemoryDevice::unlink(const char *shmName) {
+#ifdef XI_SHM_POSIX
+  return shm_unlink(shmName) == 0;
+#else
+  (void)shmName;
+  return false;
+#endif
+}
+
+usz SharedMemoryDevice::usedBytes() const {
+  if (!base)
+    return 0;
+  return (usz)(header()->bump.load(std::memory_order_relaxed) -
+               header()->dataStart);
+}
+
+// -------------------------------------------------------------------------
+// Slab allocator
+// -------------------------------------------------------------------------
+
+static inline BlockHeader *blockAt(u8 *base, u64 off) {
+  return (BlockHeader *)(base + off);
+}
+
+void *SharedMemoryDevice::alloc(usz size) {
+  if (!base)
+    return nullptr;
+  usz need = size + sizeof(BlockHeader);
+  usz cls = 0;
+  while (cls < Classes && classBytes(cls) < need)
+    cls++;
+  if (cls == Classes)
+    return nullptr;
+
+  Header *h = header();
+  u64 off = 0;
+
+  // Pop a recycled block of this class.
+  std::atomic<u64> &list = h->freeLists[cls];
+  u64 head = list.load(std::memory_order_acquire);
+  while (headOffset(head)) {
+    u64 top = headOffset(head);
+    u64 next = blockAt(base, top)->sizeOrNext;
+    if (list.compare_exchange_weak(head, packHead(next, headTag(head) + 1),
+                                   std::memory_order_acq_rel,
+                                   std::memory_order_acquire)) {
+      off = top;
+      break;
+    }
+  }
+
+  // Otherwise carve a fresh one.
+  if (!off) {
+    u64 bytes = classBytes(cls);
+    u64 at = h->bump.fetch_add(bytes, std::memory_order_relaxed);
+    if (at + bytes > h->size) {
+      h->bump.fetch_sub(bytes, std::memory_order_relaxed);
+      return nullptr;
+    }
+    off = at;
+  }
+
+  BlockHeader *b = blockAt(base, off);
+  b->cls = (u32)cls;
+  b->sizeOrNext = size;
+  b->refs.store(1, std::memory_order_release);
+  return (void *)(usz)off;
+}
+
+// Handles come from other processes too: only block offsets past the
+// header and ring, aligned and inside the mapping, may be dereferenced.
+// The first block offset follows from the layout, so this never trusts a
+// dataStart another process could have rewritten.
+bool SharedMemoryDevice::validHandle(void *handle) const {
+  const u64 dataStart = (sizeof(Header) + 63) & ~(u64)63;
+  u64 off = (u64)(usz)handle;
+  return base && off >= dataStart && off + sizeof(BlockHeader) <= mappedSize &&
+         (off % BlockAlign) == 0;
+}
+
+void SharedMemoryDevice::free(void *handle) {
+  if (!validHandle(handle))
+    return;
+  u64 off = (u64)(usz)handle;
+  BlockHeader *b = blockAt(base, off);
+  if (b->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    return;
+
+  // Last reference anywhere: push onto the class free list.
+  std::atomic<u64> &list = header()->freeLists[b->cls];
+  u64 head = list.load(std::memory_order_acquire);
+  do {
+    b->sizeOrNext = headOffset(head);
+  } while (!list.compare_exchange_weak(head, packHead(off, headTag(head) + 1),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire));
+}
+
+void SharedMemoryDevice::retain(void *handle) {
+  if (validHandle(handle))
+    blockAt(base, (u64)(usz)handle)
+        ->refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+u32 SharedMemoryDevice::refCount(void *handle) const {
+  if (!validHandle(handle))
+    return 0;
+  return blockAt(base, (u64)(usz)handle)->refs.load(std::memory_order_acquire);
+}
+
+usz SharedMemoryDevice::sizeOf(void *handle) const {
+  if (!refCount(handle))
+    return 0;
+  return (usz)blockAt(base, (u64)(usz)handle)->sizeOrNext;
+}
+
+void *SharedMemoryDevice::view(void *handle, i32 type) {
+  (void)type;
+  if (!validHandle(handle))
+    return nullptr;
+  return base + (u64)(usz)handle + sizeof(BlockHeader);
+}
+
+void SharedMemoryDevice::upload(void *handle, const void *src, usz size) {
+  if (void *dst = view(handle))
+    memcpy(dst, src, size);
+}
+
+void SharedMemoryDevice::download(void *handle, void *dst, usz size) {
+  if (void *src = view(handle))
+    memcpy(dst, src, size);
+}
+
+// -------------------------------------------------------------------------
+// Handle ring (bounded MPMC, Vyukov)
+// -------------------------------------------------------------------------
+
+bool SharedMemoryDevice::send(void *handle) {
+  if (!validHandle(handle))
+    return false;
+  Header *h = header();
+  u64 pos = h->enqueuePos.load(std::memory_order_relaxed);
+  for (;;) {
+    RingCell &c = h->ring[pos % RingSlots];
+    u64 seq = c.seq.load(std::memory_order_acquire);
+    i64 diff = (i64)seq - (i64)pos;
+    if (diff == 0) {
+      if (h->enqueuePos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+        retain(handle);
+        c.value = (u64)(usz)handle;
+        c.seq.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    } else if (diff < 0) {
+      return false; // full
+    } else {
+      pos = h->enqueuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void *SharedMemoryDevice::receive() {
+  if (!base)
+    return nullptr;
+  Header *h = header();
+  u64 pos = h->dequeuePos.load(std::memory_order_relaxed);
+  for (;;) {
+    RingCell &c = h->ring[pos % RingSlots];
+    u64 seq = c.seq.load(std::memory_order_acquire);
+    i64 diff = (i64)seq - (i64)(pos + 1);
+    if (diff == 0) {
+      if (h->dequeuePos.compare_exchange_weak(pos, pos + 1,
+                                              std::memory_order_relaxed)) {
+        u64 v = c.value;
+        c.seq.store(pos + RingSlots, std::memory_order_release);
+        return (void *)(usz)v;
+      }
+    } else if (diff < 0) {
+      return nullptr; // empty
+    } else {
+      pos = h->dequeuePos.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+} // namespace Xi
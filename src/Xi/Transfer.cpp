@@ -0,0 +1,234 @@
+#include "../../include/Xi/Transfer.hpp"
+
+#include <string.h>
+
+namespace Xi {
+
+static constexpr usz Direct = ~(usz)0;
+
+// -------------------------------------------------------------------------
+// TransferQueue
+// -------------------------------------------------------------------------
+
+TransferQueue::~TransferQueue() {
+  flush();
+  if (pool)
+    pool->wait(group);
+}
+
+void TransferQueue::upload(void *handle, usz offset, const void *src,
+                           usz size) {
+  if (!handle || !src || !size)
+    return;
+  recordedOps++;
+
+  if (size >= stageBelow) {
+    recording.push(Record{TransferOp{handle, offset, size, src, nullptr},
+                          Direct});
+    directBytes += size;
+    return;
+  }
+
+  usz at = staging.size();
+  // Grow geometrically, then append with one memcpy.
+  if (staging.capacity() < at + size)
+    staging.reserve((at + size) * 2);
+  staging.allocate(at + size);
+  memcpy(staging.data() + at, src, size);
+  stagedBytes += size;
+
+  // Coalesce with the previous op if it continues the same range.
+  if (recording.size() > 0) {
+    Record &prev = recording[recording.size() - 1];
+    if (prev.stagingAt != Direct && prev.op.handle == handle &&
+        prev.op.offset + prev.op.size == offset &&
+        prev.stagingAt + prev.op.size == at) {
+      prev.op.size += size;
+      return;
+    }
+  }
+  recording.push(Record{TransferOp{handle, offset, size, nullptr, nullptr},
+                        at});
+}
+
+void TransferQueue::download(void *handle, usz offset, void *dst, usz size) {
+  if (!handle || !dst || !size)
+    return;
+  recordedOps++;
+  recording.push(
+      Record{TransferOp{handle, offset, size, nullptr, dst}, Direct});
+}
+
+u64 TransferQueue::submit() {
+  if (recording.size() == 0)
+    return nextFence - 1;
+
+  Batch *b = new Batch();
+  u64 fence = nextFence++;
+  b->fence = fence;
+  b->staging = Xi::Move(staging);
+  staging = InlineArray<u8>();
+
+  // Staged sources are resolved only now: the staging buffer may have moved
+  // while it grew.
+  b->ops.allocate(recording.size());
+  for (usz i = 0; i < recording.size(); ++i) {
+    TransferOp op = recording[i].op;
+    if (recording[i].stagingAt != Direct)
+      op.src = b->staging.data() + recording[i].stagingAt;
+    b->ops[i] = op;
+  }
+  submittedOps += recording.size();
+  recording = InlineArray<Record>();
+  batches++;
+
+  lock();
+  queued.push(b);
+  bool start = !draining;
+  draining = true;
+  unlock();
+
+  if (start) {
+    if (pool) {
+      TransferQueue *self = this;
+      pool->submit([self]() { self->drain(); }, &group);
+    } else {
+      drain();
+    }
+  }
+  return fence; // b may already have been executed and freed
+}
+
+void TransferQueue::drain() {
+  for (;;) {
+    lock();
+    if (queued.size() == 0) {
+      draining = false;
+      unlock();
+      return;
+    }
+    Batch *b = queued.shift();
+    unlock();
+
+    device->transfer(b->ops.data(), b->ops.size());
+    completed.store(b->fence, std::memory_order_release);
+    delete b;
+  }
+}
+
+void TransferQueue::wait(u64 fence) {
+  while (!done(fence)) {
+    if (pool)
+      pool->wait(group);
+    else
+      drain();
+  }
+}
+
+// -------------------------------------------------------------------------
+// EmulatedMemoryDevice
+// -------------------------------------------------------------------------
+
+namespace {
+struct EmulatedBlock {
+  usz size;
+  u8 *data;
+};
+} // namespace
+
+void *EmulatedMemoryDevice::alloc(usz size) {
+  EmulatedBlock *b = new EmulatedBlock();
+  b->size = size;
+  b->data = new u8[size ? size : 1]();
+  return b;
+}
+
+void EmulatedMemoryDevice::free(void *handle) {
+  EmulatedBlock *b = (EmulatedBlock *)handle;
+  if (!b)
+    return;
+  delete[] b->data;
+  delete b;
+}
+
+void EmulatedMemoryDevice::charge(usz n, bool newCall) {
+  i64 cost = (i64)((f64)n / bytesPerMicro);
+  if (newCall) {
+    cost += callMicros;
+    calls++;
+  }
+  bytes += n;
+  if (cost <= 0)
+    return;
+  i64 until = micros() + cost;
+  while (micros() < until) {
+  }
+}
+
+// Bounds-checked pointer into a block, or null when out of range.
+u8 *EmulatedMemoryDevice::range(void *handle, usz offset, usz size) {
+  EmulatedBlock *b = (EmulatedBlock *)handle;
+  if (!b || offset > b->size || size > b->size - offset)
+    return nullptr;
+  return b->data + offset;
+}
+
+bool EmulatedMemoryDevice::write(void *handle, usz offset, const void *src,
+                                 usz size) {
+  u8 *at = range(handle, offset, size);
+  if (!at || !src)
+    return false;
+  memcpy(at, src, size);
+  return true;
+}
+
+bool EmulatedMemoryDevice::read(void *handle, usz offset, void *dst,
+                                usz size) {
+  u8 *at = range(handle, offset, size);
+  if (!at || !dst)
+    return false;
+  memcpy(dst, at, size);
+  return true;
+}
+
+void EmulatedMemoryDevice::upload(void *handle, const void *src, usz size) {
+  charge(size, true);
+  write(handle, 0, src, size);
+}
+
+void EmulatedMemoryDevice::download(void *handle, void *dst, usz size) {
+  charge(size, true);
+  read(handle, 0, dst, size);
+}
+
+bool EmulatedMemoryDevice::uploadRange(void *handle, usz offset,
+                                       const void *src, usz size) {
+  charge(size, true);
+  return write(handle, offset, src, size);
+}
+
+bool EmulatedMemoryDevice::downloadRange(void *handle, usz offset, void *dst,
+                                         usz size) {
+  charge(size, true);
+  return read(handle, offset, dst, size);
+}
+
+void EmulatedMemoryDevice::transfer(const TransferOp *ops, usz count) {
+  usz total = 0;
+  for (usz i = 0; i < count; ++i)
+    total += ops[i].size;
+  charge(total, count > 0);
+  for (usz i = 0; i < count; ++i) {
+    const TransferOp &op = ops[i];
+    if (op.src)
+      write(op.handle, op.offset, op.src, op.size);
+    else
+      read(op.handle, op.offset, op.dst, op.size);
+  }
+}
+
+const u8 *EmulatedMemoryDevice::contents(void *handle) const {
+  return handle ? ((EmulatedBlock *)handle)->data : nullptr;
+}
+
+} // namespace Xi
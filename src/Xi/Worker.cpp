@@ -0,0 +1,224 @@
+#include "../../include/Xi/Worker.hpp"
+
+#if defined(ARDUINO) || defined(FREERTOS_CONFIG_H) ||                          \
+    defined(INC_FREERTOS_H) || defined(__cheerp__) ||                          \
+    (defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__))
+#define XI_WORKER_INLINE
+#else
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace Xi {
+
+struct Job {
+  Func<void()> fn;
+  WorkerPool::Group *group = nullptr;
+};
+
+// Growable ring buffer; jobs are moved in and out, never copied.
+struct JobQueue {
+  Job *slots = nullptr;
+  usz cap = 0, head = 0, count = 0;
+
+  ~JobQueue() { delete[] slots; }
+
+  void push(Job &&j) {
+    if (count == cap) {
+      usz ncap = cap ? cap * 2 : 64;
+      Job *ns = new Job[ncap];
+      for (usz i = 0; i < count; ++i)
+        ns[i] = Xi::Move(slots[(head + i) % cap]);
+      delete[] slots;
+      slots = ns;
+      cap = ncap;
+      head = 0;
+    }
+    slots[(head + count) % cap] = Xi::Move(j);
+    count++;
+  }
+
+  bool pop(Job &out) {
+    if (count == 0)
+      return false;
+    out = Xi::Move(slots[head]);
+    slots[head].fn = Func<void()>();
+    head = (head + 1) % cap;
+    count--;
+    return true;
+  }
+};
+
+// Returns true when this job completed its group. The group may be gone as
+// soon as the counter hits zero, so callers must not touch it afterwards.
+static bool finish(Job &j) {
+  j.fn();
+  j.fn = Func<void()>();
+  if (!j.group)
+    return false;
+  return j.group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1;
+}
+
+#ifdef XI_WORKER_INLINE
+
+struct WorkerPool::Impl {
+  JobQueue queue;
+};
+
+WorkerPool::WorkerPool(usz threads) : impl(new Impl()) { (void)threads; }
+WorkerPool::~WorkerPool() { delete impl; }
+
+void WorkerPool::submit(Func<void()> job, Group *group) {
+  if (group)
+    group->pending.fetch_add(1, std::memory_order_acq_rel);
+  Job j;
+  j.fn = Xi::Move(job);
+  j.group = group;
+  impl->queue.push(Xi::Move(j));
+}
+
+bool WorkerPool::runOne() {
+  Job j;
+  if (!impl->queue.pop(j))
+    return false;
+  finish(j);
+  return true;
+}
+
+void WorkerPool::wait(Group &group) {
+  while (!group.done() && runOne()) {
+  }
+}
+
+usz WorkerPool::hardwareThreads() { return 1; }
+
+#else
+
+struct WorkerPool::Impl {
+  std::mutex lock;
+  std::condition_variable wake; ///< Workers: a job arrived or stopping
+  std::condition_variable idle; ///< Waiters: some job finished
+  JobQueue queue;
+  std::thread *threads = nullptr;
+  bool stopping = false;
+};
+
+WorkerPool::WorkerPool(usz threads) : impl(new Impl()) {
+  if (threads == 0) {
+    usz hw = hardwareThreads();
+    threads = hw > 1 ? hw - 1 : 0;
+  }
+  workerCount = threads;
+  if (!threads)
+    return;
+  impl->threads = new std::thread[threads];
+  for (usz i = 0; i < threads; ++i) {
+    impl->threads[i] = std::thread([this]() {
+      Impl &s = *impl;
+      for (;;) {
+        Job j;
+        {
+          std::unique_lock<std::mutex> g(s.lock);
+          s.wake.wait(g, [&s]() { return s.stopping || s.queue.count > 0; });
+          if (!s.queue.pop(j))
+            return; // stopping and drained
+        }
+        if (finish(j)) {
+          std::lock_guard<std::mutex> g(s.lock);
+          s.idle.notify_all();
+        }
+      }
+    });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> g(impl->lock);
+    impl->stopping = true;
+  }
+  impl->wake.notify_all();
+  for (usz i = 0; i < workerCount; ++i)
+    impl->threads[i].join();
+  delete[] impl->threads;
+  delete impl;
+}
+
+void WorkerPool::submit(Func<void()> job, Group *group) {
+  if (group)
+    group->pending.fetch_add(1, std::memory_order_acq_rel);
+  Job j;
+  j.fn = Xi::Move(job);
+  j.group = group;
+  {
+    std::lock_guard<std::mutex> g(impl->lock);
+    impl->queue.push(Xi::Move(j));
+  }
+  impl->wake.notify_one();
+}
+
+bool WorkerPool::runOne() {
+  Job j;
+  {
+    std::lock_guard<std::mutex> g(impl->lock);
+    if (!impl->queue.pop(j))
+      return false;
+  }
+  // The group may belong to another thread that is asleep in wait().
+  if (finish(j)) {
+    std::lock_guard<std::mutex> g(impl->lock);
+    impl->idle.notify_all();
+  }
+  return true;
+}
+
+void WorkerPool::wait(Group &group) {
+  while (!group.done()) {
+    if (runOne())
+      continue;
+    // Nothing left to help with; sleep until a worker finishes a job.
+    std::unique_lock<std::mutex> g(impl->lock);
+    impl->idle.wait(g, [&]() { return group.done() || impl->queue.count > 0; });
+  }
+}
+
+usz WorkerPool::hardwareThreads() {
+  unsigned n = std::thread::hardware_concurrency();
+  return n ? (usz)n : 1;
+}
+
+#endif
+
+void WorkerPool::parallelFor(usz count, const Func<void(usz, usz)> &body,
+                             usz grain) {
+  if (count == 0)
+    return;
+  if (grain == 0)
+    grain = 1;
+  usz parts = workerCount + 1;
+  usz chunk = (count + parts - 1) / parts;
+  if (chunk < grain)
+    chunk = grain;
+  if (chunk >= count) {
+    body(0, count);
+    return;
+  }
+
+  Group g;
+  const Func<void(usz, usz)> *fn = &body;
+  // Keep the first chunk for the calling thread.
+  for (usz begin = chunk; begin < count; begin += chunk) {
+    usz end = begin + chunk < count ? begin + chunk : count;
+    submit([fn, begin, end]() { (*fn)(begin, end); }, &g);
+  }
+  body(0, chunk);
+  wait(g);
+}
+
+WorkerPool &WorkerPool::shared() {
+  static WorkerPool pool;
+  return pool;
+}
+
+} // namespace Xi
@@ -1,8 +1,14 @@
 import { execSync } from "child_process";
 import fs from "fs";
 import path from "path";
+import { pathToFileURL } from "url";
 
-const targets = process.argv.slice(2);
+const args = process.argv.slice(2);
+const targets = args.filter((a) => !a.startsWith("--"));
+const option = (name) => {
+  const arg = args.find((a) => a.startsWith(`--${name}=`));
+  return arg ? arg.slice(name.length + 3).split(",") : null;
+};
 const allTargets = ["wasm", "python", "website"];
 const activeTargets = targets.length > 0 ? targets : ["all"];
 
@@ -33,51 +39,155 @@ function run(cmd, desc, options = {}) {
   }
 }
 
-async function buildWasm() {
-  const binDir = "dist/bin/wasm";
-  const jsDir = "dist/js";
-  if (!fs.existsSync(binDir)) fs.mkdirSync(binDir, { recursive: true });
-  if (!fs.existsSync(jsDir)) fs.mkdirSync(jsDir, { recursive: true });
-
-  const includePaths = "-Iinclude -Ipackages/monocypher";
-  const emccBin = "emcc";
-
-  run("python3 src/stubgen.py", "Generating Typescript .d.ts and Python .pyi stubs from C++ Headers");
-
+// -------------------------------------------------------------------------
+// WASM variants
+// -------------------------------------------------------------------------
+// Every variant is compiled into its own object tree and linked into
+// dist/js/xi.<variant>.js; dist/js/xi.js is a small loader that picks the
+// best one the host can run. Objects cannot be shared between variants:
+// -pthread turns on atomics and shared memory for every object it touches.
+// Listed best first; `needs` are the features the loader checks for.
+export const wasmVariants = [
+  {
+    name: "simd-mt",
+    needs: ["simd", "threads"],
+    cflags: "-msimd128 -pthread",
+    // WorkerPool starts its threads up front, so pre-spawn one Worker per
+    // core; a Worker created on demand only starts once the caller yields.
+    ldflags:
+      "-pthread -sPTHREAD_POOL_SIZE='(globalThis.navigator&&navigator.hardwareConcurrency)||4' -Wno-pthreads-mem-growth",
+  },
+  { name: "simd", needs: ["simd"], cflags: "-msimd128", ldflags: "" },
+  { name: "base", needs: [], cflags: "", ldflags: "" },
+];
+
+// speed is the default; size trades throughput for a smaller download and
+// is written as xi.<variant>.min.js.
+export const wasmProfiles = [
+  { name: "speed", suffix: "", opt: "-O3 -flto" },
+  { name: "size", suffix: ".min", opt: "-Oz -flto" },
+];
+
+// src/wasm/bridge.js wraps the byte/Tunnel exports of src/wasm/Bridge.cpp.
+const wasmLinkFlags =
+  "-sMODULARIZE -sEXPORT_ES6 -sEXPORT_NAME=createXi -sALLOW_MEMORY_GROWTH --post-js src/wasm/bridge.js";
+
+export function wasmSources() {
   const excludedWasmFiles = ["Camera.cpp", "Graphics.cpp", "Window.cpp"];
-
-  const sources = [
+  return [
     "packages/monocypher/monocypher.c",
     ...fs.readdirSync("src/Xi")
         .filter(f => f.endsWith(".cpp") && !excludedWasmFiles.includes(f))
         .map(f => `src/Xi/${f}`),
     ...fs.readdirSync("src/Hardware")
         .filter(f => f.endsWith(".cpp") && !excludedWasmFiles.includes(f))
-        .map(f => `src/Hardware/${f}`)
+        .map(f => `src/Hardware/${f}`),
+    ...fs.readdirSync("src/wasm")
+        .filter(f => f.endsWith(".cpp"))
+        .map(f => `src/wasm/${f}`)
   ];
+}
 
-  const objects = [];
-
-  for (const src of sources) {
-    const outRel = src.replace(/\.(c|cpp)$/, ".o");
-    const obj = path.join(binDir, outRel);
-    const objDir = path.dirname(obj);
-    if (!fs.existsSync(objDir)) fs.mkdirSync(objDir, { recursive: true });
+// Feature probes from wasm-feature-detect: a function using a v128 op, and
+// a module with shared memory and an atomic load.
+const simdProbe = [0, 97, 115, 109, 1, 0, 0, 0, 1, 5, 1, 96, 0, 1, 123, 3, 2,
+  1, 0, 10, 10, 1, 8, 0, 65, 0, 253, 15, 253, 98, 11];
+const threadsProbe = [0, 97, 115, 109, 1, 0, 0, 0, 1, 4, 1, 96, 0, 0, 3, 2, 1,
+  0, 5, 4, 1, 3, 1, 1, 10, 11, 1, 9, 0, 65, 0, 254, 16, 2, 0, 26, 11];
+
+function writeWasmLoader(jsDir, built) {
+  const loader = `// Generated by src/build.js: loads the fastest Xi build this host runs.
+const probe = (bytes) => WebAssembly.validate(new Uint8Array(bytes));
+
+// Threads also need SharedArrayBuffer, which browsers only hand to
+// cross-origin isolated pages (COOP/COEP headers); Node always has it.
+export const features = {
+  simd: probe(${JSON.stringify(simdProbe)}),
+  threads:
+    typeof SharedArrayBuffer === "function" &&
+    globalThis.crossOriginIsolated !== false &&
+    probe(${JSON.stringify(threadsProbe)}),
+};
 
-    objects.push(obj);
-    
-    run(
-      `${emccBin} -O3 -c ${src} ${includePaths} ${src.endsWith(".cpp") ? "-std=c++17" : ""} -o ${obj}`,
-      `Compiling ${src} with Emscripten`
-    );
-  }
+export const variants = ${JSON.stringify(built, null, 2)};
 
-  run(
-    `${emccBin} -O3 ${objects.join(" ")} -o ${jsDir}/xi.js`,
-    "Linking with Emscripten Base (Execution Mode)"
+export function pick(profile = "speed") {
+  return variants.find(
+    (v) => v.profile === profile && v.needs.every((f) => features[f]),
   );
+}
 
-  log("✅ WASM Native execution environment built at dist/js/xi.js", colors.green);
+// options.variant / options.profile override the choice; everything else
+// goes to the Emscripten module factory.
+export default async function createXi(options = {}) {
+  const { variant, profile, ...moduleOptions } = options;
+  const v = variant
+    ? variants.find((x) => x.name === variant && x.profile === (profile ?? "speed"))
+    : pick(profile);
+  if (!v) throw new Error("no Xi WebAssembly build for this host");
+  const { default: factory } = await import(\`./\${v.file}\`);
+  const module = await factory(moduleOptions);
+  module.variant = v.name;
+  return module;
+}
+`;
+  fs.writeFileSync(`${jsDir}/xi.js`, loader);
+}
+
+async function buildWasm() {
+  const binDir = "dist/bin/wasm";
+  const jsDir = "dist/js";
+  if (!fs.existsSync(binDir)) fs.mkdirSync(binDir, { recursive: true });
+  if (!fs.existsSync(jsDir)) fs.mkdirSync(jsDir, { recursive: true });
+
+  const includePaths = "-Iinclude -Ipackages/monocypher";
+  const emccBin = "emcc";
+
+  run("python3 src/stubgen.py", "Generating Typescript .d.ts and Python .pyi stubs from C++ Headers");
+
+  // --variant=simd,base and --profile=size narrow the matrix.
+  const onlyVariants = option("variant");
+  const onlyProfiles = option("profile");
+  const sources = wasmSources();
+  const built = [];
+
+  for (const profile of wasmProfiles) {
+    if (onlyProfiles && !onlyProfiles.includes(profile.name)) continue;
+    for (const variant of wasmVariants) {
+      if (onlyVariants && !onlyVariants.includes(variant.name)) continue;
+      const tag = `${variant.name}${profile.suffix}`;
+      const objects = [];
+
+      for (const src of sources) {
+        const outRel = src.replace(/\.(c|cpp)$/, ".o");
+        const obj = path.join(binDir, tag, outRel);
+        const objDir = path.dirname(obj);
+        if (!fs.existsSync(objDir)) fs.mkdirSync(objDir, { recursive: true });
+
+        objects.push(obj);
+
+        run(
+          `${emccBin} ${profile.opt} ${variant.cflags} -c ${src} ${includePaths} ${src.endsWith(".cpp") ? "-std=c++17" : ""} -o ${obj}`,
+          `Compiling ${src} with Emscripten (${tag})`
+        );
+      }
+
+      // The archive lets dev/bench_wasm.mjs link its driver per variant.
+      const lib = path.join(binDir, tag, "libXi.a");
+      if (fs.existsSync(lib)) fs.unlinkSync(lib);
+      run(`emar rcs ${lib} ${objects.join(" ")}`, `Archiving ${tag}`);
+
+      const file = `xi.${tag}.js`;
+      run(
+        `${emccBin} ${profile.opt} ${variant.ldflags} ${wasmLinkFlags} ${objects.join(" ")} -o ${jsDir}/${file}`,
+        `Linking with Emscripten (${tag})`
+      );
+      built.push({ name: variant.name, profile: profile.name, needs: variant.needs, file });
+    }
+  }
+
+  writeWasmLoader(jsDir, built);
+  log(`✅ WASM builds (${built.map(b => b.file).join(", ")}) behind dist/js/xi.js`, colors.green);
 }
 
 async function buildPython() {
@@ -133,5 +243,9 @@ async function main() {
   );
 }
 
-main();
+// Only build when run as a script; dev/bench_wasm.mjs imports the variant
+// tables above.
+if (process.argv[1] && import.meta.url === pathToFileURL(process.argv[1]).href) {
+  main();
+}
 
@@ -0,0 +1,107 @@
+// -------------------------------------------------------------------------
+// C exports behind src/wasm/bridge.js (the Emscripten --post-js).
+//
+// JS holds Xi::String handles and reads or writes their InlineArray blocks
+// in place through HEAPU8, so a Tunnel bundle costs one copy from the
+// socket buffer into WASM memory and none on the way back out. Handles
+// copy-construct to pin a block: the pin shares it by refcount, and a
+// writer that finds its block shared detaches instead of overwriting it.
+// -------------------------------------------------------------------------
+
+#include "../../include/Rho/Tunnel.hpp"
+
+#ifdef __EMSCRIPTEN__
+#include <emscripten/emscripten.h>
+#define XI_WASM_API extern "C" EMSCRIPTEN_KEEPALIVE
+#else
+#define XI_WASM_API extern "C"
+#endif
+
+using namespace Xi;
+
+// --- Bytes ---
+
+/// New empty String with room for `capacity` bytes.
+XI_WASM_API String *xi_bytes_new(usz capacity) {
+  String *s = new String();
+  if (capacity)
+    s->reserve(capacity);
+  return s;
+}
+
+XI_WASM_API void xi_bytes_free(String *s) { delete s; }
+
+/// A second handle on the same block; it keeps the bytes alive and
+/// unchanged until freed.
+XI_WASM_API String *xi_bytes_pin(const String *s) { return new String(*s); }
+
+XI_WASM_API u8 *xi_bytes_data(String *s) { return s->data(); }
+
+XI_WASM_API usz xi_bytes_size(const String *s) { return s->size(); }
+
+/// Resizes to `len` bytes and returns where JS should write them. Reuses
+/// the block when this handle owns it and it is large enough.
+XI_WASM_API u8 *xi_bytes_prepare(String *s, usz len) {
+  if (!s->allocate(len))
+    return nullptr;
+  return s->data();
+}
+
+// --- Tunnel ---
+
+/// A Tunnel whose received packets queue up until JS collects them.
+struct JsTunnel {
+  Tunnel tunnel;
+  InlineArray<Packet> inbox;
+  usz next = 0;
+};
+
+XI_WASM_API JsTunnel *xi_tunnel_new() {
+  JsTunnel *t = new JsTunnel();
+  t->tunnel.onPacket([t](Packet p) { t->inbox.push(p); });
+  return t;
+}
+
+XI_WASM_API void xi_tunnel_free(JsTunnel *t) { delete t; }
+
+XI_WASM_API void xi_tunnel_secure(JsTunnel *t, const String *key) {
+  t->tunnel.enableSecurity(*key);
+}
+
+/// Nonces and replay tracking; secure tunnels need it to agree on nonces.
+XI_WASM_API void xi_tunnel_window(JsTunnel *t) {
+  t->tunnel.enableWindowing();
+}
+
+XI_WASM_API void xi_tunnel_alive_timeout(JsTunnel *t, u32 ms) {
+  t->tunnel.setAliveTimeout(ms);
+}
+
+/// Queues `payload`; the packet shares its block until flush() builds it.
+XI_WASM_API void xi_tunnel_push(JsTunnel *t, const String *payload,
+                                u32 channel) {
+  t->tunnel.push(*payload, channel);
+}
+
+/// Moves the next bundle into `out`; returns its size (0: nothing to send).
+XI_WASM_API usz xi_tunnel_flush(JsTunnel *t, String *out) {
+  *out = t->tunnel.flush();
+  return out->size();
+}
+
+XI_WASM_API void xi_tunnel_parse(JsTunnel *t, const String *bundle) {
+  t->tunnel.parse(*bundle);
+}
+
+/// Points `payload` at the next received packet (sharing its block) and
+/// returns its channel, or -1 when the inbox is empty.
+XI_WASM_API i32 xi_tunnel_receive(JsTunnel *t, String *payload) {
+  if (t->next >= t->inbox.size()) {
+    t->inbox.allocate(0);
+    t->next = 0;
+    return -1;
+  }
+  Packet &p = t->inbox[t->next++];
+  *payload = Xi::Move(p.payload);
+  return (i32)p.channel;
+}
@@ -0,0 +1,143 @@
+// Post-js for the Emscripten builds (wasmLinkFlags in src/build.js), over
+// the exports in src/wasm/Bridge.cpp. Adds Module.XiBytes and
+// Module.XiTunnel.
+//
+// An XiBytes owns one Xi::String handle and hands out Uint8Array views
+// straight over its block in WASM memory. A view is only good until the
+// next call that can reallocate the block or grow memory (prepare, edit,
+// write, parse, flush, receive); take a fresh one after those. pin()
+// returns a second handle that keeps the current bytes alive and unchanged.
+//
+// The block may be shared with a pin() or a packet queued by
+// XiTunnel.push(), so view() is for reading only: writing through it would
+// change those too. Write through prepare(), edit() or write(), which
+// detach a shared block first.
+
+const xiRegistry =
+  typeof FinalizationRegistry === "function"
+    ? new FinalizationRegistry((free) => free())
+    : null;
+
+class XiBytes {
+  constructor(ptr) {
+    this.ptr = ptr;
+    xiRegistry?.register(this, () => _xi_bytes_free(ptr), this);
+  }
+
+  static alloc(capacity = 0) {
+    return new XiBytes(_xi_bytes_new(capacity));
+  }
+
+  static from(bytes) {
+    return XiBytes.alloc(bytes.length).write(bytes);
+  }
+
+  get length() {
+    return _xi_bytes_size(this.ptr) >>> 0;
+  }
+
+  // Read-only in spirit; see the note at the top.
+  view() {
+    const at = _xi_bytes_data(this.ptr) >>> 0;
+    return HEAPU8.subarray(at, at + this.length);
+  }
+
+  // The current bytes as a view that may be written, detached from any
+  // pin or queued packet first (a copy only when the block is shared).
+  edit() {
+    return this.prepare(this.length);
+  }
+
+  // Resizes to len bytes and returns the view to fill them through.
+  prepare(len) {
+    const at = _xi_bytes_prepare(this.ptr, len) >>> 0;
+    return HEAPU8.subarray(at, at + len);
+  }
+
+  write(bytes) {
+    this.prepare(bytes.length).set(bytes);
+    return this;
+  }
+
+  pin() {
+    return new XiBytes(_xi_bytes_pin(this.ptr));
+  }
+
+  free() {
+    if (!this.ptr) return;
+    xiRegistry?.unregister(this);
+    _xi_bytes_free(this.ptr);
+    this.ptr = 0;
+  }
+}
+
+class XiTunnel {
+  constructor() {
+    const ptr = _xi_tunnel_new();
+    this.ptr = ptr;
+    this.inbound = XiBytes.alloc(1500); // parse() input, reused
+    this.outbound = XiBytes.alloc(); // flush() output, reused
+    xiRegistry?.register(this, () => _xi_tunnel_free(ptr), this);
+  }
+
+  secure(key) {
+    const k = key instanceof XiBytes ? key : XiBytes.from(key);
+    _xi_tunnel_secure(this.ptr, k.ptr);
+    if (k !== key) k.free();
+  }
+
+  enableWindowing() {
+    _xi_tunnel_window(this.ptr);
+  }
+
+  setAliveTimeout(ms) {
+    _xi_tunnel_alive_timeout(this.ptr, ms);
+  }
+
+  // Queues a packet. An XiBytes is shared, not copied; free or rewrite it
+  // freely afterwards (rewriting detaches it from the queued packet).
+  push(payload, channel = 1) {
+    if (payload instanceof XiBytes) {
+      _xi_tunnel_push(this.ptr, payload.ptr, channel);
+    } else {
+      const p = XiBytes.from(payload);
+      _xi_tunnel_push(this.ptr, p.ptr, channel);
+      p.free();
+    }
+  }
+
+  // The next bundle to send, as a view over WASM memory, or null.
+  flush() {
+    return _xi_tunnel_flush(this.ptr, this.outbound.ptr) ? this.outbound.view()
+                                                        : null;
+  }
+
+  // Parses a received bundle. Without an argument, parses what the caller
+  // wrote into this.inbound.prepare(len), e.g. straight from a socket.
+  parse(bundle) {
+    if (bundle instanceof XiBytes) {
+      _xi_tunnel_parse(this.ptr, bundle.ptr);
+      return;
+    }
+    if (bundle) this.inbound.write(bundle);
+    _xi_tunnel_parse(this.ptr, this.inbound.ptr);
+  }
+
+  // Moves the next received payload into `into` (an XiBytes) and returns
+  // its channel, or -1 when nothing is queued.
+  receive(into) {
+    return _xi_tunnel_receive(this.ptr, into.ptr);
+  }
+
+  free() {
+    if (!this.ptr) return;
+    xiRegistry?.unregister(this);
+    _xi_tunnel_free(this.ptr);
+    this.inbound.free();
+    this.outbound.free();
+    this.ptr = 0;
+  }
+}
+
+Module["XiBytes"] = XiBytes;
+Module["XiTunnel"] = XiTunnel;
@@ -1,5 +1,6 @@
 import os
 import ctypes
+import struct
 from pathlib import Path
 
 # ------------------------------------------------------------------
@@ -18,10 +19,25 @@ else:
 
 cppyy.add_include_path(str(include_path))
 
-# Dynamically parse headers at runtime!
-cppyy.include("Xi/String.hpp")
-cppyy.include("Rho/Tunnel.hpp")
-cppyy.include("Rho/Railway.hpp")
+# Prefer the precompiled dictionary (cmake -DXI_BUILD_PYTHON_DICT=ON): the
+# reflection data loads from its .pcm and the common template instances
+# are already compiled, so nothing is parsed or JIT-compiled here. Without
+# it (or with XI_JIT=1), parse the headers at runtime.
+def _find_dict():
+    if os.environ.get("XI_JIT"):
+        return None
+    for name in ("libXiPy.so", "libXiPy.dylib", "XiPy.dll"):
+        if (current_dir / name).exists():
+            return current_dir / name
+    return None
+
+_dict = _find_dict()
+if _dict is not None:
+    cppyy.load_reflection_info(str(_dict))
+else:
+    cppyy.include("Xi/String.hpp")
+    cppyy.include("Rho/Tunnel.hpp")
+    cppyy.include("Rho/Railway.hpp")
 
 Xi = cppyy.gbl.Xi
 String = Xi.String
@@ -36,30 +52,117 @@ KeyPair = Xi.KeyPair
 
 _orig_init = String.__init__
 
+# Bytes-like objects cross into C++ by address: bytes and writable buffers
+# (bytearray, array.array, NumPy, mmap) are read in place by one bulk copy
+# into the String's block; only read-only non-bytes buffers and
+# non-contiguous views are flattened first.
+def _address(arg):
+    if isinstance(arg, bytes):
+        p = ctypes.c_char_p(arg)
+        return ctypes.cast(p, ctypes.c_void_p).value or 0, len(arg), p
+    try:
+        mv = memoryview(arg).cast('B')
+    except TypeError:
+        mv = memoryview(memoryview(arg).tobytes())
+    n = mv.nbytes
+    if n == 0:
+        return 0, 0, None
+    if mv.readonly:
+        raw = (ctypes.c_ubyte * n).from_buffer_copy(mv)
+    else:
+        raw = (ctypes.c_ubyte * n).from_buffer(mv)
+    return ctypes.addressof(raw), n, raw
+
 def String_init(self, arg=None):
+    if isinstance(arg, String):
+        _orig_init(self, arg)  # shares the block, no copy
+        return
     _orig_init(self)
     if arg is None: return
-    if isinstance(arg, (bytes, bytearray)):
-        b_data = arg
-    elif isinstance(arg, str):
-        b_data = arg.encode('utf-8')
-    else:
+    if isinstance(arg, str):
+        arg = arg.encode('utf-8')
+    try:
+        addr, n, keep = _address(arg)
+    except TypeError:
         return
-    
-    c_buf = (ctypes.c_ubyte * len(b_data)).from_buffer_copy(b_data)
-    addr = ctypes.addressof(c_buf)
-    self.pushEach(cppyy.ll.cast['uint8_t*'](addr), len(b_data))
+    self.setFromRawAddress(addr, n)
 
 def String_bytes(self):
     sz = self.size()
     if sz == 0: return b""
-    addr = cppyy.ll.cast['uintptr_t'](self.data())
-    return ctypes.string_at(addr, sz)
+    return ctypes.string_at(self.address(), sz)
+
+# ------------------------------------------------------------------
+# ZERO-COPY BUFFERS
+# ------------------------------------------------------------------
+# view() exposes the InlineArray block behind a String, InlineArray<T> or
+# Array<T> of primitives as a memoryview. The view holds a C++ copy of the
+# array, which shares the block and keeps it alive for as long as the view
+# (or anything built on it, e.g. a NumPy array) exists; later pushes on the
+# original detach it from the block instead of freeing it. Writable views
+# write through to every copy sharing the block, so they are opt-in.
+
+_FORMATS = {
+    'unsigned char': 'B', 'uint8_t': 'B', 'Xi::u8': 'B', 'u8': 'B',
+    'signed char': 'b', 'char': 'b', 'int8_t': 'b', 'Xi::i8': 'b',
+    'unsigned short': 'H', 'uint16_t': 'H', 'Xi::u16': 'H',
+    'short': 'h', 'int16_t': 'h', 'Xi::i16': 'h',
+    'unsigned int': 'I', 'uint32_t': 'I', 'Xi::u32': 'I',
+    'int': 'i', 'int32_t': 'i', 'Xi::i32': 'i',
+    'unsigned long': 'Q', 'unsigned long long': 'Q', 'uint64_t': 'Q',
+    'Xi::u64': 'Q', 'Xi::usz': 'Q',
+    'long': 'q', 'long long': 'q', 'int64_t': 'q', 'Xi::i64': 'q',
+    'float': 'f', 'Xi::f32': 'f',
+    'double': 'd', 'Xi::f64': 'd',
+}
+
+def _format(obj):
+    if isinstance(obj, String):
+        return 'B'
+    name = type(obj).__cpp_name__
+    arg = name[name.index('<') + 1:name.rindex('>')].strip()
+    fmt = _FORMATS.get(arg)
+    if fmt is None:
+        raise TypeError("no buffer format for %s" % name)
+    return fmt
+
+def view(obj, writable=False):
+    fmt = _format(obj)
+    if not isinstance(obj, String) and hasattr(obj, 'fragments'):
+        obj.data()  # Array<T>: flatten into one fragment at offset 0
+        if obj.fragments.size() == 0:
+            return memoryview(b"").cast(fmt)
+        obj = obj.fragments[0]
+    owner = type(obj)(obj)  # shares the block
+    nbytes = owner.size() * struct.calcsize(fmt)
+    if nbytes == 0:
+        return memoryview(b"").cast(fmt)
+    raw = (ctypes.c_ubyte * nbytes).from_address(owner.address())
+    raw._xi_owner = owner
+    mv = memoryview(raw).cast('B').cast(fmt)
+    return mv if writable else mv.toreadonly()
+
+def numpy(obj, writable=False):
+    import numpy as np
+    mv = view(obj, writable)
+    return np.frombuffer(mv, dtype=mv.format)
+
+def _buffer(self, flags):
+    return view(self, bool(flags & 1))  # inspect.BufferFlags.WRITABLE
+
+def _pythonize(klass, name):
+    if name.startswith(('Array<', 'InlineArray<')):
+        klass.view = view
+        klass.__buffer__ = _buffer
+
+cppyy.py.add_pythonization(_pythonize, 'Xi')
 
 String.__init__ = String_init
 String.__bytes__ = String_bytes
 String.__str__ = lambda self: bytes(self).decode('utf-8', 'replace')
 String.__len__ = lambda self: self.size()
+String.view = view
+String.__buffer__ = _buffer  # PEP 688, Python 3.12+
 
 def generateKeyPair():
     return Xi.generateKeyPair()
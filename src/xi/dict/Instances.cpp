@@ -0,0 +1,3 @@
+// Explicit instantiations behind the extern declarations in XiDict.hpp.
+#define XI_PY_INSTANCES
+#include "XiDict.hpp"
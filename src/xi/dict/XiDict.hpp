@@ -0,0 +1,44 @@
+#ifndef XI_PY_DICT_HPP
+#define XI_PY_DICT_HPP
+
+// Everything the Python package reflects, in one header for genreflex
+// (see selection.xml and XI_BUILD_PYTHON_DICT in CMakeLists.txt).
+//
+// The template instances Python code uses most are declared extern here
+// and defined once in Instances.cpp, so cppyy calls into libXiPy for
+// them instead of instantiating and JIT-compiling the bodies on first
+// use. Add a line when a new instance shows up in hot Python paths;
+// instances whose members do not all compile for their argument (e.g.
+// Array<Packet>, which has no operator==) stay implicit.
+
+#include "Rho/Railway.hpp"
+#include "Rho/Tunnel.hpp"
+#include "Xi/String.hpp"
+
+#ifdef XI_PY_INSTANCES
+#define XI_PY_EXTERN
+#else
+#define XI_PY_EXTERN extern
+#endif
+
+namespace Xi {
+
+XI_PY_EXTERN template class InlineArray<u8>;
+XI_PY_EXTERN template class InlineArray<u64>;
+XI_PY_EXTERN template class InlineArray<f32>;
+XI_PY_EXTERN template class Array<String>;
+XI_PY_EXTERN template class Array<u64>;
+XI_PY_EXTERN template class Array<f32>;
+XI_PY_EXTERN template class Map<u64, String>;
+XI_PY_EXTERN template class Map<u8, String>;
+XI_PY_EXTERN template class Map<String, String>;
+XI_PY_EXTERN template class Func<void()>;
+XI_PY_EXTERN template class Func<void(Packet)>;
+XI_PY_EXTERN template class Func<void(Map<u64, String>)>;
+XI_PY_EXTERN template class Func<void(String, u64, RailwayStation *)>;
+
+} // namespace Xi
+
+#undef XI_PY_EXTERN
+
+#endif